@@ -9,9 +9,13 @@
 #include "bench/CodecBenchPriv.h"
 #include "include/codec/SkAndroidCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSamplingOptions.h"
 #include "src/core/SkOSFile.h"
 #include "tools/flags/CommandLineFlags.h"
 
+#include <algorithm>
+
 AndroidCodecBench::AndroidCodecBench(SkString baseName, SkData* encoded, int sampleSize)
     : fData(SkRef(encoded))
     , fSampleSize(sampleSize)
@@ -53,3 +57,69 @@ void AndroidCodecBench::onDraw(int n, SkCanvas* canvas) {
         SkASSERT(result == SkCodec::kSuccess || result == SkCodec::kIncompleteInput);
     }
 }
+
+AndroidCodecThumbnailBench::AndroidCodecThumbnailBench(SkString baseName, SkData* encoded,
+                                                       int thumbnailSize, bool sampleAndScale)
+    : fData(SkRef(encoded))
+    , fThumbnailSize(thumbnailSize)
+    , fSampleAndScale(sampleAndScale)
+{
+    fName.printf("AndroidCodec_%s_Thumbnail%d%s", baseName.c_str(), thumbnailSize,
+                 sampleAndScale ? "_sampleAndScale" : "");
+}
+
+const char* AndroidCodecThumbnailBench::onGetName() {
+    return fName.c_str();
+}
+
+bool AndroidCodecThumbnailBench::isSuitableFor(Backend backend) {
+    return kNonRendering_Backend == backend;
+}
+
+void AndroidCodecThumbnailBench::onDelayedSetup() {
+    std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromData(fData));
+    const SkISize dims = codec->getInfo().dimensions();
+    const float scale = std::min(1.0f, (float) fThumbnailSize / std::max(dims.width(),
+                                                                         dims.height()));
+    const SkISize thumbnailSize = { std::max(1, SkScalarRoundToInt(dims.width()  * scale)),
+                                    std::max(1, SkScalarRoundToInt(dims.height() * scale)) };
+
+    fInfo = codec->getInfo().makeDimensions(thumbnailSize).makeColorType(kN32_SkColorType);
+    if (kUnpremul_SkAlphaType == fInfo.alphaType()) {
+        fInfo = fInfo.makeAlphaType(kPremul_SkAlphaType);
+    }
+
+    fPixelStorage.reset(fInfo.computeMinByteSize());
+}
+
+void AndroidCodecThumbnailBench::onDraw(int n, SkCanvas* canvas) {
+    std::unique_ptr<SkAndroidCodec> codec;
+    const SkPixmap dst(fInfo, fPixelStorage.get(), fInfo.minRowBytes());
+    for (int i = 0; i < n; i++) {
+        codec = SkAndroidCodec::MakeFromData(fData);
+        if (!fSampleAndScale) {
+#ifdef SK_DEBUG
+            const SkCodec::Result result =
+#endif
+            codec->getResampledPixels(dst.info(), dst.writable_addr(), dst.rowBytes());
+            SkASSERT(result == SkCodec::kSuccess || result == SkCodec::kIncompleteInput);
+            continue;
+        }
+
+        // Decode at the largest sample size that is still at least as large as the thumbnail,
+        // then scale down to it.
+        const SkISize dims = codec->getInfo().dimensions();
+        SkAndroidCodec::AndroidOptions options;
+        options.fSampleSize = std::max(1, std::min(dims.width()  / fInfo.width(),
+                                                   dims.height() / fInfo.height()));
+        SkISize sampled = codec->getSampledDimensions(options.fSampleSize);
+        while (options.fSampleSize > 1 && (sampled.width()  < fInfo.width() ||
+                                           sampled.height() < fInfo.height())) {
+            sampled = codec->getSampledDimensions(--options.fSampleSize);
+        }
+        SkBitmap bitmap;
+        bitmap.allocPixels(fInfo.makeDimensions(sampled));
+        codec->getAndroidPixels(bitmap.info(), bitmap.getPixels(), bitmap.rowBytes(), &options);
+        bitmap.pixmap().scalePixels(dst, SkSamplingOptions(SkCubicResampler::Mitchell()));
+    }
+}
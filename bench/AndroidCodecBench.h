@@ -37,4 +37,30 @@ private:
     SkAutoMalloc            fPixelStorage;  // Set in onDelayedSetup.
     using INHERITED = Benchmark;
 };
+
+/**
+ *  Time decoding a thumbnail that fits in a square of thumbnailSize, either with
+ *  SkAndroidCodec::getResampledPixels() or by decoding a sampled image and scaling that.
+ */
+class AndroidCodecThumbnailBench : public Benchmark {
+public:
+    // Calls encoded->ref()
+    AndroidCodecThumbnailBench(SkString basename, SkData* encoded, int thumbnailSize,
+                               bool sampleAndScale);
+
+protected:
+    const char* onGetName() override;
+    bool isSuitableFor(Backend backend) override;
+    void onDraw(int n, SkCanvas* canvas) override;
+    void onDelayedSetup() override;
+
+private:
+    SkString                fName;
+    sk_sp<SkData>           fData;
+    const int               fThumbnailSize;
+    const bool              fSampleAndScale;
+    SkImageInfo             fInfo;          // Set in onDelayedSetup.
+    SkAutoMalloc            fPixelStorage;  // Set in onDelayedSetup.
+    using INHERITED = Benchmark;
+};
 #endif // AndroidCodecBench_DEFINED
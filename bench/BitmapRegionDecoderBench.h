@@ -23,6 +23,8 @@ class BitmapRegionDecoder;
 
 /**
  *  Benchmark Android's BitmapRegionDecoder for a particular colorType, sampleSize, and subset.
+ *  If useRowIndex, a PNG is decoded with a row index made in setup, so the subset is decoded
+ *  from the index's access point nearest above it.
  *
  *  nanobench.cpp handles creating benchmarks for interesting scaled subsets.  We strive to test
  *  on real use cases.
@@ -31,7 +33,7 @@ class BitmapRegionDecoderBench : public Benchmark {
 public:
     // Calls encoded->ref()
     BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
-            uint32_t sampleSize, const SkIRect& subset);
+            uint32_t sampleSize, const SkIRect& subset, bool useRowIndex = false);
 
 protected:
     const char* onGetName() override;
@@ -46,6 +48,7 @@ private:
     const SkColorType                                   fColorType;
     const uint32_t                                      fSampleSize;
     const SkIRect                                       fSubset;
+    const bool                                          fUseRowIndex;
     using INHERITED = Benchmark;
 };
 #endif // SK_ENABLE_ANDROID_UTILS
@@ -6,14 +6,18 @@
  */
 
 #include "bench/Benchmark.h"
+#include "bench/ImageFilterBenchPriv.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
 #include "include/effects/SkImageFilters.h"
 #include "src/base/SkRandom.h"
 
+#include <memory>
+
 #define FILTER_WIDTH_SMALL  32
 #define FILTER_HEIGHT_SMALL 32
 #define FILTER_WIDTH_LARGE  256
@@ -34,6 +38,10 @@
 // of the source (not inset). This is intended to exercise blurring a smaller source bitmap to a
 // larger destination.
 
+// When 'threads' is positive the filter is evaluated directly, without drawing its output, on a
+// raster filter context given a thread pool of that size to split rows and columns across. The
+// 1-thread variants are the baseline for the others.
+
 static sk_sp<SkImage> make_checkerboard(int width, int height) {
     SkBitmap bm;
     bm.allocN32Pixels(width, height);
@@ -61,18 +69,22 @@ static sk_sp<SkImage> make_checkerboard(int width, int height) {
 class BlurImageFilterBench : public Benchmark {
 public:
     BlurImageFilterBench(SkScalar sigmaX, SkScalar sigmaY,  bool small, bool cropped,
-                         bool expanded)
+                         bool expanded, int threads = 0)
       : fIsSmall(small)
       , fIsCropped(cropped)
       , fIsExpanded(expanded)
       , fInitialized(false)
       , fSigmaX(sigmaX)
-      , fSigmaY(sigmaY) {
+      , fSigmaY(sigmaY)
+      , fThreads(threads) {
         fName.printf("blur_image_filter_%s%s%s_%.2f_%.2f",
             fIsSmall ? "small" : "large",
             fIsCropped ? "_cropped" : "",
             fIsExpanded ? "_expanded" : "",
             SkScalarToFloat(sigmaX), SkScalarToFloat(sigmaY));
+        if (fThreads > 0) {
+            fName.appendf("_%dthreads", fThreads);
+        }
         SkASSERT(!fIsExpanded || fIsCropped); // never want expansion w/o cropping
     }
 
@@ -85,6 +97,9 @@ protected:
         if (!fInitialized) {
             fCheckerboard = make_checkerboard(fIsSmall ? FILTER_WIDTH_SMALL : FILTER_WIDTH_LARGE,
                                               fIsSmall ? FILTER_HEIGHT_SMALL : FILTER_HEIGHT_LARGE);
+            if (fThreads > 0) {
+                fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+            }
             fInitialized = true;
         }
     }
@@ -102,10 +117,19 @@ protected:
 
         const SkIRect* crop =
             fIsExpanded ? &bmpRect : fIsCropped ? &bmpRectInset : nullptr;
+        sk_sp<SkImageFilter> filter =
+                SkImageFilters::Blur(fSigmaX, fSigmaY, std::move(input), crop);
+
+        if (fExecutor) {
+            for (int i = 0; i < loops; i++) {
+                filter_raster_image(filter.get(), fCheckerboard, bmpRect, fExecutor.get());
+            }
+            return;
+        }
+
         SkPaint paint;
-        paint.setImageFilter(SkImageFilters::Blur(fSigmaX, fSigmaY, std::move(input), crop));
+        paint.setImageFilter(std::move(filter));
         SkSamplingOptions sampling;
-
         for (int i = 0; i < loops; i++) {
             canvas->drawImage(fCheckerboard, kX, kY, sampling, &paint);
         }
@@ -120,6 +144,8 @@ private:
     bool fInitialized;
     sk_sp<SkImage> fCheckerboard;
     SkScalar fSigmaX, fSigmaY;
+    int fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
     using INHERITED = Benchmark;
 };
 
@@ -161,3 +187,16 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, false, false,
+                                          1);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, false, false,
+                                          2);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, false, false,
+                                          4);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, false, false,
+                                          1);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, false, false,
+                                          2);)
+DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, false, false,
+                                          4);)
@@ -8,12 +8,15 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkBlurTypes.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkBlurMask.h"
 
+#include <memory>
+
 #define SMALL   SkIntToScalar(2)
 #define REAL    1.5f
 static const SkScalar kMedium = SkIntToScalar(5);
@@ -183,6 +186,64 @@ private:
     using INHERITED = BlurRectSeparableBench;
 };
 
+// Box blurs one large mask, split into bands across a thread pool when threads > 0.
+class BlurMaskThreadsBench: public Benchmark {
+public:
+    BlurMaskThreadsBench(SkScalar rad, int threads) : fRadius(rad), fThreads(threads) {
+        fName.printf("blurmask_boxfilter_%d_%dthreads", SkScalarRoundToInt(rad), threads);
+    }
+
+    ~BlurMaskThreadsBench() override {
+        SkMaskBuilder::FreeImage(fSrcMask.image());
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        if (fSrcMask.fImage) {
+            return;
+        }
+        fSrcMask.bounds() = SkIRect::MakeWH(1024, 1024);
+        fSrcMask.format() = SkMask::kA8_Format;
+        fSrcMask.rowBytes() = fSrcMask.fBounds.width();
+        fSrcMask.image() = SkMaskBuilder::AllocImage(fSrcMask.computeTotalImageSize());
+
+        SkRandom rand;
+        for (size_t i = 0; i < fSrcMask.computeTotalImageSize(); ++i) {
+            fSrcMask.image()[i] = rand.nextU() & 0xFF;
+        }
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkMaskBuilder mask;
+            if (!SkBlurMask::BoxBlur(&mask, fSrcMask, SkBlurMask::ConvertRadiusToSigma(fRadius),
+                                     kNormal_SkBlurStyle, nullptr, fExecutor.get())) {
+                return;
+            }
+            SkMaskBuilder::FreeImage(mask.image());
+        }
+    }
+
+private:
+    SkScalar fRadius;
+    int fThreads;
+    SkString fName;
+    SkMaskBuilder fSrcMask;
+    std::unique_ptr<SkExecutor> fExecutor;
+    using INHERITED = Benchmark;
+};
+
 DEF_BENCH(return new BlurRectBoxFilterBench(SMALL);)
 DEF_BENCH(return new BlurRectBoxFilterBench(BIG);)
 DEF_BENCH(return new BlurRectBoxFilterBench(REALBIG);)
@@ -229,3 +290,9 @@ DEF_BENCH(return new BlurRectGaussianBench(SkIntToScalar(18));)
 DEF_BENCH(return new BlurRectGaussianBench(SkIntToScalar(19));)
 DEF_BENCH(return new BlurRectGaussianBench(SkIntToScalar(20));)
 #endif
+
+DEF_BENCH(return new BlurMaskThreadsBench(BIG, 0);)
+DEF_BENCH(return new BlurMaskThreadsBench(BIG, 2);)
+DEF_BENCH(return new BlurMaskThreadsBench(BIG, 4);)
+DEF_BENCH(return new BlurMaskThreadsBench(REALBIG, 0);)
+DEF_BENCH(return new BlurMaskThreadsBench(REALBIG, 4);)
@@ -6,12 +6,16 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "modules/skottie/include/Skottie.h"
 #include "tools/Resources.h"
 
+#include <memory>
+
 class DecodeBench : public Benchmark {
 protected:
     DecodeBench(const char* name, const char* source)
@@ -55,6 +59,40 @@ private:
     using INHERITED = DecodeBench;
 };
 
+// Decodes with SkCodec::getPixels(), letting the codec use threads to decode parts of the image
+// in parallel where it can.
+class CodecThreadsDecodeBench final : public DecodeBench {
+public:
+    CodecThreadsDecodeBench(const char* name, const char* source, int threads)
+        : INHERITED(SkStringPrintf("%s_%dthreads", name, threads).c_str(), source)
+        , fThreads(threads)
+    {}
+
+    void onDelayedSetup() override {
+        INHERITED::onDelayedSetup();
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+        fBitmap.allocPixels(SkCodec::MakeFromData(fData)->getInfo()
+                                                         .makeColorType(kN32_SkColorType));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCodec::Options options;
+        options.fExecutor = fExecutor.get();
+        while (loops-- > 0) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(fData);
+            SkAssertResult(SkCodec::kSuccess == codec->getPixels(fBitmap.pixmap(), &options));
+        }
+    }
+
+private:
+    const int                   fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkBitmap                    fBitmap;
+
+    using INHERITED = DecodeBench;
+};
 
 class SkottieDecodeBench final : public DecodeBench {
 public:
@@ -234,3 +272,10 @@ DEF_BENCH(return new BitmapDecodeBench("png_small"    /*  32x  32*/, "images/man
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_connecting"   , "images/Connecting.png"));
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_generic_error", "images/Generic_Error.png"));
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_onboard"      , "images/Onboard.png"));
+
+// 3024x4032, with a restart marker after each row of MCUs.
+DEF_BENCH(return new CodecThreadsDecodeBench("jpeg_restart_large", "images/iphone_13_pro.jpeg", 0));
+DEF_BENCH(return new CodecThreadsDecodeBench("jpeg_restart_large", "images/iphone_13_pro.jpeg", 1));
+DEF_BENCH(return new CodecThreadsDecodeBench("jpeg_restart_large", "images/iphone_13_pro.jpeg", 2));
+DEF_BENCH(return new CodecThreadsDecodeBench("jpeg_restart_large", "images/iphone_13_pro.jpeg", 4));
+DEF_BENCH(return new CodecThreadsDecodeBench("jpeg_restart_large", "images/iphone_13_pro.jpeg", 8));
@@ -6,12 +6,17 @@
  */
 
 #include "bench/Benchmark.h"
+#include "bench/ImageFilterBenchPriv.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
+#include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 
+#include <memory>
+
 #define FILTER_WIDTH_SMALL  32
 #define FILTER_HEIGHT_SMALL 32
 #define FILTER_WIDTH_LARGE  256
@@ -19,15 +24,33 @@
 
 class DisplacementBaseBench : public Benchmark {
 public:
-    DisplacementBaseBench(bool small) : fInitialized(false), fIsSmall(small) { }
+    // If threads > 0, the filter is evaluated directly, without drawing its output, on a raster
+    // filter context given a thread pool of that size, which displaces the large output in bands
+    // of rows. The 1-thread variant displaces the same bands one at a time and is the baseline for
+    // the others.
+    DisplacementBaseBench(bool small, int threads)
+            : fInitialized(false), fIsSmall(small), fThreads(threads) { }
 
 protected:
+    const char* makeName(const char* name) {
+        if (fName.isEmpty()) {
+            fName.printf("%s_%s", name, fIsSmall ? "small" : "large");
+            if (fThreads > 0) {
+                fName.appendf("_%dthreads", fThreads);
+            }
+        }
+        return fName.c_str();
+    }
+
     void onDelayedSetup() override {
         if (!fInitialized) {
             this->makeBitmap();
             this->makeCheckerboard();
             fInitialized = true;
         }
+        if (fThreads > 0 && !fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
     }
 
     void makeBitmap() {
@@ -68,11 +91,22 @@ protected:
         fCheckerboard = surface->makeImageSnapshot();
     }
 
-    void drawClippedBitmap(SkCanvas* canvas, int x, int y, const SkPaint& paint) {
-        canvas->save();
-        canvas->clipIRect(fImage->bounds().makeOffset(x, y));
-        canvas->drawImage(fImage, SkIntToScalar(x), SkIntToScalar(y), SkSamplingOptions(), &paint);
-        canvas->restore();
+    void drawClippedBitmaps(int loops, SkCanvas* canvas, int x, int y, const SkPaint& paint) {
+        if (fExecutor) {
+            for (int i = 0; i < loops; i++) {
+                filter_raster_image(paint.getImageFilter(), fImage, fImage->bounds(),
+                                    fExecutor.get());
+            }
+            return;
+        }
+
+        for (int i = 0; i < loops; i++) {
+            canvas->save();
+            canvas->clipIRect(fImage->bounds().makeOffset(x, y));
+            canvas->drawImage(fImage, SkIntToScalar(x), SkIntToScalar(y), SkSamplingOptions(),
+                              &paint);
+            canvas->restore();
+        }
     }
 
     inline bool isSmall() const { return fIsSmall; }
@@ -82,16 +116,19 @@ protected:
 private:
     bool fInitialized;
     bool fIsSmall;
+    int fThreads;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
     using INHERITED = Benchmark;
 };
 
 class DisplacementZeroBench : public DisplacementBaseBench {
 public:
-    DisplacementZeroBench(bool small) : INHERITED(small) { }
+    DisplacementZeroBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return this->isSmall() ? "displacement_zero_small" : "displacement_zero_large";
+        return this->makeName("displacement_zero");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -100,10 +137,7 @@ protected:
         // No displacement effect
         paint.setImageFilter(SkImageFilters::DisplacementMap(SkColorChannel::kR, SkColorChannel::kG,
                                                              0.0f, std::move(displ), nullptr));
-
-        for (int i = 0; i < loops; i++) {
-            this->drawClippedBitmap(canvas, 0, 0, paint);
-        }
+        this->drawClippedBitmaps(loops, canvas, 0, 0, paint);
     }
 
 private:
@@ -112,11 +146,11 @@ private:
 
 class DisplacementAlphaBench : public DisplacementBaseBench {
 public:
-    DisplacementAlphaBench(bool small) : INHERITED(small) { }
+    DisplacementAlphaBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return isSmall() ? "displacement_alpha_small" : "displacement_alpha_large";
+        return this->makeName("displacement_alpha");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -125,9 +159,7 @@ protected:
         // Displacement, with 1 alpha component (which isn't pre-multiplied)
         paint.setImageFilter(SkImageFilters::DisplacementMap(SkColorChannel::kB, SkColorChannel::kA,
                                                              16.0f, std::move(displ), nullptr));
-        for (int i = 0; i < loops; i++) {
-            this->drawClippedBitmap(canvas, 100, 0, paint);
-        }
+        this->drawClippedBitmaps(loops, canvas, 100, 0, paint);
     }
 
 private:
@@ -136,11 +168,11 @@ private:
 
 class DisplacementFullBench : public DisplacementBaseBench {
 public:
-    DisplacementFullBench(bool small) : INHERITED(small) { }
+    DisplacementFullBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return isSmall() ? "displacement_full_small" : "displacement_full_large";
+        return this->makeName("displacement_full");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -149,9 +181,7 @@ protected:
         // Displacement, with 2 non-alpha components
         paint.setImageFilter(SkImageFilters::DisplacementMap(SkColorChannel::kR, SkColorChannel::kB,
                                                              32.0f, std::move(displ), nullptr));
-        for (int i = 0; i < loops; ++i) {
-            this->drawClippedBitmap(canvas, 200, 0, paint);
-        }
+        this->drawClippedBitmaps(loops, canvas, 200, 0, paint);
     }
 
 private:
@@ -166,3 +196,5 @@ DEF_BENCH( return new DisplacementFullBench(true); )
 DEF_BENCH( return new DisplacementZeroBench(false); )
 DEF_BENCH( return new DisplacementAlphaBench(false); )
 DEF_BENCH( return new DisplacementFullBench(false); )
+DEF_BENCH( return new DisplacementFullBench(false, 1); )
+DEF_BENCH( return new DisplacementFullBench(false, 4); )
@@ -7,12 +7,17 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/encode/SkWebpEncoder.h"
 #include "tools/Resources.h"
 
+#include <memory>
+
 // Like other Benchmark subclasses, Encoder benchmarks are run by:
 // nanobench --match ^Encode_
 //
@@ -123,3 +128,62 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
 #undef PNG
+
+// Encodes a screenshot-sized image as PNG. If threads > 0, the rows are filtered and deflated in
+// parallel on a thread pool of that size. nanobench can only report time per unit, so the units
+// are megabytes of pixels and the name says so: the times are ms per MB, and MB/s is 1000 / ms.
+class PngThreadsEncodeBench : public Benchmark {
+public:
+    PngThreadsEncodeBench(int threads) : fThreads(threads) {
+        fName.printf("Encode_PNG_%dx%d_per_MB", kWidth, kHeight);
+        if (fThreads > 0) {
+            fName.appendf("_%dthreads", fThreads);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkBitmap tile;
+        SkAssertResult(GetResourceAsBitmap("images/mandrill_512.png", &tile));
+        fBitmap.allocN32Pixels(kWidth, kHeight, /*isOpaque=*/true);
+        SkCanvas canvas(fBitmap);
+        for (int y = 0; y < kHeight; y += tile.height()) {
+            for (int x = 0; x < kWidth; x += tile.width()) {
+                canvas.drawImage(tile.asImage(), x, y);
+            }
+        }
+        this->setUnits(SkToInt(fBitmap.computeByteSize() >> 20));  // Exactly 80MB.
+
+        if (fThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPngEncoder::Options options;
+        options.fExecutor = fExecutor.get();
+        while (loops-- > 0) {
+            SkNullWStream dst;
+            SkAssertResult(SkPngEncoder::Encode(&dst, fBitmap.pixmap(), options));
+        }
+    }
+
+private:
+    // About 20 megapixels.
+    static constexpr int kWidth = 5120;
+    static constexpr int kHeight = 4096;
+
+    int fThreads;
+    SkString fName;
+    SkBitmap fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH(return new PngThreadsEncodeBench(0));
+DEF_BENCH(return new PngThreadsEncodeBench(1));
+DEF_BENCH(return new PngThreadsEncodeBench(2));
+DEF_BENCH(return new PngThreadsEncodeBench(4));
+DEF_BENCH(return new PngThreadsEncodeBench(8));
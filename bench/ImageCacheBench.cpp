@@ -6,7 +6,10 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -75,3 +78,59 @@ private:
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+
+// Threads hammering one cache with a mix of hits and misses. Each miss adds a rec, keeping the
+// cache over budget so that it purges (on a background thread) as it goes.
+class ImageCacheThreadedBench : public Benchmark {
+public:
+    explicit ImageCacheThreadedBench(int threads) : fThreads(threads) {}
+
+protected:
+    const char* onGetName() override {
+        fName.printf("imagecache_threaded_%d", fThreads);
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        if (!fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+            fPurgeExecutor = SkExecutor::MakeFIFOThreadPool(1, /*allowBorrowing=*/false);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        // A budget of fewer recs than keys, so that some finds miss.
+        SkResourceCache cache(KEY_COUNT * 3 / 4 * sizeof(TestRec));
+        cache.setPurgeExecutor(fPurgeExecutor.get());
+
+        SkTaskGroup(*fExecutor).batch(fThreads, [&](int thread) {
+            // Step through the keys with a different stride on each thread.
+            const intptr_t stride = 2 * thread + 1;
+            for (int i = 0; i < loops * OPS_PER_LOOP; ++i) {
+                TestKey key((i * stride) % KEY_COUNT);
+                if (!cache.find(key, TestRec::Visitor, nullptr)) {
+                    cache.add(new TestRec(key, i));
+                }
+            }
+        });
+    }
+
+private:
+    enum {
+        KEY_COUNT = 4096,
+        OPS_PER_LOOP = 256,
+    };
+
+    const int fThreads;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::unique_ptr<SkExecutor> fPurgeExecutor;
+};
+
+DEF_BENCH( return new ImageCacheThreadedBench(1); )
+DEF_BENCH( return new ImageCacheThreadedBench(4); )
+DEF_BENCH( return new ImageCacheThreadedBench(16); )
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef ImageFilterBenchPriv_DEFINED
+#define ImageFilterBenchPriv_DEFINED
+
+#include "include/core/SkImage.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/core/SkImageFilterTypes.h"
+#include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkSpecialImage.h"
+
+class SkExecutor;
+
+// Evaluates a filter over a raster source image, without drawing the result. The layer matrix is
+// the identity and the source sits at the origin, so the filter's inputs are integer translations
+// and, when given an executor, CPU filters shade outputs of at least 128 rows in bands across it.
+// A null executor evaluates everything on the calling thread.
+inline sk_sp<SkSpecialImage> filter_raster_image(const SkImageFilter* filter,
+                                                 const sk_sp<SkImage>& source,
+                                                 const SkIRect& desiredOutput,
+                                                 SkExecutor* executor) {
+    sk_sp<SkSpecialImage> src = SkSpecialImages::MakeFromRaster(source->bounds(), source, {});
+    if (!src) {
+        return nullptr;
+    }
+    skif::ContextInfo ctxInfo = {skif::Mapping(SkMatrix::I()),
+                                 skif::LayerSpace<SkIRect>(desiredOutput),
+                                 skif::FilterResult(src),
+                                 src->colorType(),
+                                 src->getColorSpace(),
+                                 src->props(),
+                                 /*cache=*/nullptr,
+                                 executor};
+    skif::Context ctx = skif::Context::MakeRaster(ctxInfo);
+    SkIPoint offset;
+    return as_IFB(filter)->filterImage(ctx).imageAndOffset(ctx, &offset);
+}
+
+#endif  // ImageFilterBenchPriv_DEFINED
@@ -6,14 +6,22 @@
  */
 
 #include "bench/Benchmark.h"
+#include "bench/ImageFilterBenchPriv.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColorFilter.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/gpu/GrDirectContext.h"
 #include "include/gpu/GrRecordingContext.h"
 #include "include/gpu/ganesh/SkImageGanesh.h"
 #include "tools/Resources.h"
 
+#include <memory>
+
 // Exercise a blur filter connected to 5 inputs of the same merge filter.
 // This bench shows an improvement in performance once cacheing of re-used
 // nodes is implemented, since the DAG is no longer flattened to a tree.
@@ -165,7 +173,103 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Exercise a blur of an image drawn at a different whole pixel offset each frame, as when the
+// content of a layer scrolls. The filter doesn't read its source, so each frame can reuse the
+// result of the first one, translated, from the image filter cache.
+class ImageFilterScrollBench : public Benchmark {
+public:
+    ImageFilterScrollBench() {}
+
+protected:
+    const char* onGetName() override { return "image_filter_scroll"; }
+
+    void onDelayedSetup() override {
+        fImage = GetResourceAsImage("images/mandrill_512.png");
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        // Allocate filters once to avoid measuring instantiation time
+        auto image = SkImageFilters::Image(fImage, SkRect::Make(fImage->bounds()),
+                                           SkRect::MakeWH(200.0f, 200.0f),
+                                           SkSamplingOptions(SkFilterMode::kLinear));
+        SkPaint paint;
+        paint.setImageFilter(SkImageFilters::Blur(20.0f, 20.0f, std::move(image)));
+
+        // Scroll down by a pixel a frame, staying inside the 640x480 viewport
+        for (int j = 0; j < loops; j++) {
+            canvas->save();
+            canvas->translate(0.0f, (float)(j % kScrollRange));
+            canvas->drawRect(SkRect::MakeWH(200.0f, 200.0f), paint);
+            canvas->restore();
+        }
+    }
+
+private:
+    static const int kScrollRange = 200;
+    sk_sp<SkImage> fImage;
+
+    using INHERITED = Benchmark;
+};
+
+// Exercise a merge of independent blur and color matrix chains, evaluated directly on a raster
+// filter context for a small part of their unbounded output. The branches are evaluated on a thread
+// pool of the given size; the 1-thread variant is the baseline for the others.
+class ImageFilterMergeBranchesBench : public Benchmark {
+public:
+    ImageFilterMergeBranchesBench(int threads) : fThreads(threads) {
+        fName.printf("image_filter_merge_branches_%dthreads", fThreads);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return kNonRendering_Backend == backend; }
+
+    void onDelayedSetup() override {
+        if (!fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+            // The merge doesn't read its source, but the filter context needs one.
+            fSource = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(1, 1))->makeImageSnapshot();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const float kDesaturate[20] = {0.33f, 0.33f, 0.33f, 0, 0,
+                                       0.33f, 0.33f, 0.33f, 0, 0,
+                                       0.33f, 0.33f, 0.33f, 0, 0,
+                                       0,     0,     0,     1, 0};
+        sk_sp<SkImageFilter> inputs[kNumInputs];
+        for (int i = 0; i < kNumInputs; ++i) {
+            const SkColor color = SkColorSetARGB(0xFF, 0x40 * i, 0x80, 0xFF - 0x40 * i);
+            inputs[i] = SkImageFilters::ColorFilter(
+                    SkColorFilters::Matrix(kDesaturate),
+                    SkImageFilters::Blur(4.0f + i, 4.0f + i,
+                                         SkImageFilters::Shader(SkShaders::Color(color))));
+        }
+        sk_sp<SkImageFilter> merge = SkImageFilters::Merge(inputs, kNumInputs);
+
+        // filter_raster_image() evaluates without the image filter cache, so each loop does the
+        // work again.
+        for (int j = 0; j < loops; j++) {
+            filter_raster_image(merge.get(), fSource, SkIRect::MakeXYWH(100, 100, 300, 200),
+                                fExecutor.get());
+        }
+    }
+
+private:
+    static const int kNumInputs = 4;
+    int fThreads;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkImage> fSource;
+
+    using INHERITED = Benchmark;
+};
+
 DEF_BENCH(return new ImageFilterDAGBench;)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
+DEF_BENCH(return new ImageFilterScrollBench;)
+DEF_BENCH(return new ImageFilterMergeBranchesBench(1);)
+DEF_BENCH(return new ImageFilterMergeBranchesBench(4);)
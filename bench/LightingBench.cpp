@@ -5,10 +5,17 @@
  * found in the LICENSE file.
  */
 #include "bench/Benchmark.h"
+#include "bench/ImageFilterBenchPriv.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPoint3.h"
+#include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 
+#include <memory>
+
 #define FILTER_WIDTH_SMALL  SkIntToScalar(32)
 #define FILTER_HEIGHT_SMALL SkIntToScalar(32)
 #define FILTER_WIDTH_LARGE  SkIntToScalar(256)
@@ -16,16 +23,53 @@
 
 class LightingBaseBench : public Benchmark {
 public:
-    LightingBaseBench(bool small) : fIsSmall(small) { }
+    // If threads > 0, the filter is evaluated directly, without drawing its output, on a raster
+    // filter context given a thread pool of that size, which lights the large output in bands of
+    // rows. The 1-thread variants light the same bands one at a time and are the baseline for the
+    // others.
+    LightingBaseBench(bool small, int threads) : fIsSmall(small), fThreads(threads) { }
 
 protected:
+    const char* makeName(const char* name) {
+        if (fName.isEmpty()) {
+            fName.printf("%s_%s", name, fIsSmall ? "small" : "large");
+            if (fThreads > 0) {
+                fName.appendf("_%dthreads", fThreads);
+            }
+        }
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        if (fThreads > 0 && !fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+
+            // The same rect draw() draws, as the source of the filter.
+            const SkRect r = this->rect();
+            auto surface = SkSurfaces::Raster(
+                    SkImageInfo::MakeN32Premul(r.roundOut().width(), r.roundOut().height()));
+            surface->getCanvas()->drawRect(r, SkPaint());
+            fSource = surface->makeImageSnapshot();
+        }
+    }
+
+    SkRect rect() const {
+        return fIsSmall ? SkRect::MakeWH(FILTER_WIDTH_SMALL, FILTER_HEIGHT_SMALL) :
+                          SkRect::MakeWH(FILTER_WIDTH_LARGE, FILTER_HEIGHT_LARGE);
+    }
+
     void draw(int loops, SkCanvas* canvas, sk_sp<SkImageFilter> imageFilter) const {
-        SkRect r = fIsSmall ? SkRect::MakeWH(FILTER_WIDTH_SMALL, FILTER_HEIGHT_SMALL) :
-                              SkRect::MakeWH(FILTER_WIDTH_LARGE, FILTER_HEIGHT_LARGE);
+        if (fExecutor) {
+            for (int i = 0; i < loops; i++) {
+                filter_raster_image(imageFilter.get(), fSource, fSource->bounds(), fExecutor.get());
+            }
+            return;
+        }
+
         SkPaint paint;
         paint.setImageFilter(std::move(imageFilter));
         for (int i = 0; i < loops; i++) {
-            canvas->drawRect(r, paint);
+            canvas->drawRect(this->rect(), paint);
         }
     }
 
@@ -92,16 +136,20 @@ protected:
     }
 
     bool fIsSmall;
+    int fThreads;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkImage> fSource;
     using INHERITED = Benchmark;
 };
 
 class LightingPointLitDiffuseBench : public LightingBaseBench {
 public:
-    LightingPointLitDiffuseBench(bool small) : INHERITED(small) { }
+    LightingPointLitDiffuseBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return fIsSmall ? "lightingpointlitdiffuse_small" : "lightingpointlitdiffuse_large";
+        return this->makeName("lightingpointlitdiffuse");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -115,11 +163,11 @@ private:
 
 class LightingDistantLitDiffuseBench : public LightingBaseBench {
 public:
-    LightingDistantLitDiffuseBench(bool small) : INHERITED(small) { }
+    LightingDistantLitDiffuseBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return fIsSmall ? "lightingdistantlitdiffuse_small" : "lightingdistantlitdiffuse_large";
+        return this->makeName("lightingdistantlitdiffuse");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -133,11 +181,11 @@ private:
 
 class LightingSpotLitDiffuseBench : public LightingBaseBench {
 public:
-    LightingSpotLitDiffuseBench(bool small) : INHERITED(small) { }
+    LightingSpotLitDiffuseBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return fIsSmall ? "lightingspotlitdiffuse_small" : "lightingspotlitdiffuse_large";
+        return this->makeName("lightingspotlitdiffuse");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -152,11 +200,11 @@ private:
 
 class LightingPointLitSpecularBench : public LightingBaseBench {
 public:
-    LightingPointLitSpecularBench(bool small) : INHERITED(small) { }
+    LightingPointLitSpecularBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return fIsSmall ? "lightingpointlitspecular_small" : "lightingpointlitspecular_large";
+        return this->makeName("lightingpointlitspecular");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -171,11 +219,11 @@ private:
 
 class LightingDistantLitSpecularBench : public LightingBaseBench {
 public:
-    LightingDistantLitSpecularBench(bool small) : INHERITED(small) { }
+    LightingDistantLitSpecularBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return fIsSmall ? "lightingdistantlitspecular_small" : "lightingdistantlitspecular_large";
+        return this->makeName("lightingdistantlitspecular");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -190,11 +238,11 @@ private:
 
 class LightingSpotLitSpecularBench : public LightingBaseBench {
 public:
-    LightingSpotLitSpecularBench(bool small) : INHERITED(small) { }
+    LightingSpotLitSpecularBench(bool small, int threads = 0) : INHERITED(small, threads) { }
 
 protected:
     const char* onGetName() override {
-        return fIsSmall ? "lightingspotlitspecular_small" : "lightingspotlitspecular_large";
+        return this->makeName("lightingspotlitspecular");
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
@@ -221,3 +269,7 @@ DEF_BENCH( return new LightingDistantLitSpecularBench(true); )
 DEF_BENCH( return new LightingDistantLitSpecularBench(false); )
 DEF_BENCH( return new LightingSpotLitSpecularBench(true); )
 DEF_BENCH( return new LightingSpotLitSpecularBench(false); )
+DEF_BENCH( return new LightingPointLitDiffuseBench(false, 1); )
+DEF_BENCH( return new LightingPointLitDiffuseBench(false, 4); )
+DEF_BENCH( return new LightingSpotLitSpecularBench(false, 1); )
+DEF_BENCH( return new LightingSpotLitSpecularBench(false, 4); )
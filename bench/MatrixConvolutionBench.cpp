@@ -5,22 +5,36 @@
  * found in the LICENSE file.
  */
 #include "bench/Benchmark.h"
+#include "bench/ImageFilterBenchPriv.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
 #include "include/core/SkTileMode.h"
 #include "include/effects/SkImageFilters.h"
 #include "src/base/SkRandom.h"
 
 #include "tools/ToolUtils.h"
 
+#include <memory>
+
 class MatrixConvolutionBench : public Benchmark {
 public:
-    MatrixConvolutionBench(bool bigKernel, SkTileMode tileMode, bool convolveAlpha)
+    // If threads > 0, the filter is evaluated directly, without drawing its output, over a 400x400
+    // oval on a raster filter context given a thread pool of that size to shade the output rows
+    // across. The 1-thread variant is the baseline for the others.
+    MatrixConvolutionBench(bool bigKernel, SkTileMode tileMode, bool convolveAlpha,
+                           int threads = 0)
         : fName(SkStringPrintf("matrixconvolution_%s%s%s",
                                bigKernel ? "bigKernel_" : "",
                                ToolUtils::tilemode_name(tileMode),
-                               convolveAlpha ? "" : "_noConvolveAlpha")) {
+                               convolveAlpha ? "" : "_noConvolveAlpha"))
+        , fThreads(threads) {
+        if (fThreads > 0) {
+            fName.appendf("_%dthreads", fThreads);
+        }
         if (bigKernel) {
             SkISize kernelSize = SkISize::Make(9, 9);
             SkScalar kernel[81];
@@ -53,7 +67,26 @@ protected:
         return fName.c_str();
     }
 
+    void onDelayedSetup() override {
+        if (fThreads > 0 && !fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+
+            auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(400, 400));
+            SkPaint paint;
+            paint.setAntiAlias(true);
+            surface->getCanvas()->drawOval(SkRect::MakeWH(400, 400), paint);
+            fSource = surface->makeImageSnapshot();
+        }
+    }
+
     void onDraw(int loops, SkCanvas* canvas) override {
+        if (fExecutor) {
+            for (int i = 0; i < loops; i++) {
+                filter_raster_image(fFilter.get(), fSource, fSource->bounds(), fExecutor.get());
+            }
+            return;
+        }
+
         SkPaint paint;
         this->setupPaint(&paint);
         paint.setImageFilter(fFilter);
@@ -70,6 +103,9 @@ protected:
 private:
     sk_sp<SkImageFilter> fFilter;
     SkString fName;
+    int fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkImage> fSource;
 
     using INHERITED = Benchmark;
 };
@@ -85,3 +121,6 @@ DEF_BENCH( return new MatrixConvolutionBench(true, SkTileMode::kRepeat, true); )
 DEF_BENCH( return new MatrixConvolutionBench(true, SkTileMode::kMirror, true); )
 DEF_BENCH( return new MatrixConvolutionBench(true, SkTileMode::kDecal, true); )
 DEF_BENCH( return new MatrixConvolutionBench(true, SkTileMode::kDecal, false); )
+
+DEF_BENCH( return new MatrixConvolutionBench(true, SkTileMode::kDecal, true, 1); )
+DEF_BENCH( return new MatrixConvolutionBench(true, SkTileMode::kDecal, true, 4); )
@@ -6,16 +6,23 @@
  */
 
 #include "bench/Benchmark.h"
+#include "bench/ImageFilterBenchPriv.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
 #include "src/base/SkRandom.h"
 
+#include <memory>
+
 #define SMALL   SkIntToScalar(2)
 #define REAL    1.5f
 #define BIG     SkIntToScalar(10)
+#define LARGE    SkIntToScalar(64)
 
 enum MorphologyType {
     kErode_MT,
@@ -30,19 +37,29 @@ static const char* gStyleName[] = {
 class MorphologyBench : public Benchmark {
     SkScalar       fRadius;
     MorphologyType fStyle;
+    int            fThreads;
     SkString       fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+    sk_sp<SkImage> fSource;
 
 public:
-    MorphologyBench(SkScalar rad, MorphologyType style)
+    // If threads > 0, the filter is evaluated directly, without drawing its output, over a 400x400
+    // oval on a raster filter context given a thread pool of that size to split the morphology
+    // across. The 1-thread variant is the baseline for the others.
+    MorphologyBench(SkScalar rad, MorphologyType style, int threads = 0)
          {
         fRadius = rad;
         fStyle = style;
+        fThreads = threads;
         const char* name = rad > 0 ? gStyleName[style] : "none";
         if (SkScalarFraction(rad) != 0) {
             fName.printf("morph_%.2f_%s", SkScalarToFloat(rad), name);
         } else {
             fName.printf("morph_%d_%s", SkScalarRoundToInt(rad), name);
         }
+        if (fThreads > 0) {
+            fName.appendf("_%dthreads", fThreads);
+        }
     }
 
 protected:
@@ -50,7 +67,27 @@ protected:
         return fName.c_str();
     }
 
+    void onDelayedSetup() override {
+        if (fThreads > 0 && !fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+
+            auto surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(400, 400));
+            SkPaint paint;
+            paint.setAntiAlias(true);
+            surface->getCanvas()->drawOval(SkRect::MakeWH(400, 400), paint);
+            fSource = surface->makeImageSnapshot();
+        }
+    }
+
     void onDraw(int loops, SkCanvas* canvas) override {
+        if (fExecutor) {
+            sk_sp<SkImageFilter> mf = this->makeFilter();
+            for (int i = 0; i < loops; i++) {
+                filter_raster_image(mf.get(), fSource, fSource->bounds(), fExecutor.get());
+            }
+            return;
+        }
+
         SkPaint paint;
         this->setupPaint(&paint);
 
@@ -63,23 +100,24 @@ protected:
             r.offset(fRadius, fRadius);
 
             if (fRadius > 0) {
-                sk_sp<SkImageFilter> mf;
-                switch (fStyle) {
-                case kDilate_MT:
-                    mf = SkImageFilters::Dilate(
-                            SkScalarFloorToInt(fRadius), SkScalarFloorToInt(fRadius), nullptr);
-                    break;
-                case kErode_MT:
-                    mf = SkImageFilters::Erode(
-                            SkScalarFloorToInt(fRadius), SkScalarFloorToInt(fRadius), nullptr);
-                    break;
-                }
-                paint.setImageFilter(std::move(mf));
+                paint.setImageFilter(this->makeFilter());
             }
             canvas->drawOval(r, paint);
         }
     }
 
+    sk_sp<SkImageFilter> makeFilter() const {
+        switch (fStyle) {
+        case kDilate_MT:
+            return SkImageFilters::Dilate(
+                    SkScalarFloorToInt(fRadius), SkScalarFloorToInt(fRadius), nullptr);
+        case kErode_MT:
+            return SkImageFilters::Erode(
+                    SkScalarFloorToInt(fRadius), SkScalarFloorToInt(fRadius), nullptr);
+        }
+        SkUNREACHABLE;
+    }
+
 private:
     using INHERITED = Benchmark;
 };
@@ -94,3 +132,8 @@ DEF_BENCH( return new MorphologyBench(REAL, kErode_MT); )
 DEF_BENCH( return new MorphologyBench(REAL, kDilate_MT); )
 
 DEF_BENCH( return new MorphologyBench(0, kErode_MT); )
+
+DEF_BENCH( return new MorphologyBench(LARGE, kErode_MT); )
+DEF_BENCH( return new MorphologyBench(LARGE, kDilate_MT); )
+DEF_BENCH( return new MorphologyBench(LARGE, kDilate_MT, 1); )
+DEF_BENCH( return new MorphologyBench(LARGE, kDilate_MT, 4); )
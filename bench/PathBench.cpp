@@ -21,6 +21,7 @@
 
 #include "src/core/SkDraw.h"
 #include "src/core/SkMatrixPriv.h"
+#include "src/core/SkScan.h"
 
 using namespace skia_private;
 
@@ -38,6 +39,7 @@ class PathBench : public Benchmark {
     SkPaint     fPaint;
     SkString    fName;
     Flags       fFlags;
+    bool        fDeltaAA = false;
 public:
     PathBench(Flags flags) : fFlags(flags) {
         fPaint.setStyle(flags & kStroke_Flag ? SkPaint::kStroke_Style :
@@ -50,12 +52,21 @@ public:
     virtual void makePath(SkPath*) = 0;
     virtual int complexity() { return 0; }
 
+    // Draws with the delta accumulation scan converter instead of AAA/SAA.
+    PathBench* withDeltaAA() {
+        fDeltaAA = true;
+        return this;
+    }
+
 protected:
     const char* onGetName() override {
         fName.printf("path_%s_%s_",
                      fFlags & kStroke_Flag ? "stroke" : "fill",
                      fFlags & kBig_Flag ? "big" : "small");
         this->appendName(&fName);
+        if (fDeltaAA) {
+            fName.append("_daa");
+        }
         return fName.c_str();
     }
 
@@ -70,9 +81,12 @@ protected:
             path.transform(m);
         }
 
+        const bool forceDeltaAA = gSkForceDeltaAA;
+        gSkForceDeltaAA = fDeltaAA;
         for (int i = 0; i < loops; i++) {
             canvas->drawPath(path, paint);
         }
+        gSkForceDeltaAA = forceDeltaAA;
     }
 
 private:
@@ -1199,6 +1213,17 @@ DEF_BENCH( return new LongCurvedPathBench(FLAGS01); )
 DEF_BENCH( return new LongLinePathBench(FLAGS00); )
 DEF_BENCH( return new LongLinePathBench(FLAGS01); )
 
+DEF_BENCH( return (new OvalPathBench(FLAGS10))->withDeltaAA(); )
+DEF_BENCH( return (new CirclePathBench(FLAGS10))->withDeltaAA(); )
+DEF_BENCH( return (new AAAConcavePathBench(FLAGS10))->withDeltaAA(); )
+DEF_BENCH( return (new AAAConvexPathBench(FLAGS10))->withDeltaAA(); )
+DEF_BENCH( return (new SawToothPathBench(FLAGS00))->withDeltaAA(); )
+DEF_BENCH( return (new SawToothPathBench(FLAGS01))->withDeltaAA(); )
+DEF_BENCH( return (new LongCurvedPathBench(FLAGS00))->withDeltaAA(); )
+DEF_BENCH( return (new LongCurvedPathBench(FLAGS01))->withDeltaAA(); )
+DEF_BENCH( return (new LongLinePathBench(FLAGS00))->withDeltaAA(); )
+DEF_BENCH( return (new LongLinePathBench(FLAGS01))->withDeltaAA(); )
+
 DEF_BENCH( return new PathCreateBench(); )
 DEF_BENCH( return new PathCopyBench(); )
 DEF_BENCH( return new PathTransformBench(true); )
@@ -20,13 +20,19 @@ static const int NUM_BUILD_RECTS = 500;
 static const int NUM_QUERY_RECTS = 5000;
 static const int GRID_WIDTH = 100;
 
+static const char* ordering_suffix(SkRTree::Ordering ordering) {
+    return ordering == SkRTree::Ordering::kHilbert ? "" : "_insertionorder";
+}
+
 typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
 
 // Time how long it takes to build an R-Tree.
 class RTreeBuildBench : public Benchmark {
 public:
-    RTreeBuildBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_build", name);
+    RTreeBuildBench(const char* name, MakeRectProc proc,
+                    SkRTree::Ordering ordering = SkRTree::Ordering::kHilbert)
+            : fProc(proc), fOrdering(ordering) {
+        fName.printf("rtree_%s_build%s", name, ordering_suffix(ordering));
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -45,12 +51,13 @@ protected:
         }
 
         for (int i = 0; i < loops; ++i) {
-            SkRTree tree;
+            SkRTree tree(fOrdering);
             tree.insert(rects.data(), NUM_BUILD_RECTS);
         }
     }
 private:
     MakeRectProc fProc;
+    SkRTree::Ordering fOrdering;
     SkString fName;
     using INHERITED = Benchmark;
 };
@@ -58,8 +65,10 @@ private:
 // Time how long it takes to perform queries on an R-Tree.
 class RTreeQueryBench : public Benchmark {
 public:
-    RTreeQueryBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_query", name);
+    RTreeQueryBench(const char* name, MakeRectProc proc,
+                    SkRTree::Ordering ordering = SkRTree::Ordering::kHilbert)
+            : fTree(ordering), fProc(proc) {
+        fName.printf("rtree_%s_query%s", name, ordering_suffix(ordering));
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -97,6 +106,61 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Time how long it takes to find the ops for every tile of a large picture, either by searching
+// once per tile or by partitioning the tree in one pass.
+class RTreeTilesBench : public Benchmark {
+public:
+    RTreeTilesBench(bool partition) : fPartition(partition) {
+        fName.printf("rtree_tiles_%s", partition ? "partition" : "search");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    static constexpr int kNumRects = 100000,
+                         kSize     = 4096,
+                         kTileSize = 256;
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+    void onDelayedSetup() override {
+        SkRandom rand;
+        AutoTArray<SkRect> rects(kNumRects);
+        for (int i = 0; i < kNumRects; ++i) {
+            rects[i] = SkRect::MakeXYWH(rand.nextRangeF(0, kSize), rand.nextRangeF(0, kSize),
+                                        rand.nextRangeF(1, 64), rand.nextRangeF(1, 64));
+        }
+        fTree.insert(rects.data(), kNumRects);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const SkIRect area = SkIRect::MakeWH(kSize, kSize);
+        std::vector<std::vector<int>> buckets;
+        for (int i = 0; i < loops; ++i) {
+            if (fPartition) {
+                fTree.partition(area, {kTileSize, kTileSize}, 1, &buckets);
+            } else {
+                buckets.resize((kSize / kTileSize) * (kSize / kTileSize));
+                for (int t = 0; t < (int)buckets.size(); t++) {
+                    SkIRect tile = SkIRect::MakeXYWH((t % (kSize / kTileSize)) * kTileSize,
+                                                     (t / (kSize / kTileSize)) * kTileSize,
+                                                     kTileSize, kTileSize);
+                    buckets[t].clear();
+                    fTree.search(SkRect::Make(tile).makeOutset(1, 1), &buckets[t]);
+                }
+            }
+        }
+    }
+private:
+    bool fPartition;
+    SkRTree fTree;
+    SkString fName;
+    using INHERITED = Benchmark;
+};
+
 static inline SkRect make_XYordered_rects(SkRandom& rand, int index, int numRects) {
     SkRect out;
     out.fLeft   = SkIntToScalar(index % GRID_WIDTH);
@@ -138,3 +202,15 @@ DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
 DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
 DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
 DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeBuildBench("XY", &make_XYordered_rects,
+                                     SkRTree::Ordering::kInsertionOrder));
+DEF_BENCH(return new RTreeBuildBench("random", &make_random_rects,
+                                     SkRTree::Ordering::kInsertionOrder));
+DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects,
+                                     SkRTree::Ordering::kInsertionOrder));
+DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects,
+                                     SkRTree::Ordering::kInsertionOrder));
+
+DEF_BENCH(return new RTreeTilesBench(false));
+DEF_BENCH(return new RTreeTilesBench(true));
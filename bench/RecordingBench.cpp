@@ -34,14 +34,20 @@ SkISize PictureCentricBench::onGetSize() {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH)
+RecordingBench::RecordingBench(const char* name, const SkPicture* pic, bool useBBH,
+                               SkPictureRecorder::OptimizationFlags optimizations)
     : INHERITED(name, pic)
     , fUseBBH(useBBH)
-{}
+    , fOptimizations(optimizations) {
+    if (fOptimizations) {
+        fName.append("_recordopts");
+    }
+}
 
 void RecordingBench::onDraw(int loops, SkCanvas*) {
     SkRTreeFactory factory;
     SkPictureRecorder recorder;
+    recorder.setOptimizationFlags(fOptimizations);
     while (loops --> 0) {
         fSrc->playback(recorder.beginRecording(fSrc->cullRect(), fUseBBH ? &factory : nullptr));
         (void)recorder.finishRecordingAsPicture();
@@ -10,6 +10,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
 
 class PictureCentricBench : public Benchmark {
 public:
@@ -29,13 +30,15 @@ protected:
 
 class RecordingBench : public PictureCentricBench {
 public:
-    RecordingBench(const char* name, const SkPicture*, bool useBBH);
+    RecordingBench(const char* name, const SkPicture*, bool useBBH,
+                   SkPictureRecorder::OptimizationFlags optimizations = 0);
 
 protected:
     void onDraw(int loops, SkCanvas*) override;
 
 private:
     bool fUseBBH;
+    SkPictureRecorder::OptimizationFlags fOptimizations;
 
     using INHERITED = PictureCentricBench;
 };
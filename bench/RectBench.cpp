@@ -29,12 +29,15 @@ public:
     SkColor fColors[N];
     bool    fAA;
     bool    fPerspective;
+    bool    fSharedPaint;
 
-    RectBench(int shift, int stroke = 0, bool aa = true, bool perspective = false)
+    RectBench(int shift, int stroke = 0, bool aa = true, bool perspective = false,
+              bool sharedPaint = false)
         : fShift(shift)
         , fStroke(stroke)
         , fAA(aa)
-        , fPerspective(perspective) {}
+        , fPerspective(perspective)
+        , fSharedPaint(sharedPaint) {}
 
     const char* computeName(const char root[]) {
         fBaseName.printf("%s_%d", root, fShift);
@@ -49,6 +52,9 @@ public:
         if (fPerspective) {
             fBaseName.appendf("_persp");
         }
+        if (fSharedPaint) {
+            fBaseName.appendf("_sharedpaint");
+        }
         return fBaseName.c_str();
     }
 
@@ -75,7 +81,8 @@ protected:
             fRects[i].setXYWH(SkIntToScalar(x), SkIntToScalar(y),
                               SkIntToScalar(w), SkIntToScalar(h));
             fRects[i].offset(offset, offset);
-            fColors[i] = rand.nextU() | 0xFF808080;
+            // With a shared paint every rect is drawn in the same color, as in UI and charts.
+            fColors[i] = fSharedPaint && i > 0 ? fColors[0] : rand.nextU() | 0xFF808080;
         }
     }
 
@@ -195,7 +202,8 @@ private:
 
 class OvalBench : public RectBench {
 public:
-    OvalBench(int shift, int stroke = 0) : RectBench(shift, stroke) {}
+    OvalBench(int shift, int stroke = 0, bool sharedPaint = false)
+        : RectBench(shift, stroke, true, false, sharedPaint) {}
 protected:
     void drawThisRect(SkCanvas* c, const SkRect& r, const SkPaint& p) override {
         c->drawOval(r, p);
@@ -205,7 +213,8 @@ protected:
 
 class RRectBench : public RectBench {
 public:
-    RRectBench(int shift, int stroke = 0) : RectBench(shift, stroke) {}
+    RRectBench(int shift, int stroke = 0, bool sharedPaint = false)
+        : RectBench(shift, stroke, true, false, sharedPaint) {}
 protected:
     void drawThisRect(SkCanvas* c, const SkRect& r, const SkPaint& p) override {
         c->drawRoundRect(r, r.width() / 4, r.height() / 4, p);
@@ -341,6 +350,10 @@ DEF_BENCH(return new RectBench(1, 0, false);)
 DEF_BENCH(return new RectBench(1, 4, false);)
 DEF_BENCH(return new RectBench(3, 0, false);)
 DEF_BENCH(return new RectBench(3, 4, false);)
+// Runs of rects drawn with one paint
+DEF_BENCH(return new RectBench(3, 0, true,  false, true);)
+DEF_BENCH(return new RectBench(3, 0, false, false, true);)
+DEF_BENCH(return new RectBench(5, 0, false, false, true);)
 
 DEF_BENCH(return new OvalBench(1);)
 DEF_BENCH(return new OvalBench(3);)
@@ -350,6 +363,8 @@ DEF_BENCH(return new RRectBench(1);)
 DEF_BENCH(return new RRectBench(1, 4);)
 DEF_BENCH(return new RRectBench(3);)
 DEF_BENCH(return new RRectBench(3, 4);)
+DEF_BENCH(return new OvalBench(3, 0, true);)
+DEF_BENCH(return new RRectBench(3, 0, true);)
 DEF_BENCH(return new PointsBench(SkCanvas::kPoints_PointMode, "points");)
 DEF_BENCH(return new PointsBench(SkCanvas::kLines_PointMode, "lines");)
 DEF_BENCH(return new PointsBench(SkCanvas::kPolygon_PointMode, "polygon");)
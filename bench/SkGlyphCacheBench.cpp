@@ -10,6 +10,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/chromium/SkChromeRemoteGlyphCache.h"
@@ -115,10 +116,87 @@ private:
     SkString fName;
 };
 
+// Many threads drawing text from strikes that are already warm, the common steady state when
+// rasterizing tiles in parallel. The total work is the same for every thread count, so with no
+// contention on the strike cache the time would drop in proportion to the threads.
+class SkGlyphCacheThreaded : public Benchmark {
+public:
+    explicit SkGlyphCacheThreaded(int threads) : fThreads(threads) { }
+
+protected:
+    const char* onGetName() override {
+        fName.printf("SkGlyphCacheThreaded_%dthreads", fThreads);
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        if (!fExecutor) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        }
+        fTypefaces[0] = ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic());
+        fTypefaces[1] = ToolUtils::create_portable_typeface("sans-serif", SkFontStyle::Italic());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        size_t oldCacheLimitSize = SkGraphics::GetFontCacheLimit();
+        SkGraphics::SetFontCacheLimit(32 * 1024 * 1024);
+
+        // Warm every strike before timing the lookups.
+        for (int task = 0; task < 2; task++) {
+            this->drawText(task);
+        }
+
+        for (int work = 0; work < loops; work++) {
+            SkTaskGroup(*fExecutor).batch(kTasks, [&](int task) { this->drawText(task); });
+        }
+        SkGraphics::SetFontCacheLimit(oldCacheLimitSize);
+    }
+
+private:
+    static constexpr int kTasks = 32;
+
+    void drawText(int task) {
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        font.setTypeface(fTypefaces[task % 2]);
+
+        SkPaint defaultPaint;
+        SkPackedGlyphID glyphs['z'];
+        for (int c = ' '; c < 'z'; c++) {
+            glyphs[c] = SkPackedGlyphID{font.unicharToGlyph(c)};
+        }
+        constexpr size_t glyphCount = 'z' - ' ';
+        SkSpan<const SkPackedGlyphID> glyphIDs{&glyphs[SkTo<int>(' ')], glyphCount};
+        for (SkScalar size = 8; size < 24; size++) {
+            font.setSize(size);
+            auto strikeSpec = SkStrikeSpec::MakeMask(
+                    font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I());
+            SkBulkGlyphMetricsAndImages images{strikeSpec};
+            (void)images.glyphs(glyphIDs);
+        }
+    }
+
+    using INHERITED = Benchmark;
+    const int fThreads;
+    SkString fName;
+    sk_sp<SkTypeface> fTypefaces[2];
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheThreaded(1); )
+DEF_BENCH( return new SkGlyphCacheThreaded(4); )
+DEF_BENCH( return new SkGlyphCacheThreaded(16); )
+DEF_BENCH( return new SkGlyphCacheThreaded(32); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
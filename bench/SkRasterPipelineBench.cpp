@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkString.h"
+#include "src/core/SkRasterPipeline.h"
+
+#include <cstdint>
+
+extern bool gDisableRasterPipelineStageFusion;
+extern bool gDisableRasterPipelineProgramTemplates;
+
+// Runs a few sequences of stages that SkRasterPipeline replaces with fused stages, with stage
+// fusion enabled or disabled, to measure what fusion saves.
+enum class FusedSequence {
+    kLoadPremul,      // load_8888, premul
+    kSrcOverBGRA,     // load_8888, swap_rb, srcover_rgba_8888
+    kLoadStoreBGRA,   // load_8888, swap_rb, load_8888_dst, swap_rb_dst, srcover, swap_rb, store_8888
+};
+
+class SkRasterPipelineFusionBench : public Benchmark {
+public:
+    SkRasterPipelineFusionBench(FusedSequence sequence, bool fused)
+            : fSequence(sequence), fFused(fused) {
+        static const char* kNames[] = {"load_premul", "srcover_bgra", "load_store_bgra"};
+        fName.printf("SkRasterPipeline_%s_%s",
+                     kNames[(int)sequence], fused ? "fused" : "unfused");
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkRasterPipeline_MemoryCtx src_ctx = { fSrc, 0 },
+                                   dst_ctx = { fDst, 0 };
+
+        SkRasterPipeline_<256> p;
+        switch (fSequence) {
+            case FusedSequence::kLoadPremul:
+                p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+                p.append(SkRasterPipelineOp::premul);
+                p.append(SkRasterPipelineOp::store_8888, &dst_ctx);
+                break;
+            case FusedSequence::kSrcOverBGRA:
+                p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+                p.append(SkRasterPipelineOp::swap_rb);
+                p.append(SkRasterPipelineOp::srcover_rgba_8888, &dst_ctx);
+                break;
+            case FusedSequence::kLoadStoreBGRA:
+                p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+                p.append(SkRasterPipelineOp::swap_rb);
+                p.append(SkRasterPipelineOp::load_8888_dst, &dst_ctx);
+                p.append(SkRasterPipelineOp::swap_rb_dst);
+                p.append(SkRasterPipelineOp::srcover);
+                p.append(SkRasterPipelineOp::swap_rb);
+                p.append(SkRasterPipelineOp::store_8888, &dst_ctx);
+                break;
+        }
+
+        bool wasDisabled = gDisableRasterPipelineStageFusion;
+        gDisableRasterPipelineStageFusion = !fFused;
+        auto fn = p.compile();
+        gDisableRasterPipelineStageFusion = wasDisabled;
+
+        while (loops --> 0) {
+            fn(0,0,kWidth,1);
+        }
+    }
+
+private:
+    static constexpr int kWidth = 1024;
+
+    FusedSequence fSequence;
+    bool          fFused;
+    SkString      fName;
+    uint32_t      fSrc[kWidth] = {};
+    uint32_t      fDst[kWidth] = {};
+};
+
+#define DEF_FUSION_BENCH(sequence)                                                        \
+    DEF_BENCH(return (new SkRasterPipelineFusionBench(FusedSequence::sequence, false));)  \
+    DEF_BENCH(return (new SkRasterPipelineFusionBench(FusedSequence::sequence, true));)
+
+DEF_FUSION_BENCH(kLoadPremul)
+DEF_FUSION_BENCH(kSrcOverBGRA)
+DEF_FUSION_BENCH(kLoadStoreBGRA)
+
+// Builds and runs a new pipeline for each short span, as a blitter does for each small draw with a
+// repeated paint, so each loop either reuses this thread's program template for the op list or,
+// with templates disabled, builds the program from scratch.
+class SkRasterPipelineProgramTemplateBench : public Benchmark {
+public:
+    SkRasterPipelineProgramTemplateBench(bool templates) : fTemplates(templates) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override {
+        return fTemplates ? "SkRasterPipeline_program_template_hit"
+                          : "SkRasterPipeline_program_cold_build";
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        bool wasDisabled = gDisableRasterPipelineProgramTemplates;
+        gDisableRasterPipelineProgramTemplates = !fTemplates;
+
+        float scale = 0.5f;
+        for (int i = 0; i < loops; i++) {
+            // New contexts each time, like the uniforms of a new draw.
+            SkRasterPipeline_MemoryCtx src_ctx = { fSrc, 0 },
+                                       dst_ctx = { fDst, 0 };
+
+            SkRasterPipeline_<256> p;
+            p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+            p.append(SkRasterPipelineOp::swap_rb);
+            p.append(SkRasterPipelineOp::scale_1_float, &scale);
+            p.append(SkRasterPipelineOp::load_8888_dst, &dst_ctx);
+            p.append(SkRasterPipelineOp::srcover);
+            p.append(SkRasterPipelineOp::store_8888, &dst_ctx);
+            p.run(0,0,kWidth,1);
+        }
+
+        gDisableRasterPipelineProgramTemplates = wasDisabled;
+    }
+
+private:
+    static constexpr int kWidth = 4;
+
+    bool     fTemplates;
+    uint32_t fSrc[kWidth] = {};
+    uint32_t fDst[kWidth] = {};
+};
+
+DEF_BENCH(return (new SkRasterPipelineProgramTemplateBench(false));)
+DEF_BENCH(return (new SkRasterPipelineProgramTemplateBench(true));)
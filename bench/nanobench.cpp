@@ -28,6 +28,7 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkString.h"
@@ -141,6 +142,8 @@ static DEFINE_string(zoom, "1.0,0",
                      "Comma-separated zoomMax,zoomPeriodMs factors for a periodic SKP zoom "
                      "function that ping-pongs between 1.0 and zoomMax.");
 static DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
+static DEFINE_bool(recordOpts, false,
+                   "Apply SkPictureRecorder's optional overdraw culling and rect merging to SKPs?");
 static DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
 static DEFINE_int(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 static DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
@@ -193,6 +196,11 @@ static DEFINE_int_2(threads, j, -1,
                "Run threadsafe tests on a threadpool with this many extra threads, "
                "defaulting to one extra thread per core.");
 
+static DEFINE_int(rasterThreads, 0,
+                  "Threads used to rasterize tiles for the 8888_mt config, "
+                  "defaulting to one per core.");
+static DEFINE_int(rasterTileSize, 256, "Tile width and height for the 8888_mt config.");
+
 static DEFINE_string2(writePath, w, "", "If set, write bitmaps here as .pngs.");
 
 static DEFINE_string(key, "",
@@ -237,6 +245,25 @@ bool Target::capturePixels(SkBitmap* bmp) {
     return true;
 }
 
+struct TiledRasterTarget : public Target {
+    explicit TiledRasterTarget(const Config& c) : Target(c) {}
+    std::unique_ptr<SkExecutor> executor;
+
+    bool init(SkImageInfo info, Benchmark* bench) override {
+        this->executor = SkExecutor::MakeFIFOThreadPool(FLAGS_rasterThreads);
+        this->surface = SkSurfaces::RasterTiled(info,
+                                                this->executor.get(),
+                                                {FLAGS_rasterTileSize, FLAGS_rasterTileSize});
+        return this->surface != nullptr;
+    }
+    void endTiming() override {
+        // Draws are only recorded until someone looks at the pixels; make sure they're all
+        // rasterized inside the timed region.
+        SkPixmap pixmap;
+        this->surface->peekPixels(&pixmap);
+    }
+};
+
 struct GPUTarget : public Target {
     explicit GPUTarget(const Config& c) : Target(c) {}
     ContextInfo contextInfo;
@@ -641,7 +668,7 @@ static std::optional<Config> create_config(const SkCommandLineConfig* config) {
     }
 #endif
 
-#define CPU_CONFIG(name, backend, color, alpha)                                         \
+#define CPU_CONFIG(name, backend, color, alpha, tiled)                                  \
     if (config->getBackend().equals(name)) {                                            \
         if (!FLAGS_cpu) {                                                               \
             SkDebugf("Skipping config '%s' as requested.\n", config->getTag().c_str()); \
@@ -655,18 +682,21 @@ static std::optional<Config> create_config(const SkCommandLineConfig* config) {
                       0,                                                                \
                       kBogusContextType,                                                \
                       kBogusContextOverrides,                                           \
-                      0};                                                               \
+                      0,                                                                \
+                      tiled};                                                           \
     }
 
-    CPU_CONFIG("nonrendering", kNonRendering_Backend, kUnknown_SkColorType, kUnpremul_SkAlphaType)
+    CPU_CONFIG("nonrendering", kNonRendering_Backend, kUnknown_SkColorType, kUnpremul_SkAlphaType,
+               false)
 
-    CPU_CONFIG("a8",    kRaster_Backend,    kAlpha_8_SkColorType, kPremul_SkAlphaType)
-    CPU_CONFIG("565",   kRaster_Backend,    kRGB_565_SkColorType, kOpaque_SkAlphaType)
-    CPU_CONFIG("8888",  kRaster_Backend,        kN32_SkColorType, kPremul_SkAlphaType)
-    CPU_CONFIG("rgba",  kRaster_Backend,  kRGBA_8888_SkColorType, kPremul_SkAlphaType)
-    CPU_CONFIG("bgra",  kRaster_Backend,  kBGRA_8888_SkColorType, kPremul_SkAlphaType)
-    CPU_CONFIG("f16",   kRaster_Backend,   kRGBA_F16_SkColorType, kPremul_SkAlphaType)
-    CPU_CONFIG("srgba", kRaster_Backend, kSRGBA_8888_SkColorType, kPremul_SkAlphaType)
+    CPU_CONFIG("a8",      kRaster_Backend,    kAlpha_8_SkColorType, kPremul_SkAlphaType, false)
+    CPU_CONFIG("565",     kRaster_Backend,    kRGB_565_SkColorType, kOpaque_SkAlphaType, false)
+    CPU_CONFIG("8888",    kRaster_Backend,        kN32_SkColorType, kPremul_SkAlphaType, false)
+    CPU_CONFIG("8888_mt", kRaster_Backend,        kN32_SkColorType, kPremul_SkAlphaType, true)
+    CPU_CONFIG("rgba",    kRaster_Backend,  kRGBA_8888_SkColorType, kPremul_SkAlphaType, false)
+    CPU_CONFIG("bgra",    kRaster_Backend,  kBGRA_8888_SkColorType, kPremul_SkAlphaType, false)
+    CPU_CONFIG("f16",     kRaster_Backend,   kRGBA_F16_SkColorType, kPremul_SkAlphaType, false)
+    CPU_CONFIG("srgba",   kRaster_Backend, kSRGBA_8888_SkColorType, kPremul_SkAlphaType, false)
 
 #undef CPU_CONFIG
 
@@ -720,7 +750,7 @@ static Target* is_enabled(Benchmark* bench, const Config& config) {
         break;
 #endif
     default:
-        target = new Target(config);
+        target = config.tiledRaster ? new TiledRasterTarget(config) : new Target(config);
         break;
     }
 
@@ -819,6 +849,12 @@ public:
         }
     }
 
+    static SkPictureRecorder::OptimizationFlags RecordOptimizations() {
+        return FLAGS_recordOpts ? SkPictureRecorder::kCullOverdraw_OptimizationFlag |
+                                  SkPictureRecorder::kMergeDrawRects_OptimizationFlag
+                                : 0;
+    }
+
     static sk_sp<SkPicture> ReadPicture(const char* path) {
         // Not strictly necessary, as it will be checked again later,
         // but helps to avoid a lot of pointless work if we're going to skip it.
@@ -948,7 +984,15 @@ public:
             fBenchType  = "recording";
             fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
             fSKPOps   = pic->approximateOpCount();
-            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh);
+            const SkPictureRecorder::OptimizationFlags optimizations = RecordOptimizations();
+            if (optimizations) {
+                // Report how many ops are left once the optional passes have run.
+                SkPictureRecorder recorder;
+                recorder.setOptimizationFlags(optimizations);
+                pic->playback(recorder.beginRecording(pic->cullRect()));
+                fSKPOps = recorder.finishRecordingAsPicture()->approximateOpCount();
+            }
+            return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh, optimizations);
         }
 
         // Add all .skps as DeserializePictureBenchs.
@@ -975,13 +1019,15 @@ public:
                     continue;
                 }
 
-                if (FLAGS_bbh) {
-                    // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
+                if (FLAGS_bbh || FLAGS_recordOpts) {
+                    // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one,
+                    // and so any optional recording optimizations get applied.
                     SkRTreeFactory factory;
                     SkPictureRecorder recorder;
+                    recorder.setOptimizationFlags(RecordOptimizations());
                     pic->playback(recorder.beginRecording(pic->cullRect().width(),
                                                           pic->cullRect().height(),
-                                                          &factory));
+                                                          FLAGS_bbh ? &factory : nullptr));
                     pic = recorder.finishRecordingAsPicture();
                 }
                 SkString name = SkOSPath::Basename(path.c_str());
@@ -1143,7 +1189,25 @@ public:
                 return new AndroidCodecBench(SkOSPath::Basename(path.c_str()),
                                              encoded.get(), sampleSize);
             }
+
+            // Decode thumbnails both with getResampledPixels() and by sampling and scaling.
+            const int thumbnailSizes[] = { 256 };
+            while (fCurrentThumbnail < 2 * (int) std::size(thumbnailSizes)) {
+                int thumbnailSize = thumbnailSizes[fCurrentThumbnail / 2];
+                bool sampleAndScale = fCurrentThumbnail % 2;
+                fCurrentThumbnail++;
+                if (2 * thumbnailSize > std::max(codec->getInfo().width(),
+                                                 codec->getInfo().height())) {
+                    // Avoid benchmarking thumbnails of already small images.
+                    break;
+                }
+
+                return new AndroidCodecThumbnailBench(SkOSPath::Basename(path.c_str()),
+                                                      encoded.get(), thumbnailSize,
+                                                      sampleAndScale);
+            }
             fCurrentSampleSize = 0;
+            fCurrentThumbnail = 0;
         }
 
 #ifdef SK_ENABLE_ANDROID_UTILS
@@ -1178,7 +1242,7 @@ public:
                         sk_sp<SkData> encoded(SkData::MakeFromFileName(path.c_str()));
                         const SkColorType colorType = fColorTypes[fCurrentColorType];
                         uint32_t sampleSize = brdSampleSizes[fCurrentSampleSize];
-                        int currentSubsetType = fCurrentSubsetType++;
+                        int currentSubsetType = fCurrentSubsetType;
 
                         int width = 0;
                         int height = 0;
@@ -1187,6 +1251,15 @@ public:
                             break;
                         }
 
+                        // PNG subsets are also decoded with a row index, which lets them start
+                        // near their first row rather than at the top of the image.
+                        const bool useRowIndex = fUseBRDRowIndex;
+                        fUseBRDRowIndex = !useRowIndex &&
+                                          SkPngDecoder::IsPng(encoded->data(), encoded->size());
+                        if (!fUseBRDRowIndex) {
+                            fCurrentSubsetType++;
+                        }
+
                         SkString basename = SkOSPath::Basename(path.c_str());
                         SkIRect subset;
                         const uint32_t subsetSize = sampleSize * minOutputSize;
@@ -1220,7 +1293,7 @@ public:
                         }
 
                         return new BitmapRegionDecoderBench(basename.c_str(), encoded.get(),
-                                colorType, sampleSize, subset);
+                                colorType, sampleSize, subset, useRowIndex);
                     }
                     fCurrentSubsetType = 0;
                     fCurrentSampleSize++;
@@ -1298,10 +1371,12 @@ private:
 #ifdef SK_ENABLE_ANDROID_UTILS
     int fCurrentBRDImage = 0;
     int fCurrentSubsetType = 0;
+    bool fUseBRDRowIndex = false;
 #endif
     int fCurrentColorType = 0;
     int fCurrentAlphaType = 0;
     int fCurrentSampleSize = 0;
+    int fCurrentThumbnail = 0;
     int fCurrentAnimSKP = 0;
 };
 
@@ -31,6 +31,7 @@ struct Config {
     sk_gpu_test::GrContextFactory::ContextType ctxType;
     sk_gpu_test::GrContextFactory::ContextOverrides ctxOverrides;
     uint32_t surfaceFlags;
+    bool tiledRaster = false;  // Raster surface that plays back draws in parallel tiles.
 };
 
 struct Target {
@@ -15,7 +15,11 @@ namespace android {
 namespace skia {
 
 std::unique_ptr<BitmapRegionDecoder> BitmapRegionDecoder::Make(sk_sp<SkData> data) {
-    auto codec = SkAndroidCodec::MakeFromData(std::move(data));
+    return Make(SkAndroidCodec::MakeFromData(std::move(data)));
+}
+
+std::unique_ptr<BitmapRegionDecoder> BitmapRegionDecoder::Make(
+        std::unique_ptr<SkAndroidCodec> codec) {
     if (nullptr == codec) {
         SkCodecPrintf("Error: Failed to create codec.\n");
         return nullptr;
@@ -19,6 +19,7 @@ namespace skia {
 class BitmapRegionDecoder final {
 public:
     static std::unique_ptr<BitmapRegionDecoder> Make(sk_sp<SkData> data);
+    static std::unique_ptr<BitmapRegionDecoder> Make(std::unique_ptr<SkAndroidCodec> codec);
 
     bool decodeRegion(SkBitmap* bitmap,
                       BRDAllocator* allocator,
@@ -12,6 +12,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkEncodedInfo.h"
@@ -261,6 +262,26 @@ public:
         return this->getAndroidPixels(info, pixels, rowBytes);
     }
 
+    /**
+     *  Decode into the given pixels, scaled to the dimensions of info, which may be any size no
+     *  larger than the image (or options->fSubset, if it is set) in either dimension. This is
+     *  meant for thumbnails.
+     *
+     *  The image is decoded at the smallest size the codec scales to natively that is still at
+     *  least as large as info (e.g. with libjpeg-turbo's DCT scaling), and each decoded row is
+     *  resampled with the cubic filter as it comes out of the codec, so the decode and the
+     *  resampling take a single pass and only a few rows of scratch memory. Decodes that can't
+     *  be done that way (subsets, other frames, and color types other than 8888) decode a
+     *  sampled image first and then resample it.
+     *
+     *  options->fSampleSize is ignored; the codec picks its own.
+     *
+     *  @return Result kSuccess, or another value explaining the type of failure.
+     */
+    SkCodec::Result getResampledPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                                       const AndroidOptions* options = nullptr,
+                                       SkCubicResampler cubic = SkCubicResampler::Mitchell());
+
     SkCodec* codec() const { return fCodec.get(); }
 
     /**
@@ -28,6 +28,7 @@
 #include <vector>
 
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -298,6 +299,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -341,6 +343,16 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may use this executor to decode parts of the image in
+         *  parallel, and will wait for that work to finish before returning. Only some codecs,
+         *  and some images, can be decoded this way (e.g. JPEGs with restart markers, and PNGs
+         *  decoded with a row index); the rest ignore it.
+         *
+         *  Not used by scanline or incremental decodes.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -35,6 +35,27 @@ SK_API std::unique_ptr<SkCodec> Decode(sk_sp<SkData>,
                                        SkCodec::Result*,
                                        SkCodecs::DecodeContext = nullptr);
 
+/**
+ *  Inflates and unfilters all of the rows of the given PNG, to make an index of places its rows
+ *  can later be decoded from without decoding the rows above them. The index can be kept
+ *  alongside the PNG, and costs about 32KB for each megabyte of unfiltered rows.
+ *
+ *  Returns nullptr if the PNG is interlaced, or its image data is incomplete or corrupt.
+ */
+SK_API sk_sp<SkData> MakeRowIndex(sk_sp<SkData>);
+
+/**
+ *  Like Decode, but subset decodes start from the place in rowIndex nearest above the subset,
+ *  and full decodes with an SkCodec::Options::fExecutor decode the rows between those places
+ *  in parallel.
+ *
+ *  If rowIndex was not made by MakeRowIndex for these bytes, it is ignored.
+ */
+SK_API std::unique_ptr<SkCodec> DecodeWithRowIndex(sk_sp<SkData>,
+                                                   sk_sp<SkData> rowIndex,
+                                                   SkCodec::Result*,
+                                                   SkCodecs::DecodeContext = nullptr);
+
 inline SkCodecs::Decoder Decoder() {
     return { "png", IsPng, Decode };
 }
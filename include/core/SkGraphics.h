@@ -74,6 +74,21 @@ public:
      */
     static void PurgeFontCache();
 
+    /**
+     *  Back the font cache with a glyph cache file at path, creating it if needed. Glyph images
+     *  and paths found in the file are used instead of being generated again when their strike is
+     *  first made, and glyphs generated afterwards are appended to the file in the background.
+     *  Entries written by another version of Skia, or for font data that has since changed, are
+     *  not used.
+     *
+     *  The file is kept under byteLimit bytes. Once it is full, new glyphs are not written until
+     *  the next process opens it, which rewrites it with the most recently written strikes.
+     *
+     *  Call this once, before drawing any text. Only one process should use a file at a time.
+     *  Returns false if the file can't be opened for writing, or if a file was already set.
+     */
+    static bool SetFontCacheFile(const char path[], size_t byteLimit = 32 << 20);
+
     /**
      *  If the strike cache is above the cache limit, attempt to purge strikes
      *  with pinners. This should be called after clients release locks on
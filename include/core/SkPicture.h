@@ -87,6 +87,23 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture that was serialized into data, typically a file mapped into memory
+        with SkData::MakeFromFD() or SkData::MakeFromFileName(). Unlike MakeFromData(), the
+        returned SkPicture plays back its drawing commands, and the encoded data of its images,
+        from data in place rather than from copies, and keeps data alive. Paths and text blobs
+        are read from data when they are first drawn. Opening a large picture is then quick,
+        and processes that map the same file share its pages.
+
+        Only pictures serialized with SkSerialProcs::fMappablePictures are fully played back in
+        place; parts of other pictures are copied out of data as MakeFromData() would.
+
+        @param data   container for serial data
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture constructed from data
+    */
+    static sk_sp<SkPicture> MakeFromMappedData(sk_sp<SkData> data,
+                                               const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -244,13 +261,16 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkMappedPicture;
     friend class SkPicturePriv;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
         bool textBlobsOnly=false) const;
+    // If mapped is not null, stream reads it from the start, and the picture plays back from it.
     static sk_sp<SkPicture> MakeFromStreamPriv(SkStream*, const SkDeserialProcs*,
                                                class SkTypefacePlayback*,
-                                               int recursionLimit);
+                                               int recursionLimit,
+                                               const SkData* mapped = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
@@ -13,6 +13,7 @@
 #include "include/core/SkScalar.h"
 #include "include/private/base/SkAPI.h"
 
+#include <cstdint>
 #include <memory>
 
 #ifdef SK_BUILD_FOR_ANDROID_FRAMEWORK
@@ -34,11 +35,28 @@ public:
     SkPictureRecorder();
     ~SkPictureRecorder();
 
+    /** Optional optimizations applied to the recorded ops when recording finishes. They reduce
+        the number of ops played back, but are only pixel-exact when the result is drawn with an
+        integer translate and without anti-aliased clips, so they are off by default.
+    */
+    enum OptimizationFlagsSet {
+        /** Drops draws that a later opaque rect or paint completely covers. */
+        kCullOverdraw_OptimizationFlag   = 1 << 0,
+        /** Merges runs of pixel-aligned drawRect() calls sharing a paint into one drawRegion(). */
+        kMergeDrawRects_OptimizationFlag = 1 << 1,
+    };
+    typedef uint32_t OptimizationFlags;
+
+    /** Sets the optimizations applied by the finishRecording methods. They stay set for
+        subsequent recordings made with this recorder.
+    */
+    void setOptimizationFlags(OptimizationFlags flags) { fOptimizationFlags = flags; }
+    OptimizationFlags getOptimizationFlags() const { return fOptimizationFlags; }
+
     /** Returns the canvas that records the drawing commands.
         @param bounds the cull rect used when recording this picture. Any drawing the falls outside
                       of this rect is undefined, and may be drawn or it may not.
         @param bbh         optional acceleration structure
-        @param recordFlags optional flags that control recording.
         @return the canvas.
     */
     SkCanvas* beginRecording(const SkRect& bounds, sk_sp<SkBBoxHierarchy> bbh);
@@ -92,6 +110,7 @@ public:
 
 private:
     void reset();
+    void optimize();
 
     /** Replay the current (partially recorded) operation stream into
         canvas. This call doesn't close the current recording.
@@ -107,6 +126,7 @@ private:
     sk_sp<SkBBoxHierarchy>      fBBH;
     std::unique_ptr<SkRecorder> fRecorder;
     sk_sp<SkRecord>             fRecord;
+    OptimizationFlags           fOptimizationFlags = 0;
 
     SkPictureRecorder(SkPictureRecorder&&) = delete;
     SkPictureRecorder& operator=(SkPictureRecorder&&) = delete;
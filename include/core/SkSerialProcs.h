@@ -64,6 +64,12 @@ struct SK_API SkSerialProcs {
 
     SkSerialTypefaceProc fTypefaceProc = nullptr;
     void*                fTypefaceCtx = nullptr;
+
+    // Like fAllowSkSL in SkDeserialProcs, this is a flag rather than a proc. If true, pictures
+    // are written so that SkPicture::MakeFromMappedData() can play them back from the data in
+    // place: their sections are 4-byte aligned, and their paths and text blobs are indexed so
+    // that each is only read when it is drawn. Older versions of Skia can't read them.
+    bool                 fMappablePictures = false;
 };
 
 struct SK_API SkDeserialProcs {
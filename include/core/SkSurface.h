@@ -14,6 +14,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypes.h"
 
@@ -30,10 +31,10 @@ class SkBitmap;
 class SkCanvas;
 class SkCapabilities;
 class SkColorSpace;
+class SkExecutor;
 class SkPaint;
 class SkSurface;
 struct SkIRect;
-struct SkISize;
 
 namespace skgpu::graphite {
 class Recorder;
@@ -82,6 +83,25 @@ inline sk_sp<SkSurface> Raster(const SkImageInfo& imageInfo,
     return Raster(imageInfo, 0, props);
 }
 
+/** Allocates raster SkSurface like Raster(), but SkCanvas returned by SkSurface records its draws
+    instead of rasterizing them immediately. Recorded draws are played back when the pixels are
+    needed (makeImageSnapshot(), readPixels(), peekPixels(), writePixels() or draw()), with the
+    surface split into tiles that are rasterized in parallel on executor. The resulting pixels are
+    identical to those drawn by a Raster() surface.
+
+    @param imageInfo  width, height, SkColorType, SkAlphaType, SkColorSpace,
+                      of raster surface; width and height must be greater than zero
+    @param executor   runs one task per tile; if nullptr, SkExecutor::GetDefault() is used
+    @param tileSize   dimensions of each tile; if empty, a default size is used
+    @param props      LCD striping orientation and setting for device independent fonts;
+                      may be nullptr
+    @return           SkSurface if parameters are valid and memory was allocated, else nullptr.
+*/
+SK_API sk_sp<SkSurface> RasterTiled(const SkImageInfo& imageInfo,
+                                    SkExecutor* executor,
+                                    SkISize tileSize = {0, 0},
+                                    const SkSurfaceProps* props = nullptr);
+
 /** Allocates raster SkSurface. SkCanvas returned by SkSurface draws directly into the
     provided pixels.
 
@@ -43,12 +43,29 @@ public:
      */
     bool encodeRows(int numRows);
 
+    /**
+     *  Encode the rows of |rows| as the next |rows.height()| rows of output, reading their pixels
+     *  from |rows| instead of from the src.  This allows an image to be encoded a band at a time,
+     *  without ever holding all of its pixels: the src then only has to describe the image, and
+     *  may point at the first band.  |rows| must have the width, color type, alpha type and
+     *  color space of the src, and must not extend past the src's last row.
+     */
+    bool encodeRows(const SkPixmap& rows);
+
     virtual ~SkEncoder() {}
 
 protected:
 
     virtual bool onEncodeRows(int numRows) = 0;
 
+    /**
+     *  The pixels of row |fCurrRow + i|, from the rows passed to encodeRows(const SkPixmap&) if
+     *  they are being encoded, otherwise from the src.
+     */
+    const void* srcRowAddr(int i) const {
+        return fRows ? fRows->addr(0, i) : fSrc.addr(0, fCurrRow + i);
+    }
+
     SkEncoder(const SkPixmap& src, size_t storageBytes)
         : fSrc(src)
         , fCurrRow(0)
@@ -57,6 +74,7 @@ protected:
 
     const SkPixmap&        fSrc;
     int                    fCurrRow;
+    const SkPixmap*        fRows = nullptr;
     skia_private::AutoTMalloc<uint8_t> fStorage;
 };
 
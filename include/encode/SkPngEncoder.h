@@ -19,6 +19,7 @@
 
 class GrDirectContext;
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPixmap;
 class SkWStream;
@@ -80,6 +81,17 @@ struct Options {
      */
     const skcms_ICCProfile* fICCProfile = nullptr;
     const char* fICCProfileDescription = nullptr;
+
+    /**
+     *  If not null, rows are filtered and compressed in parallel on this executor. The rows are
+     *  split into strips of a few hundred KB, each deflated on its own and ended with a sync
+     *  flush, and the strips are joined into the png's single zlib stream. The result is a
+     *  standard png, typically a percent or so larger than a serial encode.
+     *
+     *  This ignores libpng for the image data, so the rows need not come out byte-for-byte the
+     *  same as a serial encode. Opaque kRGBA_F16 sources are always encoded serially.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
@@ -13,15 +13,56 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+class SkData;
+class SkExecutor;
 class SkImage;
 
 class SkAnimCodecPlayer {
 public:
     SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec);
+
+    struct DecodeAheadOptions {
+        /**
+         *  Runs the decodes of the frames ahead of the current one. Must outlive the player.
+         */
+        SkExecutor* fExecutor = nullptr;
+
+        /**
+         *  The most frames, starting with the current one, to keep decoded.
+         */
+        int fMaxFrames = 8;
+
+        /**
+         *  The most memory the frames kept decoded may use. The current frame is always kept.
+         */
+        size_t fMaxBytes = 64 << 20;
+
+        /**
+         *  If the current frame is still being decoded, getFrame() normally waits for it. If this
+         *  is true, getFrame() returns the last frame it returned instead, so that playback never
+         *  waits on a decode.
+         */
+        bool fDropLateFrames = false;
+    };
+
+    /**
+     *  Like the constructor above, but decodes the frames after the current one on
+     *  options.fExecutor, each with a codec of its own made from data. Frames that do not
+     *  depend on each other's pixels (see SkCodec::FrameInfo::fRequiredFrame) are decoded in
+     *  parallel. Rather than keeping every frame, only those from the current frame to
+     *  options.fMaxFrames after it are kept.
+     *
+     *  If options.fExecutor is null, or data is not animated, this is the same as the
+     *  constructor above. If data cannot be decoded, getFrame() returns null and
+     *  dimensions() is empty.
+     */
+    SkAnimCodecPlayer(sk_sp<SkData> data, const DecodeAheadOptions& options);
+
     ~SkAnimCodecPlayer();
 
     /**
@@ -53,6 +94,8 @@ public:
 
 
 private:
+    class DecodeAhead;
+
     std::unique_ptr<SkCodec>        fCodec;
     SkImageInfo                     fImageInfo;
     std::vector<SkCodec::FrameInfo> fFrameInfos;
@@ -60,7 +103,11 @@ private:
     int                             fCurrIndex = 0;
     uint32_t                        fTotalDuration;
 
+    std::unique_ptr<DecodeAhead>    fDecodeAhead;
+    sk_sp<SkImage>                  fLastFrame;     // The last frame getFrame() returned.
+
     sk_sp<SkImage> getFrameAt(int index);
+    sk_sp<SkImage> getDecodedAheadFrame(int index);
 };
 
 #endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureBandRenderer_DEFINED
+#define SkPictureBandRenderer_DEFINED
+
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkTypes.h"
+
+#include <functional>
+
+class SkPicture;
+class SkPixmap;
+
+/**
+ *  Plays an SkPicture into a raster image that may be far too large to allocate, e.g. a poster
+ *  tens of thousands of pixels on a side, by rendering it one horizontal band at a time into a
+ *  single band-sized buffer. Each finished band is handed to a callback, which can write it out,
+ *  for instance with SkEncoder::encodeRows(const SkPixmap&), before the next band replaces it.
+ *  Peak memory is proportional to the band, not the image.
+ *
+ *  Every band replays the picture clipped to the band. Pictures recorded with a bounding box
+ *  hierarchy (see SkRTreeFactory) only draw the ops that touch each band; others replay all of
+ *  their ops for every band. SKPs deserialized with SkPicture::MakeFromData() or MakeFromStream()
+ *  have no bounding box hierarchy, so it pays to re-record them with one first.
+ */
+class SK_API SkPictureBandRenderer {
+public:
+    /**
+     *  Called with the rows of each band, from top to bottom, and the row of the image the band
+     *  starts at. The pixels are only valid during the call. Returning false stops the rendering.
+     */
+    using BandProc = std::function<bool(const SkPixmap& band, int top)>;
+
+    struct Options {
+        /** The number of rows in each band, except maybe the last. */
+        int fBandHeight = 256;
+
+        /** Each band is cleared to this color before the picture is drawn into it. */
+        SkColor4f fBackground = SkColors::kTransparent;
+
+        /** Maps the picture's coordinates to the image's pixels. */
+        SkMatrix fMatrix = SkMatrix::I();
+    };
+
+    /**
+     *  Renders picture into an image described by info, one band at a time, calling bandProc
+     *  with each band. Returns false if the band buffer can't be allocated for info, or if
+     *  bandProc returns false.
+     */
+    static bool Render(const SkPicture* picture,
+                       const SkImageInfo& info,
+                       const Options& options,
+                       const BandProc& bandProc);
+};
+
+#endif
@@ -219,6 +219,7 @@ SKIA_PUBLIC_HDRS = [
     "include/utils/SkPaintFilterCanvas.h",
     "include/utils/SkParse.h",
     "include/utils/SkParsePath.h",
+    "include/utils/SkPictureBandRenderer.h",
     "include/utils/SkShadowUtils.h",
     "include/utils/SkTextUtils.h",
     "include/utils/SkTraceEventPhase.h",
@@ -397,6 +398,8 @@ BASE_SRCS_ALL = [
     "src/core/SkBlitRow_D32.cpp",
     "src/core/SkBlitter.cpp",
     "src/core/SkBlitter.h",
+    "src/core/SkBlitterCache.cpp",
+    "src/core/SkBlitterCache.h",
     "src/core/SkBlitter_A8.cpp",
     "src/core/SkBlitter_A8.h",
     "src/core/SkBlitter_ARGB32.cpp",
@@ -521,6 +524,8 @@ BASE_SRCS_ALL = [
     "src/core/SkMask.h",
     "src/core/SkMaskBlurFilter.cpp",
     "src/core/SkMaskBlurFilter.h",
+    "src/core/SkMaskBlurFilter_opts.cpp",
+    "src/core/SkMaskBlurFilter_opts_hsw.cpp",
     "src/core/SkMaskCache.cpp",
     "src/core/SkMaskCache.h",
     "src/core/SkMaskFilter.cpp",
@@ -541,6 +546,8 @@ BASE_SRCS_ALL = [
     "src/core/SkMipmapAccessor.h",
     "src/core/SkMipmapBuilder.cpp",
     "src/core/SkMipmapBuilder.h",
+    "src/core/SkMipmap_opts.cpp",
+    "src/core/SkMipmap_opts_hsw.cpp",
     "src/core/SkNextID.h",
     "src/core/SkOSFile.h",
     "src/core/SkOpts.cpp",
@@ -564,6 +571,8 @@ BASE_SRCS_ALL = [
     "src/core/SkPathRef.cpp",
     "src/core/SkPathUtils.cpp",
     "src/core/SkPath_serial.cpp",
+    "src/core/SkMappedPicture.cpp",
+    "src/core/SkMappedPicture.h",
     "src/core/SkPicture.cpp",
     "src/core/SkPictureData.cpp",
     "src/core/SkPictureData.h",
@@ -622,7 +631,9 @@ BASE_SRCS_ALL = [
     "src/core/SkRegion.cpp",
     "src/core/SkRegionPriv.h",
     "src/core/SkRegion_path.cpp",
+    "src/core/SkResourceCachePool.cpp",
     "src/core/SkResourceCache.cpp",
+    "src/core/SkResourceCachePool.h",
     "src/core/SkResourceCache.h",
     "src/core/SkRuntimeBlender.cpp",
     "src/core/SkRuntimeBlender.h",
@@ -642,6 +653,7 @@ BASE_SRCS_ALL = [
     "src/core/SkScan_AAAPath.cpp",
     "src/core/SkScan_AntiPath.cpp",
     "src/core/SkScan_Antihair.cpp",
+    "src/core/SkScan_DAAPath.cpp",
     "src/core/SkScan_Hairline.cpp",
     "src/core/SkScan_Path.cpp",
     "src/core/SkScan_SAAPath.cpp",
@@ -655,7 +667,9 @@ BASE_SRCS_ALL = [
     "src/core/SkStreamPriv.h",
     "src/core/SkStrike.cpp",
     "src/core/SkStrike.h",
+    "src/core/SkStrikeDiskCache.cpp",
     "src/core/SkStrikeCache.cpp",
+    "src/core/SkStrikeDiskCache.h",
     "src/core/SkStrikeCache.h",
     "src/core/SkStrikeSpec.cpp",
     "src/core/SkStrikeSpec.h",
@@ -680,6 +694,8 @@ BASE_SRCS_ALL = [
     "src/core/SkTextBlobTrace.cpp",
     "src/core/SkTextBlobTrace.h",
     "src/core/SkTextFormatParams.h",
+    "src/core/SkTiledRasterCanvas.cpp",
+    "src/core/SkTiledRasterCanvas.h",
     "src/core/SkTime.cpp",
     "src/core/SkTraceEvent.h",
     "src/core/SkTraceEventCommon.h",
@@ -1291,6 +1307,8 @@ BASE_SRCS_ALL = [
     "src/opts/SkBitmapProcState_opts.h",
     "src/opts/SkBlitMask_opts.h",
     "src/opts/SkBlitRow_opts.h",
+    "src/opts/SkMaskBlurFilter_opts.h",
+    "src/opts/SkMipmap_opts.h",
     "src/opts/SkOpts_RestoreTarget.h",
     "src/opts/SkOpts_SetTarget.h",
     "src/opts/SkRasterPipeline_opts.h",
@@ -1746,6 +1764,7 @@ BASE_SRCS_ALL = [
     "src/utils/SkParsePath.cpp",
     "src/utils/SkPatchUtils.cpp",
     "src/utils/SkPatchUtils.h",
+    "src/utils/SkPictureBandRenderer.cpp",
     "src/utils/SkPolyUtils.cpp",
     "src/utils/SkPolyUtils.h",
     "src/utils/SkShaderUtils.cpp",
@@ -1822,6 +1841,10 @@ CODEC_SRCS_LIMITED = [
     "src/codec/SkJpegDecoderMgr.cpp",
     "src/codec/SkJpegDecoderMgr.h",
     "src/codec/SkJpegPriv.h",
+    "src/codec/SkJpegRestartStrips.cpp",
+    "src/codec/SkJpegRestartStrips.h",
+    "src/codec/SkJpegSegmentScan.cpp",
+    "src/codec/SkJpegSegmentScan.h",
     "src/codec/SkJpegSourceMgr.cpp",
     "src/codec/SkJpegSourceMgr.h",
     "src/codec/SkJpegUtility.cpp",
@@ -1838,6 +1861,8 @@ CODEC_SRCS_LIMITED = [
     "src/codec/SkScalingCodec.h",
     "src/codec/SkSampler.cpp",
     "src/codec/SkSampler.h",
+    "src/codec/SkScanlineResampler.cpp",
+    "src/codec/SkScanlineResampler.h",
     "src/codec/SkSwizzler.cpp",
     "src/codec/SkSwizzler.h",
     "src/codec/SkWbmpCodec.cpp",
@@ -1851,6 +1876,8 @@ CODEC_SRCS_ALL = CODEC_SRCS_LIMITED + [
     "src/codec/SkIcoCodec.h",
     "src/codec/SkPngCodec.cpp",
     "src/codec/SkPngCodec.h",
+    "src/codec/SkPngRowIndex.cpp",
+    "src/codec/SkPngRowIndex.h",
     "src/codec/SkWebpCodec.cpp",
     "src/codec/SkWebpCodec.h",
 ]
@@ -10,9 +10,11 @@
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkStream.h"
 #include "include/private/SkGainmapInfo.h"
@@ -21,6 +23,7 @@
 #include "src/codec/SkAndroidCodecAdapter.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkSampledCodec.h"
+#include "src/codec/SkScanlineResampler.h"
 
 #include <algorithm>
 #include <cstdint>
@@ -544,6 +547,108 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& info, void*
     return this->getAndroidPixels(info, pixels, rowBytes, nullptr);
 }
 
+// Decodes the rows of the whole image from top to bottom, at the smallest size that the codec can
+// scale to natively and that is no smaller than dst, and resamples each into dst as it comes.
+static SkCodec::Result decode_and_resample(SkCodec* codec, const SkPixmap& dst,
+                                           const SkCodec::Options& options,
+                                           SkCubicResampler cubic) {
+    SkISize decodeDims = codec->dimensions();
+    for (int num = 1; num < 8; num++) {
+        const SkISize dims = codec->getScaledDimensions(num / 8.0f);
+        if (!smaller_than(dims, dst.dimensions())) {
+            decodeDims = dims;
+            break;
+        }
+    }
+
+    const SkImageInfo decodeInfo = dst.info().makeDimensions(decodeDims);
+    SkCodec::Result result = codec->startScanlineDecode(decodeInfo, &options);
+    if (result != SkCodec::kSuccess) {
+        return result;
+    }
+    if (codec->getScanlineOrder() != SkCodec::kTopDown_SkScanlineOrder) {
+        return SkCodec::kUnimplemented;
+    }
+
+    SkScanlineResampler resampler(decodeDims, dst, cubic);
+    for (int y = 0; y < decodeDims.height(); y++) {
+        if (result == SkCodec::kSuccess && codec->getScanlines(resampler.srcRow(), 1, 0) != 1) {
+            result = SkCodec::kIncompleteInput;
+        }
+        if (result != SkCodec::kSuccess) {
+            // Like SkCodec::fillIncompleteImage(), fill the rest with zeros.
+            sk_bzero(resampler.srcRow(), decodeInfo.minRowBytes());
+        }
+        resampler.pushRow();
+    }
+    return result;
+}
+
+SkCodec::Result SkAndroidCodec::getResampledPixels(const SkImageInfo& info, void* pixels,
+                                                   size_t rowBytes,
+                                                   const AndroidOptions* options,
+                                                   SkCubicResampler cubic) {
+    if (!pixels || rowBytes < info.minRowBytes() || info.isEmpty()) {
+        return SkCodec::kInvalidParameters;
+    }
+
+    AndroidOptions opts;
+    if (options) {
+        opts = *options;
+    }
+    opts.fSampleSize = 1;
+    if (opts.fSubset) {
+        if (!is_valid_subset(*opts.fSubset, fCodec->dimensions())) {
+            return SkCodec::kInvalidParameters;
+        }
+        if (SkIRect::MakeSize(fCodec->dimensions()) == *opts.fSubset) {
+            opts.fSubset = nullptr;
+        }
+    }
+    const SkISize srcDims = opts.fSubset ? opts.fSubset->size() : fCodec->dimensions();
+    if (smaller_than(srcDims, info.dimensions())) {
+        return SkCodec::kInvalidScale;
+    }
+    if (srcDims == info.dimensions() || supports_any_down_scale(fCodec.get())) {
+        return this->getAndroidPixels(info, pixels, rowBytes, &opts);
+    }
+
+    if (!opts.fSubset && opts.fFrameIndex == 0 && SkScanlineResampler::Supports(info.colorType())) {
+        const SkCodec::Result result =
+                decode_and_resample(fCodec.get(), SkPixmap(info, pixels, rowBytes), opts, cubic);
+        if (result != SkCodec::kUnimplemented) {
+            return result;
+        }
+    }
+
+    // Decode the largest sampled image that is no smaller than info, and resample that.
+    auto sampledDims = [&](int sampleSize) {
+        return opts.fSubset ? this->getSampledSubsetDimensions(sampleSize, *opts.fSubset)
+                            : this->getSampledDimensions(sampleSize);
+    };
+    int sampleSize = std::max(1, std::min(srcDims.width() / info.width(),
+                                          srcDims.height() / info.height()));
+    while (sampleSize > 1 && smaller_than(sampledDims(sampleSize), info.dimensions())) {
+        sampleSize--;
+    }
+    SkBitmap sampled;
+    if (!sampled.tryAllocPixels(info.makeDimensions(sampledDims(sampleSize)))) {
+        return SkCodec::kInternalError;
+    }
+    opts.fSampleSize = sampleSize;
+    const SkCodec::Result result = this->getAndroidPixels(sampled.info(), sampled.getPixels(),
+                                                          sampled.rowBytes(), &opts);
+    if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput &&
+        result != SkCodec::kErrorInInput) {
+        return result;
+    }
+    if (!sampled.pixmap().scalePixels(SkPixmap(info, pixels, rowBytes),
+                                      SkSamplingOptions(cubic))) {
+        return SkCodec::kInvalidConversion;
+    }
+    return result;
+}
+
 bool SkAndroidCodec::getAndroidGainmap(SkGainmapInfo* info,
                                        std::unique_ptr<SkStream>* outGainmapImageStream) {
     if (!fCodec->onGetGainmapInfo(info, outGainmapImageStream)) {
@@ -27,8 +27,10 @@
 #include "src/codec/SkJpegConstants.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/codec/SkJpegRestartStrips.h"
 #include "src/codec/SkParseEncodedOrigin.h"
 #include "src/codec/SkSwizzler.h"
+#include "src/core/SkTaskGroup.h"
 
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include "include/private/SkGainmapInfo.h"
@@ -39,6 +41,7 @@
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
 #include <array>
+#include <atomic>
 #include <csetjmp>
 #include <cstring>
 #include <utility>
@@ -652,6 +655,10 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kUnimplemented;
     }
 
+    if (options.fExecutor && this->decodeRestartStrips(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
@@ -687,6 +694,69 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+// Strips of fewer rows than this aren't worth a decoder of their own. Each strip also decodes a
+// restart interval or more above and below itself.
+static constexpr int kMinRestartStripRows = 256;
+static constexpr int kMaxRestartStrips = 16;
+
+bool SkJpegCodec::decodeRestartStrips(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+                                      const Options& options) {
+    SkASSERT(options.fExecutor && !options.fSubset);
+    // Scaled decodes would have to scale each strip by the same whole number of rows.
+    SkStream* stream = this->stream();
+    if (dstInfo.dimensions() != this->dimensions() || !stream->getMemoryBase() ||
+        !stream->hasLength()) {
+        return false;
+    }
+    std::unique_ptr<SkJpegRestartStrips> strips = SkJpegRestartStrips::Make(
+            SkData::MakeWithoutCopy(stream->getMemoryBase(), stream->getLength()),
+            kMaxRestartStrips, kMinRestartStripRows);
+    if (!strips) {
+        return false;
+    }
+
+    const skcms_ICCProfile* profile = this->getEncodedInfo().profile();
+    std::atomic<bool> failed{false};
+    SkTaskGroup tasks(*options.fExecutor);
+    tasks.batch(strips->count(), [&](int i) {
+        // The strip's JPEG has the same metadata as the image, but if the image's color profile
+        // came from elsewhere (e.g. SkRawCodec), the strip needs it too.
+        Result result;
+        std::unique_ptr<SkCodec> codec = MakeFromStream(
+                SkMemoryStream::Make(strips->makeStripData(i)), &result,
+                profile ? SkEncodedInfo::ICCProfile::Make(*profile) : nullptr);
+        if (!codec) {
+            failed = true;
+            return;
+        }
+
+        const SkImageInfo stripInfo = dstInfo.makeDimensions(codec->dimensions());
+        Options stripOptions;
+        stripOptions.fZeroInitialized = options.fZeroInitialized;
+        if (kSuccess != codec->startScanlineDecode(stripInfo, &stripOptions)) {
+            failed = true;
+            return;
+        }
+        // Decode the rows above the strip, rather than skip them, so that the rows of the strip
+        // are upsampled from the same rows of chroma as when decoding the whole image.
+        if (strips->rowsAbove(i) > 0) {
+            AutoTMalloc<uint8_t> scratch(stripInfo.minRowBytes());
+            if (strips->rowsAbove(i) != codec->getScanlines(scratch.get(), strips->rowsAbove(i),
+                                                            0)) {
+                failed = true;
+                return;
+            }
+        }
+        void* stripDst = SkTAddOffset<void>(dst, strips->top(i) * dstRowBytes);
+        if (strips->height(i) != codec->getScanlines(stripDst, strips->height(i), dstRowBytes)) {
+            failed = true;
+        }
+    });
+    tasks.wait();
+
+    return !failed;
+}
+
 bool SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
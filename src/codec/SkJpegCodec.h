@@ -126,6 +126,14 @@ private:
                 JpegDecoderMgr* decoderMgr,
                 SkEncodedOrigin origin);
 
+    /*
+     * Decodes the image on options.fExecutor, in strips split at its restart markers, each with
+     * a decoder of its own. Returns false, having decoded nothing, if the image has no restart
+     * markers to split it with, and false if any strip fails to decode.
+     */
+    bool decodeRestartStrips(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+                             const Options& options);
+
     void initializeSwizzler(const SkImageInfo& dstInfo, const Options& options,
                             bool needsCMYKToRGB);
     [[nodiscard]] bool allocateStorage(const SkImageInfo& dstInfo);
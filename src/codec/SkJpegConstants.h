@@ -19,6 +19,15 @@ static constexpr uint8_t kJpegMarkerEndOfImage = 0xD9;
 // The header of a JPEG file is the data in all segments before the first StartOfScan.
 static constexpr uint8_t kJpegMarkerStartOfScan = 0xDA;
 
+// Frames coded with Huffman coding, sequentially, are started by one of these markers.
+static constexpr uint8_t kJpegMarkerStartOfFrameBaseline = 0xC0;
+static constexpr uint8_t kJpegMarkerStartOfFrameExtended = 0xC1;
+
+// Entropy-coded data is split into restart intervals of this many MCUs by RST0 through RST7.
+static constexpr uint8_t kJpegMarkerDefineRestartInterval = 0xDD;
+static constexpr uint8_t kJpegMarkerRestart0 = 0xD0;
+static constexpr uint8_t kJpegMarkerRestart7 = 0xD7;
+
 // Metadata and auxiliary images are stored in the APP1 through APP15 markers.
 static constexpr uint8_t kJpegMarkerAPP0 = 0xE0;
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2023 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkJpegRestartStrips.h"
+
+#include "include/private/base/SkAssert.h"
+#include "src/codec/SkCodecPriv.h"
+#include "src/codec/SkJpegConstants.h"
+#include "src/codec/SkJpegSegmentScan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// The start of frame markers of frames that are progressive, lossless, or arithmetic-coded.
+static bool is_unsupported_start_of_frame(uint8_t marker) {
+    switch (marker) {
+        case 0xC2: case 0xC3:
+        case 0xC5: case 0xC6: case 0xC7:
+        case 0xC9: case 0xCA: case 0xCB:
+        case 0xCD: case 0xCE: case 0xCF:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_restart(uint8_t marker) {
+    return marker >= kJpegMarkerRestart0 && marker <= kJpegMarkerRestart7;
+}
+
+static uint16_t read_u16(const uint8_t* bytes) { return (bytes[0] << 8) | bytes[1]; }
+
+std::unique_ptr<SkJpegRestartStrips> SkJpegRestartStrips::Make(sk_sp<SkData> data,
+                                                               int maxStrips,
+                                                               int minStripRows) {
+    if (!data || maxStrips < 2) {
+        return nullptr;
+    }
+
+    // Truncated or corrupt images are left to the decoder of the whole image, which knows what
+    // to do with them.
+    SkJpegSegmentScanner scanner(kJpegMarkerEndOfImage);
+    scanner.onBytes(data->data(), data->size());
+    if (!scanner.isDone()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SkJpegRestartStrips> strips(new SkJpegRestartStrips(data));
+    const SkJpegSegment* frame = nullptr;
+    const SkJpegSegment* scan = nullptr;
+    uint16_t restartInterval = 0;
+    for (const SkJpegSegment& segment : scanner.getSegments()) {
+        if (scan) {
+            // The scan must be the only one, and run to the end of the image.
+            if (is_restart(segment.marker)) {
+                strips->fRestartOffsets.push_back(segment.offset);
+            } else if (segment.marker == kJpegMarkerEndOfImage) {
+                strips->fEndOfImageOffset = segment.offset;
+            } else {
+                return nullptr;
+            }
+            continue;
+        }
+        switch (segment.marker) {
+            case kJpegMarkerStartOfFrameBaseline:
+            case kJpegMarkerStartOfFrameExtended:
+                if (frame) {
+                    return nullptr;
+                }
+                frame = &segment;
+                break;
+            case kJpegMarkerDefineRestartInterval: {
+                auto params = SkJpegSegmentScanner::GetParameters(data.get(), segment);
+                if (params->size() != 2) {
+                    return nullptr;
+                }
+                restartInterval = read_u16(params->bytes());
+                break;
+            }
+            case kJpegMarkerStartOfScan:
+                scan = &segment;
+                break;
+            default:
+                if (is_unsupported_start_of_frame(segment.marker) || is_restart(segment.marker)) {
+                    return nullptr;
+                }
+                break;
+        }
+    }
+    if (!frame || !scan || !restartInterval) {
+        return nullptr;
+    }
+
+    auto frameParams = SkJpegSegmentScanner::GetParameters(data.get(), *frame);
+    const uint8_t* frameBytes = frameParams->bytes();
+    if (frameParams->size() < 6 || frameBytes[0] != 8) {
+        return nullptr;
+    }
+    const int height = read_u16(frameBytes + 1);
+    const int width = read_u16(frameBytes + 3);
+    const int components = frameBytes[5];
+    if (!height || !width || !components || frameParams->size() < 6 + 3 * (size_t)components) {
+        return nullptr;
+    }
+    auto scanParams = SkJpegSegmentScanner::GetParameters(data.get(), *scan);
+    if (scanParams->size() < 1 || scanParams->bytes()[0] != components) {
+        return nullptr;
+    }
+
+    // See section A.2: an MCU of an interleaved scan covers the blocks of each component that
+    // cover the same region of the image, while an MCU of a scan of one component is one block.
+    int maxH = 1, maxV = 1;
+    for (int c = 0; c < components; c++) {
+        const uint8_t samplingFactors = frameBytes[6 + 3 * c + 1];
+        maxH = std::max(maxH, samplingFactors >> 4);
+        maxV = std::max(maxV, samplingFactors & 0xF);
+    }
+    const int mcuWidth = components == 1 ? 8 : 8 * maxH;
+    const int mcuHeight = components == 1 ? 8 : 8 * maxV;
+    const int64_t mcuCols = (width + mcuWidth - 1) / mcuWidth;
+    const int64_t mcuRows = (height + mcuHeight - 1) / mcuHeight;
+    const int64_t intervals = (mcuCols * mcuRows + restartInterval - 1) / restartInterval;
+    if ((int64_t)strips->fRestartOffsets.size() != intervals - 1) {
+        SkCodecPrintf("Expected %d restart markers, found %d\n",
+                      (int)(intervals - 1), (int)strips->fRestartOffsets.size());
+        return nullptr;
+    }
+
+    strips->fHeightOffset =
+            frame->offset + kJpegMarkerCodeSize + kJpegSegmentParameterLengthSize + 1;
+    strips->fScanDataOffset = scan->offset + kJpegMarkerCodeSize + scan->parameterLength;
+
+    // The places the image can be split: the restart intervals that start a row of MCUs, and the
+    // end of the image.
+    struct Split {
+        int fRow;
+        int fInterval;
+    };
+    std::vector<Split> splits;
+    for (int64_t interval = 0; interval < intervals; interval++) {
+        const int64_t mcu = interval * restartInterval;
+        if (mcu % mcuCols == 0) {
+            splits.push_back({(int)std::min<int64_t>(mcu / mcuCols * mcuHeight, height),
+                              (int)interval});
+        }
+    }
+    splits.push_back({height, (int)intervals});
+
+    const int targetRows = std::max(minStripRows, (height + maxStrips - 1) / maxStrips);
+    std::vector<int> cuts = {0};  // Indices into splits.
+    for (int s = 1; s < (int)splits.size() - 1; s++) {
+        if (splits[s].fRow - splits[cuts.back()].fRow >= targetRows &&
+            height - splits[s].fRow >= minStripRows) {
+            cuts.push_back(s);
+        }
+    }
+    cuts.push_back((int)splits.size() - 1);
+    if (cuts.size() < 3) {
+        return nullptr;
+    }
+
+    for (size_t c = 0; c + 1 < cuts.size(); c++) {
+        const Split& decodeTop = splits[std::max(cuts[c] - 1, 0)];
+        const Split& decodeBottom = splits[std::min(cuts[c + 1] + 1, (int)splits.size() - 1)];
+        Strip strip;
+        strip.fTop = splits[cuts[c]].fRow;
+        strip.fHeight = splits[cuts[c + 1]].fRow - strip.fTop;
+        strip.fDecodeTop = decodeTop.fRow;
+        strip.fDecodeHeight = decodeBottom.fRow - decodeTop.fRow;
+        strip.fFirstInterval = decodeTop.fInterval;
+        strip.fEndInterval = decodeBottom.fInterval;
+        strips->fStrips.push_back(strip);
+    }
+    return strips;
+}
+
+sk_sp<SkData> SkJpegRestartStrips::makeStripData(int i) const {
+    const Strip& strip = fStrips[i];
+    const int intervals = static_cast<int>(fRestartOffsets.size()) + 1;
+    const size_t start = strip.fFirstInterval == 0
+                               ? fScanDataOffset
+                               : fRestartOffsets[strip.fFirstInterval - 1] + kJpegMarkerCodeSize;
+    const size_t end = strip.fEndInterval == intervals ? fEndOfImageOffset
+                                                       : fRestartOffsets[strip.fEndInterval - 1];
+    SkASSERT(start <= end);
+
+    const size_t headerSize = fScanDataOffset;
+    sk_sp<SkData> stripData =
+            SkData::MakeUninitialized(headerSize + (end - start) + kJpegMarkerCodeSize);
+    uint8_t* dst = static_cast<uint8_t*>(stripData->writable_data());
+    const uint8_t* src = fData->bytes();
+
+    memcpy(dst, src, headerSize);
+    dst[fHeightOffset]     = static_cast<uint8_t>(strip.fDecodeHeight >> 8);
+    dst[fHeightOffset + 1] = static_cast<uint8_t>(strip.fDecodeHeight);
+
+    memcpy(dst + headerSize, src + start, end - start);
+    // The decoder expects the restart markers of a scan to count up from RST0.
+    for (int interval = strip.fFirstInterval; interval < strip.fEndInterval - 1; interval++) {
+        const size_t marker = headerSize + fRestartOffsets[interval] - start + 1;
+        SkASSERT(is_restart(dst[marker]));
+        dst[marker] = kJpegMarkerRestart0 + ((interval - strip.fFirstInterval) & 7);
+    }
+
+    dst[stripData->size() - 2] = 0xFF;
+    dst[stripData->size() - 1] = kJpegMarkerEndOfImage;
+    return stripData;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2023 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegRestartStrips_codec_DEFINED
+#define SkJpegRestartStrips_codec_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * Splits a baseline JPEG into horizontal strips that can be decoded independently, and so in
+ * parallel, using its restart markers. The entropy-coded data of each restart interval can be
+ * decoded on its own, since the DC predictions are reset at the start of each one. Every
+ * restart interval that begins at the start of a row of MCUs is a place the image can be split.
+ *
+ * Each strip is decoded from a JPEG of its own, made from the image's header (with its height
+ * changed) and the restart intervals of the strip. So that chroma upsampling has the same rows
+ * above and below a strip as when decoding the whole image, the JPEG of a strip also holds the
+ * rows up to the places the image could be split before and after it; those rows are decoded
+ * and thrown away.
+ */
+class SkJpegRestartStrips {
+public:
+    /*
+     * Returns nullptr unless data is a JPEG with a single, interleaved, Huffman-coded sequential
+     * scan, that has restart intervals which let it be split into at least two strips of at least
+     * minStripRows rows. It will be split into at most maxStrips strips.
+     */
+    static std::unique_ptr<SkJpegRestartStrips> Make(sk_sp<SkData> data,
+                                                     int maxStrips,
+                                                     int minStripRows);
+
+    int count() const { return static_cast<int>(fStrips.size()); }
+
+    // The first row of the image in strip i, and the number of rows of the image in strip i.
+    int top(int i) const { return fStrips[i].fTop; }
+    int height(int i) const { return fStrips[i].fHeight; }
+
+    // The number of rows the JPEG of strip i has above the strip's first row.
+    int rowsAbove(int i) const { return fStrips[i].fTop - fStrips[i].fDecodeTop; }
+
+    // Returns a JPEG with the rows of strip i, and the rows above and below that make it decode
+    // exactly as it does in the whole image.
+    sk_sp<SkData> makeStripData(int i) const;
+
+private:
+    struct Strip {
+        int fTop;
+        int fHeight;
+        int fDecodeTop;       // The first row of the strip's JPEG in the image.
+        int fDecodeHeight;
+        int fFirstInterval;   // The restart intervals of the strip's JPEG.
+        int fEndInterval;
+    };
+
+    SkJpegRestartStrips(sk_sp<SkData> data) : fData(std::move(data)) {}
+
+    sk_sp<SkData>       fData;
+    size_t              fHeightOffset = 0;     // Where the height is in the frame header.
+    size_t              fScanDataOffset = 0;   // Where the first restart interval starts.
+    size_t              fEndOfImageOffset = 0;
+    std::vector<size_t> fRestartOffsets;       // Where the marker at the end of each interval is.
+    std::vector<Strip>  fStrips;
+};
+
+#endif
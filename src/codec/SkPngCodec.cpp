@@ -25,13 +25,17 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkColorPalette.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/codec/SkPngRowIndex.h"
 #include "src/codec/SkSwizzler.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <csetjmp>
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <utility>
+#include <vector>
 
 #include <png.h>
 #include <pngconf.h>
@@ -1017,6 +1021,11 @@ SkPngCodec::~SkPngCodec() {
     this->destroyReadStruct();
 }
 
+void SkPngCodec::setRowIndex(std::unique_ptr<SkPngRowIndex> index) {
+    SkASSERT(!index || index->height() == this->dimensions().height());
+    fRowIndex = std::move(index);
+}
+
 void SkPngCodec::destroyReadStruct() {
     if (fPng_ptr) {
         // We will never have a nullptr fInfo_ptr with a non-nullptr fPng_ptr
@@ -1138,6 +1147,9 @@ void SkPngCodec::initializeSwizzler(const SkImageInfo& dstInfo, const Options& o
 }
 
 SkSampler* SkPngCodec::getSampler(bool createIfNecessary) {
+    if (fRegionCodec) {
+        return fRegionCodec->getSampler(createIfNecessary);
+    }
     if (fSwizzler || !createIfNecessary) {
         return fSwizzler.get();
     }
@@ -1153,6 +1165,7 @@ bool SkPngCodec::onRewind() {
     // come through this function which will rewind and again attempt
     // to reinitialize them.
     this->destroyReadStruct();
+    fRegionCodec.reset();
 
     png_structp png_ptr;
     png_infop info_ptr;
@@ -1170,6 +1183,11 @@ bool SkPngCodec::onRewind() {
 SkCodec::Result SkPngCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
                                         size_t rowBytes, const Options& options,
                                         int* rowsDecoded) {
+    if (options.fExecutor && fRowIndex && !options.fSubset &&
+        this->decodeRowIndexBands(dstInfo, dst, rowBytes, options)) {
+        return kSuccess;
+    }
+
     Result result = this->initializeXforms(dstInfo, options);
     if (kSuccess != result) {
         return result;
@@ -1186,6 +1204,12 @@ SkCodec::Result SkPngCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
 
 SkCodec::Result SkPngCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo,
         void* dst, size_t rowBytes, const SkCodec::Options& options) {
+    fRegionCodec.reset();
+    if (options.fSubset && fRowIndex &&
+        this->startRowIndexRegion(dstInfo, dst, rowBytes, options)) {
+        return kSuccess;
+    }
+
     Result result = this->initializeXforms(dstInfo, options);
     if (kSuccess != result) {
         return result;
@@ -1206,12 +1230,88 @@ SkCodec::Result SkPngCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo,
 }
 
 SkCodec::Result SkPngCodec::onIncrementalDecode(int* rowsDecoded) {
+    if (fRegionCodec) {
+        return fRegionCodec->incrementalDecode(rowsDecoded);
+    }
+
     // FIXME: Only necessary on the first call.
     this->initializeXformParams();
 
     return this->decode(rowsDecoded);
 }
 
+// The rows decoded from an index are a PNG of their own, with the image's chunks up to its image
+// data. They are decoded without the chunk reader, which has already seen those chunks.
+static std::unique_ptr<SkPngCodec> make_region_codec(const SkPngRowIndex& index,
+                                                     int top, int bottom) {
+    sk_sp<SkData> region = index.makeRegion(top, bottom);
+    if (!region) {
+        return nullptr;
+    }
+    SkCodec::Result result;
+    std::unique_ptr<SkCodec> codec =
+            SkPngCodec::MakeFromStream(SkMemoryStream::Make(std::move(region)), &result);
+    return std::unique_ptr<SkPngCodec>(static_cast<SkPngCodec*>(codec.release()));
+}
+
+bool SkPngCodec::startRowIndexRegion(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                     const Options& options) {
+    SkASSERT(fRowIndex && options.fSubset);
+    // Only a subset below an access point skips any rows.
+    const std::vector<int> startRows = fRowIndex->startRows();
+    const int top = options.fSubset->top();
+    const int bottom = options.fSubset->bottom();
+    if (startRows.size() < 2 || startRows[1] > top) {
+        return false;
+    }
+
+    std::unique_ptr<SkPngCodec> codec = make_region_codec(*fRowIndex, top, bottom);
+    if (!codec) {
+        return false;
+    }
+    const SkIRect regionSubset = SkIRect::MakeLTRB(options.fSubset->left(), 0,
+                                                   options.fSubset->right(), bottom - top);
+    Options regionOptions = options;
+    regionOptions.fSubset = &regionSubset;
+    if (kSuccess != codec->startIncrementalDecode(dstInfo.makeDimensions(codec->dimensions()),
+                                                  dst, rowBytes, &regionOptions)) {
+        return false;
+    }
+    fRegionCodec = std::move(codec);
+    return true;
+}
+
+bool SkPngCodec::decodeRowIndexBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                     const Options& options) {
+    SkASSERT(fRowIndex && options.fExecutor && !options.fSubset);
+    // Each band runs from one access point to the next, so no rows are inflated twice.
+    std::vector<int> bands = fRowIndex->startRows();
+    if (bands.size() < 2 || dstInfo.dimensions() != this->dimensions()) {
+        return false;
+    }
+    bands.push_back(dstInfo.height());
+
+    std::atomic<bool> failed{false};
+    SkTaskGroup tasks(*options.fExecutor);
+    tasks.batch(static_cast<int>(bands.size()) - 1, [&](int i) {
+        std::unique_ptr<SkPngCodec> codec = make_region_codec(*fRowIndex, bands[i], bands[i + 1]);
+        if (!codec) {
+            failed = true;
+            return;
+        }
+        Options bandOptions;
+        bandOptions.fZeroInitialized = options.fZeroInitialized;
+        void* bandDst = SkTAddOffset<void>(dst, bands[i] * rowBytes);
+        if (kSuccess != codec->getPixels(dstInfo.makeDimensions(codec->dimensions()), bandDst,
+                                         rowBytes, &bandOptions)) {
+            failed = true;
+        }
+    });
+    tasks.wait();
+
+    return !failed;
+}
+
 std::unique_ptr<SkCodec> SkPngCodec::MakeFromStream(std::unique_ptr<SkStream> stream,
                                                     Result* result, SkPngChunkReader* chunkReader) {
     SkASSERT(result);
@@ -1259,4 +1359,22 @@ std::unique_ptr<SkCodec> Decode(sk_sp<SkData> data,
     }
     return Decode(SkMemoryStream::Make(std::move(data)), outResult, ctx);
 }
+
+sk_sp<SkData> MakeRowIndex(sk_sp<SkData> data) {
+    std::unique_ptr<SkPngRowIndex> index = SkPngRowIndex::Make(std::move(data));
+    return index ? index->serialize() : nullptr;
+}
+
+std::unique_ptr<SkCodec> DecodeWithRowIndex(sk_sp<SkData> data,
+                                            sk_sp<SkData> rowIndex,
+                                            SkCodec::Result* outResult,
+                                            SkCodecs::DecodeContext ctx) {
+    std::unique_ptr<SkPngRowIndex> index =
+            rowIndex ? SkPngRowIndex::Deserialize(data, *rowIndex) : nullptr;
+    std::unique_ptr<SkCodec> codec = Decode(std::move(data), outResult, ctx);
+    if (codec && index) {
+        static_cast<SkPngCodec*>(codec.get())->setRowIndex(std::move(index));
+    }
+    return codec;
+}
 }  // namespace SkPngDecoder
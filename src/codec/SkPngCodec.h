@@ -18,6 +18,7 @@
 
 class SkColorPalette;
 class SkPngChunkReader;
+class SkPngRowIndex;
 class SkSampler;
 class SkStream;
 class SkSwizzler;
@@ -35,6 +36,13 @@ public:
     // FIXME (scroggo): Temporarily needed by AutoCleanPng.
     void setIdatLength(size_t len) { fIdatLength = len; }
 
+    /*
+     *  Lets subset decodes start from the access point of the index nearest above them, and lets
+     *  full decodes with an executor decode the rows between access points in parallel. The
+     *  index must have been made for the image this codec decodes.
+     */
+    void setRowIndex(std::unique_ptr<SkPngRowIndex>);
+
     ~SkPngCodec() override;
 
 protected:
@@ -113,6 +121,13 @@ private:
     void allocateStorage(const SkImageInfo& dstInfo);
     void destroyReadStruct();
 
+    // Decode using fRowIndex. These return false if the index cannot be used, so that the caller
+    // can decode from the start of the image data instead.
+    bool decodeRowIndexBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                             const Options&);
+    bool startRowIndexRegion(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                             const Options&);
+
     virtual Result decodeAllRows(void* dst, size_t rowBytes, int* rowsDecoded) = 0;
     virtual void setRange(int firstRow, int lastRow, void* dst, size_t rowBytes) = 0;
     virtual Result decode(int* rowsDecoded) = 0;
@@ -123,6 +138,10 @@ private:
     size_t                         fIdatLength;
     bool                           fDecodedIdat;
 
+    std::unique_ptr<SkPngRowIndex> fRowIndex;
+    // Decodes the rows of an incremental subset decode from fRowIndex, in place of this codec.
+    std::unique_ptr<SkPngCodec>    fRegionCodec;
+
     using INHERITED = SkCodec;
 };
 #endif  // SkPngCodec_DEFINED
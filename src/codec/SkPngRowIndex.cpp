@@ -0,0 +1,520 @@
+/*
+ * Copyright 2023 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkPngRowIndex.h"
+
+#include "include/core/SkStream.h"
+#include "include/private/base/SkAssert.h"
+#include "src/base/SkScopeExit.h"
+#include "src/codec/SkCodecPriv.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+#include "zlib.h"
+
+static constexpr size_t kWindowSize = 32768;   // The most a deflate back reference can reach.
+static constexpr size_t kMaxStoredBlock = 65535;
+static constexpr uint32_t kIndexMagic = 0x58444952;  // 'RIDX'
+static constexpr uint32_t kIndexVersion = 1;
+
+static uint32_t read_u32(const uint8_t* bytes) {
+    return ((uint32_t)bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+static void write_u32(uint8_t* bytes, uint32_t value) {
+    bytes[0] = static_cast<uint8_t>(value >> 24);
+    bytes[1] = static_cast<uint8_t>(value >> 16);
+    bytes[2] = static_cast<uint8_t>(value >> 8);
+    bytes[3] = static_cast<uint8_t>(value);
+}
+
+// Writes a chunk whose data is header followed by data, and returns the end of it.
+static uint8_t* write_chunk(uint8_t* dst, const char type[4],
+                            const uint8_t* header, size_t headerLength,
+                            const uint8_t* data, size_t length) {
+    write_u32(dst, static_cast<uint32_t>(headerLength + length));
+    memcpy(dst + 4, type, 4);
+    if (headerLength) {
+        memcpy(dst + 8, header, headerLength);
+    }
+    if (length) {
+        memcpy(dst + 8 + headerLength, data, length);
+    }
+    const uInt crcLength = static_cast<uInt>(4 + headerLength + length);
+    write_u32(dst + 8 + headerLength + length, crc32(crc32(0, nullptr, 0), dst + 4, crcLength));
+    return dst + 12 + headerLength + length;
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    const int pa = abs(b - c);
+    const int pb = abs(a - c);
+    const int pc = abs(a + b - 2 * c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Reverses the filtering of row in place, given the unfiltered row above it.
+static bool unfilter_row(uint8_t filter, uint8_t* row, const uint8_t* prior,
+                         size_t rowBytes, size_t bpp) {
+    switch (filter) {
+        case 0:
+            return true;
+        case 1:
+            for (size_t i = bpp; i < rowBytes; i++) {
+                row[i] += row[i - bpp];
+            }
+            return true;
+        case 2:
+            for (size_t i = 0; i < rowBytes; i++) {
+                row[i] += prior[i];
+            }
+            return true;
+        case 3:
+            for (size_t i = 0; i < rowBytes; i++) {
+                const int left = i < bpp ? 0 : row[i - bpp];
+                row[i] += static_cast<uint8_t>((left + prior[i]) >> 1);
+            }
+            return true;
+        case 4:
+            for (size_t i = 0; i < rowBytes; i++) {
+                const uint8_t left = i < bpp ? 0 : row[i - bpp];
+                const uint8_t upperLeft = i < bpp ? 0 : prior[i - bpp];
+                row[i] += paeth(left, prior[i], upperLeft);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+namespace {
+
+// Gathers inflated bytes into filtered rows, and unfilters each row once it is complete.
+class RowAssembler {
+public:
+    RowAssembler(size_t rowBytes, size_t bpp)
+            : fRowBytes(rowBytes), fBpp(bpp), fRow(rowBytes + 1), fPrior(rowBytes, 0) {}
+
+    // Resumes at row, given the unfiltered row above it and the filtered start of row.
+    void reset(int row, const uint8_t* prior, const uint8_t* partial, size_t partialLength) {
+        SkASSERT(partialLength <= fRowBytes);
+        fRowIndex = row;
+        memcpy(fPrior.data(), prior, fRowBytes);
+        memcpy(fRow.data(), partial, partialLength);
+        fRowLength = partialLength;
+    }
+
+    int row() const { return fRowIndex; }
+    const uint8_t* prior() const { return fPrior.data(); }
+    const uint8_t* partial() const { return fRow.data(); }
+    size_t partialLength() const { return fRowLength; }
+
+    // Calls onRow(row, unfilteredRow) for each row that bytes complete, stopping at endRow.
+    // Returns false if a row has an unknown filter.
+    template <typename OnRow>
+    bool consume(const uint8_t* bytes, size_t length, int endRow, OnRow&& onRow) {
+        while (length && fRowIndex < endRow) {
+            const size_t n = std::min(length, fRow.size() - fRowLength);
+            memcpy(fRow.data() + fRowLength, bytes, n);
+            fRowLength += n;
+            bytes += n;
+            length -= n;
+            if (fRowLength < fRow.size()) {
+                break;
+            }
+            if (!unfilter_row(fRow[0], fRow.data() + 1, fPrior.data(), fRowBytes, fBpp)) {
+                return false;
+            }
+            onRow(fRowIndex, fRow.data() + 1);
+            memcpy(fPrior.data(), fRow.data() + 1, fRowBytes);
+            fRowLength = 0;
+            fRowIndex++;
+        }
+        return true;
+    }
+
+private:
+    const size_t         fRowBytes;
+    const size_t         fBpp;
+    std::vector<uint8_t> fRow;     // The filter type, then the row.
+    std::vector<uint8_t> fPrior;   // Unfiltered, and zero above the first row.
+    size_t               fRowLength = 0;
+    int                  fRowIndex = 0;
+};
+
+}  // namespace
+
+bool SkPngRowIndex::parseChunks() {
+    static constexpr uint8_t kSignature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    static constexpr size_t kIhdrEnd = 8 + 12 + 13;
+
+    const uint8_t* data = fPng->bytes();
+    const size_t size = fPng->size();
+    if (size < kIhdrEnd || memcmp(data, kSignature, 8) != 0 || read_u32(data + 8) != 13 ||
+        memcmp(data + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+
+    const uint8_t* ihdr = data + 16;
+    const uint32_t width = read_u32(ihdr);
+    const uint32_t height = read_u32(ihdr + 4);
+    const int bitDepth = ihdr[8];
+    const int colorType = ihdr[9];
+    const int interlace = ihdr[12];
+    if (!width || !height || width > INT_MAX || height > INT_MAX || interlace != 0) {
+        return false;
+    }
+    int channels;
+    switch (colorType) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: return false;
+    }
+    if (bitDepth != 1 && bitDepth != 2 && bitDepth != 4 && bitDepth != 8 && bitDepth != 16) {
+        return false;
+    }
+    const size_t bitsPerPixel = channels * bitDepth;
+    fWidth = static_cast<int>(width);
+    fHeight = static_cast<int>(height);
+    fRowBytes = (static_cast<uint64_t>(width) * bitsPerPixel + 7) / 8;
+    fBytesPerPixel = std::max<size_t>(1, bitsPerPixel / 8);
+    fAncillaryOffset = kIhdrEnd;
+
+    // The IDAT chunks must be consecutive; anything after them is not needed to decode rows.
+    size_t offset = kIhdrEnd;
+    while (offset + 12 <= size) {
+        const size_t length = read_u32(data + offset);
+        const uint8_t* type = data + offset + 4;
+        if (length > size - offset - 12) {
+            return false;
+        }
+        if (memcmp(type, "IDAT", 4) == 0) {
+            if (fIdat.empty()) {
+                fAncillaryLength = offset - fAncillaryOffset;
+            }
+            fIdat.push_back({offset + 8, length, fStreamLength});
+            fStreamLength += length;
+        } else if (!fIdat.empty() || memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        offset += 12 + length;
+    }
+    // The stream ends with the Adler-32 of the rows.
+    return fStreamLength > 4;
+}
+
+size_t SkPngRowIndex::pointStride() const {
+    return kWindowSize + fRowBytes + (fRowBytes + 1);
+}
+
+uint8_t SkPngRowIndex::streamByte(uint64_t streamOffset) const {
+    SkASSERT(streamOffset < fStreamLength);
+    const IdatChunk& chunk = fIdat[this->findChunk(streamOffset)];
+    return fPng->bytes()[chunk.fOffset + (streamOffset - chunk.fStreamOffset)];
+}
+
+size_t SkPngRowIndex::findChunk(uint64_t streamOffset) const {
+    auto next = std::upper_bound(fIdat.begin(), fIdat.end(), streamOffset,
+                                 [](uint64_t offset, const IdatChunk& chunk) {
+                                     return offset < chunk.fStreamOffset;
+                                 });
+    SkASSERT(next != fIdat.begin());
+    return (next - fIdat.begin()) - 1;
+}
+
+std::unique_ptr<SkPngRowIndex> SkPngRowIndex::Make(sk_sp<SkData> png, size_t span) {
+    if (!png) {
+        return nullptr;
+    }
+    std::unique_ptr<SkPngRowIndex> index(new SkPngRowIndex(std::move(png)));
+    if (!index->parseChunks()) {
+        return nullptr;
+    }
+
+    z_stream zstream;
+    memset(&zstream, 0, sizeof(zstream));
+    if (inflateInit(&zstream) != Z_OK) {
+        return nullptr;
+    }
+    SK_AT_SCOPE_EXIT(inflateEnd(&zstream));
+
+    // The inflated bytes go around a buffer the size of the window, so that the window at each
+    // access point is the buffer, rotated.
+    std::vector<uint8_t> window(kWindowSize);
+    RowAssembler rows(index->fRowBytes, index->fBytesPerPixel);
+    const size_t stride = index->pointStride();
+    uint64_t totalOut = 0;
+    uint64_t lastPoint = 0;
+    bool ended = false;
+    for (const IdatChunk& chunk : index->fIdat) {
+        zstream.next_in = const_cast<Bytef*>(index->fPng->bytes() + chunk.fOffset);
+        zstream.avail_in = static_cast<uInt>(chunk.fLength);
+        while (zstream.avail_in && !ended) {
+            if (!zstream.avail_out) {
+                zstream.next_out = window.data();
+                zstream.avail_out = kWindowSize;
+            }
+            const uint8_t* out = zstream.next_out;
+            // Z_BLOCK stops at the end of each deflate block.
+            const int ret = inflate(&zstream, Z_BLOCK);
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                SkCodecPrintf("Could not inflate the image data to index it\n");
+                return nullptr;
+            }
+            const size_t produced = zstream.next_out - out;
+            totalOut += produced;
+            if (!rows.consume(out, produced, index->fHeight, [](int, const uint8_t*) {})) {
+                return nullptr;
+            }
+            ended = ret == Z_STREAM_END;
+
+            // Bit 7 of data_type is set at the end of a block, and bit 6 if it was the last one.
+            const bool blockBoundary = (zstream.data_type & 128) && !(zstream.data_type & 64);
+            if (blockBoundary && totalOut - lastPoint > span && rows.row() < index->fHeight) {
+                const uint64_t in = chunk.fStreamOffset + (chunk.fLength - zstream.avail_in);
+                index->fPoints.push_back(
+                        {in, totalOut, static_cast<uint32_t>(zstream.data_type & 7)});
+
+                const size_t base = index->fPointData.size();
+                index->fPointData.resize(base + stride);
+                uint8_t* dst = index->fPointData.data() + base;
+                const size_t left = zstream.avail_out;
+                memcpy(dst, window.data() + kWindowSize - left, left);
+                memcpy(dst + left, window.data(), kWindowSize - left);
+                memcpy(dst + kWindowSize, rows.prior(), index->fRowBytes);
+                memcpy(dst + kWindowSize + index->fRowBytes, rows.partial(),
+                       rows.partialLength());
+                lastPoint = totalOut;
+            }
+        }
+        if (ended) {
+            break;
+        }
+    }
+    if (rows.row() < index->fHeight) {
+        SkCodecPrintf("The image data ended after %d of %d rows\n", rows.row(), index->fHeight);
+        return nullptr;
+    }
+    return index;
+}
+
+std::vector<int> SkPngRowIndex::startRows() const {
+    std::vector<int> starts = {0};
+    for (const AccessPoint& point : fPoints) {
+        const int row = this->pointRow(point);
+        if (row > starts.back()) {
+            starts.push_back(row);
+        }
+    }
+    return starts;
+}
+
+sk_sp<SkData> SkPngRowIndex::makeRegion(int top, int bottom) const {
+    SkASSERT(0 <= top && top < bottom && bottom <= fHeight);
+
+    // The last access point at or above top.
+    size_t pointIndex = fPoints.size();
+    for (size_t i = 0; i < fPoints.size() && this->pointRow(fPoints[i]) <= top; i++) {
+        pointIndex = i;
+    }
+    const AccessPoint* point = pointIndex < fPoints.size() ? &fPoints[pointIndex] : nullptr;
+
+    // Without a point, the stream is inflated from its zlib header; from a point, it is raw
+    // deflate data, and the bits of the byte before the point that follow it are primed.
+    z_stream zstream;
+    memset(&zstream, 0, sizeof(zstream));
+    if ((point ? inflateInit2(&zstream, -MAX_WBITS) : inflateInit(&zstream)) != Z_OK) {
+        return nullptr;
+    }
+    SK_AT_SCOPE_EXIT(inflateEnd(&zstream));
+
+    RowAssembler rows(fRowBytes, fBytesPerPixel);
+    uint64_t streamOffset = 0;
+    if (point) {
+        const uint8_t* pointData = fPointData.data() + pointIndex * this->pointStride();
+        if (point->fBits) {
+            const int byte = this->streamByte(point->fIn - 1);
+            if (inflatePrime(&zstream, point->fBits, byte >> (8 - point->fBits)) != Z_OK) {
+                return nullptr;
+            }
+        }
+        if (inflateSetDictionary(&zstream, pointData, kWindowSize) != Z_OK) {
+            return nullptr;
+        }
+        rows.reset(this->pointRow(*point), pointData + kWindowSize,
+                   pointData + kWindowSize + fRowBytes, point->fOut % (fRowBytes + 1));
+        streamOffset = point->fIn;
+    }
+
+    // The rows of the region, filtered with filter type 0 (none), as the PNG's image data.
+    const size_t regionRowBytes = fRowBytes + 1;
+    std::vector<uint8_t> regionRows(static_cast<size_t>(bottom - top) * regionRowBytes);
+    auto onRow = [&](int row, const uint8_t* unfiltered) {
+        if (row >= top) {
+            uint8_t* dst = regionRows.data() + (row - top) * regionRowBytes;
+            dst[0] = 0;
+            memcpy(dst + 1, unfiltered, fRowBytes);
+        }
+    };
+
+    std::vector<uint8_t> out(kWindowSize);
+    size_t chunkIndex = this->findChunk(streamOffset);
+    while (rows.row() < bottom) {
+        if (!zstream.avail_in) {
+            if (chunkIndex == fIdat.size()) {
+                return nullptr;
+            }
+            const IdatChunk& chunk = fIdat[chunkIndex++];
+            const size_t skip = static_cast<size_t>(
+                    streamOffset > chunk.fStreamOffset ? streamOffset - chunk.fStreamOffset : 0);
+            zstream.next_in = const_cast<Bytef*>(fPng->bytes() + chunk.fOffset + skip);
+            zstream.avail_in = static_cast<uInt>(chunk.fLength - skip);
+            continue;
+        }
+        zstream.next_out = out.data();
+        zstream.avail_out = static_cast<uInt>(out.size());
+        const int ret = inflate(&zstream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            SkCodecPrintf("Could not inflate rows [%d, %d)\n", top, bottom);
+            return nullptr;
+        }
+        if (!rows.consume(out.data(), zstream.next_out - out.data(), bottom, onRow)) {
+            return nullptr;
+        }
+        if (ret == Z_STREAM_END) {
+            break;
+        }
+    }
+    if (rows.row() < bottom) {
+        return nullptr;
+    }
+
+    static constexpr uint8_t kZlibHeader[2] = {0x78, 0x01};
+    const size_t blocks = (regionRows.size() + kMaxStoredBlock - 1) / kMaxStoredBlock;
+    const size_t size = fAncillaryOffset + fAncillaryLength +
+                        (12 + sizeof(kZlibHeader)) +
+                        blocks * (12 + 5) + regionRows.size() +
+                        (12 + 4) +
+                        12;
+    sk_sp<SkData> region = SkData::MakeUninitialized(size);
+    uint8_t* dst = static_cast<uint8_t*>(region->writable_data());
+
+    // The signature and the IHDR of the image, with the region's height.
+    memcpy(dst, fPng->bytes(), fAncillaryOffset);
+    write_u32(dst + 20, static_cast<uint32_t>(bottom - top));
+    write_u32(dst + 29, crc32(crc32(0, nullptr, 0), dst + 12, 4 + 13));
+    memcpy(dst + fAncillaryOffset, fPng->bytes() + fAncillaryOffset, fAncillaryLength);
+    dst += fAncillaryOffset + fAncillaryLength;
+
+    dst = write_chunk(dst, "IDAT", kZlibHeader, sizeof(kZlibHeader), nullptr, 0);
+    uLong adler = adler32(0, nullptr, 0);
+    for (size_t offset = 0; offset < regionRows.size(); offset += kMaxStoredBlock) {
+        const size_t length = std::min(kMaxStoredBlock, regionRows.size() - offset);
+        const uint8_t header[5] = {
+                static_cast<uint8_t>(offset + length == regionRows.size()),  // BFINAL, BTYPE 00
+                static_cast<uint8_t>(length),
+                static_cast<uint8_t>(length >> 8),
+                static_cast<uint8_t>(~length),
+                static_cast<uint8_t>(~length >> 8),
+        };
+        dst = write_chunk(dst, "IDAT", header, sizeof(header),
+                          regionRows.data() + offset, length);
+        adler = adler32(adler, regionRows.data() + offset, static_cast<uInt>(length));
+    }
+    uint8_t trailer[4];
+    write_u32(trailer, static_cast<uint32_t>(adler));
+    dst = write_chunk(dst, "IDAT", trailer, sizeof(trailer), nullptr, 0);
+    dst = write_chunk(dst, "IEND", nullptr, 0, nullptr, 0);
+    SkASSERT(dst == region->bytes() + region->size());
+    return region;
+}
+
+sk_sp<SkData> SkPngRowIndex::serialize() const {
+    SkDynamicMemoryWStream stream;
+    stream.write32(kIndexMagic);
+    stream.write32(kIndexVersion);
+    stream.write32(fWidth);
+    stream.write32(fHeight);
+    stream.write(&fStreamLength, sizeof(fStreamLength));
+    stream.write32(this->streamTail());
+    stream.write32(static_cast<uint32_t>(fPoints.size()));
+    for (const AccessPoint& point : fPoints) {
+        stream.write(&point.fIn, sizeof(point.fIn));
+        stream.write(&point.fOut, sizeof(point.fOut));
+        stream.write32(point.fBits);
+    }
+    stream.write(fPointData.data(), fPointData.size());
+    return stream.detachAsData();
+}
+
+uint32_t SkPngRowIndex::streamTail() const {
+    uint32_t tail = 0;
+    for (uint64_t offset = fStreamLength - 4; offset < fStreamLength; offset++) {
+        tail = (tail << 8) | this->streamByte(offset);
+    }
+    return tail;
+}
+
+std::unique_ptr<SkPngRowIndex> SkPngRowIndex::Deserialize(sk_sp<SkData> png,
+                                                          const SkData& data) {
+    if (!png) {
+        return nullptr;
+    }
+    std::unique_ptr<SkPngRowIndex> index(new SkPngRowIndex(std::move(png)));
+    if (!index->parseChunks()) {
+        return nullptr;
+    }
+
+    // The index must have been made for this image: the same dimensions, and the same image
+    // data, as far as its length and its checksum tell.
+    SkMemoryStream stream(data.data(), data.size());
+    uint32_t magic, version, width, height, tail, count;
+    uint64_t streamLength;
+    if (!stream.readU32(&magic) || magic != kIndexMagic ||
+        !stream.readU32(&version) || version != kIndexVersion ||
+        !stream.readU32(&width) || width != (uint32_t)index->fWidth ||
+        !stream.readU32(&height) || height != (uint32_t)index->fHeight ||
+        stream.read(&streamLength, sizeof(streamLength)) != sizeof(streamLength) ||
+        streamLength != index->fStreamLength ||
+        !stream.readU32(&tail) || tail != index->streamTail() ||
+        !stream.readU32(&count)) {
+        return nullptr;
+    }
+
+    const size_t stride = index->pointStride();
+    const uint64_t rowsLength = (uint64_t)index->fHeight * (index->fRowBytes + 1);
+    if (count > stream.getLength() / stride) {
+        return nullptr;
+    }
+    index->fPoints.resize(count);
+    uint64_t lastOut = 0;
+    for (AccessPoint& point : index->fPoints) {
+        if (stream.read(&point.fIn, sizeof(point.fIn)) != sizeof(point.fIn) ||
+            stream.read(&point.fOut, sizeof(point.fOut)) != sizeof(point.fOut) ||
+            !stream.readU32(&point.fBits) ||
+            point.fIn == 0 || point.fIn >= index->fStreamLength || point.fBits > 7 ||
+            point.fOut <= lastOut || point.fOut >= rowsLength) {
+            return nullptr;
+        }
+        lastOut = point.fOut;
+    }
+    index->fPointData.resize(count * stride);
+    if (stream.read(index->fPointData.data(), index->fPointData.size()) !=
+                index->fPointData.size() ||
+        !stream.isAtEnd()) {
+        return nullptr;
+    }
+    return index;
+}
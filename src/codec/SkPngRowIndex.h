@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPngRowIndex_DEFINED
+#define SkPngRowIndex_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * An index of places in the image data of a non-interlaced PNG that its rows can be decoded
+ * from, without first inflating and unfiltering all of the rows above them.
+ *
+ * The image data of a PNG is one zlib stream of filtered rows, and each row may be filtered
+ * against the one above it. Like zlib's zran example, the index records access points at the
+ * deflate block boundaries that come about every span bytes of the inflated data. Each holds the
+ * 32KB window that the back references after it may reach, the unfiltered row above it, and the
+ * filtered part of its row before it. Making the index inflates and unfilters the whole image;
+ * the index can then be serialized, and kept alongside the PNG.
+ *
+ * Rows are decoded from an index as a PNG of their own, with the ancillary chunks of the image
+ * and the unfiltered rows in stored deflate blocks, which SkPngCodec decodes cheaply.
+ */
+class SkPngRowIndex {
+public:
+    static constexpr size_t kDefaultSpan = 1 << 20;
+
+    /*
+     * Returns nullptr if png is not a non-interlaced PNG whose image data inflates to all of its
+     * rows.
+     */
+    static std::unique_ptr<SkPngRowIndex> Make(sk_sp<SkData> png, size_t span = kDefaultSpan);
+
+    /*
+     * Reads an index written by serialize(). Returns nullptr if index is not one, or if it was
+     * not made for png.
+     */
+    static std::unique_ptr<SkPngRowIndex> Deserialize(sk_sp<SkData> png, const SkData& index);
+
+    sk_sp<SkData> serialize() const;
+
+    int height() const { return fHeight; }
+
+    /*
+     * The rows that decoding can start at without inflating any of the rows above them: 0, and the
+     * rows with access points, in increasing order.
+     */
+    std::vector<int> startRows() const;
+
+    /*
+     * Returns a PNG of rows [top, bottom) of the image, decoded from the last access point at or
+     * above top. Returns nullptr if the image data is corrupt.
+     */
+    sk_sp<SkData> makeRegion(int top, int bottom) const;
+
+private:
+    struct IdatChunk {
+        size_t   fOffset;        // Where the chunk's data is in the PNG.
+        size_t   fLength;
+        uint64_t fStreamOffset;  // Where the chunk's data is in the zlib stream.
+    };
+
+    struct AccessPoint {
+        uint64_t fIn;    // The bytes of the zlib stream before the point.
+        uint64_t fOut;   // The bytes of filtered rows before the point.
+        uint32_t fBits;  // The bits of the byte before fIn that are after the point.
+    };
+
+    SkPngRowIndex(sk_sp<SkData> png) : fPng(std::move(png)) {}
+
+    bool parseChunks();
+    size_t pointStride() const;
+    size_t findChunk(uint64_t streamOffset) const;  // The IDAT chunk the offset is in.
+    uint8_t streamByte(uint64_t streamOffset) const;
+    uint32_t streamTail() const;                     // The Adler-32 that ends the stream.
+    int pointRow(const AccessPoint& point) const {
+        return static_cast<int>(point.fOut / (fRowBytes + 1));
+    }
+
+    sk_sp<SkData>            fPng;
+    int                      fWidth = 0;
+    int                      fHeight = 0;
+    size_t                   fRowBytes = 0;
+    size_t                   fBytesPerPixel = 0;  // The distance filters look back, at least 1.
+    size_t                   fAncillaryOffset = 0;  // The chunks between IHDR and the image data.
+    size_t                   fAncillaryLength = 0;
+    std::vector<IdatChunk>   fIdat;
+    uint64_t                 fStreamLength = 0;
+
+    std::vector<AccessPoint> fPoints;
+    // For each point, its window, the unfiltered row above it, and the filtered start of its row.
+    std::vector<uint8_t>     fPointData;
+};
+
+#endif  // SkPngRowIndex_DEFINED
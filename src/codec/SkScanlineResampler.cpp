@@ -0,0 +1,142 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkScanlineResampler.h"
+
+#include "include/core/SkScalar.h"
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The Mitchell-Netravali family of cubics, nonzero in (-2, 2).
+static float cubic_weight(float x, SkCubicResampler cubic) {
+    const float B = cubic.B,
+                C = cubic.C;
+    x = std::fabs(x);
+    if (x < 1) {
+        return ((12 - 9*B - 6*C) * x*x*x + (-18 + 12*B + 6*C) * x*x + (6 - 2*B)) * (1/6.0f);
+    }
+    if (x < 2) {
+        return ((-B - 6*C) * x*x*x + (6*B + 30*C) * x*x + (-12*B - 48*C) * x + (8*B + 24*C))
+               * (1/6.0f);
+    }
+    return 0;
+}
+
+SkScanlineResampler::Filter::Filter(int srcCount, int dstCount, SkCubicResampler cubic) {
+    SkASSERT(0 < dstCount && dstCount <= srcCount);
+    fFirst.resize(dstCount);
+    if (srcCount == dstCount) {
+        // Cubics that aren't interpolating (B > 0) would blur the image at scale 1.
+        fTaps = 1;
+        fWeights.assign(dstCount, 1.0f);
+        for (int i = 0; i < dstCount; i++) {
+            fFirst[i] = i;
+        }
+        return;
+    }
+
+    // Stretch the filter over the source pixels that each destination pixel covers.
+    const float scale = (float)srcCount / dstCount;
+    const float radius = 2 * scale;
+    fTaps = SkScalarCeilToInt(2 * radius) + 1;
+    fWeights.assign((size_t)dstCount * fTaps, 0.0f);
+    for (int i = 0; i < dstCount; i++) {
+        const float center = (i + 0.5f) * scale;
+        const int first = std::max(0, SkScalarCeilToInt(center - radius - 0.5f));
+        const int last  = std::min(srcCount - 1, SkScalarFloorToInt(center + radius - 0.5f));
+        SkASSERT(last - first < fTaps);
+
+        float* weights = fWeights.data() + (size_t)i * fTaps;
+        float sum = 0;
+        for (int j = first; j <= last; j++) {
+            weights[j - first] = cubic_weight((j + 0.5f - center) / scale, cubic);
+            sum += weights[j - first];
+        }
+        // Renormalize, since the source ends within the filter at the edges.
+        for (int j = first; sum != 0 && j <= last; j++) {
+            weights[j - first] /= sum;
+        }
+        fFirst[i] = first;
+    }
+}
+
+bool SkScanlineResampler::Supports(SkColorType colorType) {
+    switch (colorType) {
+        case kRGBA_8888_SkColorType:
+        case kBGRA_8888_SkColorType:
+        case kRGB_888x_SkColorType:
+            return true;
+        default:
+            return false;
+    }
+}
+
+SkScanlineResampler::SkScanlineResampler(SkISize srcDims, const SkPixmap& dst,
+                                         SkCubicResampler cubic)
+        : fSrcDims(srcDims)
+        , fDst(dst)
+        , fPremul(dst.alphaType() == kPremul_SkAlphaType)
+        , fFilterX(srcDims.width(), dst.width(), cubic)
+        , fFilterY(srcDims.height(), dst.height(), cubic)
+        , fSrcRow(srcDims.width())
+        , fRing((size_t)fFilterY.fTaps * dst.width() * 4) {
+    SkASSERT(Supports(dst.colorType()));
+}
+
+void SkScanlineResampler::pushRow() {
+    SkASSERT(fSrcY < fSrcDims.height());
+    using F = skvx::float4;
+
+    // Filter the row horizontally into the ring.
+    const uint32_t* src = fSrcRow.get();
+    float* ringRow = fRing.get() + (size_t)(fSrcY % fFilterY.fTaps) * fDst.width() * 4;
+    for (int x = 0; x < fDst.width(); x++) {
+        const uint32_t* px = src + fFilterX.fFirst[x];
+        const float* weights = fFilterX.fWeights.data() + (size_t)x * fFilterX.fTaps;
+        const int taps = std::min(fFilterX.fTaps, fSrcDims.width() - fFilterX.fFirst[x]);
+        F sum = 0;
+        for (int t = 0; t < taps; t++) {
+            sum += skvx::cast<float>(skvx::byte4::Load(px + t)) * weights[t];
+        }
+        sum.store(ringRow + 4 * x);
+    }
+
+    // Write every destination row whose source rows have all arrived.
+    while (fDstY < fDst.height()) {
+        const int last = std::min(fFilterY.fFirst[fDstY] + fFilterY.fTaps, fSrcDims.height()) - 1;
+        if (last > fSrcY) {
+            break;
+        }
+        this->writeRow(fDstY++);
+    }
+    fSrcY++;
+}
+
+void SkScanlineResampler::writeRow(int dstY) {
+    using F = skvx::float4;
+    const int first = fFilterY.fFirst[dstY];
+    const int taps = std::min(fFilterY.fTaps, fSrcDims.height() - first);
+    const float* weights = fFilterY.fWeights.data() + (size_t)dstY * fFilterY.fTaps;
+    const size_t ringRowFloats = (size_t)fDst.width() * 4;
+
+    uint32_t* dst = fDst.writable_addr32(0, dstY);
+    for (int x = 0; x < fDst.width(); x++) {
+        F sum = 0;
+        for (int t = 0; t < taps; t++) {
+            const float* ringRow = fRing.get() + ((first + t) % fFilterY.fTaps) * ringRowFloats;
+            sum += F::Load(ringRow + 4 * x) * weights[t];
+        }
+        // Cubics with negative lobes overshoot; keep the result a valid color.
+        sum = skvx::pin(sum + 0.5f, F(0), F(255));
+        if (fPremul) {
+            sum = skvx::min(sum, sum[3]);
+        }
+        skvx::cast<uint8_t>(sum).store(dst + x);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScanlineResampler_DEFINED
+#define SkScanlineResampler_DEFINED
+
+#include "include/core/SkColorType.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSize.h"
+#include "include/private/base/SkNoncopyable.h"
+#include "include/private/base/SkTemplates.h"
+
+#include <vector>
+
+/**
+ *  Downscales an image to a destination pixmap with a separable cubic filter, as its rows are
+ *  decoded from top to bottom. Each source row is filtered horizontally as soon as it arrives,
+ *  and each destination row is written as soon as the last source row it needs has arrived, so
+ *  the scratch memory is a handful of rows rather than the whole source image.
+ *
+ *  Source rows are in the destination's color type and alpha type; they are filtered as they
+ *  come, so premultiplied rows are filtered premultiplied.
+ */
+class SkScanlineResampler : SkNoncopyable {
+public:
+    /**
+     *  Returns true if rows of this color type can be resampled.
+     */
+    static bool Supports(SkColorType);
+
+    /**
+     *  srcDims must be at least as large as dst in both dimensions.
+     */
+    SkScanlineResampler(SkISize srcDims, const SkPixmap& dst, SkCubicResampler);
+
+    /**
+     *  Where to put the next source row, in dst's color type.
+     */
+    void* srcRow() { return fSrcRow.get(); }
+
+    /**
+     *  Filters the row put in srcRow(), and writes out the destination rows it finishes.
+     */
+    void pushRow();
+
+private:
+    // For each destination pixel (or row), the source pixels (or rows) that it is made of, from
+    // fFirst, with fTaps weights each; the weights beyond the edge of the source are zero.
+    struct Filter {
+        Filter(int srcCount, int dstCount, SkCubicResampler);
+
+        int fTaps;
+        std::vector<int>   fFirst;
+        std::vector<float> fWeights;
+    };
+
+    void writeRow(int dstY);
+
+    const SkISize  fSrcDims;
+    const SkPixmap fDst;
+    const bool     fPremul;
+    const Filter   fFilterX;
+    const Filter   fFilterY;
+
+    skia_private::AutoTMalloc<uint32_t> fSrcRow;
+    // fFilterY.fTaps horizontally filtered rows, as 4 floats per destination pixel. Source row y
+    // is row y % fFilterY.fTaps.
+    skia_private::AutoTMalloc<float>    fRing;
+    int fSrcY = 0;
+    int fDstY = 0;
+};
+
+#endif  // SkScanlineResampler_DEFINED
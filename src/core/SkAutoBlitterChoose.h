@@ -11,6 +11,7 @@
 #include "include/private/base/SkMacros.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkBlitter.h"
+#include "src/core/SkBlitterCache.h"
 #include "src/core/SkDrawBase.h"
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkSurfacePriv.h"
@@ -28,6 +29,11 @@ public:
                         bool drawCoverage = false) {
         this->choose(draw, ctm, paint, drawCoverage);
     }
+    ~SkAutoBlitterChoose() {
+        if (fCache) {
+            fCache->release();
+        }
+    }
 
     SkBlitter*  operator->() { return fBlitter; }
     SkBlitter*  get() const { return fBlitter; }
@@ -35,6 +41,12 @@ public:
     SkBlitter* choose(const SkDrawBase& draw, const SkMatrix* ctm,
                       const SkPaint& paint, bool drawCoverage = false) {
         SkASSERT(!fBlitter);
+        if (draw.fBlitterCache) {
+            if ((fBlitter = draw.fBlitterCache->acquire(draw, paint, drawCoverage))) {
+                fCache = draw.fBlitterCache;
+                return fBlitter;
+            }
+        }
         fBlitter = draw.fBlitterChooser(draw.fDst,
                                         ctm ? *ctm : *draw.fCTM,
                                         paint,
@@ -48,6 +60,8 @@ public:
 private:
     // Owned by fAlloc, which will handle the delete.
     SkBlitter* fBlitter = nullptr;
+    // Set if fBlitter was borrowed from the draw's blitter cache rather than built in fAlloc.
+    SkBlitterCache* fCache = nullptr;
 
     SkSTArenaAlloc<kSkBlitterContextSize> fAlloc;
 };
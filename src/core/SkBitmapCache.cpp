@@ -15,12 +15,12 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkTypes.h"
-#include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkMutex.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkNextID.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkResourceCachePool.h"
 #include "src/image/SkImage_Base.h"
 
 #include <cstddef>
@@ -94,7 +94,7 @@ public:
             SkASSERT(fDM->data());
             fDM->unlock();
         }
-        sk_free(fMalloc);   // may be null
+        SkResourceCachePool::Global()->release(fMalloc);   // may be null
     }
 
     const Key& getKey() const override { return fKey; }
@@ -203,7 +203,7 @@ SkBitmapCache::RecPtr SkBitmapCache::Alloc(const SkBitmapCacheDesc& desc, const
     if (factory) {
         dm.reset(factory(size));
     } else {
-        block = sk_malloc_canfail(size);
+        block = SkResourceCachePool::Global()->allocate(size);
     }
     if (!dm && !block) {
         return nullptr;
@@ -136,6 +136,7 @@ public:
         }
 
         fDraw.fProps = &fDevice->surfaceProps();
+        fDraw.fBlitterCache = &fDevice->fBlitterCache;
     }
 
     bool needsTiling() const { return fNeedsTiling; }
@@ -211,6 +212,7 @@ public:
         }
         fCTM = &dev->localToDevice();
         fRC = &dev->fRCStack.rc();
+        fBlitterCache = &dev->fBlitterCache;
     }
 };
 
@@ -292,6 +294,7 @@ void SkBitmapDevice::replaceBitmapBackendForRasterSurface(const SkBitmap& bm) {
     SkASSERT(bm.width() == fBitmap.width());
     SkASSERT(bm.height() == fBitmap.height());
     fBitmap = bm;   // intent is to use bm's pixelRef (and rowbytes/config)
+    fBlitterCache.reset();
     this->privateResize(fBitmap.info().width(), fBitmap.info().height());
 }
 
@@ -14,6 +14,7 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
+#include "src/core/SkBlitterCache.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkGlyphRunPainter.h"
 #include "src/core/SkImageFilterTypes.h"
@@ -169,6 +170,8 @@ private:
     void*       fRasterHandle = nullptr;
     SkRasterClipStack  fRCStack;
     SkGlyphRunListPainterCPU fGlyphPainter;
+    // Lets consecutive draws with the same solid-color paint share one blitter.
+    SkBlitterCache     fBlitterCache;
 
 
     using INHERITED = SkBaseDevice;
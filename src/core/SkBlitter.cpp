@@ -47,6 +47,8 @@ SkBlitter::~SkBlitter() {}
 
 bool SkBlitter::isNullBlitter() const { return false; }
 
+bool SkBlitter::setSolidColor(const SkColor4f&) { return false; }
+
 /*
 void SkBlitter::blitH(int x, int y, int width) {
     SkDEBUGFAIL("unimplemented");
@@ -328,6 +330,9 @@ void SkNullBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {}
 
 bool SkNullBlitter::isNullBlitter() const { return true; }
 
+// Choose() gives up on drawing on the same paths whatever the color.
+bool SkNullBlitter::setSolidColor(const SkColor4f&) { return true; }
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static int compute_anti_width(const int16_t runs[]) {
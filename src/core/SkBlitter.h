@@ -112,6 +112,16 @@ public:
      */
     virtual bool isNullBlitter() const;
 
+    /**
+     *  For a blitter that Choose() built for a paint with no shader or color filter, switches it
+     *  to drawing with color (the paint's unpremul sRGB color), as if it had been built for that
+     *  paint with this color instead. Callers must only pass colors that take the same path
+     *  through Choose(): the same 8-bit alpha being opaque or not, and the same fitsInBytes().
+     *  Returns false, leaving the blitter unchanged, if the new color would still have been drawn
+     *  with a different blitter. Default impl returns false.
+     */
+    virtual bool setSolidColor(const SkColor4f& color);
+
     /**
      * Special methods for blitters that can blit more than one row at a time.
      * This function returns the number of rows that this blitter could optimally
@@ -172,6 +182,7 @@ public:
     void blitRect(int x, int y, int width, int height) override;
     void blitMask(const SkMask&, const SkIRect& clip) override;
     bool isNullBlitter() const override;
+    bool setSolidColor(const SkColor4f&) override;
 };
 
 /** Wraps another (real) blitter, and ensures that the real blitter is only
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkBlitterCache.h"
+
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkSurfacePriv.h"
+
+#include <optional>
+
+extern bool gSkForceRasterPipelineBlitter;
+
+bool SkBlitterCache::Key::operator==(const Key& that) const {
+    return fChooser             == that.fChooser             &&
+           fPixels              == that.fPixels              &&
+           fRowBytes            == that.fRowBytes            &&
+           fInfo                == that.fInfo                &&
+           fOpaque              == that.fOpaque              &&
+           fColorFitsInBytes    == that.fColorFitsInBytes    &&
+           fBlendMode           == that.fBlendMode           &&
+           fPropsFlags          == that.fPropsFlags          &&
+           fDither              == that.fDither              &&
+           fDrawCoverage        == that.fDrawCoverage        &&
+           fForceRasterPipeline == that.fForceRasterPipeline;
+}
+
+SkBlitter* SkBlitterCache::acquire(const SkDrawBase& draw, const SkPaint& paint,
+                                   bool drawCoverage) {
+    std::optional<SkBlendMode> blendMode = paint.asBlendMode();
+    if (!blendMode || paint.getShader() || paint.getColorFilter() || paint.getMaskFilter() ||
+        draw.fRC->clipShader()) {
+        return nullptr;
+    }
+
+    const SkSurfaceProps props = SkSurfacePropsCopyOrDefault(draw.fProps);
+    const Key key = {draw.fBlitterChooser,
+                     draw.fDst.addr(),
+                     draw.fDst.rowBytes(),
+                     draw.fDst.info(),
+                     paint.getAlpha() == 0xFF,
+                     paint.getColor4f().fitsInBytes(),
+                     *blendMode,
+                     props.flags(),
+                     paint.isDither(),
+                     drawCoverage,
+                     gSkForceRasterPipelineBlitter};
+
+    // Clear draws ignore the paint color.
+    const SkColor4f color = *blendMode == SkBlendMode::kClear ? SkColors::kTransparent
+                                                              : paint.getColor4f();
+
+    const bool keyMatches = fBlitter && fKey == key;
+    if (!keyMatches || fColor != color) {
+        if (fUses > 0) {
+            // An enclosing draw is still blitting through the cached blitter.
+            return nullptr;
+        }
+        // setSolidColor() only knows what SkBlitter::Choose() would build.
+        if (!keyMatches || fKey.fChooser != SkBlitter::Choose ||
+            !fBlitter->setSolidColor(color)) {
+            this->reset();
+            // Without a shader the blitter never looks at the matrix, so identity is as good as
+            // any.
+            fBlitter = draw.fBlitterChooser(draw.fDst, SkMatrix::I(), paint, &fAlloc,
+                                            drawCoverage, nullptr, props);
+            if (!fBlitter) {
+                return nullptr;
+            }
+            fKey = key;
+        }
+        fColor = color;
+    }
+    fUses++;
+    return fBlitter;
+}
+
+void SkBlitterCache::reset() {
+    SkASSERT(fUses == 0);
+    fBlitter = nullptr;
+    fAlloc.reset();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlitterCache_DEFINED
+#define SkBlitterCache_DEFINED
+
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/private/base/SkNoncopyable.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkDrawBase.h"
+
+#include <cstddef>
+#include <cstdint>
+
+class SkPaint;
+
+/**
+ *  Holds on to the blitter built for the most recent solid-color paint drawn through a device, so
+ *  a run of draws with similar paints (UI rects, chart bars, ...) blits through one blitter
+ *  instead of building a new one, and re-compiling its pipelines, for every draw. When only the
+ *  color changes, the blitter is switched to the new color with SkBlitter::setSolidColor().
+ *
+ *  Only paints whose blitter cannot depend on the matrix are cached: no shader, color filter or
+ *  mask filter, and a plain blend mode. The cache is single-threaded, like the device owning it.
+ */
+class SkBlitterCache : SkNoncopyable {
+public:
+    SkBlitterCache() = default;
+
+    /**
+     *  Returns a blitter for drawing paint into draw.fDst, reusing the cached one if it was built
+     *  for the same destination and a paint that differs at most in color. Returns nullptr if the
+     *  paint can't be cached, or if the cached blitter is still in use by an enclosing draw and
+     *  doesn't match; the caller should then build its own. Each non-null result must be paired
+     *  with a call to release().
+     */
+    SkBlitter* acquire(const SkDrawBase& draw, const SkPaint& paint, bool drawCoverage);
+    void release() {
+        SkASSERT(fUses > 0);
+        fUses--;
+    }
+
+    /** Drops the cached blitter, e.g. when the device's pixels are replaced. */
+    void reset();
+
+private:
+    struct Key {
+        SkDrawBase::BlitterChooser* fChooser;
+        const void*  fPixels;
+        size_t       fRowBytes;
+        SkImageInfo  fInfo;
+        // What SkBlitter::Choose() decides from the color before building a blitter.
+        bool         fOpaque;
+        bool         fColorFitsInBytes;
+        SkBlendMode  fBlendMode;
+        uint32_t     fPropsFlags;
+        bool         fDither;
+        bool         fDrawCoverage;
+        bool         fForceRasterPipeline;
+
+        bool operator==(const Key&) const;
+    };
+
+    SkSTArenaAllocWithReset<kSkBlitterContextSize> fAlloc;
+    SkBlitter* fBlitter = nullptr;  // owned by fAlloc
+    Key        fKey;
+    SkColor4f  fColor;              // the color fBlitter currently draws with
+    int        fUses = 0;
+};
+
+#endif  // SkBlitterCache_DEFINED
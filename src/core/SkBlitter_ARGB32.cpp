@@ -687,7 +687,10 @@ static void SkARGB32_Blit32(const SkPixmap& device, const SkMask& mask,
 
 SkARGB32_Blitter::SkARGB32_Blitter(const SkPixmap& device, const SkPaint& paint)
         : INHERITED(device) {
-    SkColor color = paint.getColor();
+    this->setColor(paint.getColor());
+}
+
+void SkARGB32_Blitter::setColor(SkColor color) {
     fColor = color;
 
     fSrcA = SkColorGetA(color);
@@ -699,6 +702,30 @@ SkARGB32_Blitter::SkARGB32_Blitter(const SkPixmap& device, const SkPaint& paint)
     fPMColor = SkPackARGB32(fSrcA, fSrcR, fSrcG, fSrcB);
 }
 
+// SkBlitter::Choose() picks between these three blitters by color: opaque black, other opaque
+// colors and translucent colors. Each only takes colors it would have been picked for.
+bool SkARGB32_Blitter::setSolidColor(const SkColor4f& color) {
+    SkColor c = color.toSkColor();
+    if (SkColorGetA(c) == 0xFF) {
+        return false;
+    }
+    this->setColor(c);
+    return true;
+}
+
+bool SkARGB32_Opaque_Blitter::setSolidColor(const SkColor4f& color) {
+    SkColor c = color.toSkColor();
+    if (SkColorGetA(c) != 0xFF || c == SK_ColorBLACK) {
+        return false;
+    }
+    this->setColor(c);
+    return true;
+}
+
+bool SkARGB32_Black_Blitter::setSolidColor(const SkColor4f& color) {
+    return color.toSkColor() == SK_ColorBLACK;
+}
+
 #if defined _WIN32  // disable warning : local variable used without having been initialized
 #pragma warning ( push )
 #pragma warning ( disable : 4701 )
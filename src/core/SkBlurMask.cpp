@@ -114,7 +114,7 @@ void SkMask_FreeImage(uint8_t* image) {
 }
 
 bool SkBlurMask::BoxBlur(SkMaskBuilder* dst, const SkMask& src, SkScalar sigma, SkBlurStyle style,
-                         SkIPoint* margin) {
+                         SkIPoint* margin, SkExecutor* executor) {
     if (src.fFormat != SkMask::kBW_Format &&
         src.fFormat != SkMask::kA8_Format &&
         src.fFormat != SkMask::kARGB32_Format &&
@@ -142,7 +142,7 @@ bool SkBlurMask::BoxBlur(SkMaskBuilder* dst, const SkMask& src, SkScalar sigma,
         }
         return false;
     }
-    const SkIPoint border = blurFilter.blur(src, dst);
+    const SkIPoint border = blurFilter.blur(src, dst, executor);
     // If src.fImage is null, then this call is only to calculate the border.
     if (src.fImage != nullptr && dst->fImage == nullptr) {
         return false;
@@ -14,6 +14,7 @@
 
 #include <cstdint>
 
+class SkExecutor;
 class SkRRect;
 enum SkBlurStyle : int;
 struct SkIPoint;
@@ -40,10 +41,12 @@ public:
     // * calculate margin - if src.fImage is null, then this call only calculates the border.
     // * failure          - if src.fImage is not null, failure is signal with dst->fImage being
     //                      null.
+    // * executor         - if not null, large masks are blurred in bands run in parallel on it.
 
     [[nodiscard]] static bool BoxBlur(SkMaskBuilder* dst, const SkMask& src,
                                       SkScalar sigma, SkBlurStyle style,
-                                      SkIPoint* margin = nullptr);
+                                      SkIPoint* margin = nullptr,
+                                      SkExecutor* executor = nullptr);
 
     // the "ground truth" blur does a gaussian convolution; it's slow
     // but useful for comparison purposes.
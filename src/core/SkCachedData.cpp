@@ -8,6 +8,7 @@
 
 #include "include/private/base/SkMalloc.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
+#include "src/core/SkResourceCachePool.h"
 
 SkCachedData::SkCachedData(void* data, size_t size)
     : fData(data)
@@ -31,11 +32,26 @@ SkCachedData::SkCachedData(size_t size, SkDiscardableMemory* dm)
     fStorage.fDM = dm;
 }
 
+SkCachedData::SkCachedData(size_t size, SkResourceCachePool* pool, void* pooledData)
+    : fData(pooledData)
+    , fSize(size)
+    , fRefCnt(1)
+    , fStorageType(kPool_StorageType)
+    , fInCache(false)
+    , fIsLocked(true)
+{
+    fStorage.fPooled.fPool = pool;
+    fStorage.fPooled.fData = pooledData;
+}
+
 SkCachedData::~SkCachedData() {
     switch (fStorageType) {
         case kMalloc_StorageType:
             sk_free(fStorage.fMalloc);
             break;
+        case kPool_StorageType:
+            fStorage.fPooled.fPool->release(fStorage.fPooled.fData);
+            break;
         case kDiscardableMemory_StorageType:
             delete fStorage.fDM;
             break;
@@ -124,6 +140,9 @@ void SkCachedData::inMutexLock() {
         case kMalloc_StorageType:
             this->setData(fStorage.fMalloc);
             break;
+        case kPool_StorageType:
+            this->setData(fStorage.fPooled.fData);
+            break;
         case kDiscardableMemory_StorageType:
             if (fStorage.fDM->lock()) {
                 void* ptr = fStorage.fDM->data();
@@ -144,6 +163,7 @@ void SkCachedData::inMutexUnlock() {
 
     switch (fStorageType) {
         case kMalloc_StorageType:
+        case kPool_StorageType:
             // nothing to do/check
             break;
         case kDiscardableMemory_StorageType:
@@ -165,6 +185,9 @@ void SkCachedData::validate() const {
             case kMalloc_StorageType:
                 SkASSERT(fData == fStorage.fMalloc);
                 break;
+            case kPool_StorageType:
+                SkASSERT(fData == fStorage.fPooled.fData);
+                break;
             case kDiscardableMemory_StorageType:
                 // fData can be null or the actual value, depending if DM's lock succeeded
                 break;
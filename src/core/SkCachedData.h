@@ -15,11 +15,14 @@
 #include <cstddef>
 
 class SkDiscardableMemory;
+class SkResourceCachePool;
 
 class SkCachedData : ::SkNoncopyable {
 public:
     SkCachedData(void* mallocData, size_t size);
     SkCachedData(size_t size, SkDiscardableMemory*);
+    // Takes ownership of pooledData, which was allocated from pool.
+    SkCachedData(size_t size, SkResourceCachePool* pool, void* pooledData);
     virtual ~SkCachedData();
 
     size_t size() const { return fSize; }
@@ -47,12 +50,17 @@ private:
 
     enum StorageType {
         kDiscardableMemory_StorageType,
-        kMalloc_StorageType
+        kMalloc_StorageType,
+        kPool_StorageType
     };
 
     union {
         SkDiscardableMemory*    fDM;
         void*                   fMalloc;
+        struct {
+            SkResourceCachePool*    fPool;
+            void*                   fData;
+        } fPooled;
     } fStorage;
     void*       fData;
     size_t      fSize;
@@ -73,8 +73,11 @@ public:
     void blitMask(const SkMask&, const SkIRect&) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+    bool setSolidColor(const SkColor4f&) override;
 
 protected:
+    void setColor(SkColor);
+
     SkColor                fColor;
     SkPMColor              fPMColor;
 
@@ -94,6 +97,7 @@ public:
     void blitMask(const SkMask&, const SkIRect&) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+    bool setSolidColor(const SkColor4f&) override;
 
 private:
     using INHERITED = SkARGB32_Blitter;
@@ -106,6 +110,7 @@ public:
     void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]) override;
     void blitAntiH2(int x, int y, U8CPU a0, U8CPU a1) override;
     void blitAntiV2(int x, int y, U8CPU a0, U8CPU a1) override;
+    bool setSolidColor(const SkColor4f&) override;
 
 private:
     using INHERITED = SkARGB32_Opaque_Blitter;
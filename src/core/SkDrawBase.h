@@ -23,6 +23,7 @@ class SkArenaAlloc;
 class SkBaseDevice;
 class SkBitmap;
 class SkBlitter;
+class SkBlitterCache;
 class SkGlyph;
 class SkMaskFilter;
 class SkMatrix;
@@ -153,6 +154,7 @@ public:
     const SkMatrix*         fCTM{nullptr};             // required
     const SkRasterClip*     fRC{nullptr};              // required
     const SkSurfaceProps*   fProps{nullptr};           // optional
+    SkBlitterCache*         fBlitterCache{nullptr};    // optional
 
 #ifdef SK_DEBUG
     void validate() const;
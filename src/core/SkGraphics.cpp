@@ -24,10 +24,13 @@
 #include "src/core/SkCpu.h"
 #include "src/core/SkGeometry.h"
 #include "src/core/SkImageFilter_Base.h"
+#include "src/core/SkMaskBlurFilter.h"
+#include "src/core/SkMipmap.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkTypefaceCache.h"
 
 #include <stdlib.h>
@@ -38,6 +41,8 @@ void SkGraphics::Init() {
     SkOpts::Init();
     SkOpts::Init_BitmapProcState();
     SkOpts::Init_BlitMask();
+    SkOpts::Init_MaskBlurFilter();
+    SkOpts::Init_Mipmap();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -84,6 +89,11 @@ void SkGraphics::PurgeFontCache() {
     SkTypefaceCache::PurgeAll();
 }
 
+bool SkGraphics::SetFontCacheFile(const char path[], size_t byteLimit) {
+    std::unique_ptr<SkStrikeDiskCache> diskCache = SkStrikeDiskCache::Make(path, byteLimit);
+    return diskCache && SkStrikeCache::GlobalStrikeCache()->setDiskCache(std::move(diskCache));
+}
+
 void SkGraphics::PurgePinnedFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgePinned();
 }
@@ -8,7 +8,9 @@
 #include "include/core/SkImageFilter.h"
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkTime.h"
 #include "include/private/base/SkSafe32.h"
 #include "src/core/SkFuzzLogging.h"
 #include "src/core/SkImageFilterCache.h"
@@ -18,10 +20,12 @@
 #include "src/core/SkRectPriv.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkSpecialSurface.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkValidationUtils.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <atomic>
+#include <cmath>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // SkImageFilter - A number of the public APIs on SkImageFilter downcast to SkImageFilter_Base
@@ -236,12 +240,30 @@ skif::FilterResult SkImageFilter_Base::filterImage(const skif::Context& context)
     const SkIRect srcSubset = fUsesSrcInput ? context.sourceImage()->subset()
                                             : SkIRect::MakeWH(0, 0);
 
-    SkImageFilterCacheKey key(fUniqueID, context.mapping().layerMatrix(), context.clipBounds(),
-                              srcGenID, srcSubset);
+    // A filter that doesn't read the source produces the same pixels, shifted, when the layer
+    // matrix is shifted by whole pixels. Its results are cached relative to the integer part of the
+    // translation, so they are reused as the content scrolls.
+    SkMatrix layerMatrix = context.mapping().layerMatrix();
+    SkIRect clipBounds = context.clipBounds();
+    skif::LayerSpace<skif::IVector> offset({0, 0});
+    if (!fUsesSrcInput && !layerMatrix.hasPerspective()) {
+        const float tx = sk_float_floor(layerMatrix.getTranslateX()),
+                    ty = sk_float_floor(layerMatrix.getTranslateY());
+        // Every integer within +/-2^24 is a float, so splitting off the offset is exact.
+        constexpr float kMaxOffset = 1 << 24;
+        if (std::abs(tx) < kMaxOffset && std::abs(ty) < kMaxOffset) {
+            offset = skif::LayerSpace<skif::IVector>({(int32_t)tx, (int32_t)ty});
+            layerMatrix.postTranslate(-tx, -ty);
+            clipBounds.offset(-offset.x(), -offset.y());
+        }
+    }
+
+    SkImageFilterCacheKey key(fUniqueID, layerMatrix, clipBounds, srcGenID, srcSubset);
     if (context.cache() && context.cache()->get(key, &result)) {
-        return result;
+        return result.applyOffset(offset);
     }
 
+    const double start = context.cache() ? SkTime::GetNSecs() : 0;
     result = this->onFilterImage(context);
 
     if (context.gpuBacked()) {
@@ -249,7 +271,7 @@ skif::FilterResult SkImageFilter_Base::filterImage(const skif::Context& context)
     }
 
     if (context.cache()) {
-        context.cache()->set(key, this, result);
+        context.cache()->set(key, this, result.applyOffset(-offset), SkTime::GetNSecs() - start);
     }
 
     return result;
@@ -540,6 +562,64 @@ skif::FilterResult SkImageFilter_Base::getChildOutput(int index, const skif::Con
     return input ? as_IFB(input)->filterImage(ctx) : ctx.source();
 }
 
+void SkImageFilter_Base::getChildOutputs(const skif::Context& ctx,
+                                         SkSpan<skif::FilterResult> outputs) const {
+    SkASSERT(outputs.size() <= (size_t)this->countInputs());
+    const int count = SkToInt(outputs.size());
+
+    // A branch is a non-null child filter that no earlier child shares; null children just return
+    // the source, and shared children are evaluated once and copied.
+    skia_private::STArray<4, int> firstUse;
+    skia_private::STArray<4, int> branches;
+    for (int i = 0; i < count; ++i) {
+        const SkImageFilter* child = this->getInput(i);
+        int first = i;
+        for (int j = 0; child && j < i; ++j) {
+            if (this->getInput(j) == child) {
+                first = j;
+                break;
+            }
+        }
+        firstUse.push_back(first);
+        if (child && first == i) {
+            branches.push_back(i);
+        }
+    }
+
+    auto evalChild = [&](int i) {
+        skif::LayerSpace<SkIRect> desiredOutput = ctx.desiredOutput();
+        if (!desiredOutput.intersect(this->getChildOutputLayerBounds(
+                    i, ctx.mapping(), ctx.source().layerBounds()))) {
+            outputs[i] = {};
+            return;
+        }
+        outputs[i] = this->getChildOutput(i, ctx.withNewDesiredOutput(desiredOutput));
+    };
+
+    SkExecutor* executor = ctx.executor();
+    if (executor && branches.size() > 1) {
+        // The calling thread evaluates the first branch, then helps with the rest while waiting.
+        SkTaskGroup tasks{*executor};
+        for (int b = 1; b < branches.size(); ++b) {
+            tasks.add([&evalChild, i = branches[b]] { evalChild(i); });
+        }
+        evalChild(branches[0]);
+        tasks.wait();
+    } else {
+        for (int i : branches) {
+            evalChild(i);
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (firstUse[i] != i) {
+            outputs[i] = outputs[firstUse[i]];
+        } else if (!this->getInput(i)) {
+            evalChild(i);
+        }
+    }
+}
+
 sk_sp<SkSpecialImage> SkImageFilter_Base::filterInput(int index,
                                                       const skif::Context& ctx,
                                                       SkIPoint* offset) const {
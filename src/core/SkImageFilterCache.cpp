@@ -7,13 +7,14 @@
 
 #include "src/core/SkImageFilterCache.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkRefCnt.h"
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkOnce.h"
-#include "src/base/SkTInternalLList.h"
+#include "src/base/SkTDPQueue.h"
 #include "src/core/SkChecksum.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkTDynamicHash.h"
@@ -38,30 +39,52 @@ public:
     }
     struct Value {
         Value(const Key& key, const skif::FilterResult& image,
-              const SkImageFilter* filter)
-            : fKey(key), fImage(image), fFilter(filter) {}
+              const SkImageFilter* filter, double recomputeCost)
+            : fKey(key), fImage(image), fFilter(filter), fRecomputeCost(recomputeCost) {}
 
         Key fKey;
         skif::FilterResult fImage;
         const SkImageFilter* fFilter;
+        double fRecomputeCost;
+        // Eviction takes the lowest fPriority first, breaking ties by least recent use.
+        double fPriority = 0;
+        uint64_t fLastUse = 0;
+        int fQueueIndex = -1;
+
+        size_t bytes() const { return fImage.image() ? fImage.image()->getSize() : 0; }
         static const Key& GetKey(const Value& v) {
             return v.fKey;
         }
         static uint32_t Hash(const Key& key) {
             return SkChecksum::Hash32(&key, sizeof(Key));
         }
-        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Value);
+        static bool Less(Value* const& a, Value* const& b) {
+            return a->fPriority < b->fPriority ||
+                   (a->fPriority == b->fPriority && a->fLastUse < b->fLastUse);
+        }
+        static int* Index(Value* const& v) { return &v->fQueueIndex; }
     };
 
     bool get(const Key& key, skif::FilterResult* result) const override {
         SkASSERT(result);
 
         SkAutoMutexExclusive mutex(fMutex);
-        if (Value* v = fLookup.find(key)) {
-            if (v != fLRU.head()) {
-                fLRU.remove(v);
-                fLRU.addToHead(v);
+        Value* v = fLookup.find(key);
+        if (!v) {
+            // Look for a result that covers more than the requested bounds.
+            if (auto* values = fRegionValues.find(RegionHash(key))) {
+                for (Value* candidate : *values) {
+                    if (SameRegion(candidate->fKey, key) &&
+                        candidate->fKey.fClipBounds.contains(key.fClipBounds)) {
+                        v = candidate;
+                        break;
+                    }
+                }
             }
+        }
+        if (v) {
+            this->touch(v);
+            fQueue.priorityDidChange(v);
 
             *result = v->fImage;
             return true;
@@ -70,38 +93,59 @@ public:
     }
 
     void set(const Key& key, const SkImageFilter* filter,
-             const skif::FilterResult& result) override {
+             const skif::FilterResult& result, double recomputeCost) override {
         SkAutoMutexExclusive mutex(fMutex);
         if (Value* v = fLookup.find(key)) {
             this->removeInternal(v);
         }
-        Value* v = new Value(key, result, filter);
+        // Results for bounds that this one covers are no longer needed.
+        const uint32_t regionHash = RegionHash(key);
+        if (auto* values = fRegionValues.find(regionHash)) {
+            std::vector<Value*> covered;
+            for (Value* v : *values) {
+                if (SameRegion(v->fKey, key) && key.fClipBounds.contains(v->fKey.fClipBounds)) {
+                    covered.push_back(v);
+                }
+            }
+            for (Value* v : covered) {
+                this->removeInternal(v);
+            }
+        }
+
+        Value* v = new Value(key, result, filter, recomputeCost);
         fLookup.add(v);
-        fLRU.addToHead(v);
-        fCurrentBytes += result.image() ? result.image()->getSize() : 0;
+        this->touch(v);
+        fQueue.insert(v);
+        fCurrentBytes += v->bytes();
         if (auto* values = fImageFilterValues.find(filter)) {
             values->push_back(v);
         } else {
             fImageFilterValues.set(filter, {v});
         }
+        if (auto* values = fRegionValues.find(regionHash)) {
+            values->push_back(v);
+        } else {
+            fRegionValues.set(regionHash, {v});
+        }
 
         while (fCurrentBytes > fMaxBytes) {
-            Value* tail = fLRU.tail();
-            SkASSERT(tail);
-            if (tail == v) {
+            Value* victim = fQueue.peek();
+            if (victim == v) {
                 break;
             }
-            this->removeInternal(tail);
+            // Age the survivors by the evicted priority, so that cost per byte alone doesn't
+            // keep a result around forever (GreedyDual-Size).
+            fInflation = victim->fPriority;
+            this->removeInternal(victim);
         }
     }
 
     void purge() override {
         SkAutoMutexExclusive mutex(fMutex);
-        while (fCurrentBytes > 0) {
-            Value* tail = fLRU.tail();
-            SkASSERT(tail);
-            this->removeInternal(tail);
+        while (fQueue.count() > 0) {
+            this->removeInternal(fQueue.peek());
         }
+        fInflation = 0;
     }
 
     void purgeByImageFilter(const SkImageFilter* filter) override {
@@ -121,33 +165,67 @@ public:
 
     SkDEBUGCODE(int count() const override { return fLookup.count(); })
 private:
+    // Keys that differ at most in their clip bounds share a region hash.
+    static uint32_t RegionHash(const Key& key) {
+        Key region = key;
+        region.fClipBounds = SkIRect::MakeEmpty();
+        return Value::Hash(region);
+    }
+    static bool SameRegion(const Key& a, const Key& b) {
+        Key regionA = a, regionB = b;
+        regionA.fClipBounds = regionB.fClipBounds = SkIRect::MakeEmpty();
+        return regionA == regionB;
+    }
+
+    void touch(Value* v) const {
+        v->fPriority = fInflation + v->fRecomputeCost / std::max<size_t>(v->bytes(), 1);
+        v->fLastUse = fUseCounter++;
+    }
+
+    static void RemoveFrom(std::vector<Value*>* values, Value* v) {
+        for (auto it = values->begin(); it != values->end(); ++it) {
+            if (*it == v) {
+                values->erase(it);
+                break;
+            }
+        }
+    }
+
     void removeInternal(Value* v) {
         if (v->fFilter) {
             if (auto* values = fImageFilterValues.find(v->fFilter)) {
                 if (values->size() == 1 && (*values)[0] == v) {
                     fImageFilterValues.remove(v->fFilter);
                 } else {
-                    for (auto it = values->begin(); it != values->end(); ++it) {
-                        if (*it == v) {
-                            values->erase(it);
-                            break;
-                        }
-                    }
+                    RemoveFrom(values, v);
                 }
             }
         }
-        fCurrentBytes -= v->fImage.image() ? v->fImage.image()->getSize() : 0;
-        fLRU.remove(v);
+        const uint32_t regionHash = RegionHash(v->fKey);
+        if (auto* values = fRegionValues.find(regionHash)) {
+            if (values->size() == 1 && (*values)[0] == v) {
+                fRegionValues.remove(regionHash);
+            } else {
+                RemoveFrom(values, v);
+            }
+        }
+        fCurrentBytes -= v->bytes();
+        fQueue.remove(v);
         fLookup.remove(v->fKey);
         delete v;
     }
 private:
+    using Queue = SkTDPQueue<Value*, Value::Less, Value::Index>;
+
     SkTDynamicHash<Value, Key>                          fLookup;
-    mutable SkTInternalLList<Value>                     fLRU;
+    mutable Queue                                       fQueue;
     // Value* always points to an item in fLookup.
     THashMap<const SkImageFilter*, std::vector<Value*>> fImageFilterValues;
+    THashMap<uint32_t, std::vector<Value*>>             fRegionValues;
     size_t                                              fMaxBytes;
     size_t                                              fCurrentBytes;
+    double                                              fInflation = 0;
+    mutable uint64_t                                    fUseCounter = 0;
     mutable SkMutex                                     fMutex;
 };
 
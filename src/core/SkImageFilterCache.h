@@ -49,6 +49,10 @@ struct SkImageFilterCacheKey {
 // This cache maps from (filter's unique ID + CTM + clipBounds + src bitmap generation ID) to result
 // NOTE: this is the _specific_ unique ID of the image filter, so refiltering the same image with a
 // copy of the image filter (with exactly the same parameters) will not yield a cache hit.
+//
+// A result cached for larger clipBounds, with the rest of the key the same, also satisfies a
+// request, since it covers the requested bounds. Eviction is weighted by the cost of recomputing
+// each result relative to its size, so that expensive subgraphs outlive cheap, large ones.
 class SkImageFilterCache : public SkRefCnt {
 public:
     enum { kDefaultTransientSize = 32 * 1024 * 1024 };
@@ -58,13 +62,15 @@ public:
     static SkImageFilterCache* Get();
 
     // Returns true on cache hit and updates 'result' to be the cached result. Returns false when
-    // not in the cache, in which case 'result' is not modified.
+    // not in the cache, in which case 'result' is not modified. The cached result may cover more
+    // than the key's clipBounds.
     virtual bool get(const SkImageFilterCacheKey& key,
                      skif::FilterResult* result) const = 0;
     // 'filter' is included in the caching to allow the purging of all of an image filter's cached
-    // results when it is destroyed.
+    // results when it is destroyed. 'recomputeCost' is the time it took to compute 'result', in
+    // nanoseconds. Results with the same cost per byte are evicted in LRU order.
     virtual void set(const SkImageFilterCacheKey& key, const SkImageFilter* filter,
-                     const skif::FilterResult& result) = 0;
+                     const skif::FilterResult& result, double recomputeCost = 0) = 0;
     virtual void purge() = 0;
     virtual void purgeByImageFilter(const SkImageFilter*) = 0;
     SkDEBUGCODE(virtual int count() const = 0;)
@@ -12,16 +12,19 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"  // IWYU pragma: keep
+#include "include/core/SkPixmap.h"
 #include "include/core/SkShader.h"
 #include "include/private/base/SkFloatingPoint.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkMatrixPriv.h"
 #include "src/core/SkRectPriv.h"
 #include "src/core/SkSpecialSurface.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/effects/colorfilters/SkColorFilterBase.h"
 
 #ifdef SK_ENABLE_SKSL
@@ -30,6 +33,7 @@
 #endif
 
 #include <algorithm>
+#include <memory>
 
 namespace skif {
 
@@ -808,6 +812,14 @@ FilterResult FilterResult::applyCrop(const Context& ctx,
     }
 }
 
+FilterResult FilterResult::applyOffset(const LayerSpace<IVector>& offset) const {
+    FilterResult offsetResult = *this;
+    offsetResult.fTransform.postConcat(
+            LayerSpace<SkMatrix>(SkMatrix::Translate(offset.x(), offset.y())));
+    offsetResult.fLayerBounds.offset(offset);
+    return offsetResult;
+}
+
 FilterResult FilterResult::applyColorFilter(const Context& ctx,
                                             sk_sp<SkColorFilter> colorFilter) const {
     static const LayerSpace<SkMatrix> kIdentity{SkMatrix::I()};
@@ -1260,6 +1272,23 @@ SkSpan<sk_sp<SkShader>> FilterResult::Builder::createInputShaders(
     return SkSpan<sk_sp<SkShader>>(fInputShaders);
 }
 
+bool FilterResult::Builder::shadesWithIntegerTranslation(bool evaluateInParameterSpace) const {
+    auto isIntegerTranslation = [](const SkMatrix& m) {
+        return m.isTranslate() && SkScalarIsInt(m.getTranslateX()) &&
+               SkScalarIsInt(m.getTranslateY());
+    };
+    if (evaluateInParameterSpace ||
+        !isIntegerTranslation(fContext.mapping().layerMatrix())) {
+        return false;
+    }
+    for (const SampledFilterResult& input : fInputs) {
+        if (!isIntegerTranslation(static_cast<const SkMatrix&>(input.fImage.fTransform))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 LayerSpace<SkIRect> FilterResult::Builder::outputBounds(
         std::optional<LayerSpace<SkIRect>> explicitOutput) const {
     // Pessimistically assume output fills the full desired bounds
@@ -1285,7 +1314,37 @@ FilterResult FilterResult::Builder::drawShader(sk_sp<SkShader> shader,
     if (surface) {
         SkPaint paint;
         paint.setShader(std::move(shader));
-        surface->drawPaint(paint);
+
+        // On the CPU, large outputs can be split into bands of rows that are shaded in parallel,
+        // but only when the caller gave the context an executor to do so. Each band is drawn with
+        // the same matrix as a single draw, clipped to its rows, and only when that matrix and the
+        // inputs' transforms are integer translations, so every pixel is shaded at exactly the
+        // coordinates a single draw would use. Otherwise the output is drawn all at once.
+        static constexpr int kBandRows = 64;
+        SkExecutor* executor = fContext.executor();
+        SkPixmap pixels;
+        if (executor && outputBounds.height() >= 2 * kBandRows &&
+            this->shadesWithIntegerTranslation(evaluateInParameterSpace) &&
+            surface->peekPixels(&pixels)) {
+            const SkSurfaceProps props = surface->getBaseProps();
+            const int bands = (outputBounds.height() + kBandRows - 1) / kBandRows;
+            SkTaskGroup tasks{*executor};
+            tasks.batch(bands, [&](int i) {
+                const int y0 = i * kBandRows,
+                          y1 = std::min(y0 + kBandRows, outputBounds.height());
+                std::unique_ptr<SkCanvas> band = SkCanvas::MakeRasterDirect(
+                        pixels.info().makeWH(outputBounds.width(), outputBounds.height()),
+                        pixels.writable_addr(), pixels.rowBytes(), &props);
+                if (band) {
+                    band->clipIRect(SkIRect::MakeLTRB(0, y0, outputBounds.width(), y1));
+                    band->translate(-outputBounds.left(), -outputBounds.top());
+                    band->drawPaint(paint);
+                }
+            });
+            tasks.wait();
+        } else {
+            surface->drawPaint(paint);
+        }
     }
     return surface.snap();
 }
@@ -36,6 +36,7 @@ class FilterResultImageResolver;  // for testing
 class GrRecordingContext;
 class SkBitmap;
 class SkCanvas;
+class SkExecutor;
 class SkImage;
 class SkImageFilter;
 class SkImageFilterCache;
@@ -754,6 +755,11 @@ public:
                                 const LayerSpace<SkMatrix>& transform,
                                 const SkSamplingOptions& sampling) const;
 
+    // Produce a new FilterResult that is this FilterResult translated by an integer offset. Unlike
+    // applyTransform(), this only adjusts the metadata and doesn't restrict the result to a desired
+    // output, so it can move a result between layer spaces that differ by 'offset'.
+    FilterResult applyOffset(const LayerSpace<IVector>& offset) const;
+
     // Produce a new FilterResult that is visually equivalent to the output of the SkColorFilter
     // evaluating this FilterResult. If the color filter affects transparent black, the returned
     // FilterResult can become non-empty even if the input were empty.
@@ -921,6 +927,11 @@ private:
 
     LayerSpace<SkIRect> outputBounds(std::optional<LayerSpace<SkIRect>> explicitOutput) const;
 
+    // True if the layer matrix and the transforms of every input are integer translations, so the
+    // shader created in eval() maps each output pixel to the same coordinates however its draw is
+    // split up.
+    bool shadesWithIntegerTranslation(bool evaluateInParameterSpace) const;
+
     FilterResult drawShader(sk_sp<SkShader> shader,
                             const LayerSpace<SkIRect>& outputBounds,
                             bool evaluateInParameterSpace) const;
@@ -951,6 +962,8 @@ struct ContextInfo {
     SkSurfaceProps      fSurfaceProps;
 
     SkImageFilterCache* fCache;
+    // When set, CPU filtering may evaluate independent branches of the DAG on this executor.
+    SkExecutor*         fExecutor = nullptr;
 };
 
 class Context {
@@ -979,6 +992,10 @@ public:
     // The cache to use when recursing through the filter DAG, in order to avoid repeated
     // calculations of the same image.
     SkImageFilterCache* cache() const { return fInfo.fCache; }
+    // The executor to evaluate independent child filters on in parallel, or null if they must be
+    // evaluated in order on the calling thread. Only raster contexts whose ContextInfo supplied one
+    // have an executor; GPU-backed filtering is never split across threads.
+    SkExecutor* executor() const { return this->gpuBacked() ? nullptr : fInfo.fExecutor; }
     // The output device's color type, which can be used for intermediate images to be
     // compatible with the eventual target of the filtered result.
     SkColorType colorType() const { return fInfo.fColorType; }
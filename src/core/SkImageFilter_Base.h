@@ -246,6 +246,13 @@ protected:
     // `withNewDesiredOutput`.
     skif::FilterResult getChildOutput(int index, const skif::Context& ctx) const;
 
+    // Evaluates the first 'outputs.size()' child filters into 'outputs'. Each child is only asked
+    // for the part of the context's desired output that it can cover given the source content, so
+    // branches that can't reach the desired output are skipped. When the context has an executor,
+    // independent branches are evaluated on it in parallel; a filter that is the input of more than
+    // one branch is still only evaluated once.
+    void getChildOutputs(const skif::Context& ctx, SkSpan<skif::FilterResult> outputs) const;
+
     /**
      *  Returns whether any edges of the crop rect have been set. The crop
      *  rect is set at construction time, and determines which pixels from the
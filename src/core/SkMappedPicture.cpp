@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkMappedPicture.h"
+
+#include "include/core/SkData.h"
+#include "src/core/SkPictureFlat.h"
+#include "src/core/SkPicturePlayback.h"
+#include "src/core/SkReadBuffer.h"
+
+#include <utility>
+
+// Counts the ops in the op data by their headers, without playing them back.
+static int count_ops(const SkData& opData) {
+    SkReadBuffer reader(opData.data(), opData.size());
+    int count = 0;
+    while (!reader.eof() && reader.isValid()) {
+        const size_t start = reader.offset();
+        const uint32_t bits = reader.readUInt();
+        const uint32_t op = bits >> 24;
+        size_t size = bits & 0xffffff;
+        if (size == 0xffffff) {
+            // SkPictureRecord::addDraw() adds one to the size of an op that needs this extra
+            // word, rather than the four bytes that the word takes.
+            size = reader.readUInt();
+            size = size > 0 ? size - 1 + sizeof(uint32_t) : 0;
+        }
+        if (!reader.validate(size >= reader.offset() - start && op > UNUSED &&
+                             op <= LAST_DRAWTYPE_ENUM)) {
+            break;
+        }
+        reader.skip(size - (reader.offset() - start));
+        count++;
+    }
+    return count;
+}
+
+sk_sp<SkPicture> SkMappedPicture::Make(const SkPictInfo& info,
+                                       std::unique_ptr<SkPictureData> data) {
+    if (!data || !data->opData()) {
+        return nullptr;
+    }
+    return sk_sp<SkPicture>(new SkMappedPicture(info.fCullRect, std::move(data)));
+}
+
+SkMappedPicture::SkMappedPicture(const SkRect& cull, std::unique_ptr<SkPictureData> data)
+        : fCullRect(cull)
+        , fData(std::move(data)) {}
+
+void SkMappedPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    SkPicturePlayback playback(fData.get());
+    playback.draw(canvas, callback, nullptr);
+}
+
+int SkMappedPicture::approximateOpCount(bool nested) const {
+    fOpCountOnce([this] { fOpCount = count_ops(*fData->opData()); });
+    int count = fOpCount;
+    if (nested) {
+        for (const sk_sp<const SkPicture>& picture : fData->pictures()) {
+            count += picture->approximateOpCount(true);
+        }
+    }
+    return count;
+}
+
+size_t SkMappedPicture::approximateBytesUsed() const {
+    // The op data is mostly mapped, rather than allocated, memory; count it like SkBigPicture
+    // counts its SkRecord.
+    size_t bytes = sizeof(*this) + fData->opData()->size();
+    for (const sk_sp<const SkPicture>& picture : fData->pictures()) {
+        bytes += picture->approximateBytesUsed();
+    }
+    return bytes;
+}
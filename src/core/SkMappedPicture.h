@@ -0,0 +1,48 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMappedPicture_DEFINED
+#define SkMappedPicture_DEFINED
+
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkOnce.h"
+#include "src/core/SkPictureData.h"
+
+#include <cstddef>
+#include <memory>
+
+class SkCanvas;
+
+// An SkPicture made by SkPicture::MakeFromMappedData(). Rather than being recorded again into an
+// SkRecord, it plays back straight from its deserialized SkPictureData, whose op data refers to
+// the mapped SKP in place.
+class SkMappedPicture final : public SkPicture {
+public:
+    static sk_sp<SkPicture> Make(const SkPictInfo&, std::unique_ptr<SkPictureData>);
+
+// SkPicture overrides
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override { return fCullRect; }
+    int approximateOpCount(bool nested) const override;
+    size_t approximateBytesUsed() const override;
+
+    const SkPictureData& data() const { return *fData; }
+
+private:
+    SkMappedPicture(const SkRect& cull, std::unique_ptr<SkPictureData>);
+
+    const SkRect                               fCullRect;
+    const std::unique_ptr<const SkPictureData> fData;
+
+    // Counting the ops touches every page of the op data, so it waits until it's asked for.
+    mutable SkOnce fOpCountOnce;
+    mutable int    fOpCount = 0;
+};
+
+#endif  // SkMappedPicture_DEFINED
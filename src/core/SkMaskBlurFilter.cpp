@@ -8,6 +8,7 @@
 #include "src/core/SkMaskBlurFilter.h"
 
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkExecutor.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTPin.h"
 #include "include/private/base/SkTemplates.h"
@@ -15,9 +16,13 @@
 #include "src/base/SkArenaAlloc.h"
 #include "src/base/SkVx.h"
 #include "src/core/SkGaussFilter.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <cmath>
 #include <climits>
+#include <cstring>
+#include <functional>
+#include <type_traits>
 
 namespace {
 static const double kPi = 3.14159265358979323846264338327950288;
@@ -195,6 +200,25 @@ public:
             }
         }
 
+        // The vectorized scan needs every pass to have a trailing edge buffer. That is always
+        // the case for the windows SkMaskBlurFilter uses this plan for, but not for a window of 1.
+        bool canBlurLanes() const {
+            return fBuffer0 < fBuffer0End && fBuffer1 < fBuffer1End && fBuffer2 < fBuffer2End;
+        }
+
+        // Blurs several A8 rows at once, storing them transposed like blur() does. See
+        // SkOpts::mask_blur_rows.
+        void blurRows(const uint8_t* src, size_t srcRB, int rows, int srcCount,
+                      uint8_t* dst, size_t dstStride, int dstCount, uint32_t* laneBuffer) const {
+            const int passSizes[3] = {SkToInt(fBuffer0End - fBuffer0),
+                                      SkToInt(fBuffer1End - fBuffer1),
+                                      SkToInt(fBuffer2End - fBuffer2)};
+            // Every pass having a buffer means the window is at least 2, so the weight is < 2^32.
+            SkOpts::mask_blur_rows(src, srcRB, rows, srcCount, fNoChangeCount,
+                                   SkTo<uint32_t>(fWeight), passSizes, laneBuffer,
+                                   dst, dstStride, dstCount);
+        }
+
     private:
         inline static constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
 
@@ -950,9 +974,74 @@ static SkIPoint small_blur(double sigmaX, double sigmaY, const SkMask& src, SkMa
     return {radiusX, radiusY};
 }
 
+// Blurs rows [y0, y1) of a mask whose row y0 spans [start, end), storing each row transposed:
+// output i of row y goes to dst[y + i * dstStride].
+template <typename AlphaIter>
+static void blur_rows_transposed(const PlanGauss& plan, AlphaIter start, AlphaIter end,
+                                 uint32_t srcRB, int srcCount, int y0, int y1,
+                                 uint8_t* dst, size_t dstStride, int dstCount) {
+    constexpr int N = SkMaskBlurFilter::kMaxLanes;
+
+    // Bands of rows may run concurrently, so each one gets its own buffers.
+    size_t scalarSize = std::max<size_t>(plan.bufferSize(), 1);
+    skia_private::AutoTMalloc<uint32_t> buffer(scalarSize + plan.bufferSize() * N);
+    const PlanGauss::Scan& scan = plan.makeBlurScan(srcCount, buffer.get());
+
+    if (!scan.canBlurLanes()) {
+        for (int y = y0; y < y1; ++y, start >>= srcRB, end >>= srcRB) {
+            auto dstStart = dst + y;
+            scan.blur(start, end, dstStart, dstStride, dstStart + dstStride * dstCount);
+        }
+        return;
+    }
+
+    uint32_t* laneBuffer = buffer.get() + scalarSize;
+    if constexpr (std::is_same_v<AlphaIter, SkMask::AlphaIter<SkMask::kA8_Format>>) {
+        scan.blurRows(start.fPtr, srcRB, y1 - y0, srcCount,
+                      dst + y0, dstStride, dstCount, laneBuffer);
+    } else {
+        // Convert the other formats to A8 a few rows at a time.
+        skia_private::AutoTMalloc<uint8_t> a8(SkToSizeT(srcCount) * N);
+        for (int y = y0; y < y1; y += N) {
+            int rows = std::min(N, y1 - y);
+            for (int r = 0; r < rows; ++r, start >>= srcRB) {
+                AlphaIter src = start;
+                uint8_t* a8Row = a8.get() + r * srcCount;
+                for (int i = 0; i < srcCount; ++i, ++src) {
+                    a8Row[i] = *src;
+                }
+            }
+            scan.blurRows(a8.get(), srcCount, rows, srcCount,
+                          dst + y, dstStride, dstCount, laneBuffer);
+        }
+    }
+}
+
+// Calls blurRows() over [0, rows), split into bands run in parallel on executor when there is
+// enough work to be worth it. Bands start on multiples of SkMaskBlurFilter::kMaxLanes.
+static void for_each_band(SkExecutor* executor, int rows, int width,
+                          const std::function<void(int, int)>& blurRows) {
+    constexpr int N = SkMaskBlurFilter::kMaxLanes;
+    int bandRows = std::max(1, (64 * 1024) / std::max(1, width));
+    bandRows = (bandRows + N - 1) / N * N;
+
+    if (!executor || rows < 2 * bandRows) {
+        blurRows(0, rows);
+        return;
+    }
+
+    SkTaskGroup tasks(*executor);
+    tasks.batch((rows + bandRows - 1) / bandRows, [&](int band) {
+        int y0 = band * bandRows;
+        blurRows(y0, std::min(rows, y0 + bandRows));
+    });
+    tasks.wait();
+}
+
 // TODO: assuming sigmaW = sigmaH. Allow different sigmas. Right now the
 // API forces the sigmas to be the same.
-SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMaskBuilder* dst) const {
+SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMaskBuilder* dst,
+                                SkExecutor* executor) const {
 
     if (fSigmaW < 2.0 && fSigmaH < 2.0) {
         return small_blur(fSigmaW, fSigmaH, src, dst);
@@ -983,9 +1072,6 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMaskBuilder* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
-
     // Blur both directions.
     int tmpW = srcH,
         tmpH = dstW;
@@ -997,58 +1083,51 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMaskBuilder* dst) const {
     auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
 
     // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
-    switch (src.fFormat) {
-        case SkMask::kBW_Format: {
-            const uint8_t* bwStart = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
-            auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kA8_Format: {
-            const uint8_t* a8Start = src.fImage;
-            auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
-            auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kARGB32_Format: {
-            const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
-            auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        case SkMask::kLCD16_Format: {
-            const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
-            auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
-            auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
-        } break;
-        default:
-            SK_ABORT("Unhandled format.");
-    }
+    for_each_band(executor, srcH, srcW, [&](int y0, int y1) {
+        const void* row = SkTAddOffset<const void>(src.fImage, SkToSizeT(y0) * src.fRowBytes);
+        switch (src.fFormat) {
+            case SkMask::kBW_Format: {
+                const uint8_t* bwStart = static_cast<const uint8_t*>(row);
+                auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
+                auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
+                blur_rows_transposed(planW, start, end, src.fRowBytes, srcW, y0, y1,
+                                     tmp, tmpW, tmpH);
+            } break;
+            case SkMask::kA8_Format: {
+                const uint8_t* a8Start = static_cast<const uint8_t*>(row);
+                auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
+                auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
+                blur_rows_transposed(planW, start, end, src.fRowBytes, srcW, y0, y1,
+                                     tmp, tmpW, tmpH);
+            } break;
+            case SkMask::kARGB32_Format: {
+                const uint32_t* argbStart = static_cast<const uint32_t*>(row);
+                auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
+                auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
+                blur_rows_transposed(planW, start, end, src.fRowBytes, srcW, y0, y1,
+                                     tmp, tmpW, tmpH);
+            } break;
+            case SkMask::kLCD16_Format: {
+                const uint16_t* lcdStart = static_cast<const uint16_t*>(row);
+                auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
+                auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
+                blur_rows_transposed(planW, start, end, src.fRowBytes, srcW, y0, y1,
+                                     tmp, tmpW, tmpH);
+            } break;
+            default:
+                SK_ABORT("Unhandled format.");
+        }
+    });
 
     // Blur vertically (scan in memory order because of the transposition),
     // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->image()[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    for_each_band(executor, tmpH, tmpW, [&](int y0, int y1) {
+        const uint8_t* tmpStart = &tmp[y0 * tmpW];
+        auto start = SkMask::AlphaIter<SkMask::kA8_Format>(tmpStart);
+        auto end = SkMask::AlphaIter<SkMask::kA8_Format>(tmpStart + tmpW);
+        blur_rows_transposed(planH, start, end, tmpW, tmpW, y0, y1,
+                             dst->image(), dst->fRowBytes, dstH);
+    });
 
     return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
 }
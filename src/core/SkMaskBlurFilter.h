@@ -9,12 +9,16 @@
 #define SkMaskBlurFilter_DEFINED
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <tuple>
 
 #include "include/core/SkTypes.h"
 #include "src/core/SkMask.h"
 
+class SkExecutor;
+
 // Implement a single channel Gaussian blur. The specifics for implementation are taken from:
 // https://drafts.fxtf.org/filters/#feGaussianBlurElement
 class SkMaskBlurFilter {
@@ -26,12 +30,26 @@ public:
     // returns true iff the sigmas will result in an identity mask (no blurring)
     bool hasNoBlur() const;
 
-    // Given a src SkMask, generate dst SkMask returning the border width and height.
-    SkIPoint blur(const SkMask& src, SkMaskBuilder* dst) const;
+    // Given a src SkMask, generate dst SkMask returning the border width and height. If an
+    // executor is given, large masks are blurred in bands of rows in parallel on it. The result
+    // is the same either way.
+    SkIPoint blur(const SkMask& src, SkMaskBuilder* dst, SkExecutor* executor = nullptr) const;
+
+    // The most rows SkOpts::mask_blur_rows() blurs at once. Its buffer holds this many copies
+    // of the scalar scan's buffer.
+    static constexpr int kMaxLanes = 8;
 
 private:
     const double fSigmaW;
     const double fSigmaH;
 };
 
+namespace SkOpts {
+    extern void (*mask_blur_rows)(const uint8_t* src, size_t srcRB, int rows, int srcCount,
+                                  int noChangeCount, uint32_t weight, const int passSizes[3],
+                                  uint32_t* buffer, uint8_t* dst, size_t dstStride, int dstCount);
+
+    void Init_MaskBlurFilter();
+}  // namespace SkOpts
+
 #endif  // SkBlurMaskFilter_DEFINED
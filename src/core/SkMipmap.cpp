@@ -8,6 +8,7 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
 #include "include/private/base/SkTo.h"
@@ -16,6 +17,7 @@
 #include "src/base/SkVx.h"
 #include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkMipmapBuilder.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <new>
 
@@ -402,7 +404,7 @@ size_t SkMipmap::AllocLevelsSize(int levelCount, size_t pixelSize) {
 }
 
 SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
-                          bool computeContents) {
+                          bool computeContents, SkExecutor* executor) {
     typedef void FilterProc(void*, const void* srcPtr, size_t srcRB, int count);
 
     FilterProc* proc_1_2 = nullptr;
@@ -423,7 +425,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_8888>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8888>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8888>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8888>;
+            proc_2_2 = SkOpts::downsample_2_2_8888;
             proc_2_3 = downsample_2_3<ColorTypeFilter_8888>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8888>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_8888>;
@@ -455,7 +457,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_8>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8>;
+            proc_2_2 = SkOpts::downsample_2_2_a8;
             proc_2_3 = downsample_2_3<ColorTypeFilter_8>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_8>;
@@ -466,7 +468,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
             proc_1_2 = downsample_1_2<ColorTypeFilter_RGBA_F16>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_RGBA_F16>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_RGBA_F16>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_RGBA_F16>;
+            proc_2_2 = SkOpts::downsample_2_2_f16;
             proc_2_3 = downsample_2_3<ColorTypeFilter_RGBA_F16>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_RGBA_F16>;
             proc_3_2 = downsample_3_2<ColorTypeFilter_RGBA_F16>;
@@ -645,14 +647,32 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
 
         const SkPixmap& dstPM = levels[i].fPixmap;
         if (computeContents) {
-            const void* srcBasePtr = srcPM.addr();
-            void* dstBasePtr = dstPM.writable_addr();
-
-            const size_t srcRB = srcPM.rowBytes();
-            for (int y = 0; y < height; y++) {
-                proc(dstBasePtr, srcBasePtr, srcRB, width);
-                srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
-                dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
+            auto downsample_rows = [proc, width, srcPM, dstPM](int y0, int y1) {
+                const size_t srcRB = srcPM.rowBytes();
+                const void* srcBasePtr = (const char*)srcPM.addr() + srcRB * 2 * y0;
+                void* dstBasePtr = (char*)dstPM.writable_addr() + dstPM.rowBytes() * y0;
+
+                for (int y = y0; y < y1; y++) {
+                    proc(dstBasePtr, srcBasePtr, srcRB, width);
+                    srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
+                    dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
+                }
+            };
+
+            // Each level is built from the one before it, so we can only split a level's rows
+            // among tasks, waiting for them all before moving on to the next level. Small levels
+            // aren't worth the overhead.
+            constexpr int kMinPixelsPerTask = 64 * 1024;
+            const int rowsPerTask = std::max(1, kMinPixelsPerTask / width);
+            if (executor && height >= 2 * rowsPerTask) {
+                SkTaskGroup tg(*executor);
+                const int tasks = (height + rowsPerTask - 1) / rowsPerTask;
+                tg.batch(tasks, [&](int i) {
+                    downsample_rows(i * rowsPerTask, std::min(height, (i + 1) * rowsPerTask));
+                });
+                tg.wait();
+            } else {
+                downsample_rows(0, height);
             }
         }
         srcPM = dstPM;
@@ -798,12 +818,13 @@ bool SkMipmap::validForRootLevel(const SkImageInfo& root) const {
 
 // Helper which extracts a pixmap from the src bitmap
 //
-SkMipmap* SkMipmap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
+SkMipmap* SkMipmap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact,
+                          SkExecutor* executor) {
     SkPixmap srcPixmap;
     if (!src.peekPixels(&srcPixmap)) {
         return nullptr;
     }
-    return Build(srcPixmap, fact);
+    return Build(srcPixmap, fact, /*computeContents=*/true, executor);
 }
 
 int SkMipmap::countLevels() const {
@@ -18,6 +18,7 @@
 class SkBitmap;
 class SkData;
 class SkDiscardableMemory;
+class SkExecutor;
 class SkMipmapBuilder;
 
 typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
@@ -34,10 +35,11 @@ public:
     ~SkMipmap() override;
     // Allocate and fill-in a mipmap. If computeContents is false, we just allocated
     // and compute the sizes/rowbytes, but leave the pixel-data uninitialized.
+    // If an executor is given, the rows of each large level are downsampled in parallel on it.
     static SkMipmap* Build(const SkPixmap& src, SkDiscardableFactoryProc,
-                           bool computeContents = true);
+                           bool computeContents = true, SkExecutor* = nullptr);
 
-    static SkMipmap* Build(const SkBitmap& src, SkDiscardableFactoryProc);
+    static SkMipmap* Build(const SkBitmap& src, SkDiscardableFactoryProc, SkExecutor* = nullptr);
 
     // Determines how many levels a SkMipmap will have without creating that mipmap.
     // This does not include the base mipmap level that the user provided when
@@ -90,4 +92,14 @@ private:
     static size_t AllocLevelsSize(int levelCount, size_t pixelSize);
 };
 
+namespace SkOpts {
+    // Vectorized 2x2 box filters for the most common formats, matching the portable filters.
+    // Each writes `count` dst pixels from the two src rows starting at src and src + srcRB.
+    extern void (*downsample_2_2_8888)(void* dst, const void* src, size_t srcRB, int count);
+    extern void (*downsample_2_2_a8  )(void* dst, const void* src, size_t srcRB, int count);
+    extern void (*downsample_2_2_f16 )(void* dst, const void* src, size_t srcRB, int count);
+
+    void Init_Mipmap();
+}  // namespace SkOpts
+
 #endif
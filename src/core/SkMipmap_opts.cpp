@@ -0,0 +1,41 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/private/base/SkFeatures.h"
+#include "src/core/SkCpu.h"
+#include "src/core/SkMipmap.h"
+#include "src/core/SkOpts.h"
+
+#define SK_OPTS_TARGET SK_OPTS_TARGET_DEFAULT
+#include "src/opts/SkOpts_SetTarget.h"
+
+#include "src/opts/SkMipmap_opts.h"  // IWYU pragma: keep
+
+#include "src/opts/SkOpts_RestoreTarget.h"
+
+namespace SkOpts {
+    DEFINE_DEFAULT(downsample_2_2_8888);
+    DEFINE_DEFAULT(downsample_2_2_a8);
+    DEFINE_DEFAULT(downsample_2_2_f16);
+
+    void Init_Mipmap_hsw();
+
+    static bool init() {
+    #if defined(SK_ENABLE_OPTIMIZE_SIZE)
+        // All Init_foo functions are omitted when optimizing for size
+    #elif defined(SK_CPU_X86)
+        #if SK_CPU_SSE_LEVEL < SK_CPU_SSE_LEVEL_AVX2
+            if (SkCpu::Supports(SkCpu::HSW)) { Init_Mipmap_hsw(); }
+        #endif
+    #endif
+      return true;
+    }
+
+    void Init_Mipmap() {
+        [[maybe_unused]] static bool gInitialized = init();
+    }
+}  // namespace SkOpts
@@ -18,7 +18,8 @@
 
 enum SkFILE_Flags {
     kRead_SkFILE_Flag   = 0x01,
-    kWrite_SkFILE_Flag  = 0x02
+    kWrite_SkFILE_Flag  = 0x02,
+    kAppend_SkFILE_Flag = 0x04   // Write at the end of the file, creating it if needed.
 };
 
 FILE* sk_fopen(const char path[], SkFILE_Flags);
@@ -70,6 +70,7 @@ namespace SkOpts {
     void Init_ssse3();
     void Init_avx();
     void Init_hsw();
+    void Init_skx();
     void Init_erms();
 
     static void init() {
@@ -88,6 +89,10 @@ namespace SkOpts {
             if (SkCpu::Supports(SkCpu::HSW)) { Init_hsw(); }
         #endif
 
+        #if SK_CPU_SSE_LEVEL < SK_CPU_SSE_LEVEL_SKX
+            if (SkCpu::Supports(SkCpu::HSW | SkCpu::SKX)) { Init_skx(); }
+        #endif
+
         if (SkCpu::Supports(SkCpu::ERMS)) { Init_erms(); }
     #endif
     }
@@ -65,6 +65,7 @@ class TraceHook;
 #define SK_OPTS_TARGET_SSSE3   0x01
 #define SK_OPTS_TARGET_AVX     0x02
 #define SK_OPTS_TARGET_HSW     0x04
+#define SK_OPTS_TARGET_SKX     0x08
 
 namespace SkOpts {
     // Call to replace pointers to portable functions with pointers to CPU-specific functions.
@@ -15,6 +15,7 @@
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
 #include "src/core/SkCanvasPriv.h"
+#include "src/core/SkMappedPicture.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
@@ -38,6 +39,7 @@ enum {
     kFailure_TrailingStreamByteAfterPictInfo     = 0,   // nothing follows
     kPictureData_TrailingStreamByteAfterPictInfo = 1,   // SkPictureData follows
     kCustom_TrailingStreamByteAfterPictInfo      = 2,   // -size32 follows
+    kAlignedPictureData_TrailingStreamByteAfterPictInfo = 3,  // mappable SkPictureData follows
 };
 
 /* SkPicture impl.  This handles generic responsibilities like unique IDs and serialization. */
@@ -165,8 +167,17 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit);
 }
 
+sk_sp<SkPicture> SkPicture::MakeFromMappedData(sk_sp<SkData> data, const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit, data.get());
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                               SkTypefacePlayback* typefaces, int recursionLimit) {
+                                               SkTypefacePlayback* typefaces, int recursionLimit,
+                                               const SkData* mapped) {
     if (recursionLimit <= 0) {
         return nullptr;
     }
@@ -183,10 +194,16 @@ sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeseria
     uint8_t trailingStreamByteAfterPictInfo;
     if (!stream->readU8(&trailingStreamByteAfterPictInfo)) { return nullptr; }
     switch (trailingStreamByteAfterPictInfo) {
-        case kPictureData_TrailingStreamByteAfterPictInfo: {
+        case kPictureData_TrailingStreamByteAfterPictInfo:
+        case kAlignedPictureData_TrailingStreamByteAfterPictInfo: {
+            const bool aligned = trailingStreamByteAfterPictInfo ==
+                                 kAlignedPictureData_TrailingStreamByteAfterPictInfo;
             std::unique_ptr<SkPictureData> data(
                     SkPictureData::CreateFromStream(stream, info, procs, typefaces,
-                                                    recursionLimit));
+                                                    recursionLimit, mapped, aligned));
+            if (mapped) {
+                return SkMappedPicture::Make(info, std::move(data));
+            }
             return Forwardport(info, data.get(), nullptr);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
@@ -304,7 +321,9 @@ void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
 
     std::unique_ptr<SkPictureData> data(this->backport());
     if (data) {
-        stream->write8(kPictureData_TrailingStreamByteAfterPictInfo);
+        stream->write8(procs.fMappablePictures
+                               ? kAlignedPictureData_TrailingStreamByteAfterPictInfo
+                               : kPictureData_TrailingStreamByteAfterPictInfo);
         data->serialize(stream, procs, typefaceSet, textBlobsOnly);
     } else {
         stream->write8(kFailure_TrailingStreamByteAfterPictInfo);
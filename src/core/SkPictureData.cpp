@@ -16,7 +16,6 @@
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
-#include "src/base/SkAutoMalloc.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
 #include "src/core/SkPtrRecorder.h"
@@ -151,7 +150,8 @@ void SkPictureData::WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec,
     }
 }
 
-void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) const {
+void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly,
+                                    bool indexed) const {
     if (!textBlobsOnly) {
         int numPaints = fPaints.size();
         if (numPaints > 0) {
@@ -162,7 +162,7 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) c
         }
 
         int numPaths = fPaths.size();
-        if (numPaths > 0) {
+        if (numPaths > 0 && !indexed) {
             write_tag_size(buffer, SK_PICT_PATH_BUFFER_TAG, numPaths);
             buffer.writeInt(numPaths);
             for (const SkPath& path : fPaths) {
@@ -171,7 +171,7 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) c
         }
     }
 
-    if (!fTextBlobs.empty()) {
+    if (!fTextBlobs.empty() && !indexed) {
         write_tag_size(buffer, SK_PICT_TEXTBLOB_BUFFER_TAG, fTextBlobs.size());
         for (const auto& blob : fTextBlobs) {
             SkTextBlobPriv::Flatten(*blob, buffer);
@@ -202,6 +202,41 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) c
     }
 }
 
+// An indexed section is a table of count + 1 offsets, followed by the count items. Item i starts
+// offsets[i] bytes after the table, and ends where item i + 1 starts.
+template <typename T, typename FlattenProc>
+static void write_indexed_section(SkBinaryWriteBuffer& buffer, uint32_t tag,
+                                  const TArray<T>& items, FlattenProc&& flattenProc) {
+    write_tag_size(buffer, tag, items.size());
+    const size_t table = buffer.bytesWritten();
+    for (int i = 0; i <= items.size(); i++) {
+        buffer.writeUInt(0);
+    }
+
+    const size_t start = buffer.bytesWritten();
+    for (int i = 0; i < items.size(); i++) {
+        buffer.overwriteUIntAt(table + i * sizeof(uint32_t),
+                               SkToU32(buffer.bytesWritten() - start));
+        flattenProc(items[i]);
+    }
+    buffer.overwriteUIntAt(table + items.size() * sizeof(uint32_t),
+                           SkToU32(buffer.bytesWritten() - start));
+}
+
+void SkPictureData::flattenIndexedToBuffer(SkBinaryWriteBuffer& buffer,
+                                           bool textBlobsOnly) const {
+    if (!textBlobsOnly && !fPaths.empty()) {
+        write_indexed_section(buffer, SK_PICT_INDEXED_PATH_BUFFER_TAG, fPaths,
+                              [&](const SkPath& path) { buffer.writePath(path); });
+    }
+    if (!fTextBlobs.empty()) {
+        write_indexed_section(buffer, SK_PICT_INDEXED_TEXTBLOB_BUFFER_TAG, fTextBlobs,
+                              [&](const sk_sp<const SkTextBlob>& blob) {
+                                  SkTextBlobPriv::Flatten(*blob, buffer);
+                              });
+    }
+}
+
 // SkPictureData::serialize() will write out paints, and then write out an array of typefaces
 // (unique set). However, paint's serializer will respect SerialProcs, which can cause us to
 // call that custom typefaceproc on *every* typeface, not just on the unique ones. To avoid this,
@@ -221,7 +256,17 @@ static SkSerialProcs skip_typeface_proc(const SkSerialProcs& procs) {
 // TODO(nifong): dedupe typefaces and all other shared resources in a faster and more readable way.
 void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
                               SkRefCntSet* topLevelTypeFaceSet, bool textBlobsOnly) const {
+    // Mappable pictures start each tag 4-byte aligned, so that the op data and the buffer can be
+    // read in place.
+    const bool mappable = procs.fMappablePictures;
+    auto alignTag = [&] {
+        if (mappable) {
+            StreamPadToAlign4(stream);
+        }
+    };
+
     // This can happen at pretty much any time, so might as well do it first.
+    alignTag();
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
     stream->write(fOpData->bytes(), fOpData->size());
 
@@ -236,7 +281,10 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
     buffer.setFactoryRecorder(sk_ref_sp(&factSet));
     buffer.setSerialProcs(skip_typeface_proc(procs));
     buffer.setTypefaceRecorder(sk_ref_sp(typefaceSet));
-    this->flattenToBuffer(buffer, textBlobsOnly);
+    this->flattenToBuffer(buffer, textBlobsOnly, mappable);
+    if (mappable) {
+        this->flattenIndexedToBuffer(buffer, textBlobsOnly);
+    }
 
     // Pretend to serialize our sub-pictures for the side effect of filling typefaceSet
     // with typefaces from sub-pictures.
@@ -253,24 +301,29 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
 
     // We need to write factories before we write the buffer.
     // We need to write typefaces before we write the buffer or any sub-picture.
+    alignTag();
     WriteFactories(stream, factSet);
     // Pass the original typefaceproc (if any) now that we're ready to actually serialize the
     // typefaces. We skipped this proc before, when we were serializing paints, so that the
     // paints would just write indices into our typeface set.
+    alignTag();
     WriteTypefaces(stream, *typefaceSet, procs);
 
     // Write the buffer.
+    alignTag();
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
     buffer.writeToStream(stream);
 
     // Write sub-pictures by calling serialize again.
     if (!fPictures.empty()) {
+        alignTag();
         write_tag_size(stream, SK_PICT_PICTURE_TAG, fPictures.size());
         for (const auto& pic : fPictures) {
             pic->serialize(stream, &procs, typefaceSet, /*textBlobsOnly=*/ false);
         }
     }
 
+    alignTag();
     stream->write32(SK_PICT_EOF_TAG);
 }
 
@@ -299,16 +352,34 @@ void SkPictureData::flatten(SkWriteBuffer& buffer) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Returns the next size bytes of the stream. If the stream reads mapped, and the bytes are 4-byte
+// aligned there, they are referenced in place rather than copied.
+static sk_sp<SkData> read_section(SkStream* stream, size_t size, const SkData* mapped) {
+    if (mapped && stream->hasPosition()) {
+        const size_t offset = stream->getPosition();
+        if (offset <= mapped->size() && size <= mapped->size() - offset &&
+            SkIsAlign4((uintptr_t)(mapped->bytes() + offset))) {
+            if (stream->skip(size) != size) {
+                return nullptr;
+            }
+            return SkData::MakeSubset(mapped, offset, size);
+        }
+    }
+    return SkData::MakeFromStream(stream, size);
+}
+
 bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
                                    SkTypefacePlayback* topLevelTFPlayback,
-                                   int recursionLimit) {
+                                   int recursionLimit,
+                                   const SkData* mapped,
+                                   bool aligned) {
     switch (tag) {
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            fOpData = read_section(stream, size, mapped);
             if (!fOpData) {
                 return false;
             }
@@ -364,8 +435,8 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fPictures.reserve_exact(SkToInt(size));
 
             for (uint32_t i = 0; i < size; i++) {
-                auto pic = SkPicture::MakeFromStreamPriv(stream, &procs,
-                                                         topLevelTFPlayback, recursionLimit - 1);
+                auto pic = SkPicture::MakeFromStreamPriv(stream, &procs, topLevelTFPlayback,
+                                                         recursionLimit - 1, mapped);
                 if (!pic) {
                     return false;
                 }
@@ -376,13 +447,17 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             if (StreamRemainingLengthIsBelow(stream, size)) {
                 return false;
             }
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            sk_sp<SkData> storage = read_section(stream, size, mapped);
+            if (!storage) {
                 return false;
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(storage->data(), size);
             buffer.setVersion(fInfo.getVersion());
+            if (mapped) {
+                // Let images refer to their encoded data in place.
+                buffer.setMemoryOwner(storage);
+            }
 
             if (!fFactoryPlayback) {
                 return false;
@@ -390,6 +465,14 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fFactoryPlayback->setupBuffer(buffer);
             buffer.setDeserialProcs(procs);
 
+            if (aligned && fTFPlayback.count() == 0 && topLevelTFPlayback != &fTFPlayback) {
+                // Paths and text blobs may be read after the top picture is gone, so keep the
+                // typefaces that they refer to.
+                fTFPlayback.setCount(topLevelTFPlayback->count());
+                for (size_t i = 0; i < topLevelTFPlayback->count(); i++) {
+                    fTFPlayback[i] = (*topLevelTFPlayback)[i];
+                }
+            }
             if (fTFPlayback.count() > 0) {
                 // .skp files <= v43 have typefaces serialized with each sub picture.
                 fTFPlayback.setupBuffer(buffer);
@@ -398,11 +481,15 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
                 topLevelTFPlayback->setupBuffer(buffer);
             }
 
+            fArrayData = std::move(storage);
             while (!buffer.eof() && buffer.isValid()) {
                 tag = buffer.readUInt();
                 size = buffer.readUInt();
                 this->parseBufferTag(buffer, tag, size);
             }
+            if (!fLazyPaths && !fLazyTextBlobs) {
+                fArrayData.reset();
+            }
             if (!buffer.isValid()) {
                 return false;
             }
@@ -411,6 +498,18 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
     return true;    // success
 }
 
+static bool read_path(SkReadBuffer& buffer, SkPath* path) {
+    buffer.readPath(path);
+    // Pre-compute the bounds, like initForPlayback().
+    path->updateBoundsCache();
+    return buffer.isValid();
+}
+
+static bool read_text_blob(SkReadBuffer& buffer, sk_sp<const SkTextBlob>* blob) {
+    *blob = SkTextBlobPriv::MakeFromBuffer(buffer);
+    return *blob != nullptr;
+}
+
 static sk_sp<SkImage> create_image_from_buffer(SkReadBuffer& buffer) {
     return buffer.readImage();
 }
@@ -444,6 +543,29 @@ bool new_array_from_buffer(SkReadBuffer& buffer, uint32_t inCount,
     return true;
 }
 
+template <typename T>
+std::unique_ptr<SkPictureData::LazyItems<T>> SkPictureData::parseIndexedSection(
+        SkReadBuffer& buffer, uint32_t count, typename LazyItems<T>::ReadProc readProc) {
+    // The items are read from fArrayData after parsing is done.
+    if (!buffer.validate(fArrayData != nullptr && count > 0 && SkTFitsIn<int>(count))) {
+        return nullptr;
+    }
+    auto offsets = static_cast<const uint32_t*>(buffer.skip(count + 1, sizeof(uint32_t)));
+    if (!offsets) {
+        return nullptr;
+    }
+    auto items = static_cast<const char*>(buffer.skip(offsets[count]));
+    if (!items) {
+        return nullptr;
+    }
+    return std::make_unique<LazyItems<T>>(offsets, items, SkToInt(count), readProc);
+}
+
+void SkPictureData::setupLazyBuffer(SkReadBuffer& buffer) const {
+    buffer.setVersion(fInfo.getVersion());
+    fTFPlayback.setupBuffer(buffer);
+}
+
 void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t size) {
     switch (tag) {
         case SK_PICT_PAINT_BUFFER_TAG: {
@@ -475,6 +597,17 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
         case SK_PICT_TEXTBLOB_BUFFER_TAG:
             new_array_from_buffer(buffer, size, fTextBlobs, SkTextBlobPriv::MakeFromBuffer);
             break;
+        case SK_PICT_INDEXED_PATH_BUFFER_TAG:
+            if (buffer.validate(!fLazyPaths && fPaths.empty())) {
+                fLazyPaths = this->parseIndexedSection<SkPath>(buffer, size, read_path);
+            }
+            break;
+        case SK_PICT_INDEXED_TEXTBLOB_BUFFER_TAG:
+            if (buffer.validate(!fLazyTextBlobs && fTextBlobs.empty())) {
+                fLazyTextBlobs = this->parseIndexedSection<sk_sp<const SkTextBlob>>(
+                        buffer, size, read_text_blob);
+            }
+            break;
         case SK_PICT_SLUG_BUFFER_TAG:
             new_array_from_buffer(buffer, size, fSlugs, sktext::gpu::Slug::MakeFromBuffer);
             break;
@@ -514,13 +647,15 @@ SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
                                                SkTypefacePlayback* topLevelTFPlayback,
-                                               int recursionLimit) {
+                                               int recursionLimit,
+                                               const SkData* mapped,
+                                               bool aligned) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback, recursionLimit)) {
+    if (!data->parseStream(stream, procs, topLevelTFPlayback, recursionLimit, mapped, aligned)) {
         return nullptr;
     }
     return data.release();
@@ -537,20 +672,39 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
     return data.release();
 }
 
+// Mappable pictures pad each tag to a multiple of 4 bytes from the start of the stream they were
+// written to. No byte of a tag is zero, so the padding is skipped without knowing where it began.
+static bool read_aligned_tag(SkStream* stream, uint32_t* tag) {
+    uint8_t bytes[4] = {0, 0, 0, 0};
+    for (int padding = 0; bytes[0] == 0; padding++) {
+        if (padding > 3 || !stream->readU8(&bytes[0])) {
+            return false;
+        }
+    }
+    if (stream->read(bytes + 1, 3) != 3) {
+        return false;
+    }
+    memcpy(tag, bytes, sizeof(*tag));
+    return true;
+}
+
 bool SkPictureData::parseStream(SkStream* stream,
                                 const SkDeserialProcs& procs,
                                 SkTypefacePlayback* topLevelTFPlayback,
-                                int recursionLimit) {
+                                int recursionLimit,
+                                const SkData* mapped,
+                                bool aligned) {
     for (;;) {
         uint32_t tag;
-        if (!stream->readU32(&tag)) { return false; }
+        if (!(aligned ? read_aligned_tag(stream, &tag) : stream->readU32(&tag))) { return false; }
         if (SK_PICT_EOF_TAG == tag) {
             break;
         }
 
         uint32_t size;
         if (!stream->readU32(&size)) { return false; }
-        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, recursionLimit)) {
+        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, recursionLimit,
+                                  mapped, aligned)) {
             return false; // we're invalid
         }
     }
@@ -20,6 +20,8 @@
 #include "include/core/SkTextBlob.h"
 #include "include/core/SkTypes.h"
 #include "include/core/SkVertices.h"
+#include "include/private/base/SkAlign.h"
+#include "include/private/base/SkOnce.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/chromium/Slug.h"
 #include "src/core/SkPictureFlat.h"
@@ -28,6 +30,7 @@
 #include <cstdint>
 #include <memory>
 
+class SkBinaryWriteBuffer;
 class SkFactorySet;
 class SkPictureRecord;
 class SkRefCntSet;
@@ -73,6 +76,10 @@ public:
 #define SK_PICT_SLUG_BUFFER_TAG SkSetFourByteTag('s', 'l', 'u', 'g')
 #define SK_PICT_VERTICES_BUFFER_TAG SkSetFourByteTag('v', 'e', 'r', 't')
 #define SK_PICT_IMAGE_BUFFER_TAG    SkSetFourByteTag('i', 'm', 'a', 'g')
+// Mappable pictures (see SkSerialProcs::fMappablePictures) write their paths and text blobs
+// after a table of where each starts, so that each can be read on its own when first drawn.
+#define SK_PICT_INDEXED_PATH_BUFFER_TAG     SkSetFourByteTag('p', 't', 'h', '#')
+#define SK_PICT_INDEXED_TEXTBLOB_BUFFER_TAG SkSetFourByteTag('b', 'l', 'o', '#')
 
 // Always write this last (with no length field afterwards)
 #define SK_PICT_EOF_TAG     SkSetFourByteTag('e', 'o', 'f', ' ')
@@ -87,12 +94,16 @@ T* read_index_base_1_or_null(SkReadBuffer* reader,
 class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
-    // Does not affect ownership of SkStream.
+    // Does not affect ownership of SkStream. If mapped is not null, the stream reads it from the
+    // start, and the op data and arrays are referenced in it rather than copied where possible.
+    // If aligned, each tag may follow up to 3 bytes of padding, as written for mappable pictures.
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
                                            SkTypefacePlayback*,
-                                           int recursionLimit);
+                                           int recursionLimit,
+                                           const SkData* mapped = nullptr,
+                                           bool aligned = false);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false) const;
@@ -102,12 +113,14 @@ public:
 
     const sk_sp<SkData>& opData() const { return fOpData; }
 
+    const skia_private::TArray<sk_sp<const SkPicture>>& pictures() const { return fPictures; }
+
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
     // Does not affect ownership of SkStream.
     bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*,
-                     int recursionLimit);
+                     int recursionLimit, const SkData* mapped, bool aligned);
     bool parseBuffer(SkReadBuffer& buffer);
 
 public:
@@ -119,6 +132,12 @@ public:
 
     const SkPath& getPath(SkReadBuffer* reader) const {
         int index = reader->readInt();
+        if (fLazyPaths) {
+            const SkPath* path = reader->validate(index > 0 && index <= fLazyPaths->count())
+                                         ? fLazyPaths->get(*this, index - 1)
+                                         : nullptr;
+            return reader->validate(path != nullptr) ? *path : fEmptyPath;
+        }
         return reader->validate(index > 0 && index <= fPaths.size()) ?
                 fPaths[index - 1] : fEmptyPath;
     }
@@ -139,6 +158,14 @@ public:
     const SkPaint& requiredPaint(SkReadBuffer* reader) const;
 
     const SkTextBlob* getTextBlob(SkReadBuffer* reader) const {
+        if (fLazyTextBlobs) {
+            int index = reader->readInt();
+            const sk_sp<const SkTextBlob>* blob =
+                    reader->validate(index > 0 && index <= fLazyTextBlobs->count())
+                            ? fLazyTextBlobs->get(*this, index - 1)
+                            : nullptr;
+            return reader->validate(blob != nullptr) ? blob->get() : nullptr;
+        }
         return read_index_base_1_or_null(reader, fTextBlobs);
     }
 
@@ -151,17 +178,75 @@ public:
     }
 
 private:
+    // The items of an indexed section, each read from the section the first time it is asked
+    // for. Returns nullptr for an item that can't be read.
+    template <typename T>
+    class LazyItems {
+    public:
+        using ReadProc = bool (*)(SkReadBuffer&, T*);
+
+        // offsets holds count + 1 offsets into items, the last being the end of the items.
+        LazyItems(const uint32_t* offsets, const char* items, int count, ReadProc readProc)
+                : fOffsets(offsets)
+                , fItems(items)
+                , fCount(count)
+                , fReadProc(readProc)
+                , fSlots(new Slot[count]) {}
+
+        int count() const { return fCount; }
+
+        const T* get(const SkPictureData& data, int index) const {
+            SkASSERT(0 <= index && index < fCount);
+            Slot& slot = fSlots[index];
+            slot.fOnce([&] {
+                const uint32_t start = fOffsets[index],
+                               end   = fOffsets[index + 1];
+                if (start <= end && end <= fOffsets[fCount] &&
+                    SkIsAlign4(start) && SkIsAlign4(end)) {
+                    SkReadBuffer buffer(fItems + start, end - start);
+                    data.setupLazyBuffer(buffer);
+                    slot.fValid = fReadProc(buffer, &slot.fItem) && buffer.isValid();
+                }
+            });
+            return slot.fValid ? &slot.fItem : nullptr;
+        }
+
+    private:
+        struct Slot {
+            SkOnce fOnce;
+            T      fItem;
+            bool   fValid = false;
+        };
+
+        const uint32_t* const fOffsets;
+        const char* const     fItems;
+        const int             fCount;
+        const ReadProc        fReadProc;
+        const std::unique_ptr<Slot[]> fSlots;
+    };
+
     // these help us with reading/writing
     // Does not affect ownership of SkStream.
     bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size,
                         const SkDeserialProcs&, SkTypefacePlayback*,
-                        int recursionLimit);
+                        int recursionLimit, const SkData* mapped, bool aligned);
     void parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
-    void flattenToBuffer(SkWriteBuffer&, bool textBlobsOnly) const;
+    template <typename T>
+    std::unique_ptr<LazyItems<T>> parseIndexedSection(SkReadBuffer&, uint32_t count,
+                                                      typename LazyItems<T>::ReadProc);
+    // If indexed, paths and text blobs are left to flattenIndexedToBuffer().
+    void flattenToBuffer(SkWriteBuffer&, bool textBlobsOnly, bool indexed = false) const;
+    void flattenIndexedToBuffer(SkBinaryWriteBuffer&, bool textBlobsOnly) const;
+    void setupLazyBuffer(SkReadBuffer&) const;
 
     skia_private::TArray<SkPaint> fPaints;
     skia_private::TArray<SkPath>  fPaths;
 
+    // The SK_PICT_BUFFER_SIZE_TAG section, kept while its indexed sections are read from it.
+    sk_sp<SkData>                               fArrayData;
+    std::unique_ptr<LazyItems<SkPath>>          fLazyPaths;
+    std::unique_ptr<LazyItems<sk_sp<const SkTextBlob>>> fLazyTextBlobs;
+
     sk_sp<SkData>                 fOpData;    // opcodes and parameters
 
     const SkPath                  fEmptyPath;
@@ -55,6 +55,17 @@ SkCanvas* SkPictureRecorder::getRecordingCanvas() {
     return fActivelyRecording ? fRecorder.get() : nullptr;
 }
 
+void SkPictureRecorder::optimize() {
+    // Cull first, so rects left separated only by culled draws can still be merged.
+    if (fOptimizationFlags & kCullOverdraw_OptimizationFlag) {
+        SkRecordCullOverdraw(fRecord.get(), fCullRect);
+    }
+    if (fOptimizationFlags & kMergeDrawRects_OptimizationFlag) {
+        SkRecordMergeDrawRects(fRecord.get());
+    }
+    SkRecordOptimize(fRecord.get());
+}
+
 class SkEmptyPicture final : public SkPicture {
 public:
     void playback(SkCanvas*, AbortCallback*) const override { }
@@ -73,7 +84,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture() {
     }
 
     // TODO: delay as much of this work until just before first playback?
-    SkRecordOptimize(fRecord.get());
+    this->optimize();
 
     SkDrawableList* drawableList = fRecorder->getDrawableList();
     std::unique_ptr<SkBigPicture::SnapshotArray> pictList{
@@ -133,7 +144,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable() {
     fActivelyRecording = false;
     fRecorder->restoreToCount(1);  // If we were missing any restores, add them now.
 
-    SkRecordOptimize(fRecord.get());
+    this->optimize();
 
     if (fBBH) {
         AutoTArray<SkRect> bounds(fRecord->count());
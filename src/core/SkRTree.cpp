@@ -7,162 +7,262 @@
 
 #include "src/core/SkRTree.h"
 
-SkRTree::SkRTree() : fCount(0) {}
+#include "include/private/base/SkFloatingPoint.h"
+#include "include/private/base/SkTPin.h"
+#include "src/base/SkMathPriv.h"
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// Maps 16-bit x and y to their 32-bit index along a Hilbert curve filling the 2^16 x 2^16 square.
+// This is the branch-free formulation from http://threadlocalmutex.com/?p=126.
+static uint32_t hilbert_index(uint32_t x, uint32_t y) {
+    uint32_t a = x ^ y;
+    uint32_t b = 0xFFFF ^ a;
+    uint32_t c = 0xFFFF ^ (x | y);
+    uint32_t d = x & (y ^ 0xFFFF);
+
+    uint32_t A = a | (b >> 1);
+    uint32_t B = (a >> 1) ^ a;
+    uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+    B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+    C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+    D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+    B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+    C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+    D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+    a = A; b = B; c = C; d = D;
+    C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+    D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+
+    uint32_t i0 = x ^ y;
+    uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+    auto spread = [](uint32_t v) {
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return (spread(i1) << 1) | spread(i0);
+}
+
+SkRTree::SkRTree(Ordering ordering) : fOrdering(ordering) {}
 
 void SkRTree::insert(const SkRect boundsArray[], int N) {
     SkASSERT(0 == fCount);
 
-    std::vector<Branch> branches;
-    branches.reserve(N);
-
+    fOps.reserve(N);
     for (int i = 0; i < N; i++) {
         const SkRect& bounds = boundsArray[i];
         if (bounds.isEmpty()) {
             continue;
         }
+        fOps.push_back(i);
+        fBounds.join(bounds);
+    }
 
-        Branch b;
-        b.fBounds = bounds;
-        b.fOpIndex = i;
-        branches.push_back(b);
+    fCount = (int)fOps.size();
+    if (0 == fCount) {
+        return;
     }
 
-    fCount = (int)branches.size();
-    if (fCount) {
-        if (1 == fCount) {
-            fNodes.reserve(1);
-            Node* n = this->allocateNodeAtLevel(0);
-            n->fNumChildren = 1;
-            n->fChildren[0] = branches[0];
-            fRoot.fSubtree = n;
-            fRoot.fBounds  = branches[0].fBounds;
-        } else {
-            fNodes.reserve(CountNodes(fCount));
-            fRoot = this->bulkLoad(&branches);
+    if (fOrdering == Ordering::kHilbert && fCount > kMaxChildren) {
+        // Sort by the Hilbert index of each center, packed above the op index into one key.
+        const float sx = 0xFFFF / std::max(fBounds.width(),  SK_ScalarNearlyZero),
+                    sy = 0xFFFF / std::max(fBounds.height(), SK_ScalarNearlyZero);
+        std::vector<uint64_t> keys(fCount);
+        for (int i = 0; i < fCount; i++) {
+            const SkRect& r = boundsArray[fOps[i]];
+            const uint32_t x = (uint32_t)SkTPin((r.centerX() - fBounds.fLeft) * sx, 0.f, 65535.f),
+                           y = (uint32_t)SkTPin((r.centerY() - fBounds.fTop ) * sy, 0.f, 65535.f);
+            keys[i] = (uint64_t)hilbert_index(x, y) << 32 | (uint32_t)fOps[i];
+        }
+        std::sort(keys.begin(), keys.end());
+        for (int i = 0; i < fCount; i++) {
+            fOps[i] = (int)(uint32_t)keys[i];
         }
     }
-}
-
-SkRTree::Node* SkRTree::allocateNodeAtLevel(uint16_t level) {
-    SkDEBUGCODE(Node* p = fNodes.data());
-    fNodes.push_back(Node{});
-    Node& out = fNodes.back();
-    SkASSERT(fNodes.data() == p);  // If this fails, we didn't reserve() enough.
-    out.fNumChildren = 0;
-    out.fLevel = level;
-    return &out;
-}
 
-// This function parallels bulkLoad, but just counts how many nodes bulkLoad would allocate.
-int SkRTree::CountNodes(int branches) {
-    if (branches == 1) {
-        return 1;
-    }
-    int remainder   = branches % kMaxChildren;
-    if (remainder > 0) {
-        if (remainder >= kMinChildren) {
-            remainder = 0;
-        } else {
-            remainder = kMinChildren - remainder;
+    int nodeCount = 0;
+    for (int n = fCount; ; ) {
+        n = (n + kMaxChildren - 1) / kMaxChildren;
+        nodeCount += n;
+        if (n == 1) {
+            break;
         }
     }
-    int currentBranch = 0;
-    int nodes = 0;
-    while (currentBranch < branches) {
-        int incrementBy = kMaxChildren;
-        if (remainder != 0) {
-            if (remainder <= kMaxChildren - kMinChildren) {
-                incrementBy -= remainder;
-                remainder = 0;
-            } else {
-                incrementBy = kMinChildren;
-                remainder -= kMaxChildren - kMinChildren;
+    fNodes.reserve(nodeCount);
+
+    // Build one level at a time, bottom-up. boxes holds the bounds of the level being grouped,
+    // whose entries start at index childBase of fOps (for the leaves) or fNodes.
+    std::vector<SkRect> boxes(fCount);
+    for (int i = 0; i < fCount; i++) {
+        boxes[i] = boundsArray[fOps[i]];
+    }
+    int childBase = 0;
+    do {
+        const int n = (int)boxes.size(),
+                  m = (n + kMaxChildren - 1) / kMaxChildren;
+        const int levelBase = (int)fNodes.size();
+
+        std::vector<SkRect> parents(m);
+        for (int j = 0; j < m; j++) {
+            const int begin = (int)((int64_t)n *  j      / m),
+                      end   = (int)((int64_t)n * (j + 1) / m);
+            SkASSERT(end - begin <= kMaxChildren);
+
+            Node& node = fNodes.emplace_back();
+            node.fFirstChild = childBase + begin;
+            node.fNumChildren = end - begin;
+            for (int k = 0; k < kMaxChildren; k++) {
+                if (k < node.fNumChildren) {
+                    const SkRect& r = boxes[begin + k];
+                    node.fLeft  [k] = r.fLeft;
+                    node.fTop   [k] = r.fTop;
+                    node.fRight [k] = r.fRight;
+                    node.fBottom[k] = r.fBottom;
+                } else {
+                    node.fLeft  [k] = node.fTop   [k] = +std::numeric_limits<float>::infinity();
+                    node.fRight [k] = node.fBottom[k] = -std::numeric_limits<float>::infinity();
+                }
+            }
+
+            SkRect& parent = parents[j];
+            parent = boxes[begin];
+            for (int k = begin + 1; k < end; k++) {
+                parent.join(boxes[k]);
             }
         }
-        nodes++;
-        currentBranch++;
-        for (int k = 1; k < incrementBy && currentBranch < branches; ++k) {
-            currentBranch++;
+
+        if (fDepth == 0) {
+            fLeafCount = m;
         }
-    }
-    return nodes + CountNodes(nodes);
+        fDepth++;
+        childBase = levelBase;
+        boxes = std::move(parents);
+    } while (boxes.size() > 1);
+    SkASSERT((int)fNodes.size() == nodeCount);
 }
 
-SkRTree::Branch SkRTree::bulkLoad(std::vector<Branch>* branches, int level) {
-    if (branches->size() == 1) { // Only one branch.  It will be the root.
-        return (*branches)[0];
+void SkRTree::search(const SkRect& query, std::vector<int>* results) const {
+    if (fCount > 0 && SkRect::Intersects(fBounds, query)) {
+        const size_t first = results->size();
+        this->search((int)fNodes.size() - 1, query, results);
+        if (fOrdering == Ordering::kHilbert) {
+            // Callers draw the results in order, but the leaves are sorted by position.
+            std::sort(results->begin() + first, results->end());
+        }
     }
+}
 
-    // We might sort our branches here, but we expect Blink gives us a reasonable x,y order.
-    // Skipping a call to sort (in Y) here resulted in a 17% win for recording with negligible
-    // difference in playback speed.
-    int remainder   = (int)branches->size() % kMaxChildren;
-    int newBranches = 0;
-
-    if (remainder > 0) {
-        // If the remainder isn't enough to fill a node, we'll add fewer nodes to other branches.
-        if (remainder >= kMinChildren) {
-            remainder = 0;
-        } else {
-            remainder = kMinChildren - remainder;
-        }
+void SkRTree::search(int nodeIndex, const SkRect& query, std::vector<int>* results) const {
+    using V = skvx::Vec<kMaxChildren, float>;
+    const Node& node = fNodes[nodeIndex];
+
+    // The same strict test as SkRect::Intersects(); neither the children nor the query are empty.
+    const auto hit = (V::Load(node.fLeft) < query.fRight ) & (query.fLeft < V::Load(node.fRight )) &
+                     (V::Load(node.fTop ) < query.fBottom) & (query.fTop  < V::Load(node.fBottom));
+
+    // Narrow each all-ones or all-zeros lane to a byte, then gather one bit per lane.
+    uint64_t bytes[2];
+    skvx::cast<uint8_t>(hit).store(bytes);
+    uint32_t mask = 0;
+    for (int half = 0; half < 2; half++) {
+        mask |= (uint32_t)(((bytes[half] & 0x0101010101010101) * 0x0102040810204080) >> 56)
+                << (8 * half);
     }
 
-    int currentBranch = 0;
-    while (currentBranch < (int)branches->size()) {
-        int incrementBy = kMaxChildren;
-        if (remainder != 0) {
-            // if need be, omit some nodes to make up for remainder
-            if (remainder <= kMaxChildren - kMinChildren) {
-                incrementBy -= remainder;
-                remainder = 0;
-            } else {
-                incrementBy = kMinChildren;
-                remainder -= kMaxChildren - kMinChildren;
-            }
+    const int first = node.fFirstChild;
+    if (nodeIndex < fLeafCount) {
+        for (; mask; mask &= mask - 1) {
+            results->push_back(fOps[first + SkCTZ(mask)]);
         }
-        Node* n = allocateNodeAtLevel(level);
-        n->fNumChildren = 1;
-        n->fChildren[0] = (*branches)[currentBranch];
-        Branch b;
-        b.fBounds = (*branches)[currentBranch].fBounds;
-        b.fSubtree = n;
-        ++currentBranch;
-        for (int k = 1; k < incrementBy && currentBranch < (int)branches->size(); ++k) {
-            b.fBounds.join((*branches)[currentBranch].fBounds);
-            n->fChildren[k] = (*branches)[currentBranch];
-            ++n->fNumChildren;
-            ++currentBranch;
+    } else {
+        for (; mask; mask &= mask - 1) {
+            this->search(first + SkCTZ(mask), query, results);
         }
-        (*branches)[newBranches] = b;
-        ++newBranches;
     }
-    branches->resize(newBranches);
-    return this->bulkLoad(branches, level + 1);
 }
 
-void SkRTree::search(const SkRect& query, std::vector<int>* results) const {
-    if (fCount > 0 && SkRect::Intersects(fRoot.fBounds, query)) {
-        this->search(fRoot.fSubtree, query, results);
+void SkRTree::partition(const SkIRect& area, SkISize tileSize, SkScalar outset,
+                        std::vector<std::vector<int>>* buckets) const {
+    SkASSERT(!tileSize.isEmpty());
+    int tilesX = 0, tilesY = 0;
+    if (!area.isEmpty()) {
+        tilesX = (area.width()  + tileSize.width()  - 1) / tileSize.width();
+        tilesY = (area.height() + tileSize.height() - 1) / tileSize.height();
+    }
+    buckets->resize(tilesX * tilesY);
+    for (std::vector<int>& bucket : *buckets) {
+        bucket.clear();
+    }
+
+    const SkRect query = SkRect::Make(area).makeOutset(outset, outset);
+    if (fCount == 0 || !SkRect::Intersects(fBounds, query)) {
+        return;
     }
-}
 
-void SkRTree::search(Node* node, const SkRect& query, std::vector<int>* results) const {
-    for (int i = 0; i < node->fNumChildren; ++i) {
-        if (SkRect::Intersects(node->fChildren[i].fBounds, query)) {
-            if (0 == node->fLevel) {
-                results->push_back(node->fChildren[i].fOpIndex);
-            } else {
-                this->search(node->fChildren[i].fSubtree, query, results);
+    // Tile t spans [area.fLeft + tx*w - outset, area.fLeft + (tx+1)*w + outset) horizontally (with
+    // the last column ending at area.fRight + outset instead), and likewise vertically. Solving
+    // the strict intersection test for tx gives the first and last tile a box touches. Doubles
+    // hold these quotients exactly enough that we never miss a tile.
+    auto first_tile = [](double lo, double origin, double outset, int size) {
+        return (int)std::floor((lo - origin - outset) / size);
+    };
+    auto last_tile = [](double hi, double origin, double outset, int size) {
+        return (int)std::ceil((hi - origin + outset) / size) - 1;
+    };
+
+    for (int n = 0; n < fLeafCount; n++) {
+        const Node& node = fNodes[n];
+        for (int i = 0; i < node.fNumChildren; i++) {
+            const SkRect box = {node.fLeft[i], node.fTop[i], node.fRight[i], node.fBottom[i]};
+            if (!SkRect::Intersects(box, query)) {
+                continue;
+            }
+            const int w = tileSize.width(),
+                      h = tileSize.height();
+            const int x0 = std::max(first_tile(box.fLeft,   area.fLeft, outset, w), 0),
+                      x1 = std::min(last_tile (box.fRight,  area.fLeft, outset, w), tilesX - 1),
+                      y0 = std::max(first_tile(box.fTop,    area.fTop,  outset, h), 0),
+                      y1 = std::min(last_tile (box.fBottom, area.fTop,  outset, h), tilesY - 1);
+            const int op = fOps[node.fFirstChild + i];
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    (*buckets)[y * tilesX + x].push_back(op);
+                }
             }
         }
     }
+
+    if (fOrdering == Ordering::kHilbert) {
+        for (std::vector<int>& bucket : *buckets) {
+            std::sort(bucket.begin(), bucket.end());
+        }
+    }
 }
 
 size_t SkRTree::bytesUsed() const {
     size_t byteCount = sizeof(SkRTree);
 
     byteCount += fNodes.capacity() * sizeof(Node);
+    byteCount += fOps.capacity() * sizeof(int);
 
     return byteCount;
 }
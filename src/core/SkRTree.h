@@ -10,73 +10,84 @@
 
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
+
+#include <cstddef>
+#include <vector>
 
 /**
  * An R-Tree implementation. In short, it is a balanced n-ary tree containing a hierarchy of
  * bounding rectangles.
  *
- * It only supports bulk-loading, i.e. creation from a batch of bounding rectangles.
- * This performs a bottom-up bulk load using the STR (sort-tile-recursive) algorithm.
- *
- * TODO: Experiment with other bulk-load algorithms (in particular the Hilbert pack variant,
- * which groups rects by position on the Hilbert curve, is probably worth a look). There also
- * exist top-down bulk load variants (VAMSplit, TopDownGreedy, etc).
+ * It only supports bulk-loading, i.e. creation from a batch of bounding rectangles. The leaves
+ * are ordered along a Hilbert curve through their centers (the Hilbert pack variant), then packed
+ * bottom-up into full nodes, so the whole tree lives in one flat array with each level stored
+ * contiguously. Each node keeps its children's bounds as structure-of-arrays, so a query tests
+ * all of a node's children with a few vector compares.
  *
  * For more details see:
  *
+ *  Kamel, I.; Faloutsos, C. (1993). "On packing R-trees"
  *  Beckmann, N.; Kriegel, H. P.; Schneider, R.; Seeger, B. (1990). "The R*-tree:
  *      an efficient and robust access method for points and rectangles"
  */
 class SkRTree : public SkBBoxHierarchy {
 public:
-    SkRTree();
+    enum class Ordering {
+        kHilbert,         // Group boxes by position; tighter nodes for scattered content.
+        kInsertionOrder,  // Keep boxes in the order given; cheaper to build, results need no sort.
+    };
+
+    explicit SkRTree(Ordering = Ordering::kHilbert);
 
     void insert(const SkRect[], int N) override;
     void search(const SkRect& query, std::vector<int>* results) const override;
     size_t bytesUsed() const override;
 
+    /**
+     *  Splits area into a grid of tileSize tiles, stored row by row, and fills (*buckets)[t] with
+     *  the indices of the boxes that search() would find for tile t (clipped to area) outset by
+     *  outset, in increasing order. This takes one walk over the leaves rather than a search per
+     *  tile, and leaves each bucket ready for a separate thread to play back.
+     */
+    void partition(const SkIRect& area, SkISize tileSize, SkScalar outset,
+                   std::vector<std::vector<int>>* buckets) const;
+
     // Methods and constants below here are only public for tests.
 
     // Return the depth of the tree structure.
-    int getDepth() const { return fCount ? fRoot.fSubtree->fLevel + 1 : 0; }
+    int getDepth() const { return fDepth; }
     // Insertion count (not overall node count, which may be greater).
     int getCount() const { return fCount; }
 
-    // These values were empirically determined to produce reasonable performance in most cases.
-    static const int kMinChildren = 6,
-                     kMaxChildren = 11;
+    // Each level's children are spread evenly over as few nodes as possible, so every node but
+    // the root has between kMinChildren and kMaxChildren children.
+    static const int kMinChildren = 8,
+                     kMaxChildren = 16;
 
 private:
-    struct Node;
-
-    struct Branch {
-        union {
-            Node* fSubtree;
-            int fOpIndex;
-        };
-        SkRect fBounds;
-    };
-
     struct Node {
-        uint16_t fNumChildren;
-        uint16_t fLevel;
-        Branch fChildren[kMaxChildren];
+        // Unused slots hold inverted bounds, which never intersect anything.
+        float fLeft  [kMaxChildren];
+        float fTop   [kMaxChildren];
+        float fRight [kMaxChildren];
+        float fBottom[kMaxChildren];
+        int   fFirstChild;   // Index into fOps for leaves, into fNodes otherwise.
+        int   fNumChildren;
     };
 
-    void search(Node* root, const SkRect& query, std::vector<int>* results) const;
-
-    // Consumes the input array.
-    Branch bulkLoad(std::vector<Branch>* branches, int level = 0);
-
-    // How many times will bulkLoad() call allocateNodeAtLevel()?
-    static int CountNodes(int branches);
+    void search(int nodeIndex, const SkRect& query, std::vector<int>* results) const;
 
-    Node* allocateNodeAtLevel(uint16_t level);
+    const Ordering fOrdering;
 
     // This is the count of data elements (rather than total nodes in the tree)
-    int fCount;
-    Branch fRoot;
-    std::vector<Node> fNodes;
+    int fCount = 0;
+    int fDepth = 0;
+    int fLeafCount = 0;
+    SkRect fBounds = SkRect::MakeEmpty();
+    std::vector<Node> fNodes;  // The leaves, then each level above them; the root is last.
+    std::vector<int>  fOps;    // The inserted indices, in leaf order.
 };
 
 #endif
@@ -12,11 +12,14 @@
 #include "include/core/SkMatrix.h"
 #include "include/private/base/SkTemplates.h"
 #include "modules/skcms/skcms.h"
+#include "include/private/base/SkTArray.h"
 #include "src/base/SkVx.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkOpts.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <vector>
 
@@ -24,6 +27,8 @@ using namespace skia_private;
 using Op = SkRasterPipelineOp;
 
 bool gForceHighPrecisionRasterPipeline;
+bool gDisableRasterPipelineStageFusion;
+bool gDisableRasterPipelineProgramTemplates;
 
 SkRasterPipeline::SkRasterPipeline(SkArenaAlloc* alloc) : fAlloc(alloc) {
     this->reset();
@@ -32,6 +37,17 @@ void SkRasterPipeline::reset() {
     fRewindCtx = nullptr;
     fStages    = nullptr;
     fNumStages = 0;
+    fOpHash    = 0;
+}
+
+// Programs are built from the op list and from which stages have contexts (fused stages pick
+// whichever context is non-null), so that is all the op hash covers.
+static uint16_t stage_key(SkRasterPipelineOp op, const void* ctx) {
+    return (uint16_t)(((int)op << 1) | (ctx ? 1 : 0));
+}
+
+static uint32_t hash_stage(uint32_t hash, SkRasterPipelineOp op, const void* ctx) {
+    return (hash ^ stage_key(op, ctx)) * 16777619;
 }
 
 void SkRasterPipeline::append(SkRasterPipelineOp op, void* ctx) {
@@ -51,6 +67,7 @@ void SkRasterPipeline::append(SkRasterPipelineOp op, void* ctx) {
 void SkRasterPipeline::unchecked_append(SkRasterPipelineOp op, void* ctx) {
     fStages = fAlloc->make<StageList>(StageList{fStages, op, ctx});
     fNumStages += 1;
+    fOpHash = hash_stage(fOpHash, op, ctx);
 }
 void SkRasterPipeline::append(SkRasterPipelineOp op, uintptr_t ctx) {
     void* ptrCtx;
@@ -88,6 +105,9 @@ void SkRasterPipeline::extend(const SkRasterPipeline& src) {
 
     fStages = &stages[src.fNumStages - 1];
     fNumStages += src.fNumStages;
+    for (int i = 0; i < src.fNumStages; ++i) {
+        fOpHash = hash_stage(fOpHash, stages[i].stage, stages[i].ctx);
+    }
 }
 
 const char* SkRasterPipeline::GetOpName(SkRasterPipelineOp op) {
@@ -411,14 +431,70 @@ static void prepend_to_pipeline(SkRasterPipelineStage*& ip, SkOpts::StageFn stag
     ip->ctx = ctx;
 }
 
-bool SkRasterPipeline::build_lowp_pipeline(SkRasterPipelineStage* ip) const {
+// Sequences of two stages which have a single fused stage doing the same work. Exactly one stage
+// of each pair takes a context, and the fused stage takes that same context.
+static constexpr struct {
+    Op first, second, fused;
+} kFusedStages[] = {
+    {Op::load_8888,     Op::premul,            Op::load_8888_premul},
+    {Op::load_8888,     Op::swap_rb,           Op::load_bgra_8888},
+    {Op::load_8888_dst, Op::swap_rb_dst,       Op::load_bgra_8888_dst},
+    {Op::swap_rb,       Op::store_8888,        Op::store_bgra_8888},
+    {Op::swap_rb,       Op::srcover_rgba_8888, Op::srcover_bgra_8888},
+};
+
+const SkRasterPipeline::StageList* SkRasterPipeline::fuse_stages(const StageList* stages,
+                                                                 StageList* storage,
+                                                                 int* numStages) const {
+    *numStages = fNumStages;
+    if (gDisableRasterPipelineStageFusion) {
+        return stages;
+    }
+
+    // Like fStages, the fused list is built back to front.
+    StageList* head = nullptr;
+    StageList** link = &head;
+    int count = 0;
+    for (const StageList* st = stages; st; st = st->prev) {
+        if ((int)st->stage >= kNumRasterPipelineLowpOps) {
+            // SkSL branch stages jump a fixed number of stages, which fusion would throw off.
+            // None of the highp-only stages can be fused anyway, so leave these pipelines alone.
+            return stages;
+        }
+        Op op = st->stage;
+        void* ctx = st->ctx;
+        if (const StageList* prev = st->prev) {
+            for (const auto& f : kFusedStages) {
+                if (prev->stage == f.first && st->stage == f.second) {
+                    op  = f.fused;
+                    ctx = prev->ctx ? prev->ctx : st->ctx;
+                    st  = prev;
+                    break;
+                }
+            }
+        }
+        StageList* node = &storage[count++];
+        *node = StageList{nullptr, op, ctx};
+        *link = node;
+        link = &node->prev;
+    }
+
+    if (count == fNumStages) {
+        return stages;
+    }
+    *numStages = count;
+    return head;
+}
+
+bool SkRasterPipeline::build_lowp_pipeline(const StageList* stages,
+                                           SkRasterPipelineStage* ip) const {
     if (gForceHighPrecisionRasterPipeline || fRewindCtx) {
         return false;
     }
     // Stages are stored backwards in fStages; to compensate, we assemble the pipeline in reverse
     // here, back to front.
     prepend_to_pipeline(ip, SkOpts::just_return_lowp, /*ctx=*/nullptr);
-    for (const StageList* st = fStages; st; st = st->prev) {
+    for (const StageList* st = stages; st; st = st->prev) {
         int opIndex = (int)st->stage;
         if (opIndex >= kNumRasterPipelineLowpOps || !SkOpts::ops_lowp[opIndex]) {
             // This program contains a stage that doesn't exist in lowp.
@@ -429,10 +505,11 @@ bool SkRasterPipeline::build_lowp_pipeline(SkRasterPipelineStage* ip) const {
     return true;
 }
 
-void SkRasterPipeline::build_highp_pipeline(SkRasterPipelineStage* ip) const {
+void SkRasterPipeline::build_highp_pipeline(const StageList* stages,
+                                            SkRasterPipelineStage* ip) const {
     // We assemble the pipeline in reverse, since the stage list is stored backwards.
     prepend_to_pipeline(ip, SkOpts::just_return_highp, /*ctx=*/nullptr);
-    for (const StageList* st = fStages; st; st = st->prev) {
+    for (const StageList* st = stages; st; st = st->prev) {
         int opIndex = (int)st->stage;
         prepend_to_pipeline(ip, SkOpts::ops_highp[opIndex], st->ctx);
     }
@@ -448,19 +525,19 @@ void SkRasterPipeline::build_highp_pipeline(SkRasterPipelineStage* ip) const {
 }
 
 SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(
-        SkRasterPipelineStage* ip) const {
+        const StageList* stages, SkRasterPipelineStage* ip) const {
     // We try to build a lowp pipeline first; if that fails, we fall back to a highp float pipeline.
-    if (this->build_lowp_pipeline(ip)) {
+    if (this->build_lowp_pipeline(stages, ip)) {
         return SkOpts::start_pipeline_lowp;
     }
 
-    this->build_highp_pipeline(ip);
+    this->build_highp_pipeline(stages, ip);
     return SkOpts::start_pipeline_highp;
 }
 
-int SkRasterPipeline::stages_needed() const {
+int SkRasterPipeline::stages_needed(int numStages) const {
     // Add 1 to budget for a `just_return` stage at the end.
-    int stages = fNumStages + 1;
+    int stages = numStages + 1;
 
     // If we have any stack_rewind stages, we will need to inject a stack_checkpoint stage.
     if (fRewindCtx) {
@@ -469,17 +546,120 @@ int SkRasterPipeline::stages_needed() const {
     return stages;
 }
 
+struct SkRasterPipeline::ProgramTemplate {
+    uint32_t        fOpHash = 0;
+    uint8_t         fFlags  = 0;
+    StartPipelineFn fStart  = nullptr;
+    // stage_key() of each stage, back to front like fStages.
+    TArray<uint16_t> fStageKeys;
+    // The stage function of each program slot, and where its context comes from: 0 for none,
+    // kRewindCtx for fRewindCtx, otherwise the 1-based index of a stage (back to front).
+    TArray<SkOpts::StageFn> fFns;
+    TArray<int>             fCtxIndex;
+
+    static constexpr int kRewindCtx = -1;
+};
+
+static std::atomic<int64_t> gProgramTemplateHits{0};
+static std::atomic<int64_t> gProgramTemplateMisses{0};
+static thread_local SkRasterPipeline::ProgramCacheStats tProgramTemplateStats = {0, 0};
+
+SkRasterPipeline::ProgramCacheStats SkRasterPipeline::GetProgramCacheStats() {
+    return {gProgramTemplateHits.load(std::memory_order_relaxed),
+            gProgramTemplateMisses.load(std::memory_order_relaxed)};
+}
+
+SkRasterPipeline::ProgramCacheStats SkRasterPipeline::GetThreadProgramCacheStats() {
+    return tProgramTemplateStats;
+}
+
+const SkRasterPipeline::ProgramTemplate* SkRasterPipeline::find_or_build_template() const {
+    // Each thread keeps its own direct-mapped set of templates, so lookups never take a lock.
+    static constexpr int kNumTemplates = 64;
+    static thread_local ProgramTemplate tTemplates[kNumTemplates];
+
+    const uint8_t flags = (gForceHighPrecisionRasterPipeline ? 1 : 0) |
+                          (gDisableRasterPipelineStageFusion ? 2 : 0) |
+                          (fRewindCtx                        ? 4 : 0);
+    ProgramTemplate* tmpl = &tTemplates[SkChecksum::CheapMix(fOpHash) % kNumTemplates];
+
+    // gDisableRasterPipelineProgramTemplates makes every lookup miss, to measure a cold build.
+    if (!gDisableRasterPipelineProgramTemplates &&
+        tmpl->fStart && tmpl->fOpHash == fOpHash && tmpl->fFlags == flags &&
+        tmpl->fStageKeys.size() == fNumStages) {
+        int i = 0;
+        for (const StageList* st = fStages; st; st = st->prev, ++i) {
+            if (tmpl->fStageKeys[i] != stage_key(st->stage, st->ctx)) {
+                break;
+            }
+        }
+        if (i == fNumStages) {
+            gProgramTemplateHits.fetch_add(1, std::memory_order_relaxed);
+            tProgramTemplateStats.fHits++;
+            return tmpl;
+        }
+    }
+    gProgramTemplateMisses.fetch_add(1, std::memory_order_relaxed);
+    tProgramTemplateStats.fMisses++;
+
+    // Build the program from a copy of the stage list whose contexts are replaced by stage
+    // indices; those come out in the program slots wherever the real contexts would have gone.
+    AutoSTMalloc<32, StageList> indexed(fNumStages);
+    tmpl->fStageKeys.clear();
+    int i = 0;
+    for (const StageList* st = fStages; st; st = st->prev, ++i) {
+        void* index = st->ctx ? reinterpret_cast<void*>((uintptr_t)(i + 1)) : nullptr;
+        indexed[i] = StageList{i + 1 < fNumStages ? &indexed[i + 1] : nullptr, st->stage, index};
+        tmpl->fStageKeys.push_back(stage_key(st->stage, st->ctx));
+    }
+
+    AutoSTMalloc<32, StageList> fused(fNumStages);
+    int numStages;
+    const StageList* stages = this->fuse_stages(indexed.get(), fused.get(), &numStages);
+
+    int stagesNeeded = this->stages_needed(numStages);
+    AutoSTMalloc<32, SkRasterPipelineStage> program(stagesNeeded);
+    tmpl->fStart = this->build_pipeline(stages, program.get() + stagesNeeded);
+
+    tmpl->fFns.clear();
+    tmpl->fCtxIndex.clear();
+    for (int slot = 0; slot < stagesNeeded; ++slot) {
+        tmpl->fFns.push_back(program[slot].fn);
+        tmpl->fCtxIndex.push_back(program[slot].ctx == fRewindCtx && fRewindCtx
+                                          ? ProgramTemplate::kRewindCtx
+                                          : (int)reinterpret_cast<uintptr_t>(program[slot].ctx));
+    }
+    tmpl->fOpHash = fOpHash;
+    tmpl->fFlags  = flags;
+    return tmpl;
+}
+
+SkRasterPipeline::StartPipelineFn SkRasterPipeline::instantiate(
+        const ProgramTemplate* tmpl, SkRasterPipelineStage* program) const {
+    AutoSTMalloc<32, void*> ctxs(fNumStages + 1);
+    ctxs[0] = nullptr;
+    int i = 1;
+    for (const StageList* st = fStages; st; st = st->prev) {
+        ctxs[i++] = st->ctx;
+    }
+    for (int slot = 0; slot < tmpl->fFns.size(); ++slot) {
+        int index = tmpl->fCtxIndex[slot];
+        program[slot].fn  = tmpl->fFns[slot];
+        program[slot].ctx = index == ProgramTemplate::kRewindCtx ? fRewindCtx : ctxs[index];
+    }
+    return tmpl->fStart;
+}
+
 void SkRasterPipeline::run(size_t x, size_t y, size_t w, size_t h) const {
     if (this->empty()) {
         return;
     }
 
-    int stagesNeeded = this->stages_needed();
-
     // Best to not use fAlloc here... we can't bound how often run() will be called.
-    AutoSTMalloc<32, SkRasterPipelineStage> program(stagesNeeded);
+    const ProgramTemplate* tmpl = this->find_or_build_template();
+    AutoSTMalloc<32, SkRasterPipelineStage> program(tmpl->fFns.size());
 
-    auto start_pipeline = this->build_pipeline(program.get() + stagesNeeded);
+    auto start_pipeline = this->instantiate(tmpl, program.get());
     start_pipeline(x,y,x+w,y+h, program.get());
 }
 
@@ -488,11 +668,10 @@ std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile()
         return [](size_t, size_t, size_t, size_t) {};
     }
 
-    int stagesNeeded = this->stages_needed();
-
-    SkRasterPipelineStage* program = fAlloc->makeArray<SkRasterPipelineStage>(stagesNeeded);
+    const ProgramTemplate* tmpl = this->find_or_build_template();
+    SkRasterPipelineStage* program = fAlloc->makeArray<SkRasterPipelineStage>(tmpl->fFns.size());
 
-    auto start_pipeline = this->build_pipeline(program + stagesNeeded);
+    auto start_pipeline = this->instantiate(tmpl, program);
     return [=](size_t x, size_t y, size_t w, size_t h) {
         start_pipeline(x,y,x+w,y+h, program);
     };
@@ -87,6 +87,18 @@ public:
     // Allocates a thunk which amortizes run() setup cost in alloc.
     std::function<void(size_t, size_t, size_t, size_t)> compile() const;
 
+    // run() and compile() build programs from per-thread templates keyed on the op list, so a
+    // pipeline with the same ops as one built before on this thread (e.g. the same shader, color
+    // filter and blend mode with new uniforms) only has its contexts patched in.
+    // GetProgramCacheStats() counts template lookups across all threads, and
+    // GetThreadProgramCacheStats() only those made on the calling thread.
+    struct ProgramCacheStats {
+        int64_t fHits;
+        int64_t fMisses;
+    };
+    static ProgramCacheStats GetProgramCacheStats();
+    static ProgramCacheStats GetThreadProgramCacheStats();
+
     // Callers can inspect the stage list for debugging purposes.
     struct StageList {
         StageList*          prev;
@@ -133,19 +145,30 @@ public:
     bool empty() const { return fStages == nullptr; }
 
 private:
-    bool build_lowp_pipeline(SkRasterPipelineStage* ip) const;
-    void build_highp_pipeline(SkRasterPipelineStage* ip) const;
+    // Returns `stages` with common sequences of stages replaced by fused stages, using `storage`
+    // (room for getNumStages() entries) if anything was fused.
+    const StageList* fuse_stages(const StageList* stages, StageList* storage,
+                                 int* numStages) const;
+
+    bool build_lowp_pipeline(const StageList*, SkRasterPipelineStage* ip) const;
+    void build_highp_pipeline(const StageList*, SkRasterPipelineStage* ip) const;
 
     using StartPipelineFn = void(*)(size_t,size_t,size_t,size_t, SkRasterPipelineStage* program);
-    StartPipelineFn build_pipeline(SkRasterPipelineStage*) const;
+    StartPipelineFn build_pipeline(const StageList*, SkRasterPipelineStage*) const;
+
+    // Returns the program template for this op list, building it on a miss.
+    struct ProgramTemplate;
+    const ProgramTemplate* find_or_build_template() const;
+    StartPipelineFn instantiate(const ProgramTemplate*, SkRasterPipelineStage* program) const;
 
     void unchecked_append(SkRasterPipelineOp, void*);
-    int stages_needed() const;
+    int stages_needed(int numStages) const;
 
     SkArenaAlloc*               fAlloc;
     SkRasterPipeline_RewindCtx* fRewindCtx;
     StageList*                  fStages;
     int                         fNumStages;
+    uint32_t                    fOpHash;  // covers each stage's op and whether it has a context
 };
 
 template <size_t bytes>
@@ -51,9 +51,11 @@ public:
     void blitMask  (const SkMask&, const SkIRect& clip)             override;
     void blitRect  (int x, int y, int width, int height)            override;
     void blitV     (int x, int y, int height, SkAlpha alpha)        override;
+    bool setSolidColor(const SkColor4f&)                            override;
 
 private:
     void blitRectWithTrace(int x, int y, int w, int h, bool trace);
+    void storeMemsetColor();
     void append_load_dst      (SkRasterPipeline*) const;
     void append_store         (SkRasterPipeline*) const;
 
@@ -79,6 +81,11 @@ private:
     void   (*fMemset2D)(SkPixmap*, int x,int y, int w,int h, uint64_t color) = nullptr;
     uint64_t fMemsetColor = 0;   // Big enough for largest memsettable dst format, F16.
 
+    // When the color pipeline is just the paint color, that color's stage and context, which
+    // setSolidColor() rewrites to draw with another color.
+    SkRasterPipelineOp                fPaintColorStage;
+    SkRasterPipeline_UniformColorCtx* fPaintColor = nullptr;
+
     // Built lazily on first use.
     std::function<void(size_t, size_t, size_t, size_t)> fBlitRect,
                                                         fBlitAntiH,
@@ -94,13 +101,30 @@ private:
     using INHERITED = SkBlitter;
 };
 
-static SkColor4f paint_color_to_dst(const SkPaint& paint, const SkPixmap& dst) {
-    SkColor4f paintColor = paint.getColor4f();
+static SkColor4f paint_color_to_dst(SkColor4f paintColor, const SkPixmap& dst) {
     SkColorSpaceXformSteps(sk_srgb_singleton(), kUnpremul_SkAlphaType,
                            dst.colorSpace(),    kUnpremul_SkAlphaType).apply(paintColor.vec());
     return paintColor;
 }
 
+static SkColor4f paint_color_to_dst(const SkPaint& paint, const SkPixmap& dst) {
+    return paint_color_to_dst(paint.getColor4f(), dst);
+}
+
+// Folds a constant color pipeline into the color it produces, clamped for dst.
+static SkColor4f fold_constant_color(SkRasterPipeline* colorPipeline, const SkImageInfo& dst) {
+    SkColor4f constantColor;
+    SkRasterPipeline_MemoryCtx constantColorPtr = { &constantColor, 0 };
+    // We could remove this clamp entirely, but if the destination is 8888, doing the clamp
+    // here allows the color pipeline to still run in lowp (we'll use uniform_color, rather than
+    // unbounded_uniform_color).
+    colorPipeline->append_clamp_if_normalized(dst);
+    colorPipeline->append(SkRasterPipelineOp::store_f32, &constantColorPtr);
+    colorPipeline->run(0,0,1,1);
+    colorPipeline->reset();
+    return constantColor;
+}
+
 SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap& dst,
                                          const SkPaint& paint,
                                          const SkMatrix& ctm,
@@ -254,17 +278,16 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
 
     // Optimization: A pipeline that's still constant here can collapse back into a constant color.
     if (is_constant) {
-        SkColor4f constantColor;
-        SkRasterPipeline_MemoryCtx constantColorPtr = { &constantColor, 0 };
-        // We could remove this clamp entirely, but if the destination is 8888, doing the clamp
-        // here allows the color pipeline to still run in lowp (we'll use uniform_color, rather than
-        // unbounded_uniform_color).
-        colorPipeline->append_clamp_if_normalized(dst.info());
-        colorPipeline->append(SkRasterPipelineOp::store_f32, &constantColorPtr);
-        colorPipeline->run(0,0,1,1);
-        colorPipeline->reset();
+        SkColor4f constantColor = fold_constant_color(colorPipeline, dst.info());
         colorPipeline->append_constant_color(alloc, constantColor);
 
+        // Without a shader or color filter that color came from the paint alone.
+        const SkRasterPipeline::StageList* stage = colorPipeline->getStageList();
+        if (!paint.getShader() && !paint.getColorFilter() && paint.asBlendMode() && stage->ctx) {
+            blitter->fPaintColorStage = stage->stage;
+            blitter->fPaintColor = static_cast<SkRasterPipeline_UniformColorCtx*>(stage->ctx);
+        }
+
         is_opaque = constantColor.fA == 1.0f;
     }
 
@@ -285,13 +308,7 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
     // (The previous two optimizations help find more opportunities for this one.)
     if (is_constant && as_BB(blender)->asBlendMode() == SkBlendMode::kSrc &&
         dst.info().bytesPerPixel() <= static_cast<int>(sizeof(blitter->fMemsetColor))) {
-        // Run our color pipeline all the way through to produce what we'd memset when we can.
-        // Not all blits can memset, so we need to keep colorPipeline too.
-        SkRasterPipeline_<256> p;
-        p.extend(*colorPipeline);
-        blitter->fDstPtr = SkRasterPipeline_MemoryCtx{&blitter->fMemsetColor, 0};
-        blitter->append_store(&p);
-        p.run(0,0,1,1);
+        blitter->storeMemsetColor();
 
         switch (blitter->fDst.shiftPerPixel()) {
             case 0: blitter->fMemset2D = [](SkPixmap* dst, int x,int y, int w,int h, uint64_t c) {
@@ -336,6 +353,44 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
     return blitter;
 }
 
+void SkRasterPipelineBlitter::storeMemsetColor() {
+    // Run our color pipeline all the way through to produce what we'd memset when we can.
+    // Not all blits can memset, so we need to keep fColorPipeline too.
+    SkRasterPipeline_<256> p;
+    p.extend(fColorPipeline);
+    SkRasterPipeline_MemoryCtx dstPtr = fDstPtr;
+    fDstPtr = SkRasterPipeline_MemoryCtx{&fMemsetColor, 0};
+    this->append_store(&p);
+    p.run(0,0,1,1);
+    fDstPtr = dstPtr;
+}
+
+bool SkRasterPipelineBlitter::setSolidColor(const SkColor4f& color) {
+    if (!fPaintColor) {
+        return false;
+    }
+
+    // Fold the new color just as Create() folded the first one...
+    SkSTArenaAlloc<256> alloc;
+    SkRasterPipeline p(&alloc);
+    p.append_constant_color(&alloc, paint_color_to_dst(color, fDst).premul().vec());
+    SkColor4f constantColor = fold_constant_color(&p, fDst.info());
+
+    // ...and only take it if it would have been drawn with the same stage and blend mode.
+    p.append_constant_color(&alloc, constantColor);
+    const SkRasterPipeline::StageList* stage = p.getStageList();
+    if (stage->stage != fPaintColorStage || !stage->ctx ||
+        (constantColor.fA == 1.0f) != (fPaintColor->a == 1.0f)) {
+        return false;
+    }
+    *fPaintColor = *static_cast<const SkRasterPipeline_UniformColorCtx*>(stage->ctx);
+
+    if (fMemset2D) {
+        this->storeMemsetColor();
+    }
+    return true;
+}
+
 void SkRasterPipelineBlitter::append_load_dst(SkRasterPipeline* p) const {
     p->append_load_dst(fDst.info().colorType(), &fDstPtr);
     if (fDst.info().alphaType() == kUnpremul_SkAlphaType) {
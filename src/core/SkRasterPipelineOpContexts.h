@@ -8,6 +8,8 @@
 #ifndef SkRasterPipelineOpContexts_DEFINED
 #define SkRasterPipelineOpContexts_DEFINED
 
+#include "include/core/SkTypes.h"
+
 #include <cstddef>
 
 namespace SkSL { class TraceHook; }
@@ -17,7 +19,15 @@ namespace SkSL { class TraceHook; }
 // by stages that have no lowp implementation. They can therefore use the (smaller) highp value to
 // save memory in the arena.
 inline static constexpr int SkRasterPipeline_kMaxStride = 16;
+
+// Highp runs 16 pixels at a time only in the AVX-512 (skx) stages. Those are built into x86 builds
+// and chosen at runtime, so any x86 build needs contexts with room for them. Everywhere else highp
+// is at most 8 pixels wide.
+#if defined(SK_CPU_X86)
+inline static constexpr int SkRasterPipeline_kMaxStride_highp = 16;
+#else
 inline static constexpr int SkRasterPipeline_kMaxStride_highp = 8;
+#endif
 
 // These structs hold the context data for many of the Raster Pipeline ops.
 struct SkRasterPipeline_MemoryCtx {
@@ -37,6 +37,9 @@
     M(darken) M(difference)                                        \
     M(exclusion) M(hardlight) M(lighten) M(overlay)                \
     M(srcover_rgba_8888)                                           \
+    M(load_8888_premul)                                            \
+    M(load_bgra_8888) M(load_bgra_8888_dst) M(store_bgra_8888)     \
+    M(srcover_bgra_8888)                                           \
     M(matrix_translate) M(matrix_scale_translate)                  \
     M(matrix_2x3)                                                  \
     M(matrix_perspective)                                          \
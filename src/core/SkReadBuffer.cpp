@@ -315,6 +315,17 @@ const void* SkReadBuffer::skipByteArray(size_t* size) {
 }
 
 sk_sp<SkData> SkReadBuffer::readByteArrayAsData() {
+    if (fMemoryOwner) {
+        size_t numBytes;
+        const void* bytes = this->skipByteArray(&numBytes);
+        if (!bytes) {
+            return nullptr;
+        }
+        return SkData::MakeSubset(fMemoryOwner.get(),
+                                  (const uint8_t*)bytes - fMemoryOwner->bytes(),
+                                  numBytes);
+    }
+
     size_t numBytes = this->getArrayCount();
     if (!this->validate(this->isAvailable(numBytes))) {
         return nullptr;
@@ -10,6 +10,7 @@
 
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkData.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkPaint.h"
@@ -35,9 +36,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <utility>
 
 class SkBlender;
-class SkData;
 class SkImage;
 class SkM44;
 class SkMaskFilter;
@@ -185,6 +186,17 @@ public:
         fFactoryCount = count;
     }
 
+    /**
+     *  Call this if the buffer's memory belongs to data, which must outlive any reference
+     *  to it. Byte arrays read with readByteArrayAsData(), e.g. encoded images, then refer
+     *  to data instead of being copied out of it.
+     */
+    void setMemoryOwner(sk_sp<SkData> data) {
+        SkASSERT(!data || (data->bytes() <= (const uint8_t*)fBase &&
+                           (const uint8_t*)fStop <= data->bytes() + data->size()));
+        fMemoryOwner = std::move(data);
+    }
+
     void setDeserialProcs(const SkDeserialProcs& procs);
     const SkDeserialProcs& getDeserialProcs() const { return fProcs; }
 
@@ -257,6 +269,8 @@ private:
 
     SkDeserialProcs fProcs;
 
+    sk_sp<SkData> fMemoryOwner;
+
     static bool IsPtrAlign4(const void* ptr) {
         return SkIsAlign4((uintptr_t)ptr);
     }
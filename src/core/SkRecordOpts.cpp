@@ -10,15 +10,26 @@
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkShader.h"
 #include "include/private/base/SkMath.h"
+#include "include/private/base/SkTemplates.h"
 #include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
 #include "src/core/SkRecordPattern.h"
 #include "src/core/SkRecords.h"
+#include "src/core/SkRectPriv.h"
 
+#include <climits>
 #include <cstdint>
 #include <optional>
+#include <type_traits>
 
 using namespace SkRecords;
 
@@ -254,6 +265,255 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// The passes below aren't pattern-based: they walk the record in order, tracking the matrix and
+// whether the clip may be anti-aliased, which is all they need to know about the canvas state.
+class CanvasStateTracker {
+public:
+    const SkMatrix& ctm() const { return fCTM; }
+
+    // True if the current clip may have partial coverage along its edges.
+    bool softClip() const { return fSoftClipDepth <= fDepth; }
+
+    template <typename T> void operator()(const T& op) { this->update(op); }
+
+private:
+    template <typename T> void update(const T&) {}
+
+    void update(const Save&)       { fDepth++; }
+    void update(const SaveLayer&)  { fDepth++; }
+    void update(const SaveBehind&) { fDepth++; }
+    void update(const Restore& op) {
+        fCTM = op.matrix;
+        fDepth--;
+        if (fDepth < fSoftClipDepth) {
+            fSoftClipDepth = INT_MAX;
+        }
+    }
+
+    void update(const SetMatrix& op) { fCTM = op.matrix; }
+    void update(const SetM44& op)    { fCTM = op.matrix.asM33(); }
+    void update(const Concat& op)    { fCTM.preConcat(op.matrix); }
+    void update(const Concat44& op)  { fCTM.preConcat(op.matrix.asM33()); }
+    void update(const Translate& op) { fCTM.preTranslate(op.dx, op.dy); }
+    void update(const Scale& op)     { fCTM.preScale(op.sx, op.sy); }
+
+    void update(const ClipPath& op)   { this->clip(op.opAA.aa()); }
+    void update(const ClipRRect& op)  { this->clip(op.opAA.aa()); }
+    void update(const ClipRect& op)   { this->clip(op.opAA.aa()); }
+    void update(const ClipShader&)    { this->clip(true); }
+
+    void clip(bool aa) {
+        if (aa && fSoftClipDepth > fDepth) {
+            fSoftClipDepth = fDepth;
+        }
+    }
+
+    SkMatrix fCTM = SkMatrix::I();
+    int      fDepth = 0;
+    int      fSoftClipDepth = INT_MAX;  // Shallowest save depth with an anti-aliased clip.
+};
+
+// Does drawing with this paint replace the destination, wherever it fully covers a pixel?
+static bool paint_is_opaque(const SkPaint& paint) {
+    std::optional<SkBlendMode> mode = paint.asBlendMode();
+    return paint.getAlpha() == 0xFF &&
+           (mode == SkBlendMode::kSrcOver || mode == SkBlendMode::kSrc) &&
+           !paint.getColorFilter() &&
+           (!paint.getShader() || paint.getShader()->isOpaque());
+}
+
+// Does this paint draw exactly the geometry it's given, with no fringe or post-processing?
+static bool paint_is_plain_fill(const SkPaint& paint) {
+    return paint.getStyle() == SkPaint::kFill_Style &&
+           !paint.getMaskFilter() &&
+           !paint.getPathEffect() &&
+           !paint.getImageFilter();
+}
+
+// Classifies each op for SkRecordCullOverdraw().
+class OverdrawScanner {
+public:
+    explicit OverdrawScanner(const SkRect& cullRect) : fCullRect(cullRect) {}
+
+    // The device pixels the last op fully and opaquely covered, if any.
+    const SkIRect& occluder() const { return fOccluder; }
+    // Whether removing the last op could only change the pixels it draws.
+    bool removable() const { return fRemovable; }
+    // Whether the last op may have changed the matrix, the clip, or the layer being drawn into.
+    bool barrier() const { return fBarrier; }
+
+    template <typename T> void operator()(const T& op) {
+        fOccluder = SkIRect::MakeEmpty();
+        fRemovable = false;
+        fBarrier = false;
+        this->scan(op);
+        fState(op);
+    }
+
+private:
+    template <typename T>
+    std::enable_if_t<SkToBool(T::kTags & kDraw_Tag)> scan(const T&) { fRemovable = true; }
+    template <typename T>
+    std::enable_if_t<!(T::kTags & kDraw_Tag)> scan(const T&) { fBarrier = true; }
+
+    void scan(const NoOp&) {}
+    // These draw, but may have side effects or draw beneath earlier content, so we keep them.
+    void scan(const DrawDrawable&) {}
+    void scan(const DrawPicture&) {}
+    void scan(const DrawBehind&) {}
+
+    void scan(const DrawRect& op) {
+        fRemovable = true;
+        if (paint_is_opaque(op.paint) && paint_is_plain_fill(op.paint) &&
+            !fState.softClip() && fState.ctm().rectStaysRect()) {
+            fOccluder = fState.ctm().mapRect(op.rect).roundIn();
+        }
+    }
+    void scan(const DrawPaint& op) {
+        fRemovable = true;
+        if (paint_is_opaque(op.paint) && !op.paint.getMaskFilter() &&
+            !op.paint.getImageFilter() && !fState.softClip()) {
+            fOccluder = fCullRect.roundOut();
+        }
+    }
+
+    const SkRect       fCullRect;
+    CanvasStateTracker fState;
+    SkIRect            fOccluder;
+    bool               fRemovable;
+    bool               fBarrier;
+};
+
+void SkRecordCullOverdraw(SkRecord* record, const SkRect& cullRect) {
+    const int count = record->count();
+    if (count == 0) {
+        return;
+    }
+
+    skia_private::AutoTArray<SkRect> bounds(count);
+    skia_private::AutoTMalloc<SkBBoxHierarchy::Metadata> meta(count);
+    SkRecordFillBounds(cullRect, *record, bounds.data(), meta);
+
+    skia_private::AutoTArray<SkIRect> occluders(count);
+    skia_private::AutoTArray<bool> removable(count), barrier(count);
+    OverdrawScanner scanner(cullRect);
+    for (int i = 0; i < count; i++) {
+        record->visit(i, scanner);
+        occluders[i] = scanner.occluder();
+        removable[i] = scanner.removable();
+        barrier[i]   = scanner.barrier();
+    }
+
+    // Within each run of draws sharing a matrix, clip and layer, walk backwards remembering the
+    // largest few occluders we've passed, and drop draws that fall entirely inside one of them.
+    static constexpr int kMaxOccluders = 4;
+    SkIRect live[kMaxOccluders];
+    int liveCount = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        if (barrier[i]) {
+            liveCount = 0;
+            continue;
+        }
+        if (removable[i]) {
+            const SkIRect drawn = bounds[i].roundOut();
+            bool covered = false;
+            for (int j = 0; j < liveCount && !covered; j++) {
+                covered = live[j].contains(drawn);
+            }
+            if (covered) {
+                record->replace<NoOp>(i);
+                continue;
+            }
+        }
+
+        const SkIRect& occluder = occluders[i];
+        if (occluder.isEmpty()) {
+            continue;
+        }
+        if (liveCount < kMaxOccluders) {
+            live[liveCount++] = occluder;
+        } else {
+            int smallest = 0;
+            for (int j = 1; j < kMaxOccluders; j++) {
+                if (live[j].height64() * live[j].width64() <
+                    live[smallest].height64() * live[smallest].width64()) {
+                    smallest = j;
+                }
+            }
+            if (occluder.height64() * occluder.width64() >
+                live[smallest].height64() * live[smallest].width64()) {
+                live[smallest] = occluder;
+            }
+        }
+    }
+}
+
+// Returns the DrawRect an op is, or nullptr if it's anything else.
+struct AsDrawRect {
+    const DrawRect* operator()(const DrawRect& op) { return &op; }
+    template <typename T> const DrawRect* operator()(const T&) { return nullptr; }
+};
+
+struct IsNoOp {
+    bool operator()(const NoOp&) { return true; }
+    template <typename T> bool operator()(const T&) { return false; }
+};
+
+// Returns op->rect as integers if it lands on whole pixels under ctm and may be merged.
+static std::optional<SkIRect> mergeable_rect(const DrawRect* op, const SkMatrix& ctm) {
+    if (!op || !paint_is_plain_fill(op->paint) || !ctm.isTranslate() ||
+        !SkScalarIsInt(ctm.getTranslateX()) || !SkScalarIsInt(ctm.getTranslateY())) {
+        return std::nullopt;
+    }
+    const SkIRect rect = op->rect.round();
+    if (rect.isEmpty() || SkRect::Make(rect) != op->rect) {
+        return std::nullopt;
+    }
+    return rect;
+}
+
+void SkRecordMergeDrawRects(SkRecord* record) {
+    CanvasStateTracker state;
+    for (int i = 0; i < record->count(); i++) {
+        const DrawRect* first = record->visit(i, AsDrawRect());
+        std::optional<SkIRect> rect = mergeable_rect(first, state.ctm());
+        if (!rect) {
+            record->visit(i, state);
+            continue;
+        }
+
+        // DrawRects and NoOps don't change the matrix, so the whole run shares it.
+        const bool opaque = paint_is_opaque(first->paint);
+        SkRegion region(*rect);
+        int last = i, merged = 1;
+        for (int j = i + 1; j < record->count(); j++) {
+            if (record->visit(j, IsNoOp())) {
+                continue;
+            }
+            const DrawRect* next = record->visit(j, AsDrawRect());
+            std::optional<SkIRect> nextRect = mergeable_rect(next, state.ctm());
+            if (!nextRect || next->paint != first->paint ||
+                (!opaque && region.intersects(*nextRect))) {
+                break;
+            }
+            region.op(*nextRect, SkRegion::kUnion_Op);
+            last = j;
+            merged++;
+        }
+
+        if (merged > 1) {
+            SkPaint paint = first->paint;
+            for (int j = i + 1; j <= last; j++) {
+                record->replace<NoOp>(j);
+            }
+            new (record->replace<DrawRegion>(i)) DrawRegion{std::move(paint), std::move(region)};
+        }
+        i = last;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 void SkRecordOptimize(SkRecord* record) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
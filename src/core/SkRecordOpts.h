@@ -9,6 +9,7 @@
 #define SkRecordOpts_DEFINED
 
 class SkRecord;
+struct SkRect;
 
 // Run all optimizations in recommended order.
 void SkRecordOptimize(SkRecord*);
@@ -26,4 +27,16 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
+// Turns draws that a later opaque DrawRect or DrawPaint in the same layer, and under the same
+// matrix and clip, completely covers into no-ops.  cullRect is the recording's cull rect.
+//
+// Coverage is decided in picture space, so this is exact when the picture is played back with an
+// integer translate and no anti-aliased clip; otherwise a culled draw may have shown through the
+// anti-aliased edge of the draw that covered it.
+void SkRecordCullOverdraw(SkRecord*, const SkRect& cullRect);
+
+// Merges runs of adjacent, pixel-aligned DrawRects that share a paint into a single DrawRegion.
+// Overlapping rects are only merged when the paint is opaque, so no pixel is blended twice.
+void SkRecordMergeDrawRects(SkRecord*);
+
 #endif//SkRecordOpts_DEFINED
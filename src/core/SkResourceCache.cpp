@@ -7,7 +7,9 @@
 
 #include "src/core/SkResourceCache.h"
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkTraceMemoryDump.h"
+#include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTo.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
@@ -15,6 +17,8 @@
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkMessageBus.h"
 #include "src/core/SkMipmap.h"
+#include "src/core/SkResourceCachePool.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <stddef.h>
 #include <stdlib.h>
@@ -77,16 +81,34 @@ namespace {
 class SkResourceCache::Hash :
     public THashTable<SkResourceCache::Rec*, SkResourceCache::Key, HashTraits> {};
 
+struct SkResourceCache::Shard {
+    mutable SkMutex fMutex;
+    Rec*    fHead SK_GUARDED_BY(fMutex) = nullptr;
+    Rec*    fTail SK_GUARDED_BY(fMutex) = nullptr;
+    Hash    fHash SK_GUARDED_BY(fMutex);
+    size_t  fBytesUsed SK_GUARDED_BY(fMutex) = 0;
+    int     fCount SK_GUARDED_BY(fMutex) = 0;
+
+    // Returns the least recently used rec that can be purged, or nullptr.
+    Rec* lastPurgeable() SK_REQUIRES(fMutex) {
+        for (Rec* rec = fTail; rec; rec = rec->fPrev) {
+            if (rec->canBePurged()) {
+                return rec;
+            }
+        }
+        return nullptr;
+    }
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::init() {
-    fHead = nullptr;
-    fTail = nullptr;
-    fHash = new Hash;
+    fShards = new Shard[kShardCount];
     fTotalBytesUsed = 0;
     fCount = 0;
+    fUseClock = 0;
     fSingleAllocationByteLimit = 0;
+    fPurgePending = false;
 
     // One of these should be explicit set by the caller after we return.
     fTotalByteLimit = 0;
@@ -106,13 +128,27 @@ SkResourceCache::SkResourceCache(size_t byteLimit)
 }
 
 SkResourceCache::~SkResourceCache() {
-    Rec* rec = fHead;
-    while (rec) {
-        Rec* next = rec->fNext;
-        delete rec;
-        rec = next;
+    fPurges.reset();    // waits for a purge in flight
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard* shard = &fShards[i];
+        SkAutoMutexExclusive lock(shard->fMutex);
+        Rec* rec = shard->fHead;
+        while (rec) {
+            Rec* next = rec->fNext;
+            delete rec;
+            rec = next;
+        }
     }
-    delete fHash;
+    delete[] fShards;
+}
+
+void SkResourceCache::setPurgeExecutor(SkExecutor* executor) {
+    SkASSERT(!fPurges);
+    fPurges = std::make_unique<SkTaskGroup>(*executor);
+}
+
+SkResourceCache::Shard* SkResourceCache::shardFor(const Key& key) const {
+    return &fShards[key.hash() >> (32 - kShardBits)];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -120,13 +156,15 @@ SkResourceCache::~SkResourceCache() {
 bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     this->checkMessages();
 
-    if (auto found = fHash->find(key)) {
+    Shard* shard = this->shardFor(key);
+    SkAutoMutexExclusive lock(shard->fMutex);
+    if (auto found = shard->fHash.find(key)) {
         Rec* rec = *found;
         if (visitor(*rec, context)) {
-            this->moveToHead(rec);  // for our LRU
+            this->moveToHead(shard, rec);  // for our LRU
             return true;
         } else {
-            this->remove(rec);  // stale
+            this->remove(shard, rec);  // stale
             return false;
         }
     }
@@ -149,61 +187,65 @@ void SkResourceCache::add(Rec* rec, void* payload) {
     this->checkMessages();
 
     SkASSERT(rec);
-    // See if we already have this key (racy inserts, etc.)
-    if (Rec** preexisting = fHash->find(rec->getKey())) {
-        Rec* prev = *preexisting;
-        if (prev->canBePurged()) {
-            // if it can be purged, the install may fail, so we have to remove it
-            this->remove(prev);
-        } else {
-            // if it cannot be purged, we reuse it and delete the new one
-            prev->postAddInstall(payload);
-            delete rec;
-            return;
+    Shard* shard = this->shardFor(rec->getKey());
+    {
+        SkAutoMutexExclusive lock(shard->fMutex);
+        // See if we already have this key (racy inserts, etc.)
+        if (Rec** preexisting = shard->fHash.find(rec->getKey())) {
+            Rec* prev = *preexisting;
+            if (prev->canBePurged()) {
+                // if it can be purged, the install may fail, so we have to remove it
+                this->remove(shard, prev);
+            } else {
+                // if it cannot be purged, we reuse it and delete the new one
+                prev->postAddInstall(payload);
+                delete rec;
+                return;
+            }
         }
-    }
 
-    this->addToHead(rec);
-    fHash->set(rec);
-    rec->postAddInstall(payload);
+        this->addToHead(shard, rec);
+        shard->fHash.set(rec);
+        rec->postAddInstall(payload);
 
-    if (gDumpCacheTransactions) {
-        SkString bytesStr, totalStr;
-        make_size_str(rec->bytesUsed(), &bytesStr);
-        make_size_str(fTotalBytesUsed, &totalStr);
-        SkDebugf("RC:    add %5s %12p key %08x -- total %5s, count %d\n",
-                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount);
+        if (gDumpCacheTransactions) {
+            SkString bytesStr, totalStr;
+            make_size_str(rec->bytesUsed(), &bytesStr);
+            make_size_str(this->getTotalBytesUsed(), &totalStr);
+            SkDebugf("RC:    add %5s %12p key %08x -- total %5s, count %d\n",
+                     bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount.load());
+        }
     }
 
     // since the new rec may push us over-budget, we perform a purge check now
-    this->purgeAsNeeded();
+    this->purgeAfterAdd();
 }
 
-void SkResourceCache::remove(Rec* rec) {
+void SkResourceCache::remove(Shard* shard, Rec* rec) {
     SkASSERT(rec->canBePurged());
     size_t used = rec->bytesUsed();
-    SkASSERT(used <= fTotalBytesUsed);
+    SkASSERT(used <= shard->fBytesUsed);
 
-    this->release(rec);
-    fHash->remove(rec->getKey());
+    this->release(shard, rec);
+    shard->fHash.remove(rec->getKey());
 
+    shard->fBytesUsed -= used;
+    shard->fCount -= 1;
     fTotalBytesUsed -= used;
     fCount -= 1;
 
-    //SkDebugf("-RC count [%3d] bytes %d\n", fCount, fTotalBytesUsed);
-
     if (gDumpCacheTransactions) {
         SkString bytesStr, totalStr;
         make_size_str(used, &bytesStr);
-        make_size_str(fTotalBytesUsed, &totalStr);
+        make_size_str(this->getTotalBytesUsed(), &totalStr);
         SkDebugf("RC: remove %5s %12p key %08x -- total %5s, count %d\n",
-                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount);
+                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount.load());
     }
 
     delete rec;
 }
 
-void SkResourceCache::purgeAsNeeded(bool forcePurge) {
+bool SkResourceCache::isOverBudget(int overageScale) const {
     size_t byteLimit;
     int    countLimit;
 
@@ -212,20 +254,69 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         byteLimit = UINT32_MAX;  // no limit based on bytes
     } else {
         countLimit = SK_MaxS32; // no limit based on count
-        byteLimit = fTotalByteLimit;
+        byteLimit = this->getTotalByteLimit();
     }
 
-    Rec* rec = fTail;
-    while (rec) {
-        if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
+    return this->getTotalBytesUsed() / overageScale >= byteLimit ||
+           fCount.load(std::memory_order_relaxed) / overageScale >= countLimit;
+}
+
+void SkResourceCache::purgeAfterAdd() {
+    if (!this->isOverBudget()) {
+        return;
+    }
+    if (!fPurges || this->isOverBudget(2)) {
+        this->purgeAsNeeded();
+        return;
+    }
+    if (!fPurgePending.exchange(true)) {
+        fPurges->add([this] {
+            fPurgePending = false;
+            this->purgeAsNeeded();
+        });
+    }
+}
+
+void SkResourceCache::purgeAsNeeded(bool forcePurge) {
+    if (forcePurge) {
+        for (int i = 0; i < kShardCount; ++i) {
+            Shard* shard = &fShards[i];
+            SkAutoMutexExclusive lock(shard->fMutex);
+            Rec* rec = shard->fTail;
+            while (rec) {
+                Rec* prev = rec->fPrev;
+                if (rec->canBePurged()) {
+                    this->remove(shard, rec);
+                }
+                rec = prev;
+            }
+        }
+        SkResourceCachePool::Global()->releaseEmptySlabs();
+        return;
+    }
+
+    while (this->isOverBudget()) {
+        // Evict from the shard whose least recently used rec is the oldest, which purges in the
+        // same order as one LRU list would.
+        Shard* oldest = nullptr;
+        uint64_t oldestUse = UINT64_MAX;
+        for (int i = 0; i < kShardCount; ++i) {
+            Shard* shard = &fShards[i];
+            SkAutoMutexExclusive lock(shard->fMutex);
+            if (Rec* rec = shard->lastPurgeable(); rec && rec->fLastUse < oldestUse) {
+                oldest = shard;
+                oldestUse = rec->fLastUse;
+            }
+        }
+        if (!oldest) {
             break;
         }
 
-        Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
-            this->remove(rec);
+        SkAutoMutexExclusive lock(oldest->fMutex);
+        // The shard may have changed since we looked, but its tail is still a fine choice.
+        if (Rec* rec = oldest->lastPurgeable()) {
+            this->remove(oldest, rec);
         }
-        rec = prev;
     }
 }
 
@@ -245,22 +336,27 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
     gPurgeCallCounter += 1;
     bool found = false;
 #endif
-    // go backwards, just like purgeAsNeeded, just to make the code similar.
-    // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        Rec* prev = rec->fPrev;
-        if (rec->getKey().getSharedID() == sharedID) {
-            // even though the "src" is now dead, caches could still be in-flight, so
-            // we have to check if it can be removed.
-            if (rec->canBePurged()) {
-                this->remove(rec);
-            }
+    // The sharedID is not part of the hash, so it can be in any shard.
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard* shard = &fShards[i];
+        SkAutoMutexExclusive lock(shard->fMutex);
+        // go backwards, just like purgeAsNeeded, just to make the code similar.
+        // could iterate either direction and still be correct.
+        Rec* rec = shard->fTail;
+        while (rec) {
+            Rec* prev = rec->fPrev;
+            if (rec->getKey().getSharedID() == sharedID) {
+                // even though the "src" is now dead, caches could still be in-flight, so
+                // we have to check if it can be removed.
+                if (rec->canBePurged()) {
+                    this->remove(shard, rec);
+                }
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
-            found = true;
+                found = true;
 #endif
+            }
+            rec = prev;
         }
-        rec = prev;
     }
 
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -274,20 +370,23 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
 }
 
 void SkResourceCache::visitAll(Visitor visitor, void* context) {
-    // go backwards, just like purgeAsNeeded, just to make the code similar.
-    // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        visitor(*rec, context);
-        rec = rec->fPrev;
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard* shard = &fShards[i];
+        SkAutoMutexExclusive lock(shard->fMutex);
+        // go backwards, just like purgeAsNeeded, just to make the code similar.
+        // could iterate either direction and still be correct.
+        Rec* rec = shard->fTail;
+        while (rec) {
+            visitor(*rec, context);
+            rec = rec->fPrev;
+        }
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
-    size_t prevLimit = fTotalByteLimit;
-    fTotalByteLimit = newLimit;
+    size_t prevLimit = fTotalByteLimit.exchange(newLimit);
     if (newLimit < prevLimit) {
         this->purgeAsNeeded();
     }
@@ -301,25 +400,30 @@ SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
         SkDiscardableMemory* dm = fDiscardableFactory(bytes);
         return dm ? new SkCachedData(bytes, dm) : nullptr;
     } else {
-        return new SkCachedData(sk_malloc_throw(bytes), bytes);
+        SkResourceCachePool* pool = SkResourceCachePool::Global();
+        void* block = pool->allocate(bytes);
+        if (!block) {
+            sk_out_of_memory();
+        }
+        return new SkCachedData(bytes, pool, block);
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void SkResourceCache::release(Rec* rec) {
+void SkResourceCache::release(Shard* shard, Rec* rec) {
     Rec* prev = rec->fPrev;
     Rec* next = rec->fNext;
 
     if (!prev) {
-        SkASSERT(fHead == rec);
-        fHead = next;
+        SkASSERT(shard->fHead == rec);
+        shard->fHead = next;
     } else {
         prev->fNext = next;
     }
 
     if (!next) {
-        fTail = prev;
+        shard->fTail = prev;
     } else {
         next->fPrev = prev;
     }
@@ -327,77 +431,85 @@ void SkResourceCache::release(Rec* rec) {
     rec->fNext = rec->fPrev = nullptr;
 }
 
-void SkResourceCache::moveToHead(Rec* rec) {
-    if (fHead == rec) {
+void SkResourceCache::moveToHead(Shard* shard, Rec* rec) {
+    if (shard->fHead == rec) {
+        rec->fLastUse = fUseClock.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
-    SkASSERT(fHead);
-    SkASSERT(fTail);
+    SkASSERT(shard->fHead);
+    SkASSERT(shard->fTail);
 
-    this->validate();
+    this->validate(shard);
 
-    this->release(rec);
+    this->release(shard, rec);
 
-    fHead->fPrev = rec;
-    rec->fNext = fHead;
-    fHead = rec;
+    rec->fLastUse = fUseClock.fetch_add(1, std::memory_order_relaxed);
+    shard->fHead->fPrev = rec;
+    rec->fNext = shard->fHead;
+    shard->fHead = rec;
 
-    this->validate();
+    this->validate(shard);
 }
 
-void SkResourceCache::addToHead(Rec* rec) {
-    this->validate();
+void SkResourceCache::addToHead(Shard* shard, Rec* rec) {
+    this->validate(shard);
 
     rec->fPrev = nullptr;
-    rec->fNext = fHead;
-    if (fHead) {
-        fHead->fPrev = rec;
+    rec->fNext = shard->fHead;
+    rec->fLastUse = fUseClock.fetch_add(1, std::memory_order_relaxed);
+    if (shard->fHead) {
+        shard->fHead->fPrev = rec;
     }
-    fHead = rec;
-    if (!fTail) {
-        fTail = rec;
+    shard->fHead = rec;
+    if (!shard->fTail) {
+        shard->fTail = rec;
     }
+    shard->fBytesUsed += rec->bytesUsed();
+    shard->fCount += 1;
     fTotalBytesUsed += rec->bytesUsed();
     fCount += 1;
 
-    this->validate();
+    this->validate(shard);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef SK_DEBUG
-void SkResourceCache::validate() const {
-    if (nullptr == fHead) {
-        SkASSERT(nullptr == fTail);
-        SkASSERT(0 == fTotalBytesUsed);
+void SkResourceCache::validate(const Shard* shard) const {
+    const Rec* head = shard->fHead;
+    const Rec* tail = shard->fTail;
+    if (nullptr == head) {
+        SkASSERT(nullptr == tail);
+        SkASSERT(0 == shard->fBytesUsed);
         return;
     }
 
-    if (fHead == fTail) {
-        SkASSERT(nullptr == fHead->fPrev);
-        SkASSERT(nullptr == fHead->fNext);
-        SkASSERT(fHead->bytesUsed() == fTotalBytesUsed);
+    if (head == tail) {
+        SkASSERT(nullptr == head->fPrev);
+        SkASSERT(nullptr == head->fNext);
+        SkASSERT(head->bytesUsed() == shard->fBytesUsed);
         return;
     }
 
-    SkASSERT(nullptr == fHead->fPrev);
-    SkASSERT(fHead->fNext);
-    SkASSERT(nullptr == fTail->fNext);
-    SkASSERT(fTail->fPrev);
+    SkASSERT(nullptr == head->fPrev);
+    SkASSERT(head->fNext);
+    SkASSERT(nullptr == tail->fNext);
+    SkASSERT(tail->fPrev);
 
     size_t used = 0;
     int count = 0;
-    const Rec* rec = fHead;
+    const Rec* rec = head;
     while (rec) {
         count += 1;
         used += rec->bytesUsed();
-        SkASSERT(used <= fTotalBytesUsed);
+        SkASSERT(used <= shard->fBytesUsed);
+        SkASSERT(!rec->fNext || rec->fNext->fLastUse < rec->fLastUse);
         rec = rec->fNext;
     }
-    SkASSERT(fCount == count);
+    SkASSERT(shard->fCount == count);
 
-    rec = fTail;
+    rec = tail;
     while (rec) {
         SkASSERT(count > 0);
         count -= 1;
@@ -412,16 +524,19 @@ void SkResourceCache::validate() const {
 #endif
 
 void SkResourceCache::dump() const {
-    this->validate();
+    for (int i = 0; i < kShardCount; ++i) {
+        const Shard* shard = &fShards[i];
+        SkAutoMutexExclusive lock(shard->fMutex);
+        this->validate(shard);
+    }
 
     SkDebugf("SkResourceCache: count=%d bytes=%zu %s\n",
-             fCount, fTotalBytesUsed, fDiscardableFactory ? "discardable" : "malloc");
+             fCount.load(), this->getTotalBytesUsed(),
+             fDiscardableFactory ? "discardable" : "malloc");
 }
 
 size_t SkResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
-    size_t oldLimit = fSingleAllocationByteLimit;
-    fSingleAllocationByteLimit = newLimit;
-    return oldLimit;
+    return fSingleAllocationByteLimit.exchange(newLimit);
 }
 
 size_t SkResourceCache::getSingleAllocationByteLimit() const {
@@ -435,10 +550,11 @@ size_t SkResourceCache::getEffectiveSingleAllocationByteLimit() const {
     // if we're not discardable (i.e. we are fixed-budget) then cap the single-limit
     // to our budget.
     if (nullptr == fDiscardableFactory) {
+        const size_t totalByteLimit = this->getTotalByteLimit();
         if (0 == limit) {
-            limit = fTotalByteLimit;
+            limit = totalByteLimit;
         } else {
-            limit = std::min(limit, fTotalByteLimit);
+            limit = std::min(limit, totalByteLimit);
         }
     }
     return limit;
@@ -454,93 +570,73 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
-}
-
-/** Must hold resource_cache_mutex() when calling. */
 static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+    static SkResourceCache* gResourceCache = [] {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+        auto cache = new SkResourceCache(SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+        auto cache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
 #endif
-    }
+        cache->setPurgeExecutor(
+                SkExecutor::MakeFIFOThreadPool(1, /*allowBorrowing=*/false).release());
+        return cache;
+    }();
     return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->purgeAll();
 }
 
 void SkResourceCache::CheckMessages() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->checkMessages();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->visitAll(visitor, context);
 }
 
@@ -611,4 +707,5 @@ void SkResourceCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
     // Since resource could be backed by malloc or discardable, the cache always dumps detailed
     // stats to be accurate.
     VisitAll(sk_trace_dump_visitor, dump);
+    SkResourceCachePool::Global()->dumpMemoryStatistics(dump);
 }
@@ -12,19 +12,27 @@
 #include "include/private/base/SkTDArray.h"
 #include "src/core/SkMessageBus.h"
 
+#include <atomic>
+#include <memory>
+
 class SkCachedData;
 class SkDiscardableMemory;
+class SkExecutor;
+class SkTaskGroup;
 class SkTraceMemoryDump;
 
 /**
  *  Cache object for bitmaps (with possible scale in X Y as part of the key).
  *
- *  Multiple caches can be instantiated, but each instance is not implicitly
- *  thread-safe, so if a given instance is to be shared across threads, the
- *  caller must manage the access itself (e.g. via a mutex).
+ *  Multiple caches can be instantiated, and each instance is thread-safe. The
+ *  recs are split across shards by key hash, each with its own lock, hash table
+ *  and LRU list, so that finds and adds of different keys don't contend. The
+ *  budget is shared: purging evicts the least recently used rec across all the
+ *  shards.
  *
- *  As a convenience, a global instance is also defined, which can be safely
- *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  As a convenience, a global instance is also defined, which can be accessed
+ *  via the static methods (e.g. Find, Add, etc.). It purges on a background
+ *  thread, so that going over budget doesn't stall the thread adding to it.
  */
 class SkResourceCache {
 public:
@@ -103,8 +111,9 @@ public:
         virtual SkDiscardableMemory* diagnostic_only_getDiscardable() const { return nullptr; }
 
     private:
-        Rec*    fNext;
-        Rec*    fPrev;
+        Rec*     fNext;
+        Rec*     fPrev;
+        uint64_t fLastUse;  // When this was last added or found, to order recs across shards.
 
         friend class SkResourceCache;
     };
@@ -221,8 +230,8 @@ public:
     void add(Rec*, void* payload = nullptr);
     void visitAll(Visitor, void* context);
 
-    size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
-    size_t getTotalByteLimit() const { return fTotalByteLimit; }
+    size_t getTotalBytesUsed() const { return fTotalBytesUsed.load(std::memory_order_relaxed); }
+    size_t getTotalByteLimit() const { return fTotalByteLimit.load(std::memory_order_relaxed); }
 
     /**
      *  This is respected by SkBitmapProcState::possiblyScaleImage.
@@ -250,6 +259,13 @@ public:
 
     DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
 
+    /**
+     *  Purge on executor, instead of on the thread whose add() went over budget. An add() still
+     *  purges inline if the cache has grown to twice its budget before the background purge
+     *  caught up. The executor must outlive the cache.
+     */
+    void setPurgeExecutor(SkExecutor* executor);
+
     SkCachedData* newCachedData(size_t bytes);
 
     /**
@@ -258,36 +274,48 @@ public:
     void dump() const;
 
 private:
-    Rec*    fHead;
-    Rec*    fTail;
+    // The number of shards is 1 << kShardBits, selected by the top bits of the key hash.
+    static constexpr int kShardBits = 3;
+    static constexpr int kShardCount = 1 << kShardBits;
 
     class Hash;
-    Hash*   fHash;
+    struct Shard;
+    Shard*  fShards;    // kShardCount of them
 
     DiscardableFactory  fDiscardableFactory;
 
-    size_t  fTotalBytesUsed;
-    size_t  fTotalByteLimit;
-    size_t  fSingleAllocationByteLimit;
-    int     fCount;
+    std::atomic<size_t>   fTotalBytesUsed;
+    std::atomic<size_t>   fTotalByteLimit;
+    std::atomic<size_t>   fSingleAllocationByteLimit;
+    std::atomic<int>      fCount;
+    std::atomic<uint64_t> fUseClock;
+
+    std::unique_ptr<SkTaskGroup> fPurges;
+    std::atomic<bool>            fPurgePending;
 
     SkMessageBus<PurgeSharedIDMessage, uint32_t>::Inbox fPurgeSharedIDInbox;
 
+    Shard* shardFor(const Key&) const;
+
     void checkMessages();
     void purgeAsNeeded(bool forcePurge = false);
+    // Returns true if more than the limits are in use, scaled by overageScale.
+    bool isOverBudget(int overageScale = 1) const;
+    // Purges inline, or on fPurges, if the cache is over budget.
+    void purgeAfterAdd();
 
-    // linklist management
-    void moveToHead(Rec*);
-    void addToHead(Rec*);
-    void release(Rec*);
-    void remove(Rec*);
+    // linklist management, called with the shard's lock held
+    void moveToHead(Shard*, Rec*);
+    void addToHead(Shard*, Rec*);
+    void release(Shard*, Rec*);
+    void remove(Shard*, Rec*);
 
     void init();    // called by constructors
 
 #ifdef SK_DEBUG
-    void validate() const;
+    void validate(const Shard*) const;
 #else
-    void validate() const {}
+    void validate(const Shard*) const {}
 #endif
 };
 #endif
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkResourceCachePool.h"
+
+#include "include/core/SkTraceMemoryDump.h"
+#include "include/private/base/SkMalloc.h"
+#include "src/base/SkMathPriv.h"
+
+#include <algorithm>
+#include <new>
+
+SkResourceCachePool* SkResourceCachePool::Global() {
+    static SkResourceCachePool* gPool = new SkResourceCachePool;
+    return gPool;
+}
+
+SkResourceCachePool::~SkResourceCachePool() {
+    SkAutoMutexExclusive lock{fMutex};
+    for (SizeClass& sizeClass : fClasses) {
+        SkASSERT(sizeClass.fFull.isEmpty());
+        while (Slab* slab = sizeClass.fAvailable.head()) {
+            SkASSERT(slab->fUsed == 0);
+            this->freeSlab(slab);
+        }
+    }
+}
+
+int SkResourceCachePool::ClassIndex(size_t blockBytes) {
+    SkASSERT(blockBytes <= ((size_t)1 << kMaxClassLog2));
+    // blockBytes - 1 lies in [2^log2, 2^(log2 + 1)); its next two bits pick the quarter.
+    const uint32_t n = (uint32_t)std::max(blockBytes, ((size_t)1 << kMinClassLog2) + 1) - 1;
+    const int log2 = SkPrevLog2(n);
+    return 4 * (log2 - kMinClassLog2) + ((n >> (log2 - 2)) & 3);
+}
+
+size_t SkResourceCachePool::ClassBlockBytes(int classIndex) {
+    const int log2 = kMinClassLog2 + classIndex / 4;
+    return (size_t)(5 + classIndex % 4) << (log2 - 2);
+}
+
+void* SkResourceCachePool::allocate(size_t bytes) {
+    if (bytes > ((size_t)1 << kMaxClassLog2) - sizeof(BlockHeader)) {
+        if (bytes > SIZE_MAX - sizeof(BlockHeader)) {
+            return nullptr;
+        }
+        auto header = static_cast<BlockHeader*>(sk_malloc_canfail(sizeof(BlockHeader) + bytes));
+        if (!header) {
+            return nullptr;
+        }
+        header->fSlab = nullptr;
+        header->fRequested = bytes;
+        SkAutoMutexExclusive lock{fMutex};
+        fUnpooledBytes += bytes;
+        return header + 1;
+    }
+
+    const int classIndex = ClassIndex(sizeof(BlockHeader) + bytes);
+    SkAutoMutexExclusive lock{fMutex};
+    SizeClass* sizeClass = &fClasses[classIndex];
+    if (sizeClass->fBlockBytes == 0) {
+        sizeClass->fBlockBytes = ClassBlockBytes(classIndex);
+        sizeClass->fBlocksPerSlab =
+                (int)std::max<size_t>(1, kSlabTargetBytes / sizeClass->fBlockBytes);
+    }
+
+    Slab* slab = sizeClass->fAvailable.head();
+    if (!slab) {
+        slab = this->makeSlab(sizeClass);
+        if (!slab) {
+            return nullptr;
+        }
+    }
+    if (slab == sizeClass->fSpare) {
+        sizeClass->fSpare = nullptr;
+        fSpareBytes -= slab->fBytes;
+    }
+
+    BlockHeader* header = slab->fFreeList;
+    if (header) {
+        slab->fFreeList = *reinterpret_cast<BlockHeader**>(header + 1);
+    } else {
+        SkASSERT(slab->fCarved < slab->fCapacity);
+        header = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(slab + 1) +
+                                                slab->fCarved++ * sizeClass->fBlockBytes);
+    }
+    if (++slab->fUsed == slab->fCapacity) {
+        sizeClass->fAvailable.remove(slab);
+        sizeClass->fFull.addToHead(slab);
+    }
+
+    header->fSlab = slab;
+    header->fRequested = bytes;
+    fAllocatedBytes += bytes;
+    return header + 1;
+}
+
+void SkResourceCachePool::release(void* block) {
+    if (!block) {
+        return;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+    Slab* slab = header->fSlab;
+    SkAutoMutexExclusive lock{fMutex};
+    if (!slab) {
+        fUnpooledBytes -= header->fRequested;
+        sk_free(header);
+        return;
+    }
+
+    SizeClass* sizeClass = slab->fClass;
+    fAllocatedBytes -= header->fRequested;
+    *reinterpret_cast<BlockHeader**>(header + 1) = slab->fFreeList;
+    slab->fFreeList = header;
+
+    if (slab->fUsed-- == slab->fCapacity) {
+        sizeClass->fFull.remove(slab);
+        sizeClass->fAvailable.addToHead(slab);
+    }
+    if (slab->fUsed == 0) {
+        // Keep at most one empty slab per class, within the spare budget, and at the tail so the
+        // partly used slabs fill up first.
+        if (!sizeClass->fSpare && fSpareBytes + slab->fBytes <= kMaxSpareBytes) {
+            sizeClass->fSpare = slab;
+            fSpareBytes += slab->fBytes;
+            sizeClass->fAvailable.remove(slab);
+            sizeClass->fAvailable.addToTail(slab);
+        } else {
+            this->freeSlab(slab);
+        }
+    }
+}
+
+void SkResourceCachePool::releaseEmptySlabs() {
+    SkAutoMutexExclusive lock{fMutex};
+    for (SizeClass& sizeClass : fClasses) {
+        if (Slab* spare = sizeClass.fSpare) {
+            sizeClass.fSpare = nullptr;
+            fSpareBytes -= spare->fBytes;
+            this->freeSlab(spare);
+        }
+    }
+    SkASSERT(fSpareBytes == 0);
+}
+
+SkResourceCachePool::Slab* SkResourceCachePool::makeSlab(SizeClass* sizeClass) {
+    const size_t bytes = sizeof(Slab) + sizeClass->fBlocksPerSlab * sizeClass->fBlockBytes;
+    void* storage = sk_malloc_canfail(bytes);
+    if (!storage) {
+        return nullptr;
+    }
+    Slab* slab = new (storage) Slab;
+    slab->fClass = sizeClass;
+    slab->fFreeList = nullptr;
+    slab->fBytes = bytes;
+    slab->fCapacity = sizeClass->fBlocksPerSlab;
+    slab->fCarved = 0;
+    slab->fUsed = 0;
+    sizeClass->fAvailable.addToHead(slab);
+
+    fSlabCount++;
+    fSlabBytes += bytes;
+    return slab;
+}
+
+void SkResourceCachePool::freeSlab(Slab* slab) {
+    SkASSERT(slab->fUsed == 0);
+    slab->fClass->fAvailable.remove(slab);
+    fSlabCount--;
+    fSlabBytes -= slab->fBytes;
+    slab->~Slab();
+    sk_free(slab);
+}
+
+SkResourceCachePool::Stats SkResourceCachePool::stats() const {
+    SkAutoMutexExclusive lock{fMutex};
+    return {fSlabCount,
+            fSlabBytes,
+            fAllocatedBytes,
+            fSlabBytes - fAllocatedBytes - fSlabCount * sizeof(Slab),
+            fUnpooledBytes};
+}
+
+void SkResourceCachePool::dumpMemoryStatistics(SkTraceMemoryDump* dump) const {
+    const Stats stats = this->stats();
+    const char* dumpName = "skia/sk_resource_cache/pool";
+    dump->dumpNumericValue(dumpName, "size", "bytes", stats.fSlabBytes);
+    dump->dumpNumericValue(dumpName, "allocated_size", "bytes", stats.fAllocatedBytes);
+    dump->dumpNumericValue(dumpName, "fragmented_size", "bytes", stats.fFragmentedBytes);
+    dump->dumpNumericValue(dumpName, "unpooled_size", "bytes", stats.fUnpooledBytes);
+    dump->dumpNumericValue(dumpName, "slab_count", "objects", stats.fSlabCount);
+    dump->setMemoryBacking(dumpName, "malloc", nullptr);
+}
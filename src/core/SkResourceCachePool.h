@@ -0,0 +1,118 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkResourceCachePool_DEFINED
+#define SkResourceCachePool_DEFINED
+
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkNoncopyable.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/base/SkTInternalLList.h"
+
+#include <cstddef>
+
+class SkTraceMemoryDump;
+
+/**
+ *  Backs the memory SkResourceCache owns for its entries (cached bitmaps, and the SkCachedData of
+ *  blurred masks and the like) when it isn't in discardable memory. Mipmaps, which can outlive
+ *  the cache in the images that build them, use malloc.
+ *
+ *  The cache churns through blocks of a handful of sizes as it purges and re-decodes the same
+ *  images, so rather than returning each block to malloc, the pool rounds sizes up to one of four
+ *  classes per power of two and carves the blocks of a class out of slabs of about 1MB. A freed
+ *  block is recycled for the next allocation of its class.
+ *
+ *  A slab whose blocks are all free is returned to the OS right away, unless the pool is keeping
+ *  it as the spare for its class; releaseEmptySlabs() returns the spares too, and is called when
+ *  the cache is purged. Blocks too large for a class come straight from malloc.
+ *
+ *  The pool is thread-safe.
+ */
+class SkResourceCachePool : SkNoncopyable {
+public:
+    // The pool shared by all the resource caches.
+    static SkResourceCachePool* Global();
+
+    SkResourceCachePool() = default;
+    ~SkResourceCachePool();
+
+    // Returns a 16-byte aligned block of at least bytes, or nullptr if it can't be allocated.
+    void* allocate(size_t bytes);
+
+    // Returns a block from allocate() to the pool. block may be nullptr.
+    void release(void* block);
+
+    // Returns the slabs with no blocks in use to the OS.
+    void releaseEmptySlabs();
+
+    struct Stats {
+        int    fSlabCount;
+        size_t fSlabBytes;        // Memory held in slabs.
+        size_t fAllocatedBytes;   // The bytes asked for by the blocks in use in slabs.
+        size_t fFragmentedBytes;  // Slab memory not in allocatedBytes: free blocks, block headers.
+        size_t fUnpooledBytes;    // Memory in blocks that came straight from malloc.
+    };
+    Stats stats() const;
+
+    void dumpMemoryStatistics(SkTraceMemoryDump* dump) const;
+
+private:
+    struct SizeClass;
+    struct Slab;
+
+    // A block is a header followed by the memory returned to the caller.
+    struct alignas(16) BlockHeader {
+        Slab*  fSlab;       // nullptr if the block came straight from malloc.
+        size_t fRequested;  // The bytes passed to allocate().
+    };
+
+    // A slab is this header followed by fCapacity blocks, carved out as they are first needed.
+    struct alignas(16) Slab {
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(Slab);
+
+        SizeClass*   fClass;
+        BlockHeader* fFreeList;  // Released blocks, linked through their first word of memory.
+        size_t       fBytes;
+        int          fCapacity;
+        int          fCarved;
+        int          fUsed;
+    };
+
+    struct SizeClass {
+        size_t fBlockBytes = 0;  // Including the BlockHeader.
+        int fBlocksPerSlab = 0;
+        SkTInternalLList<Slab> fAvailable;  // Partly used slabs first, then the spare.
+        SkTInternalLList<Slab> fFull;
+        Slab* fSpare = nullptr;  // An empty slab kept for the next allocation.
+    };
+
+    // Four classes per power of two, from just over 256 bytes up to 8MB.
+    static constexpr int kMinClassLog2 = 8;
+    static constexpr int kMaxClassLog2 = 23;
+    static constexpr int kClassCount = 4 * (kMaxClassLog2 - kMinClassLog2);
+    static constexpr size_t kSlabTargetBytes = 1 << 20;
+    // Spare empty slabs beyond this many bytes are returned to the OS as soon as they empty.
+    static constexpr size_t kMaxSpareBytes = 2 << 20;
+
+    static int ClassIndex(size_t blockBytes);
+    static size_t ClassBlockBytes(int classIndex);
+
+    Slab* makeSlab(SizeClass* sizeClass) SK_REQUIRES(fMutex);
+    void freeSlab(Slab* slab) SK_REQUIRES(fMutex);
+
+    mutable SkMutex fMutex;
+    SizeClass fClasses[kClassCount] SK_GUARDED_BY(fMutex);
+    int    fSlabCount      SK_GUARDED_BY(fMutex) = 0;
+    size_t fSlabBytes      SK_GUARDED_BY(fMutex) = 0;
+    size_t fAllocatedBytes SK_GUARDED_BY(fMutex) = 0;
+    size_t fSpareBytes     SK_GUARDED_BY(fMutex) = 0;
+    size_t fUnpooledBytes  SK_GUARDED_BY(fMutex) = 0;
+};
+
+#endif  // SkResourceCachePool_DEFINED
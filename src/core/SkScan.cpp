@@ -12,6 +12,8 @@
 
 std::atomic<bool> gSkUseAnalyticAA{true};
 std::atomic<bool> gSkForceAnalyticAA{false};
+std::atomic<bool> gSkUseDeltaAA{false};
+std::atomic<bool> gSkForceDeltaAA{false};
 
 static inline void blitrect(SkBlitter* blitter, const SkIRect& r) {
     blitter->blitRect(r.fLeft, r.fTop, r.width(), r.height());
@@ -52,6 +52,19 @@ static bool ShouldUseAAA(const SkPath& path) {
 #endif
 }
 
+// Delta AA takes over from supersampling for the paths AAA turns down when gSkUseDeltaAA is set,
+// and from both when gSkForceDeltaAA is. It only covers the inside of the path, so inverse fills
+// stay on the other scan converters.
+static bool ShouldUseDAA(const SkPath& path, bool useAAA) {
+    if (path.isInverseFillType()) {
+        return false;
+    }
+    if (gSkForceDeltaAA) {
+        return true;
+    }
+    return gSkUseDeltaAA && !useAAA;
+}
+
 static int overflows_short_shift(int value, int shift) {
     const int s = 16 + shift;
     return (SkLeftShift(value, s) >> s) - value;
@@ -146,7 +159,10 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
         sk_blit_above(blitter, ir, *clipRgn);
     }
 
-    if (ShouldUseAAA(path)) {
+    const bool useAAA = ShouldUseAAA(path);
+    if (ShouldUseDAA(path, useAAA)) {
+        SkScan::DAAFillPath(path, blitter, ir, clipRgn->getBounds(), forceRLE);
+    } else if (useAAA) {
         // Do not use AAA if path is too complicated:
         // there won't be any speedup or significant visual improvement.
         SkScan::AAAFillPath(path, blitter, ir, clipRgn->getBounds(), forceRLE);
@@ -0,0 +1,399 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkPath.h"
+#include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkVx.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkGeometry.h"
+#include "src/core/SkMask.h"
+#include "src/core/SkScan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+
+Delta (signed-area) accumulation anti-aliasing.
+
+Instead of walking sorted edges scanline by scanline like AAA, or supersampling like SAA, every
+line segment of the flattened path deposits its exact signed area contribution into a dense
+float accumulation buffer, one cell per pixel (plus two spill cells per row). The segments can
+be processed in any order. A running sum along each row then turns those deltas into the
+winding-weighted coverage of each pixel, which is a plain prefix sum and vectorizes well.
+
+The accumulation is done one strip of rows at a time so the buffer stays cache sized no matter
+how large the path is. Each finished strip is converted to A8 and handed to the blitter with a
+single blitMask() call (or as compressed runs when the caller needs RLE output).
+
+*/
+
+namespace {
+
+// Flattening tolerance for curves, in device pixels.
+constexpr float kFlattenTolerance = 1.f / 16;
+constexpr int   kMaxFlattenSegments = 128;
+
+// Roughly how many floats of accumulation buffer to use per strip.
+constexpr int kStripFloats = 16 * 1024;
+constexpr int kMaxStripRows = 64;
+
+struct DeltaLine {
+    float fX0, fY0;    // the top end point, fY0 < fY1
+    float fY1;
+    float fDXDY;
+    float fDir;        // +1 for downward segments, -1 for upward ones
+};
+
+// Collects the path's segments in coordinates relative to the top-left of the area being drawn.
+// Segments are clipped to the vertical extent of that area, and the parts left or right of it
+// are replaced by vertical segments on the boundary, which contribute the same winding to the
+// visible pixels.
+class LineBuilder {
+public:
+    LineBuilder(float width, float height) : fW(width), fH(height) {}
+
+    void addLine(SkPoint p0, SkPoint p1) {
+        if (p0.fY == p1.fY) {
+            return;
+        }
+        float dir = 1;
+        if (p0.fY > p1.fY) {
+            std::swap(p0, p1);
+            dir = -1;
+        }
+        if (p1.fY <= 0 || p0.fY >= fH) {
+            return;
+        }
+
+        const float dxdy = (p1.fX - p0.fX) / (p1.fY - p0.fY);
+        auto xAt = [&](float y) { return p0.fX + (y - p0.fY) * dxdy; };
+
+        // Split where the segment crosses x == 0 and x == fW.
+        float ys[4];
+        int count = 0;
+        ys[count++] = std::max(p0.fY, 0.f);
+        for (float edge : {0.f, fW}) {
+            if ((p0.fX < edge) != (p1.fX < edge)) {
+                float y = p0.fY + (edge - p0.fX) / dxdy;
+                if (y > ys[0] && y < p1.fY && y < fH) {
+                    ys[count++] = y;
+                }
+            }
+        }
+        ys[count++] = std::min(p1.fY, fH);
+        std::sort(ys + 1, ys + count - 1);
+
+        for (int i = 0; i + 1 < count; ++i) {
+            const float ya = ys[i],
+                        yb = ys[i + 1];
+            if (ya >= yb) {
+                continue;
+            }
+            const float xa = SkTPin(xAt(ya), 0.f, fW),
+                        xb = SkTPin(xAt(yb), 0.f, fW);
+            fLines.push_back({xa, ya, yb, (xb - xa) / (yb - ya), dir});
+        }
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        const SkVector dd = pts[0] - pts[1] * 2 + pts[2];
+        const int n = segment_count(dd.length() * 0.25f);
+        SkQuadCoeff coeff(pts);
+        this->addCurve(n, pts[0], pts[2], [&](float t) { return coeff.eval(t); });
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        const SkVector dd0 = pts[0] - pts[1] * 2 + pts[2],
+                       dd1 = pts[1] - pts[2] * 2 + pts[3];
+        const int n = segment_count(std::max(dd0.length(), dd1.length()) * 0.75f);
+        SkCubicCoeff coeff(pts);
+        this->addCurve(n, pts[0], pts[3], [&](float t) { return coeff.eval(t); });
+    }
+
+    skia_private::TArray<DeltaLine>& lines() { return fLines; }
+
+private:
+    // Wang's formula: how many line segments keep a curve within the flattening tolerance,
+    // given its scaled second difference.
+    static int segment_count(float scaledDD) {
+        float n = std::ceil(std::sqrt(scaledDD / kFlattenTolerance));
+        return n > 1 ? (int)std::min(n, (float)kMaxFlattenSegments) : 1;
+    }
+
+    template <typename EvalFn>
+    void addCurve(int n, SkPoint start, SkPoint end, EvalFn&& eval) {
+        const float dt = 1.f / n;
+        SkPoint prev = start;
+        for (int i = 1; i < n; ++i) {
+            skvx::float2 p = eval(i * dt);
+            SkPoint next = {p[0], p[1]};
+            this->addLine(prev, next);
+            prev = next;
+        }
+        this->addLine(prev, end);
+    }
+
+    const float fW, fH;
+    skia_private::TArray<DeltaLine> fLines;
+};
+
+// Deposits the signed area of the part of line that lies in rows [top, bottom) into acc, whose
+// rows are stride floats apart and start at row top. Widens [*minCell, *maxCell] to cover every
+// cell written.
+void accumulate_line(const DeltaLine& line, int top, int bottom, float maxX,
+                     float* acc, int stride, int* minCell, int* maxCell) {
+    const float ya = std::max(line.fY0, (float)top),
+                yb = std::min(line.fY1, (float)bottom);
+    if (ya >= yb) {
+        return;
+    }
+
+    float x = SkTPin(line.fX0 + (ya - line.fY0) * line.fDXDY, 0.f, maxX);
+    const int yEnd = (int)std::ceil(yb);
+    for (int y = (int)ya; y < yEnd; ++y) {
+        const float dy = std::min((float)(y + 1), yb) - std::max((float)y, ya);
+        const float xNext = SkTPin(x + line.fDXDY * dy, 0.f, maxX);
+        const float d = dy * line.fDir;
+
+        float* row = acc + (y - top) * stride;
+        const float x0 = std::min(x, xNext),
+                    x1 = std::max(x, xNext);
+        const float x0Floor = std::floor(x0);
+        const int x0i = (int)x0Floor;
+        const int x1i = (int)std::ceil(x1);
+
+        *minCell = std::min(*minCell, x0i);
+        if (x1i <= x0i + 1) {
+            // The segment stays within one pixel column on this row.
+            const float xmf = 0.5f * (x + xNext) - x0Floor;
+            row[x0i]     += d - d * xmf;
+            row[x0i + 1] += d * xmf;
+            *maxCell = std::max(*maxCell, x0i + 1);
+        } else {
+            const float s = 1.f / (x1 - x0);
+            const float x0f = x0 - x0Floor;
+            const float a0 = 0.5f * s * (1 - x0f) * (1 - x0f);
+            const float x1f = x1 - x1i + 1;
+            const float am = 0.5f * s * x1f * x1f;
+            row[x0i] += d * a0;
+            if (x1i == x0i + 2) {
+                row[x0i + 1] += d * (1 - a0 - am);
+            } else {
+                const float a1 = s * (1.5f - x0f);
+                row[x0i + 1] += d * (a1 - a0);
+                for (int xi = x0i + 2; xi < x1i - 1; ++xi) {
+                    row[xi] += d * s;
+                }
+                const float a2 = a1 + (x1i - x0i - 3) * s;
+                row[x1i - 1] += d * (1 - a2 - am);
+            }
+            row[x1i] += d * am;
+            *maxCell = std::max(*maxCell, x1i);
+        }
+        x = xNext;
+    }
+}
+
+// Turns a winding-weighted running sum into coverage in [0, 1].
+skvx::float4 coverage(skvx::float4 sum, bool evenOdd) {
+    skvx::float4 a = abs(sum);
+    if (evenOdd) {
+        a = a - 2.f * floor(a * 0.5f);
+        return min(a, 2.f - a);
+    }
+    return min(a, 1.f);
+}
+
+float coverage(float sum, bool evenOdd) {
+    float a = std::abs(sum);
+    if (evenOdd) {
+        a = a - 2 * std::floor(a * 0.5f);
+        return std::min(a, 2 - a);
+    }
+    return std::min(a, 1.f);
+}
+
+// Running-sums n cells of acc into A8 coverage in dst, clearing those cells as it goes.
+void resolve_row(float* acc, int n, bool evenOdd, uint8_t* dst) {
+    using F = skvx::float4;
+    F sum = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        F v = F::Load(acc + i);
+        F(0).store(acc + i);
+        // In-register prefix sum, then add the running total carried over from the left.
+        v += skvx::shuffle<0, 0, 1, 2>(v) * F{0, 1, 1, 1};
+        v += skvx::shuffle<0, 0, 0, 1>(v) * F{0, 0, 1, 1};
+        v += sum;
+        sum = v[3];
+        skvx::cast<uint8_t>(coverage(v, evenOdd) * 255 + 0.5f).store(dst + i);
+    }
+    float s = sum[0];
+    for (; i < n; ++i) {
+        s += acc[i];
+        acc[i] = 0;
+        dst[i] = (uint8_t)(coverage(s, evenOdd) * 255 + 0.5f);
+    }
+}
+
+// Hands one A8 row to the blitter as runs of equal alpha, skipping transparent ends.
+void blit_row_runs(SkBlitter* blitter, int x, int y, const uint8_t* row, int n,
+                   SkAlpha* alpha, int16_t* runs) {
+    int start = 0,
+        end = n;
+    while (start < end && row[start] == 0) {
+        ++start;
+    }
+    while (end > start && row[end - 1] == 0) {
+        --end;
+    }
+    if (start == end) {
+        return;
+    }
+    for (int i = start; i < end;) {
+        int j = i + 1;
+        while (j < end && row[j] == row[i]) {
+            ++j;
+        }
+        runs[i - start] = SkToS16(j - i);
+        alpha[i - start] = row[i];
+        i = j;
+    }
+    runs[end - start] = 0;
+    blitter->blitAntiH(x + start, y, alpha, runs);
+}
+
+}  // namespace
+
+void SkScan::DAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& ir,
+                         const SkIRect& clipBounds, bool forceRLE) {
+    SkASSERT(!path.isInverseFillType());
+
+    SkIRect roi;
+    if (!roi.intersect(ir, clipBounds)) {
+        return;
+    }
+    const int width  = roi.width(),
+              height = roi.height();
+
+    LineBuilder builder((float)width, (float)height);
+    {
+        const SkVector offset = {(float)-roi.fLeft, (float)-roi.fTop};
+        SkPath::Iter iter(path, true);
+        SkPoint pts[4];
+        SkAutoConicToQuads quadder;
+        for (SkPath::Verb verb; (verb = iter.next(pts)) != SkPath::kDone_Verb;) {
+            for (SkPoint& p : pts) {
+                p += offset;
+            }
+            switch (verb) {
+                case SkPath::kLine_Verb:  builder.addLine(pts[0], pts[1]); break;
+                case SkPath::kQuad_Verb:  builder.addQuad(pts);            break;
+                case SkPath::kCubic_Verb: builder.addCubic(pts);           break;
+                case SkPath::kConic_Verb: {
+                    const SkPoint* quads = quadder.computeQuads(pts, iter.conicWeight(),
+                                                                kFlattenTolerance);
+                    for (int i = 0; i < quadder.countQuads(); ++i) {
+                        builder.addQuad(quads + 2 * i);
+                    }
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+
+    auto& lines = builder.lines();
+    if (lines.empty()) {
+        return;
+    }
+    std::sort(lines.begin(), lines.end(),
+              [](const DeltaLine& a, const DeltaLine& b) { return a.fY0 < b.fY0; });
+
+    const bool evenOdd = path.getFillType() == SkPathFillType::kEvenOdd;
+
+    // Two spill cells on the right: a segment touching x == width writes to cell width + 1.
+    const int stride = width + 2;
+    const int stripRows = SkTPin(kStripFloats / stride, 1, std::min(kMaxStripRows, height));
+    skia_private::AutoTMalloc<float> acc(stripRows * stride);
+    skia_private::AutoTMalloc<uint8_t> mask(stripRows * width);
+    std::memset(acc.get(), 0, stripRows * stride * sizeof(float));
+
+    skia_private::AutoTMalloc<SkAlpha> alpha;
+    skia_private::AutoTMalloc<int16_t> runs;
+    if (forceRLE) {
+        alpha.reset(width + 1);
+        runs.reset(width + 1);
+    }
+
+    skia_private::TArray<int> active;
+    int next = 0;
+    for (int top = 0; top < height; top += stripRows) {
+        const int bottom = std::min(top + stripRows, height);
+
+        // Retire the lines that ended above this strip and pick up those that start in it.
+        int kept = 0;
+        for (int index : active) {
+            if (lines[index].fY1 > top) {
+                active[kept++] = index;
+            }
+        }
+        active.resize_back(kept);
+        while (next < lines.size() && lines[next].fY0 < bottom) {
+            active.push_back(next++);
+        }
+        if (active.empty()) {
+            continue;
+        }
+
+        int minCell = stride,
+            maxCell = -1;
+        for (int index : active) {
+            accumulate_line(lines[index], top, bottom, (float)width,
+                            acc.get(), stride, &minCell, &maxCell);
+        }
+        if (maxCell < minCell) {
+            continue;
+        }
+
+        // Everything left of minCell is empty, and a closed path's deltas cancel out by the time
+        // the running sum passes maxCell, so only the touched columns need resolving.
+        const int left = minCell,
+                  n = std::min(maxCell, width) - left;
+        const int rows = bottom - top;
+        for (int y = 0; y < rows; ++y) {
+            float* accRow = acc.get() + y * stride;
+            if (n > 0) {
+                resolve_row(accRow + left, n, evenOdd, mask.get() + y * n);
+            }
+            std::memset(accRow + left + std::max(n, 0), 0,
+                        (maxCell + 1 - left - std::max(n, 0)) * sizeof(float));
+        }
+        if (n <= 0) {
+            continue;
+        }
+
+        if (forceRLE) {
+            for (int y = 0; y < rows; ++y) {
+                blit_row_runs(blitter, roi.fLeft + left, roi.fTop + top + y,
+                              mask.get() + y * n, n, alpha.get(), runs.get());
+            }
+        } else {
+            const SkIRect bounds = SkIRect::MakeXYWH(roi.fLeft + left, roi.fTop + top, n, rows);
+            blitter->blitMask(SkMask(mask.get(), bounds, n, SkMask::kA8_Format), bounds);
+        }
+    }
+}
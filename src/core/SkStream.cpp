@@ -984,3 +984,9 @@ bool StreamRemainingLengthIsBelow(SkStream* stream, size_t len) {
     }
     return false;
 }
+
+bool StreamPadToAlign4(SkWStream* stream) {
+    static constexpr uint8_t kZeros[3] = {0, 0, 0};
+    const size_t padding = SkAlign4(stream->bytesWritten()) - stream->bytesWritten();
+    return padding == 0 || stream->write(kZeros, padding);
+}
@@ -47,4 +47,7 @@ private:
 // certain it will fail.
 bool StreamRemainingLengthIsBelow(SkStream* stream, size_t len);
 
+// Writes zeros until the number of bytes written to the stream is a multiple of 4.
+bool StreamPadToAlign4(SkWStream* stream);
+
 #endif  // SkStreamPriv_DEFINED
@@ -21,6 +21,7 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
@@ -81,6 +82,9 @@ void SkStrike::unlock() {
     const size_t memoryIncrease = fMemoryIncrease;
     fStrikeLock.release();
     this->updateMemoryUsage(memoryIncrease);
+    if (memoryIncrease > 0 && fDiskCache != nullptr) {
+        fDiskCache->strikeChanged(this);
+    }
 }
 
 void
@@ -161,6 +165,89 @@ bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     return true;
 }
 
+bool SkStrike::mergeFromDiskCache(SkReadBuffer& buffer) {
+    // Not in a cache yet, so there is no cache total to update along with fMemoryUsed.
+    SkAutoMutexExclusive lock{fStrikeLock};
+    fMemoryIncrease = 0;
+
+    const int imagesCount = buffer.readInt();
+    for (int curImage = 0; curImage < imagesCount && buffer.isValid(); ++curImage) {
+        SkGlyph* glyph = this->mergeGlyphFromBuffer(buffer);
+        if (!buffer.validate(glyph != nullptr)) {
+            break;
+        }
+        if (!glyph->setImageHasBeenCalled()) {
+            fMemoryIncrease += glyph->addImageFromBuffer(buffer, &fAlloc);
+        } else if (!glyph->isEmpty() && SkGlyphDigest::FitsInAtlas(*glyph)) {
+            // An earlier record had this image.
+            buffer.skipByteArray(nullptr);
+        }
+    }
+
+    // addPathFromBuffer() reads, but doesn't replace, a path the glyph already has.
+    const int pathsCount = buffer.readInt();
+    for (int curPath = 0; curPath < pathsCount && buffer.isValid(); ++curPath) {
+        SkGlyph* glyph = this->mergeGlyphFromBuffer(buffer);
+        if (!buffer.validate(glyph != nullptr)) {
+            break;
+        }
+        fMemoryIncrease += glyph->addPathFromBuffer(buffer, &fAlloc);
+    }
+
+    // Drawables are never written to the disk cache.
+    buffer.validate(buffer.readInt() == 0);
+
+    // Glyphs too big or empty for an image have nothing more to write, so count those images as
+    // written too.
+    fPartsInDiskCache.resize(fGlyphForIndex.size());
+    for (size_t i = 0; i < fGlyphForIndex.size(); ++i) {
+        const SkGlyph* glyph = fGlyphForIndex[i];
+        if (glyph->setImageHasBeenCalled() || glyph->isEmpty() ||
+            !SkGlyphDigest::FitsInAtlas(*glyph)) {
+            fPartsInDiskCache[i] |= kImagePart;
+        }
+        if (glyph->setPathHasBeenCalled()) {
+            fPartsInDiskCache[i] |= kPathPart;
+        }
+    }
+
+    fMemoryUsed += fMemoryIncrease;
+    fMemoryIncrease = 0;
+    return buffer.isValid();
+}
+
+bool SkStrike::flattenForDiskCache(SkWriteBuffer& buffer) {
+    std::vector<SkGlyph> images;
+    std::vector<SkGlyph> paths;
+
+    SkAutoMutexExclusive lock{fStrikeLock};
+    fPartsInDiskCache.resize(fGlyphForIndex.size());
+    for (size_t i = 0; i < fGlyphForIndex.size(); ++i) {
+        const SkGlyph* glyph = fGlyphForIndex[i];
+        uint8_t& written = fPartsInDiskCache[i];
+        if (glyph->extraBits() != 0) {
+            // The scaler's private bits aren't flattened, and it would need them to make the
+            // glyph's other parts later, e.g. for COLR and SVG glyphs.
+            continue;
+        }
+        if (glyph->setImageHasBeenCalled() && !(written & kImagePart)) {
+            images.push_back(*glyph);
+            written |= kImagePart;
+        }
+        if (glyph->setPathHasBeenCalled() && !(written & kPathPart)) {
+            paths.push_back(*glyph);
+            written |= kPathPart;
+        }
+    }
+    if (images.empty() && paths.empty()) {
+        return false;
+    }
+
+    // The copies share their images and paths with the strike's glyphs, so flatten under the lock.
+    FlattenGlyphsByType(buffer, images, paths, {});
+    return true;
+}
+
 SkGlyph* SkStrike::mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& fromGlyph) {
     Monitor m{this};
     // TODO(herb): remove finding the glyph when setting the metrics and image are separated
@@ -172,8 +259,15 @@ SkGlyph* SkStrike::mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& fromG
                 // Should never set an image on a glyph which already has an image.
                 SkDEBUGFAIL("Re-adding image to existing glyph. This should not happen.");
             }
-            // TODO: assert that any metrics on fromGlyph are the same.
-            fMemoryIncrease += glyph->setMetricsAndImage(&fAlloc, fromGlyph);
+            // The glyph may already be published, and findPublished() readers don't take
+            // fStrikeLock, so its metrics are never rewritten. Only take an image laid out the
+            // same way.
+            if (!glyph->setImageHasBeenCalled() && fromGlyph.image() != nullptr &&
+                glyph->maskFormat() == fromGlyph.maskFormat() &&
+                glyph->iRect() == fromGlyph.iRect() &&
+                glyph->setImage(&fAlloc, fromGlyph.image())) {
+                fMemoryIncrease += glyph->imageSize();
+            }
         }
         return glyph;
     } else {
@@ -217,24 +311,48 @@ void SkStrike::findIntercepts(const SkScalar bounds[2], SkScalar scale, SkScalar
 
 SkSpan<const SkGlyph*> SkStrike::metrics(
         SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) {
-    Monitor m{this};
-    return this->internalPrepare(glyphIDs, kMetricsOnly, results);
+    size_t ready = 0;
+    while (ready < glyphIDs.size() &&
+           (results[ready] = this->findPublished(SkPackedGlyphID{glyphIDs[ready]}, kMetricsPart))) {
+        ready++;
+    }
+    if (ready < glyphIDs.size()) {
+        Monitor m{this};
+        this->internalPrepare(glyphIDs.subspan(ready), kMetricsOnly, results + ready);
+    }
+    return {results, glyphIDs.size()};
 }
 
 SkSpan<const SkGlyph*> SkStrike::preparePaths(
         SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) {
-    Monitor m{this};
-    return this->internalPrepare(glyphIDs, kMetricsAndPath, results);
+    size_t ready = 0;
+    while (ready < glyphIDs.size() &&
+           (results[ready] = this->findPublished(SkPackedGlyphID{glyphIDs[ready]}, kPathPart))) {
+        ready++;
+    }
+    if (ready < glyphIDs.size()) {
+        Monitor m{this};
+        this->internalPrepare(glyphIDs.subspan(ready), kMetricsAndPath, results + ready);
+    }
+    return {results, glyphIDs.size()};
 }
 
 SkSpan<const SkGlyph*> SkStrike::prepareImages(
         SkSpan<const SkPackedGlyphID> glyphIDs, const SkGlyph* results[]) {
-    const SkGlyph** cursor = results;
-    Monitor m{this};
-    for (auto glyphID : glyphIDs) {
-        SkGlyph* glyph = this->glyph(glyphID);
-        this->prepareForImage(glyph);
-        *cursor++ = glyph;
+    // Only take the lock once a glyph turns up that isn't already prepared.
+    size_t ready = 0;
+    while (ready < glyphIDs.size() &&
+           (results[ready] = this->findPublished(glyphIDs[ready], kImagePart))) {
+        ready++;
+    }
+    if (ready < glyphIDs.size()) {
+        Monitor m{this};
+        for (size_t i = ready; i < glyphIDs.size(); i++) {
+            SkGlyph* glyph = this->glyph(glyphIDs[i]);
+            this->prepareForImage(glyph);
+            this->publish(glyph, kImagePart);
+            results[i] = glyph;
+        }
     }
 
     return {results, glyphIDs.size()};
@@ -356,6 +474,32 @@ SkGlyphDigest* SkStrike::addGlyphAndDigest(SkGlyph* glyph) {
     return newDigest;
 }
 
+const SkGlyph* SkStrike::findPublished(SkPackedGlyphID packedID, uintptr_t parts) const {
+    const uintptr_t entry =
+            fPublishedGlyphs[packedID.hash() & (kPublishedGlyphCount - 1)].load(
+                    std::memory_order_acquire);
+    const SkGlyph* glyph = reinterpret_cast<const SkGlyph*>(entry & ~uintptr_t{kPartsMask});
+    if (glyph == nullptr || (entry & parts) != parts || glyph->getPackedID() != packedID) {
+        return nullptr;
+    }
+    return glyph;
+}
+
+void SkStrike::publish(SkGlyph* glyph, uintptr_t parts) {
+    static_assert(alignof(SkGlyph) > kPartsMask, "Not enough low bits for the published parts.");
+    std::atomic<uintptr_t>& slot =
+            fPublishedGlyphs[glyph->getPackedID().hash() & (kPublishedGlyphCount - 1)];
+    uintptr_t entry = reinterpret_cast<uintptr_t>(glyph) | parts;
+    // Only writers touch the slots, and they hold fStrikeLock, so this is not a race.
+    const uintptr_t previous = slot.load(std::memory_order_relaxed);
+    if ((previous & ~uintptr_t{kPartsMask}) == reinterpret_cast<uintptr_t>(glyph)) {
+        entry |= previous;
+    }
+    if (entry != previous) {
+        slot.store(entry, std::memory_order_release);
+    }
+}
+
 bool SkStrike::prepareForImage(SkGlyph* glyph) {
     if (glyph->setImage(&fAlloc, fScalerContext.get())) {
         fMemoryIncrease += glyph->imageSize();
@@ -405,7 +549,12 @@ bool SkStrike::mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer) {
     if (!buffer.validate(glyph != nullptr)) {
         return false;
     }
-    fMemoryIncrease += glyph->addImageFromBuffer(buffer, &fAlloc);
+    if (!glyph->setImageHasBeenCalled()) {
+        fMemoryIncrease += glyph->addImageFromBuffer(buffer, &fAlloc);
+    } else if (!glyph->isEmpty() && SkGlyphDigest::FitsInAtlas(*glyph)) {
+        // The glyph already has an image, which may be published, so don't replace it.
+        buffer.skipByteArray(nullptr);
+    }
     return buffer.isValid();
 }
 
@@ -437,6 +586,7 @@ SkSpan<const SkGlyph*> SkStrike::internalPrepare(
         if (pathDetail == kMetricsAndPath) {
             this->prepareForPath(glyph);
         }
+        this->publish(glyph, pathDetail == kMetricsAndPath ? kPathPart : kMetricsPart);
         *cursor++ = glyph;
     }
 
@@ -445,12 +595,13 @@ SkSpan<const SkGlyph*> SkStrike::internalPrepare(
 
 void SkStrike::updateMemoryUsage(size_t increase) {
     if (increase > 0) {
-        // fRemoved and the cache's total memory are managed under the cache's lock. This allows
-        // them to be accessed under LRU operation.
-        SkAutoMutexExclusive lock{fStrikeCache->fLock};
+        // fRemoved and the shard's total memory are managed under the lock of the cache shard
+        // holding this strike. This allows them to be accessed under LRU operation.
+        SkStrikeCache::Shard& shard = fStrikeCache->shardFor(this->getDescriptor());
+        SkAutoMutexExclusive lock{shard.fLock};
         fMemoryUsed += increase;
         if (!fRemoved) {
-            fStrikeCache->fTotalMemoryUsed += increase;
+            shard.fTotalMemoryUsed.fetch_add(increase, std::memory_order_relaxed);
         }
     }
 }
@@ -21,7 +21,9 @@
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -30,6 +32,7 @@ class SkDrawable;
 class SkPath;
 class SkReadBuffer;
 class SkStrikeCache;
+class SkStrikeDiskCache;
 class SkTraceMemoryDump;
 class SkWriteBuffer;
 
@@ -135,6 +138,7 @@ public:
 
 private:
     friend class SkStrikeCache;
+    friend class SkStrikeDiskCache;
     friend class SkStrikeTestingPeer;
     class Monitor;
 
@@ -153,6 +157,14 @@ private:
     // Maintain memory use statistics.
     void updateMemoryUsage(size_t increase) SK_EXCLUDES(fStrikeLock);
 
+    // Merge glyphs read from an SkStrikeDiskCache, skipping any parts the strike already has. The
+    // strike must not be in a cache yet.
+    bool mergeFromDiskCache(SkReadBuffer& buffer) SK_EXCLUDES(fStrikeLock);
+
+    // Flatten the glyph images and paths that are not yet in the disk cache, in the format read
+    // by mergeFromDiskCache(). Returns false if there are none.
+    bool flattenForDiskCache(SkWriteBuffer& buffer) SK_EXCLUDES(fStrikeLock);
+
     enum PathDetail {
         kMetricsOnly,
         kMetricsAndPath
@@ -164,6 +176,21 @@ private:
             PathDetail pathDetail,
             const SkGlyph** results) SK_REQUIRES(fStrikeLock);
 
+    // The parts of a glyph, beyond its metrics, that had been generated when it was published.
+    enum PublishedParts : uintptr_t {
+        kMetricsPart = 0,
+        kImagePart   = 1 << 0,
+        kPathPart    = 1 << 1,
+        kPartsMask   = kImagePart | kPathPart,
+    };
+
+    // Return the glyph for packedID if it has been published with at least the given parts, or
+    // nullptr. This does not take fStrikeLock.
+    const SkGlyph* findPublished(SkPackedGlyphID packedID, uintptr_t parts) const;
+
+    // Make glyph, whose given parts have been generated, visible to findPublished().
+    void publish(SkGlyph* glyph, uintptr_t parts) SK_REQUIRES(fStrikeLock);
+
     // The following are const and need no mutex protection.
     const SkFontMetrics               fFontMetrics;
     const SkGlyphPositionRoundingSpec fRoundingSpec;
@@ -197,7 +224,22 @@ private:
 
     SkArenaAlloc            fAlloc SK_GUARDED_BY(fStrikeLock) {kMinAllocAmount};
 
-    // The following are protected by the SkStrikeCache's mutex.
+    // A small, lossy, direct-mapped table of prepared glyphs, so that threads drawing text from a
+    // warm strike don't all serialize on fStrikeLock. Each entry is a glyph pointer with its
+    // PublishedParts in the low bits. Entries are only written under fStrikeLock, with release
+    // stores after the glyph's parts are generated; glyphs live as long as the strike, and a
+    // generated part is never changed again, so readers need only an acquire load.
+    inline static constexpr int kPublishedGlyphCount = 128;
+    std::atomic<uintptr_t> fPublishedGlyphs[kPublishedGlyphCount]{};
+
+    // The PublishedParts of each glyph, by index, that are already in the disk cache.
+    std::vector<uint8_t> fPartsInDiskCache SK_GUARDED_BY(fStrikeLock);
+
+    // Set by the SkStrikeCache before the strike is shared, if it has a disk cache.
+    SkStrikeDiskCache* fDiskCache{nullptr};
+    std::atomic<bool>  fDiskCacheAppendPending{false};
+
+    // The following are protected by the mutex of the SkStrikeCache shard holding this strike.
     SkStrike*                       fNext{nullptr};
     SkStrike*                       fPrev{nullptr};
     std::unique_ptr<SkStrikePinner> fPinner;
@@ -15,6 +15,7 @@
 #include "include/private/base/SkMutex.h"
 #include "src/core/SkDescriptor.h"
 #include "src/core/SkStrike.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkStrikeSpec.h"
 
 #include <algorithm>
@@ -36,13 +37,43 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
     return cache;
 }
 
+SkStrikeCache::SkStrikeCache() = default;
+
+SkStrikeCache::~SkStrikeCache() = default;
+
 auto SkStrikeCache::findOrCreateStrike(const SkStrikeSpec& strikeSpec) -> sk_sp<SkStrike> {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
-    if (strike == nullptr) {
-        strike = this->internalCreateStrike(strikeSpec);
+    const SkDescriptor& desc = strikeSpec.descriptor();
+    Shard& shard = this->shardFor(desc);
+    sk_sp<SkStrike> strike;
+    {
+        SkAutoMutexExclusive ac(shard.fLock);
+        strike = shard.findStrikeOrNull(desc);
+        if (strike != nullptr) {
+            this->internalPurge(&shard);
+        }
+    }
+    if (strike != nullptr) {
+        this->purgeOverBudget(&shard);
+        return strike;
     }
-    this->internalPurge();
+
+    // Making the scaler context can be slow, so build the strike without holding the shard's
+    // lock. If another thread added the same strike in the meantime, use that one instead.
+    strike = this->makeStrike(strikeSpec);
+    if (SkStrikeDiskCache* diskCache = this->diskCache()) {
+        diskCache->prefill(strike.get());
+        strike->fDiskCache = diskCache;
+    }
+    {
+        SkAutoMutexExclusive ac(shard.fLock);
+        if (sk_sp<SkStrike> existing = shard.findStrikeOrNull(desc)) {
+            strike = std::move(existing);
+        } else {
+            shard.attachToHead(strike);
+        }
+        this->internalPurge(&shard);
+    }
+    this->purgeOverBudget(&shard);
     return strike;
 }
 
@@ -90,13 +121,18 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
-    this->internalPurge();
+    Shard& shard = this->shardFor(desc);
+    sk_sp<SkStrike> result;
+    {
+        SkAutoMutexExclusive ac(shard.fLock);
+        result = shard.findStrikeOrNull(desc);
+        this->internalPurge(&shard);
+    }
+    this->purgeOverBudget(&shard);
     return result;
 }
 
-auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<SkStrike> {
+auto SkStrikeCache::Shard::findStrikeOrNull(const SkDescriptor& desc) -> sk_sp<SkStrike> {
 
     // Check head because it is likely the strike we are looking for.
     if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
@@ -126,58 +162,74 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         const SkStrikeSpec& strikeSpec,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
-    SkAutoMutexExclusive ac(fLock);
-    return this->internalCreateStrike(strikeSpec, maybeMetrics, std::move(pinner));
+    sk_sp<SkStrike> strike = this->makeStrike(strikeSpec, maybeMetrics, std::move(pinner));
+    Shard& shard = this->shardFor(strikeSpec.descriptor());
+    SkAutoMutexExclusive ac(shard.fLock);
+    shard.attachToHead(strike);
+    return strike;
 }
 
-auto SkStrikeCache::internalCreateStrike(
+auto SkStrikeCache::makeStrike(
         const SkStrikeSpec& strikeSpec,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) -> sk_sp<SkStrike> {
     std::unique_ptr<SkScalerContext> scaler = strikeSpec.createScalerContext();
-    auto strike =
-        sk_make_sp<SkStrike>(this, strikeSpec, std::move(scaler), maybeMetrics, std::move(pinner));
-    this->internalAttachToHead(strike);
-    return strike;
+    return sk_make_sp<SkStrike>(this, strikeSpec, std::move(scaler), maybeMetrics,
+                                std::move(pinner));
+}
+
+auto SkStrikeCache::shardFor(const SkDescriptor& desc) -> Shard& {
+    // Use the top bits, since each shard's fStrikeLookup indexes by the bottom bits.
+    return fShards[desc.getChecksum() >> (32 - kShardBits)];
 }
 
 void SkStrikeCache::purgePinned(size_t minBytesNeeded) {
-    SkAutoMutexExclusive ac(fLock);
-    this->internalPurge(minBytesNeeded, /* checkPinners= */ true);
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
+        const size_t freed = this->internalPurge(&shard, minBytesNeeded, /* checkPinners= */ true);
+        minBytesNeeded -= std::min(freed, minBytesNeeded);
+    }
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoMutexExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed, /* checkPinners= */ true);
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
+        this->internalPurge(&shard, shard.fTotalMemoryUsed, /* checkPinners= */ true);
+    }
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fTotalMemoryUsed;
+    size_t total = 0;
+    for (const Shard& shard : fShards) {
+        total += shard.fTotalMemoryUsed.load(std::memory_order_relaxed);
+    }
+    return total;
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheCount;
+    int count = 0;
+    for (const Shard& shard : fShards) {
+        count += shard.fCacheCount.load(std::memory_order_relaxed);
+    }
+    return count;
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheCountLimit;
+    return fCacheCountLimit.load(std::memory_order_relaxed);
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
-    SkAutoMutexExclusive ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit, std::memory_order_relaxed);
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
+        this->internalPurge(&shard);
+    }
+    this->purgeOverBudget(nullptr);
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheSizeLimit;
+    return fCacheSizeLimit.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::setCacheCountLimit(int newCount) {
@@ -185,48 +237,80 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoMutexExclusive ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = fCacheCountLimit.exchange(newCount, std::memory_order_relaxed);
+    for (Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
+        this->internalPurge(&shard);
+    }
+    this->purgeOverBudget(nullptr);
     return prevCount;
 }
 
+bool SkStrikeCache::setDiskCache(std::unique_ptr<SkStrikeDiskCache> diskCache) {
+    SkAutoMutexExclusive ac(fDiskCacheLock);
+    if (fDiskCacheOwner != nullptr) {
+        return false;
+    }
+    fDiskCacheOwner = std::move(diskCache);
+    fDiskCache.store(fDiskCacheOwner.get(), std::memory_order_release);
+    return true;
+}
+
+SkStrikeDiskCache* SkStrikeCache::diskCache() const {
+    return fDiskCache.load(std::memory_order_acquire);
+}
+
 void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor) const {
-    SkAutoMutexExclusive ac(fLock);
+    for (const Shard& shard : fShards) {
+        SkAutoMutexExclusive ac(shard.fLock);
 
-    this->validate();
+        shard.validate();
 
-    for (SkStrike* strike = fHead; strike != nullptr; strike = strike->fNext) {
-        visitor(*strike);
+        for (SkStrike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+            visitor(*strike);
+        }
     }
 }
 
-size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
+size_t SkStrikeCache::internalPurge(Shard* shard, size_t minBytesNeeded, bool checkPinners) {
 #ifndef SK_STRIKE_CACHE_DOESNT_AUTO_CHECK_PINNERS
     // Temporarily default to checking pinners, for staging.
     checkPinners = true;
 #endif
 
-    if (fPinnerCount == fCacheCount && !checkPinners)
+    const size_t shardMemoryUsed = shard->fTotalMemoryUsed.load(std::memory_order_relaxed);
+    const int shardCount = shard->fCacheCount.load(std::memory_order_relaxed);
+    if (shard->fPinnerCount == shardCount && !checkPinners)
         return 0;
 
+    // A shard may grow past its share of a budget while the whole cache is within it, so a few
+    // large strikes that land in the same shard are not thrashed. Once the cache is over budget,
+    // a shard over its share gives back what the cache needs.
+    const size_t sizeLimit = fCacheSizeLimit.load(std::memory_order_relaxed);
+    const size_t sizeShare = (sizeLimit + kShardCount - 1) / kShardCount;
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (shardMemoryUsed > sizeShare) {
+        const size_t totalMemoryUsed = this->getTotalMemoryUsed();
+        if (totalMemoryUsed > sizeLimit) {
+            bytesNeeded = std::min(shardMemoryUsed - sizeShare, totalMemoryUsed - sizeLimit);
+        }
     }
     bytesNeeded = std::max(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = std::max(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = std::max(bytesNeeded, shardMemoryUsed >> 2);
     }
 
+    const int countLimit = fCacheCountLimit.load(std::memory_order_relaxed);
+    const int countShare = (countLimit + kShardCount - 1) / kShardCount;
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
-        // no small purges!
-        countNeeded = std::max(countNeeded, fCacheCount >> 2);
+    if (shardCount > countShare) {
+        const int cacheCount = this->getCacheCountUsed();
+        if (cacheCount > countLimit) {
+            countNeeded = std::min(shardCount - countShare, cacheCount - countLimit);
+            // no small purges!
+            countNeeded = std::max(countNeeded, shardCount >> 2);
+        }
     }
 
     // early exit
@@ -234,12 +318,78 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
         return 0;
     }
 
+    return this->purgeFromTail(shard, bytesNeeded, countNeeded, checkPinners, nullptr);
+}
+
+void SkStrikeCache::purgeOverBudget(const Shard* mostRecent) {
+    // internalPurge() only trims a shard back to its share of the budgets, so shards that are
+    // each within, or only a little over, their shares can leave the cache as a whole over
+    // budget. Take what is still needed from the shards furthest over their shares, one shard
+    // lock at a time. Each shard either covers what remains or gives up all it can, so this
+    // takes at most one pass per shard.
+    bool exhausted[kShardCount] = {};
+    for (int pass = 0; pass < kShardCount; ++pass) {
+        const size_t sizeLimit = fCacheSizeLimit.load(std::memory_order_relaxed);
+        const int countLimit = fCacheCountLimit.load(std::memory_order_relaxed);
+        const size_t totalMemoryUsed = this->getTotalMemoryUsed();
+        const int cacheCount = this->getCacheCountUsed();
+        const bool overSize = totalMemoryUsed > sizeLimit;
+        if (!overSize && cacheCount <= countLimit) {
+            return;
+        }
+
+        const int64_t sizeShare = (sizeLimit + kShardCount - 1) / kShardCount;
+        const int64_t countShare = (countLimit + kShardCount - 1) / kShardCount;
+        int victim = -1;
+        int64_t victimExcess = 0;
+        for (int i = 0; i < kShardCount; ++i) {
+            const Shard& shard = fShards[i];
+            if (exhausted[i] || shard.fCacheCount.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            const int64_t excess =
+                    overSize ? (int64_t)shard.fTotalMemoryUsed.load(std::memory_order_relaxed) -
+                                       sizeShare
+                             : (int64_t)shard.fCacheCount.load(std::memory_order_relaxed) -
+                                       countShare;
+            // On a tie, keep the strikes of the shard that was just used.
+            if (victim < 0 || excess > victimExcess ||
+                (excess == victimExcess && &fShards[victim] == mostRecent)) {
+                victim = i;
+                victimExcess = excess;
+            }
+        }
+        if (victim < 0) {
+            return;
+        }
+
+        Shard& shard = fShards[victim];
+        SkAutoMutexExclusive ac(shard.fLock);
+        int countFreed = 0;
+        this->purgeFromTail(&shard,
+                            overSize ? totalMemoryUsed - sizeLimit : 0,
+                            std::max(cacheCount - countLimit, 0),
+                            /* checkPinners= */ false,
+                            &countFreed);
+        if (shard.fCacheCount.load(std::memory_order_relaxed) == 0 || countFreed == 0) {
+            exhausted[victim] = true;
+        }
+    }
+}
+
+size_t SkStrikeCache::purgeFromTail(
+        Shard* shard, size_t bytesNeeded, int countNeeded, bool checkPinners, int* freed) {
+#ifndef SK_STRIKE_CACHE_DOESNT_AUTO_CHECK_PINNERS
+    // Temporarily default to checking pinners, for staging.
+    checkPinners = true;
+#endif
+
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
     // Start at the tail and proceed backwards deleting; the list is in LRU
     // order, with unimportant entries at the tail.
-    SkStrike* strike = fTail;
+    SkStrike* strike = shard->fTail;
     while (strike != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
         SkStrike* prev = strike->fPrev;
 
@@ -247,12 +397,12 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
         if (strike->fPinner == nullptr || (checkPinners && strike->fPinner->canDelete())) {
             bytesFreed += strike->fMemoryUsed;
             countFreed += 1;
-            this->internalRemoveStrike(strike);
+            shard->removeStrike(strike);
         }
         strike = prev;
     }
 
-    this->validate();
+    shard->validate();
 
 #ifdef SPEW_PURGE_STATUS
     if (countFreed) {
@@ -261,18 +411,21 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
     }
 #endif
 
+    if (freed != nullptr) {
+        *freed = countFreed;
+    }
     return bytesFreed;
 }
 
-void SkStrikeCache::internalAttachToHead(sk_sp<SkStrike> strike) {
+void SkStrikeCache::Shard::attachToHead(sk_sp<SkStrike> strike) {
     SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
     SkStrike* strikePtr = strike.get();
     fStrikeLookup.set(std::move(strike));
     SkASSERT(nullptr == strikePtr->fPrev && nullptr == strikePtr->fNext);
 
-    fCacheCount += 1;
+    fCacheCount.fetch_add(1, std::memory_order_relaxed);
     fPinnerCount += strikePtr->fPinner != nullptr ? 1 : 0;
-    fTotalMemoryUsed += strikePtr->fMemoryUsed;
+    fTotalMemoryUsed.fetch_add(strikePtr->fMemoryUsed, std::memory_order_relaxed);
 
     if (fHead != nullptr) {
         fHead->fPrev = strikePtr;
@@ -286,11 +439,11 @@ void SkStrikeCache::internalAttachToHead(sk_sp<SkStrike> strike) {
     fHead = strikePtr; // Transfer ownership of strike to the cache list.
 }
 
-void SkStrikeCache::internalRemoveStrike(SkStrike* strike) {
+void SkStrikeCache::Shard::removeStrike(SkStrike* strike) {
     SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
+    fCacheCount.fetch_sub(1, std::memory_order_relaxed);
     fPinnerCount -= strike->fPinner != nullptr ? 1 : 0;
-    fTotalMemoryUsed -= strike->fMemoryUsed;
+    fTotalMemoryUsed.fetch_sub(strike->fMemoryUsed, std::memory_order_relaxed);
 
     if (strike->fPrev) {
         strike->fPrev->fNext = strike->fNext;
@@ -308,7 +461,7 @@ void SkStrikeCache::internalRemoveStrike(SkStrike* strike) {
     fStrikeLookup.remove(strike->getDescriptor());
 }
 
-void SkStrikeCache::validate() const {
+void SkStrikeCache::Shard::validate() const {
 #ifdef SK_DEBUG
     size_t computedBytes = 0;
     int computedCount = 0;
@@ -321,12 +474,14 @@ void SkStrikeCache::validate() const {
         strike = strike->fNext;
     }
 
-    if (fCacheCount != computedCount) {
-        SkDebugf("fCacheCount: %d, computedCount: %d", fCacheCount, computedCount);
+    const int cacheCount = fCacheCount.load(std::memory_order_relaxed);
+    const size_t totalMemoryUsed = fTotalMemoryUsed.load(std::memory_order_relaxed);
+    if (cacheCount != computedCount) {
+        SkDebugf("fCacheCount: %d, computedCount: %d", cacheCount, computedCount);
         SK_ABORT("fCacheCount != computedCount");
     }
-    if (fTotalMemoryUsed != computedBytes) {
-        SkDebugf("fTotalMemoryUsed: %zu, computedBytes: %zu", fTotalMemoryUsed, computedBytes);
+    if (totalMemoryUsed != computedBytes) {
+        SkDebugf("fTotalMemoryUsed: %zu, computedBytes: %zu", totalMemoryUsed, computedBytes);
         SK_ABORT("fTotalMemoryUsed == computedBytes");
     }
 #endif
@@ -339,5 +494,3 @@ const SkDescriptor& SkStrikeCache::StrikeTraits::GetKey(const sk_sp<SkStrike>& s
 uint32_t SkStrikeCache::StrikeTraits::Hash(const SkDescriptor& descriptor) {
     return descriptor.getChecksum();
 }
-
-
@@ -16,12 +16,14 @@
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 
 class SkDescriptor;
+class SkStrikeDiskCache;
 class SkStrikeSpec;
 class SkTraceMemoryDump;
 struct SkFontMetrics;
@@ -40,21 +42,22 @@ struct SkFontMetrics;
 
 class SkStrikeCache final : public sktext::StrikeForGPUCacheInterface {
 public:
-    SkStrikeCache() = default;
+    SkStrikeCache();
+    ~SkStrikeCache() override;
 
     static SkStrikeCache* GlobalStrikeCache();
 
-    sk_sp<SkStrike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
+    sk_sp<SkStrike> findStrike(const SkDescriptor& desc);
 
     sk_sp<SkStrike> createStrike(
             const SkStrikeSpec& strikeSpec,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_EXCLUDES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
-    sk_sp<SkStrike> findOrCreateStrike(const SkStrikeSpec& strikeSpec) SK_EXCLUDES(fLock);
+    sk_sp<SkStrike> findOrCreateStrike(const SkStrikeSpec& strikeSpec);
 
     sk_sp<sktext::StrikeForGPU> findOrCreateScopedStrike(
-            const SkStrikeSpec& strikeSpec) override SK_EXCLUDES(fLock);
+            const SkStrikeSpec& strikeSpec) override;
 
     static void PurgeAll();
     static void Dump();
@@ -63,55 +66,95 @@ public:
     // SkTraceMemoryDump interface.
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
-    void purgeAll() SK_EXCLUDES(fLock); // does not change budget
-    void purgePinned(size_t minBytesNeeded = 0) SK_EXCLUDES(fLock);
+    void purgeAll(); // does not change budget
+    void purgePinned(size_t minBytesNeeded = 0);
 
-    int getCacheCountLimit() const SK_EXCLUDES(fLock);
-    int setCacheCountLimit(int limit) SK_EXCLUDES(fLock);
-    int getCacheCountUsed() const SK_EXCLUDES(fLock);
+    int getCacheCountLimit() const;
+    int setCacheCountLimit(int limit);
+    int getCacheCountUsed() const;
 
-    size_t getCacheSizeLimit() const SK_EXCLUDES(fLock);
-    size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
-    size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
+    size_t getCacheSizeLimit() const;
+    size_t setCacheSizeLimit(size_t limit);
+    size_t getTotalMemoryUsed() const;
+
+    // Fill new strikes from diskCache, and append the glyphs they generate to it. This can only
+    // be set once, and should be set before any strikes are made. Returns false if the cache
+    // already has a disk cache.
+    bool setDiskCache(std::unique_ptr<SkStrikeDiskCache> diskCache);
+    SkStrikeDiskCache* diskCache() const;
 
 private:
-    friend class SkStrike;  // for SkStrike::updateDelta
+    friend class SkStrike;  // for SkStrike::updateMemoryUsage
     static constexpr char kGlyphCacheDumpName[] = "skia/sk_glyph_cache";
-    sk_sp<SkStrike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
-    sk_sp<SkStrike> internalCreateStrike(
+
+    // The strikes are split across independently locked shards by the checksum of their
+    // descriptors, so that threads drawing with different strikes rarely contend. Each shard
+    // keeps its own LRU list, and is purged back toward its share of the cache's budgets; when
+    // the cache as a whole is over budget, the shards furthest over their shares are purged too.
+    inline static constexpr int kShardBits = 3;
+    inline static constexpr int kShardCount = 1 << kShardBits;
+
+    struct StrikeTraits {
+        static const SkDescriptor& GetKey(const sk_sp<SkStrike>& strike);
+        static uint32_t Hash(const SkDescriptor& descriptor);
+    };
+
+    struct Shard {
+        sk_sp<SkStrike> findStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
+        void attachToHead(sk_sp<SkStrike> strike) SK_REQUIRES(fLock);
+        void removeStrike(SkStrike* strike) SK_REQUIRES(fLock);
+
+        // A simple accounting of what each glyph cache reports and the shard total.
+        void validate() const SK_REQUIRES(fLock);
+
+        mutable SkMutex fLock;
+        SkStrike* fHead SK_GUARDED_BY(fLock) {nullptr};
+        SkStrike* fTail SK_GUARDED_BY(fLock) {nullptr};
+        skia_private::THashTable<sk_sp<SkStrike>, SkDescriptor, StrikeTraits> fStrikeLookup
+                SK_GUARDED_BY(fLock);
+
+        // These are only changed under fLock, but are read without it when summing the totals
+        // of the whole cache.
+        std::atomic<size_t>  fTotalMemoryUsed{0};
+        std::atomic<int32_t> fCacheCount{0};
+        int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+    };
+
+    Shard& shardFor(const SkDescriptor& desc);
+
+    sk_sp<SkStrike> makeStrike(
             const SkStrikeSpec& strikeSpec,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
-
-    // The following methods can only be called when mutex is already held.
-    void internalRemoveStrike(SkStrike* strike) SK_REQUIRES(fLock);
-    void internalAttachToHead(sk_sp<SkStrike> strike) SK_REQUIRES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
+    // and attempt to purge the shard's caches to match.
     // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0, bool checkPinners = false) SK_REQUIRES(fLock);
+    size_t internalPurge(Shard* shard, size_t minBytesNeeded = 0, bool checkPinners = false)
+            SK_REQUIRES(shard->fLock);
 
-    // A simple accounting of what each glyph cache reports and the strike cache total.
-    void validate() const SK_REQUIRES(fLock);
+    // While the whole cache is over either budget, purge the shards furthest over their shares
+    // of it. Takes each shard's lock in turn, so no shard lock may be held by the caller. On a
+    // tie, the strikes of mostRecent are kept.
+    void purgeOverBudget(const Shard* mostRecent);
 
-    void forEachStrike(std::function<void(const SkStrike&)> visitor) const SK_EXCLUDES(fLock);
+    // Remove strikes from the LRU end of shard until bytesNeeded and countNeeded are both freed
+    // or nothing more can be. Returns the number of bytes freed, and the number of strikes in
+    // countFreed if it is not nullptr.
+    size_t purgeFromTail(Shard* shard, size_t bytesNeeded, int countNeeded, bool checkPinners,
+                         int* countFreed) SK_REQUIRES(shard->fLock);
 
-    mutable SkMutex fLock;
-    SkStrike* fHead SK_GUARDED_BY(fLock) {nullptr};
-    SkStrike* fTail SK_GUARDED_BY(fLock) {nullptr};
-    struct StrikeTraits {
-        static const SkDescriptor& GetKey(const sk_sp<SkStrike>& strike);
-        static uint32_t Hash(const SkDescriptor& descriptor);
-    };
-    skia_private::THashTable<sk_sp<SkStrike>, SkDescriptor, StrikeTraits> fStrikeLookup
-            SK_GUARDED_BY(fLock);
-
-    size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
-    int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
-    int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+    void forEachStrike(std::function<void(const SkStrike&)> visitor) const;
+
+    Shard fShards[kShardCount];
+
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
+
+    // Destroyed first, so its pending appends finish while the strikes are still cached.
+    SkMutex fDiskCacheLock;
+    std::unique_ptr<SkStrikeDiskCache> fDiskCacheOwner SK_GUARDED_BY(fDiskCacheLock);
+    std::atomic<SkStrikeDiskCache*> fDiskCache{nullptr};
 };
 
 #endif  // SkStrikeCache_DEFINED
@@ -0,0 +1,363 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkStrikeDiskCache.h"
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkMilestone.h"
+#include "include/core/SkStream.h"
+#include "include/private/base/SkAlign.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrike.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+struct FileHeader {
+    uint32_t fMagic;
+    uint32_t fFormatVersion;
+    uint32_t fMilestone;
+    uint32_t fRecSize;
+};
+
+// Bump this when the record layout, or the glyph flattening it contains, changes.
+constexpr uint32_t kFormatVersion = 1;
+
+constexpr FileHeader kFileHeader = {
+    SkSetFourByteTag('s', 'k', 'g', 'c'),
+    kFormatVersion,
+    SK_MILESTONE,
+    sizeof(SkScalerContextRec),
+};
+
+// Each record is a RecordHeader, then fBodyLength bytes: a RecordBody, the descriptor and the
+// flattened glyphs, the last two padded to 4 bytes.
+struct RecordHeader {
+    uint32_t fBodyLength;
+    uint32_t fChecksum;  // Hash32 of the body, to catch records torn by a crash.
+};
+
+struct RecordBody {
+    uint32_t fFingerprint[2];
+    uint32_t fDescriptorLength;
+    uint32_t fPayloadLength;
+};
+
+// The sfnt table directory at the start of a font holds a checksum of each of its tables, so this
+// much of the font data, along with its length, tells versions of a font apart without reading
+// all of it.
+constexpr size_t kFingerprintPrefixBytes = 64 * 1024;
+}  // namespace
+
+template <typename RecordProc>
+size_t SkStrikeDiskCache::ForEachRecord(const SkData& contents, RecordProc&& recordProc) {
+    const uint8_t* const start = contents.bytes();
+    const uint8_t* const end = start + contents.size();
+    if (contents.size() < sizeof(FileHeader) ||
+        memcmp(start, &kFileHeader, sizeof(FileHeader)) != 0) {
+        return 0;
+    }
+
+    const uint8_t* cursor = start + sizeof(FileHeader);
+    while ((size_t)(end - cursor) >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        memcpy(&header, cursor, sizeof(header));
+        const uint8_t* body = cursor + sizeof(RecordHeader);
+        if (header.fBodyLength < sizeof(RecordBody) ||
+            header.fBodyLength > (size_t)(end - body) ||
+            SkChecksum::Hash32(body, header.fBodyLength) != header.fChecksum) {
+            break;
+        }
+
+        RecordBody recordBody;
+        memcpy(&recordBody, body, sizeof(recordBody));
+        const size_t descriptorSpace = SkAlign4((size_t)recordBody.fDescriptorLength),
+                     payloadSpace    = SkAlign4((size_t)recordBody.fPayloadLength);
+        if (sizeof(RecordBody) + descriptorSpace + payloadSpace != header.fBodyLength) {
+            break;
+        }
+
+        Record record;
+        record.fFingerprint = (uint64_t)recordBody.fFingerprint[0] << 32 |
+                                        recordBody.fFingerprint[1];
+        record.fDescriptor = body + sizeof(RecordBody);
+        record.fDescriptorLength = recordBody.fDescriptorLength;
+        record.fPayload = record.fDescriptor + descriptorSpace;
+        record.fPayloadLength = recordBody.fPayloadLength;
+        recordProc(record);
+
+        cursor = body + header.fBodyLength;
+    }
+    return cursor - start;
+}
+
+sk_sp<SkData> SkStrikeDiskCache::Compact(const SkData& contents, size_t byteLimit) {
+    struct Span {
+        uint64_t fKey;
+        size_t   fOffset;
+        size_t   fLength;
+    };
+    std::vector<Span> spans;
+    const size_t intactLength = ForEachRecord(contents, [&](const Record& record) {
+        const uint8_t* start = record.fDescriptor - sizeof(RecordBody) - sizeof(RecordHeader);
+        const uint8_t* end = record.fPayload + SkAlign4(record.fPayloadLength);
+        spans.push_back({SkChecksum::Hash64(record.fDescriptor, record.fDescriptorLength,
+                                            record.fFingerprint),
+                         (size_t)(start - contents.bytes()),
+                         (size_t)(end - start)});
+    });
+    if (intactLength == 0) {
+        return nullptr;
+    }
+
+    // A strike's records each hold the glyphs it had generated since the last one, so a strike is
+    // kept or dropped as a whole. Keep the strikes appended to last, while they fit.
+    skia_private::THashMap<uint64_t, size_t> strikeBytes;
+    for (const Span& span : spans) {
+        strikeBytes[span.fKey] += span.fLength;
+    }
+    skia_private::THashMap<uint64_t, bool> kept;
+    size_t keptBytes = sizeof(FileHeader);
+    for (auto span = spans.rbegin(); span != spans.rend(); ++span) {
+        if (!kept.find(span->fKey)) {
+            const size_t bytes = strikeBytes[span->fKey];
+            const bool fits = keptBytes + bytes <= byteLimit;
+            kept.set(span->fKey, fits);
+            keptBytes += fits ? bytes : 0;
+        }
+    }
+
+    sk_sp<SkData> compacted = SkData::MakeUninitialized(keptBytes);
+    uint8_t* cursor = static_cast<uint8_t*>(compacted->writable_data());
+    memcpy(cursor, &kFileHeader, sizeof(FileHeader));
+    cursor += sizeof(FileHeader);
+    for (const Span& span : spans) {
+        if (*kept.find(span.fKey)) {
+            memcpy(cursor, contents.bytes() + span.fOffset, span.fLength);
+            cursor += span.fLength;
+        }
+    }
+    SkASSERT(cursor == compacted->bytes() + keptBytes);
+    return compacted;
+}
+
+std::unique_ptr<SkStrikeDiskCache> SkStrikeDiskCache::Make(const char path[], size_t byteLimit) {
+    byteLimit = std::max(byteLimit, sizeof(FileHeader));
+    sk_sp<SkData> mapped = SkData::MakeFromFileName(path);
+    const size_t intactLength =
+            mapped ? ForEachRecord(*mapped, [](const Record&) {}) : 0;
+
+    FILE* file = nullptr;
+    if (intactLength > 0 && intactLength == mapped->size() && intactLength <= byteLimit / 4 * 3) {
+        file = sk_fopen(path, kAppend_SkFILE_Flag);
+    } else {
+        // Start the file over, keeping the intact records before any torn one. If the file is
+        // nearly full, keep only up to half of the limit, so there is room for new glyphs. The
+        // records must be copied out of the mapping before the file is truncated under it.
+        mapped = intactLength > 0
+                         ? Compact(*mapped, intactLength <= byteLimit / 4 * 3 ? byteLimit
+                                                                              : byteLimit / 2)
+                         : nullptr;
+        file = sk_fopen(path, kWrite_SkFILE_Flag);
+        if (file) {
+            bool written = mapped ? sk_fwrite(mapped->data(), mapped->size(), file) ==
+                                            mapped->size()
+                                  : sk_fwrite(&kFileHeader, sizeof(kFileHeader), file) ==
+                                            sizeof(kFileHeader);
+            sk_fflush(file);
+            if (!written) {
+                sk_fclose(file);
+                file = nullptr;
+            }
+        }
+    }
+
+    if (!file) {
+        return nullptr;
+    }
+    const size_t fileBytes = mapped ? mapped->size() : sizeof(kFileHeader);
+    return std::unique_ptr<SkStrikeDiskCache>(
+            new SkStrikeDiskCache(std::move(mapped), file, fileBytes, byteLimit));
+}
+
+SkStrikeDiskCache::SkStrikeDiskCache(sk_sp<SkData> mapped, FILE* file, size_t fileBytes,
+                                     size_t byteLimit)
+        : fMapped{std::move(mapped)}
+        , fFile{file}
+        , fFileBytes{fileBytes}
+        , fByteLimit{byteLimit}
+        , fExecutor{SkExecutor::MakeFIFOThreadPool(1, /*allowBorrowing=*/false)}
+        , fAppends{*fExecutor} {
+    if (fMapped) {
+        ForEachRecord(*fMapped, [this](const Record& record) {
+            const uint64_t hash = SkChecksum::Hash64(
+                    record.fDescriptor, record.fDescriptorLength, record.fFingerprint);
+            if (std::vector<Record>* records = fRecords.find(hash)) {
+                records->push_back(record);
+            } else {
+                fRecords.set(hash, {record});
+            }
+        });
+    }
+}
+
+SkStrikeDiskCache::~SkStrikeDiskCache() {
+    this->flush();
+    SkAutoMutexExclusive lock{fFileLock};
+    sk_fclose(fFile);
+}
+
+void SkStrikeDiskCache::flush() {
+    fAppends.wait();
+}
+
+bool SkStrikeDiskCache::fingerprint(const SkTypeface& typeface, uint64_t* fingerprint) {
+    {
+        SkAutoMutexExclusive lock{fFingerprintLock};
+        if (const uint64_t* found = fFingerprints.find(typeface.uniqueID())) {
+            *fingerprint = *found;
+            return *found != 0;
+        }
+    }
+
+    // Two threads may both hash a typeface seen for the first time; they get the same hash.
+    uint64_t hash = 0;
+    int ttcIndex = 0;
+    if (std::unique_ptr<SkStreamAsset> stream = typeface.openStream(&ttcIndex)) {
+        const uint64_t length = stream->getLength();
+        hash = SkChecksum::Hash64(&ttcIndex, sizeof(ttcIndex));
+        hash = SkChecksum::Hash64(&length, sizeof(length), hash);
+        char buffer[4096];
+        size_t remaining = kFingerprintPrefixBytes;
+        while (size_t bytesRead = stream->read(buffer, std::min(remaining, sizeof(buffer)))) {
+            hash = SkChecksum::Hash64(buffer, bytesRead, hash);
+            remaining -= bytesRead;
+        }
+
+        // Instances of a variable font share the font data.
+        using Coordinate = SkFontArguments::VariationPosition::Coordinate;
+        const int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+        if (axisCount > 0) {
+            std::vector<Coordinate> coordinates(axisCount);
+            if (typeface.getVariationDesignPosition(coordinates.data(), axisCount) == axisCount) {
+                hash = SkChecksum::Hash64(coordinates.data(), axisCount * sizeof(Coordinate),
+                                          hash);
+            }
+        }
+        hash = hash != 0 ? hash : 1;
+    }
+
+    SkAutoMutexExclusive lock{fFingerprintLock};
+    fFingerprints.set(typeface.uniqueID(), hash);
+    *fingerprint = hash;
+    return hash != 0;
+}
+
+bool SkStrikeDiskCache::makeKey(const SkStrike& strike, Key* key) {
+    if (!this->fingerprint(strike.strikeSpec().typeface(), &key->fFingerprint)) {
+        return false;
+    }
+
+    // Clear the typeface ID in the rec, which is only meaningful to this process.
+    SkAutoDescriptor normalized{strike.getDescriptor()};
+    SkDescriptor* desc = normalized.getDesc();
+    uint32_t size;
+    // findEntry returns a const void*, remove the const in order to update in place.
+    void* ptr = const_cast<void*>(desc->findEntry(kRec_SkDescriptorTag, &size));
+    SkScalerContextRec rec;
+    if (!ptr || size != sizeof(rec)) {
+        return false;
+    }
+    memcpy((void*)&rec, ptr, size);
+    rec.fTypefaceID = 0;
+    memcpy(ptr, &rec, size);
+    desc->computeChecksum();
+
+    key->fDescriptor = SkData::MakeWithCopy(desc, desc->getLength());
+    key->fHash = SkChecksum::Hash64(key->fDescriptor->data(), key->fDescriptor->size(),
+                                    key->fFingerprint);
+    return true;
+}
+
+int SkStrikeDiskCache::prefill(SkStrike* strike) {
+    Key key;
+    if (!this->makeKey(*strike, &key)) {
+        return 0;
+    }
+    const std::vector<Record>* records = fRecords.find(key.fHash);
+    if (!records) {
+        return 0;
+    }
+
+    int merged = 0;
+    for (const Record& record : *records) {
+        if (record.fFingerprint != key.fFingerprint ||
+            record.fDescriptorLength != key.fDescriptor->size() ||
+            memcmp(record.fDescriptor, key.fDescriptor->data(), record.fDescriptorLength) != 0) {
+            continue;
+        }
+        SkReadBuffer buffer{record.fPayload, record.fPayloadLength};
+        if (!strike->mergeFromDiskCache(buffer)) {
+            break;
+        }
+        merged++;
+    }
+    return merged;
+}
+
+void SkStrikeDiskCache::strikeChanged(SkStrike* strike) {
+    // Coalesce a burst of changes into one append.
+    if (!strike->fDiskCacheAppendPending.exchange(true)) {
+        fAppends.add([this, strike = sk_ref_sp(strike)] { this->append(strike.get()); });
+    }
+}
+
+void SkStrikeDiskCache::append(SkStrike* strike) {
+    strike->fDiskCacheAppendPending.store(false);
+
+    Key key;
+    if (!this->makeKey(*strike, &key)) {
+        return;
+    }
+    SkBinaryWriteBuffer buffer;
+    if (!strike->flattenForDiskCache(buffer)) {
+        return;
+    }
+    sk_sp<SkData> payload = buffer.snapshotAsData();
+
+    const size_t descriptorSpace = SkAlign4(key.fDescriptor->size()),
+                 payloadSpace    = SkAlign4(payload->size());
+    std::vector<uint8_t> body(sizeof(RecordBody) + descriptorSpace + payloadSpace, 0);
+    const RecordBody recordBody = {
+        {(uint32_t)(key.fFingerprint >> 32), (uint32_t)key.fFingerprint},
+        (uint32_t)key.fDescriptor->size(),
+        (uint32_t)payload->size(),
+    };
+    memcpy(body.data(), &recordBody, sizeof(recordBody));
+    memcpy(body.data() + sizeof(RecordBody), key.fDescriptor->data(), key.fDescriptor->size());
+    memcpy(body.data() + sizeof(RecordBody) + descriptorSpace, payload->data(), payload->size());
+
+    const RecordHeader header = {(uint32_t)body.size(),
+                                 SkChecksum::Hash32(body.data(), body.size())};
+    SkAutoMutexExclusive lock{fFileLock};
+    // Once the file is full, new glyphs wait for it to be compacted the next time it is opened.
+    if (sizeof(header) + body.size() > fByteLimit - fFileBytes) {
+        return;
+    }
+    sk_fwrite(&header, sizeof(header), fFile);
+    sk_fwrite(body.data(), body.size(), fFile);
+    sk_fflush(fFile);
+    fFileBytes += sizeof(header) + body.size();
+}
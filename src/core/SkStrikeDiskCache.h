@@ -0,0 +1,120 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikeDiskCache_DEFINED
+#define SkStrikeDiskCache_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+class SkExecutor;
+class SkStrike;
+
+/**
+ *  A file of glyph metrics, images and paths that outlives the process, so that a new process can
+ *  fill its strikes from it instead of running the scaler again for the same glyphs.
+ *
+ *  The file is a header followed by records. Each record holds the glyphs of one strike, keyed by
+ *  its descriptor (with the process-local typeface ID cleared) and a fingerprint of the typeface's
+ *  font data, and flattened the same way SkStrikeServer sends them to an SkStrikeClient. Existing
+ *  records are memory mapped when the cache is opened. Glyphs that strikes generate afterwards are
+ *  appended as new records on a background thread.
+ *
+ *  A file written by another version of Skia is discarded and started over. Records for a font
+ *  file whose contents have changed no longer match any fingerprint and are ignored. Only one
+ *  process should write a given file at a time.
+ *
+ *  The file is kept under a byte limit. Appends that would take it over the limit are dropped.
+ *  A file that is more than three quarters full when opened is rewritten with the records of the
+ *  strikes appended to most recently, up to half the limit, to make room for new glyphs.
+ */
+class SkStrikeDiskCache {
+public:
+    static constexpr size_t kDefaultByteLimit = 32 << 20;
+
+    // Returns nullptr if the file can't be opened for writing.
+    static std::unique_ptr<SkStrikeDiskCache> Make(const char path[],
+                                                   size_t byteLimit = kDefaultByteLimit);
+
+    ~SkStrikeDiskCache();
+
+    // Merge the glyphs recorded for strike into it. This must be done before the strike is added
+    // to a cache. Returns the number of records merged.
+    int prefill(SkStrike* strike);
+
+    // Called when strike has generated new glyph images or paths. They are appended to the file
+    // on the background thread.
+    void strikeChanged(SkStrike* strike);
+
+    // Wait until all the appends started so far are written to the file.
+    void flush();
+
+private:
+    struct Key {
+        uint64_t fFingerprint;
+        sk_sp<SkData> fDescriptor;  // The strike's descriptor with the typeface ID cleared.
+        uint64_t fHash;
+    };
+
+    struct Record {
+        uint64_t       fFingerprint;
+        const uint8_t* fDescriptor;
+        size_t         fDescriptorLength;
+        const uint8_t* fPayload;
+        size_t         fPayloadLength;
+    };
+
+    SkStrikeDiskCache(sk_sp<SkData> mapped, FILE* file, size_t fileBytes, size_t byteLimit);
+
+    // Calls recordProc for each intact record in the file contents. Returns the length of the
+    // header and intact records, or 0 if the header is not from this version.
+    template <typename RecordProc>
+    static size_t ForEachRecord(const SkData& contents, RecordProc&& recordProc);
+
+    // Returns a copy of the header and intact records of contents, keeping only the records of the
+    // strikes appended to most recently if they don't all fit in byteLimit.
+    static sk_sp<SkData> Compact(const SkData& contents, size_t byteLimit);
+
+    // Returns false if the strike's glyphs can't be persisted, e.g. if its typeface has no data.
+    bool makeKey(const SkStrike& strike, Key* key);
+
+    // A hash of the typeface's font data, computed once per typeface. Only a bounded prefix of the
+    // data is read, outside of fFingerprintLock.
+    bool fingerprint(const SkTypeface& typeface, uint64_t* fingerprint);
+
+    void append(SkStrike* strike);
+
+    // The records found when the file was opened, by key hash.
+    const sk_sp<SkData> fMapped;
+    skia_private::THashMap<uint64_t, std::vector<Record>> fRecords;
+
+    SkMutex fFingerprintLock;
+    // A fingerprint of 0 means the typeface has no font data to hash.
+    skia_private::THashMap<SkTypefaceID, uint64_t> fFingerprints SK_GUARDED_BY(fFingerprintLock);
+
+    SkMutex fFileLock;
+    FILE* const fFile SK_PT_GUARDED_BY(fFileLock);
+    size_t fFileBytes SK_GUARDED_BY(fFileLock);
+    const size_t fByteLimit;
+
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkTaskGroup fAppends;
+};
+
+#endif  // SkStrikeDiskCache_DEFINED
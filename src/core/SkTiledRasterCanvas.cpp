@@ -0,0 +1,453 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkTiledRasterCanvas.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurface.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkRTree.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+using namespace skia_private;
+
+// Reading, peeking or writing pixels must see every draw issued before it, so the device playing
+// the role of our base layer flushes the canvas before any direct pixel access.
+class SkTiledRasterCanvas::Device final : public SkBitmapDevice {
+public:
+    Device(const SkBitmap& bitmap, const SkSurfaceProps& props, SkTiledRasterCanvas* owner)
+            : SkBitmapDevice(bitmap, props)
+            , fOwner(owner) {}
+
+    // Pixel access for playback itself, which must not recurse into flush().
+    bool accessPixelsNoFlush(SkPixmap* pm) { return this->SkBitmapDevice::onAccessPixels(pm); }
+
+protected:
+    bool onReadPixels(const SkPixmap& pm, int x, int y) override {
+        fOwner->flush();
+        return this->SkBitmapDevice::onReadPixels(pm, x, y);
+    }
+    bool onWritePixels(const SkPixmap& pm, int x, int y) override {
+        fOwner->flush();
+        return this->SkBitmapDevice::onWritePixels(pm, x, y);
+    }
+    bool onPeekPixels(SkPixmap* pm) override {
+        fOwner->flush();
+        return this->SkBitmapDevice::onPeekPixels(pm);
+    }
+    bool onAccessPixels(SkPixmap* pm) override {
+        fOwner->flush();
+        return this->SkBitmapDevice::onAccessPixels(pm);
+    }
+
+private:
+    SkTiledRasterCanvas* fOwner;
+};
+
+namespace {
+
+// Replays only the ops that establish matrix and clip state, skipping everything that draws.
+// Used to bring a tile's canvas up to the state in effect at the first unflushed op.
+class StateOnlyDraw {
+public:
+    explicit StateOnlyDraw(SkRecords::Draw* draw) : fDraw(draw) {}
+
+    template <typename T> void operator()(const T& r) {
+        if constexpr (!(T::kTags & SkRecords::kDraw_Tag)) {
+            (*fDraw)(r);
+        }
+    }
+
+    // Any layer before the flush point has already been restored and composited; all that is
+    // left of it is its save/restore pairing.
+    void operator()(const SkRecords::SaveLayer&)  { (*fDraw)(SkRecords::Save()); }
+    void operator()(const SkRecords::SaveBehind&) { (*fDraw)(SkRecords::Save()); }
+    void operator()(const SkRecords::DrawAnnotation&) {}
+
+private:
+    SkRecords::Draw* fDraw;
+};
+
+}  // namespace
+
+SkTiledRasterCanvas::SkTiledRasterCanvas(const SkBitmap& bitmap,
+                                         const SkSurfaceProps& props,
+                                         SkExecutor& executor,
+                                         SkISize tileSize,
+                                         SkSurface* surface)
+        : SkTiledRasterCanvas(sk_make_sp<Device>(bitmap, props, this), executor, tileSize,
+                              surface) {}
+
+SkTiledRasterCanvas::SkTiledRasterCanvas(sk_sp<Device> device,
+                                         SkExecutor& executor,
+                                         SkISize tileSize,
+                                         SkSurface* surface)
+        : INHERITED(device)
+        , fDevice(device.get())
+        , fExecutor(executor)
+        , fTileSize(tileSize.isEmpty() ? kDefaultTileSize : tileSize)
+        , fSurface(surface)
+        , fRecord(sk_make_sp<SkRecord>())
+        , fRecorder(fRecord.get(), SkRect::Make(device->imageInfo().bounds())) {}
+
+SkTiledRasterCanvas::~SkTiledRasterCanvas() = default;
+
+void SkTiledRasterCanvas::predrawNotify() {
+    if (fSurface) {
+        fSurface->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+    }
+}
+
+void SkTiledRasterCanvas::flush() {
+    // Draws into a layer that is still open are not visible in the base pixels yet, so we only
+    // play back up to the first open layer.
+    int end = fRecord->count();
+    for (int index : fSaveStack) {
+        if (index >= 0) {
+            end = index;
+            break;
+        }
+    }
+    if (end <= fFlushedOps) {
+        return;
+    }
+
+    SkPixmap pm;
+    SkBitmap bitmap;
+    if (!fDevice->accessPixelsNoFlush(&pm) || !bitmap.installPixels(pm)) {
+        return;
+    }
+
+    SkDrawableList* drawableList = fRecorder.getDrawableList();
+    std::unique_ptr<SkBigPicture::SnapshotArray> drawablePicts{
+        drawableList ? drawableList->newDrawableSnapshot() : nullptr
+    };
+    const SkPicture* const* picts = drawablePicts ? drawablePicts->begin() : nullptr;
+    const int pictCount = drawablePicts ? drawablePicts->count() : 0;
+
+    const SkSurfaceProps props = fDevice->surfaceProps();
+    const SkISize tileSize = fHasResetClip ? bitmap.dimensions() : fTileSize;
+    const int tilesX = (bitmap.width()  + tileSize.width()  - 1) / tileSize.width(),
+              tilesY = (bitmap.height() + tileSize.height() - 1) / tileSize.height();
+
+    // When every op is new we can afford to bound them, and bucket each op into the tiles it
+    // touches up front. Otherwise we replay the already-flushed prefix for its state and then the
+    // new ops. Each tile's canvas clip bounds are its tile outset by 1 (see getLocalClipBounds()),
+    // so we bucket with the same outset a per-tile search would have used.
+    std::vector<std::vector<int>> buckets;
+    const bool bucketed = fFlushedOps == 0;
+    if (bucketed) {
+        AutoTArray<SkRect> bounds(fRecord->count());
+        AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
+        SkRecordFillBounds(SkRect::Make(bitmap.bounds()), *fRecord, bounds.data(), meta);
+        // The tree only feeds partition(), which needs no spatial ordering.
+        SkRTree rtree(SkRTree::Ordering::kInsertionOrder);
+        rtree.insert(bounds.data(), fRecord->count());
+        rtree.partition(bitmap.bounds(), tileSize, 1, &buckets);
+        SkASSERT((int)buckets.size() == tilesX * tilesY);
+    }
+
+    SkTaskGroup tg(fExecutor);
+    tg.batch(tilesX * tilesY, [&](int i) {
+        SkIRect tile = SkIRect::MakeXYWH((i % tilesX) * tileSize.width(),
+                                         (i / tilesX) * tileSize.height(),
+                                         tileSize.width(),
+                                         tileSize.height());
+        SkAssertResult(tile.intersect(bitmap.bounds()));
+
+        // Each tile draws over the whole bitmap, clipped to its tile, so that device-space
+        // coordinates (and therefore every rasterized pixel) match a direct draw exactly.
+        SkCanvas canvas(bitmap, props);
+        canvas.clipIRect(tile);
+
+        SkRecords::Draw draw(&canvas, picts, nullptr, pictCount);
+        if (bucketed) {
+            for (int op : buckets[i]) {
+                if (op < end) {
+                    fRecord->visit(op, draw);
+                }
+            }
+        } else {
+            StateOnlyDraw state(&draw);
+            for (int op = 0; op < fFlushedOps; op++) {
+                fRecord->visit(op, state);
+            }
+            for (int op = fFlushedOps; op < end; op++) {
+                fRecord->visit(op, draw);
+            }
+        }
+    });
+    tg.wait();
+
+    fFlushedOps = end;
+
+    // Once we're back at the root with identity state there is nothing left worth replaying,
+    // so start over with an empty record rather than growing it forever.
+    if (fFlushedOps == fRecord->count() && fSaveStack.empty() &&
+        this->getLocalToDevice() == SkM44() &&
+        this->isClipRect() && this->getDeviceClipBounds() == bitmap.bounds()) {
+        fRecord = sk_make_sp<SkRecord>();
+        fRecorder.reset(fRecord.get(), SkRect::Make(bitmap.bounds()));
+        fFlushedOps = 0;
+        fHasResetClip = false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// State changes are recorded and also applied to our own device, which tracks them for queries.
+
+void SkTiledRasterCanvas::willSave() {
+    fRecorder.save();
+    fSaveStack.push_back(-1);
+    this->INHERITED::willSave();
+}
+
+SkCanvas::SaveLayerStrategy SkTiledRasterCanvas::getSaveLayerStrategy(const SaveLayerRec& rec) {
+    fSaveStack.push_back(fRecord->count());
+    fRecorder.saveLayer(rec);
+    this->INHERITED::getSaveLayerStrategy(rec);
+    // The layer only exists in the recording.
+    return kNoLayer_SaveLayerStrategy;
+}
+
+bool SkTiledRasterCanvas::onDoSaveBehind(const SkRect* bounds) {
+    fSaveStack.push_back(fRecord->count());
+    SkCanvasPriv::SaveBehind(&fRecorder, bounds);
+    this->INHERITED::onDoSaveBehind(bounds);
+    return false;
+}
+
+void SkTiledRasterCanvas::willRestore() {
+    fRecorder.restore();
+    if (!fSaveStack.empty()) {
+        fSaveStack.pop_back();
+    }
+    this->INHERITED::willRestore();
+}
+
+void SkTiledRasterCanvas::didConcat44(const SkM44& m) {
+    fRecorder.concat(m);
+}
+
+void SkTiledRasterCanvas::didSetM44(const SkM44& matrix) {
+    fRecorder.setMatrix(matrix);
+}
+
+void SkTiledRasterCanvas::didTranslate(SkScalar x, SkScalar y) {
+    fRecorder.translate(x, y);
+}
+
+void SkTiledRasterCanvas::didScale(SkScalar x, SkScalar y) {
+    fRecorder.scale(x, y);
+}
+
+void SkTiledRasterCanvas::onClipRect(const SkRect& rect, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    fRecorder.clipRect(rect, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->INHERITED::onClipRect(rect, op, edgeStyle);
+}
+
+void SkTiledRasterCanvas::onClipRRect(const SkRRect& rrect, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    fRecorder.clipRRect(rrect, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->INHERITED::onClipRRect(rrect, op, edgeStyle);
+}
+
+void SkTiledRasterCanvas::onClipPath(const SkPath& path, SkClipOp op, ClipEdgeStyle edgeStyle) {
+    fRecorder.clipPath(path, op, kSoft_ClipEdgeStyle == edgeStyle);
+    this->INHERITED::onClipPath(path, op, edgeStyle);
+}
+
+void SkTiledRasterCanvas::onClipShader(sk_sp<SkShader> sh, SkClipOp op) {
+    fRecorder.clipShader(sh, op);
+    this->INHERITED::onClipShader(std::move(sh), op);
+}
+
+void SkTiledRasterCanvas::onClipRegion(const SkRegion& deviceRgn, SkClipOp op) {
+    fRecorder.clipRegion(deviceRgn, op);
+    this->INHERITED::onClipRegion(deviceRgn, op);
+}
+
+void SkTiledRasterCanvas::onResetClip() {
+    fHasResetClip = true;
+    SkCanvasPriv::ResetClip(&fRecorder);
+    this->INHERITED::onResetClip();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Draws are only recorded.
+
+void SkTiledRasterCanvas::onDrawPaint(const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawPaint(paint);
+}
+
+void SkTiledRasterCanvas::onDrawBehind(const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawBehind(paint);
+}
+
+void SkTiledRasterCanvas::onDrawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                                       const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawPoints(mode, count, pts, paint);
+}
+
+void SkTiledRasterCanvas::onDrawRect(const SkRect& rect, const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawRect(rect, paint);
+}
+
+void SkTiledRasterCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawRegion(region, paint);
+}
+
+void SkTiledRasterCanvas::onDrawOval(const SkRect& rect, const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawOval(rect, paint);
+}
+
+void SkTiledRasterCanvas::onDrawArc(const SkRect& rect, SkScalar startAngle, SkScalar sweepAngle,
+                                    bool useCenter, const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawArc(rect, startAngle, sweepAngle, useCenter, paint);
+}
+
+void SkTiledRasterCanvas::onDrawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawRRect(rrect, paint);
+}
+
+void SkTiledRasterCanvas::onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
+                                       const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawDRRect(outer, inner, paint);
+}
+
+void SkTiledRasterCanvas::onDrawPath(const SkPath& path, const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawPath(path, paint);
+}
+
+void SkTiledRasterCanvas::onDrawImage2(const SkImage* image, SkScalar left, SkScalar top,
+                                       const SkSamplingOptions& sampling, const SkPaint* paint) {
+    this->predrawNotify();
+    fRecorder.onDrawImage2(image, left, top, sampling, paint);
+}
+
+void SkTiledRasterCanvas::onDrawImageRect2(const SkImage* image, const SkRect& src,
+                                           const SkRect& dst, const SkSamplingOptions& sampling,
+                                           const SkPaint* paint, SrcRectConstraint constraint) {
+    this->predrawNotify();
+    fRecorder.onDrawImageRect2(image, src, dst, sampling, paint, constraint);
+}
+
+void SkTiledRasterCanvas::onDrawImageLattice2(const SkImage* image, const Lattice& lattice,
+                                              const SkRect& dst, SkFilterMode filter,
+                                              const SkPaint* paint) {
+    this->predrawNotify();
+    fRecorder.onDrawImageLattice2(image, lattice, dst, filter, paint);
+}
+
+void SkTiledRasterCanvas::onDrawAtlas2(const SkImage* image, const SkRSXform xform[],
+                                       const SkRect tex[], const SkColor colors[], int count,
+                                       SkBlendMode bmode, const SkSamplingOptions& sampling,
+                                       const SkRect* cull, const SkPaint* paint) {
+    this->predrawNotify();
+    fRecorder.onDrawAtlas2(image, xform, tex, colors, count, bmode, sampling, cull, paint);
+}
+
+void SkTiledRasterCanvas::onDrawGlyphRunList(const sktext::GlyphRunList& list,
+                                             const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawGlyphRunList(list, paint);
+}
+
+void SkTiledRasterCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                                         const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawTextBlob(blob, x, y, paint);
+}
+
+void SkTiledRasterCanvas::onDrawSlug(const sktext::gpu::Slug* slug) {
+    this->predrawNotify();
+    fRecorder.onDrawSlug(slug);
+}
+
+void SkTiledRasterCanvas::onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
+                                        const SkPaint* paint) {
+    this->predrawNotify();
+    fRecorder.onDrawPicture(picture, matrix, paint);
+}
+
+void SkTiledRasterCanvas::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
+    this->predrawNotify();
+    fRecorder.onDrawDrawable(drawable, matrix);
+}
+
+void SkTiledRasterCanvas::onDrawVerticesObject(const SkVertices* vertices, SkBlendMode bmode,
+                                               const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawVerticesObject(vertices, bmode, paint);
+}
+
+#ifdef SK_ENABLE_SKSL
+void SkTiledRasterCanvas::onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender,
+                                     const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawMesh(mesh, std::move(blender), paint);
+}
+#endif
+
+void SkTiledRasterCanvas::onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                                      const SkPoint texCoords[4], SkBlendMode bmode,
+                                      const SkPaint& paint) {
+    this->predrawNotify();
+    fRecorder.onDrawPatch(cubics, colors, texCoords, bmode, paint);
+}
+
+void SkTiledRasterCanvas::onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) {
+    this->predrawNotify();
+    fRecorder.onDrawShadowRec(path, rec);
+}
+
+void SkTiledRasterCanvas::onDrawAnnotation(const SkRect& rect, const char key[], SkData* data) {
+    fRecorder.onDrawAnnotation(rect, key, data);
+}
+
+void SkTiledRasterCanvas::onDrawEdgeAAQuad(const SkRect& rect, const SkPoint clip[4],
+                                           QuadAAFlags aa, const SkColor4f& color,
+                                           SkBlendMode mode) {
+    this->predrawNotify();
+    fRecorder.onDrawEdgeAAQuad(rect, clip, aa, color, mode);
+}
+
+void SkTiledRasterCanvas::onDrawEdgeAAImageSet2(const ImageSetEntry set[], int count,
+                                                const SkPoint dstClips[],
+                                                const SkMatrix preViewMatrices[],
+                                                const SkSamplingOptions& sampling,
+                                                const SkPaint* paint,
+                                                SrcRectConstraint constraint) {
+    this->predrawNotify();
+    fRecorder.onDrawEdgeAAImageSet2(set, count, dstClips, preViewMatrices, sampling, paint,
+                                    constraint);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTiledRasterCanvas_DEFINED
+#define SkTiledRasterCanvas_DEFINED
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkCanvasVirtualEnforcer.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecorder.h"
+
+#include <cstddef>
+#include <vector>
+
+class SkBitmap;
+class SkBlender;
+class SkData;
+class SkDrawable;
+class SkExecutor;
+class SkImage;
+class SkMatrix;
+class SkMesh;
+class SkPaint;
+class SkPath;
+class SkPicture;
+class SkRRect;
+class SkRegion;
+class SkShader;
+class SkSurface;
+class SkSurfaceProps;
+class SkTextBlob;
+class SkVertices;
+enum class SkBlendMode;
+enum class SkClipOp;
+struct SkDrawShadowRec;
+struct SkPoint;
+struct SkRSXform;
+struct SkRect;
+
+namespace sktext {
+class GlyphRunList;
+namespace gpu { class Slug; }
+}
+
+/**
+ *  SkTiledRasterCanvas draws into a bitmap, but rather than rasterizing each draw as it arrives it
+ *  records them into an SkRecord. When the pixels are needed (flush(), or any read, peek or write
+ *  of the canvas' pixels) the pending draws are played back in parallel on an SkExecutor, one task
+ *  per tile. Every tile draws through its own SkCanvas over the full bitmap, restricted to the
+ *  tile by its clip, so device space is identical to drawing directly and the output matches a
+ *  plain raster canvas bit for bit.
+ *
+ *  The canvas keeps its own matrix and clip state up to date, so queries like getTotalMatrix() and
+ *  getDeviceClipBounds() behave exactly as they would on a raster canvas.
+ */
+class SkTiledRasterCanvas final : public SkCanvasVirtualEnforcer<SkCanvas> {
+public:
+    // If surface is non-null, it is notified before each recorded draw (see predrawNotify()).
+    SkTiledRasterCanvas(const SkBitmap&, const SkSurfaceProps&, SkExecutor&, SkISize tileSize,
+                        SkSurface* surface = nullptr);
+    ~SkTiledRasterCanvas() override;
+
+    // Plays back all pending draws into the bitmap. Draws inside a layer that is still open are
+    // held back until that layer is restored, just as a raster canvas wouldn't have composited
+    // them into its base pixels yet.
+    void flush();
+
+    // The number of recorded ops that have not yet been played back.
+    int pendingOpCount() const { return fRecord->count() - fFlushedOps; }
+
+    static constexpr SkISize kDefaultTileSize = {256, 256};
+
+protected:
+    void willSave() override;
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec&) override;
+    bool onDoSaveBehind(const SkRect*) override;
+    void willRestore() override;
+
+    void didConcat44(const SkM44&) override;
+    void didSetM44(const SkM44&) override;
+    void didScale(SkScalar, SkScalar) override;
+    void didTranslate(SkScalar, SkScalar) override;
+
+    void onDrawDRRect(const SkRRect&, const SkRRect&, const SkPaint&) override;
+    void onDrawGlyphRunList(const sktext::GlyphRunList&, const SkPaint&) override;
+    void onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
+                        const SkPaint& paint) override;
+    void onDrawSlug(const sktext::gpu::Slug* slug) override;
+    void onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
+                     const SkPoint texCoords[4], SkBlendMode, const SkPaint& paint) override;
+
+    void onDrawPaint(const SkPaint&) override;
+    void onDrawBehind(const SkPaint&) override;
+    void onDrawPoints(PointMode, size_t count, const SkPoint pts[], const SkPaint&) override;
+    void onDrawRect(const SkRect&, const SkPaint&) override;
+    void onDrawRegion(const SkRegion&, const SkPaint&) override;
+    void onDrawOval(const SkRect&, const SkPaint&) override;
+    void onDrawArc(const SkRect&, SkScalar, SkScalar, bool, const SkPaint&) override;
+    void onDrawRRect(const SkRRect&, const SkPaint&) override;
+    void onDrawPath(const SkPath&, const SkPaint&) override;
+
+    void onDrawImage2(const SkImage*, SkScalar, SkScalar, const SkSamplingOptions&,
+                      const SkPaint*) override;
+    void onDrawImageRect2(const SkImage*, const SkRect&, const SkRect&, const SkSamplingOptions&,
+                          const SkPaint*, SrcRectConstraint) override;
+    void onDrawImageLattice2(const SkImage*, const Lattice&, const SkRect&, SkFilterMode,
+                             const SkPaint*) override;
+    void onDrawAtlas2(const SkImage*, const SkRSXform[], const SkRect[], const SkColor[], int,
+                      SkBlendMode, const SkSamplingOptions&, const SkRect*,
+                      const SkPaint*) override;
+
+    void onDrawVerticesObject(const SkVertices*, SkBlendMode, const SkPaint&) override;
+#ifdef SK_ENABLE_SKSL
+    void onDrawMesh(const SkMesh&, sk_sp<SkBlender>, const SkPaint&) override;
+#endif
+    void onDrawShadowRec(const SkPath&, const SkDrawShadowRec&) override;
+
+    void onClipRect(const SkRect&, SkClipOp, ClipEdgeStyle) override;
+    void onClipRRect(const SkRRect&, SkClipOp, ClipEdgeStyle) override;
+    void onClipPath(const SkPath&, SkClipOp, ClipEdgeStyle) override;
+    void onClipShader(sk_sp<SkShader>, SkClipOp) override;
+    void onClipRegion(const SkRegion&, SkClipOp) override;
+    void onResetClip() override;
+
+    void onDrawPicture(const SkPicture*, const SkMatrix*, const SkPaint*) override;
+    void onDrawDrawable(SkDrawable*, const SkMatrix*) override;
+    void onDrawAnnotation(const SkRect&, const char[], SkData*) override;
+
+    void onDrawEdgeAAQuad(const SkRect&, const SkPoint[4], QuadAAFlags, const SkColor4f&,
+                          SkBlendMode) override;
+    void onDrawEdgeAAImageSet2(const ImageSetEntry[], int count, const SkPoint[], const SkMatrix[],
+                               const SkSamplingOptions&, const SkPaint*,
+                               SrcRectConstraint) override;
+
+private:
+    class Device;
+
+    SkTiledRasterCanvas(sk_sp<Device>, SkExecutor&, SkISize tileSize, SkSurface*);
+
+    // Lets the owning surface know its contents are about to change (copy-on-write, genID).
+    void predrawNotify();
+
+    Device*              fDevice;
+    SkExecutor&          fExecutor;
+    const SkISize        fTileSize;
+    SkSurface*           fSurface;
+
+    sk_sp<SkRecord>      fRecord;
+    SkRecorder           fRecorder;
+    // Ops in fRecord before this index have already been played back. They are kept around only
+    // while they still contribute matrix or clip state to the ops that follow.
+    int                  fFlushedOps = 0;
+    // One entry per open save: -1 for a plain save, or the index of its SaveLayer/SaveBehind op.
+    std::vector<int>     fSaveStack;
+    // resetClip() would discard a tile's clip, so once it's been recorded we play back untiled.
+    bool                 fHasResetClip = false;
+
+    using INHERITED = SkCanvasVirtualEnforcer<SkCanvas>;
+};
+
+#endif
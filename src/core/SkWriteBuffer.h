@@ -115,6 +115,9 @@ public:
 
     size_t bytesWritten() const { return fWriter.bytesWritten(); }
 
+    // Replaces a uint32_t already written at offset, e.g. a size that is only known later.
+    void overwriteUIntAt(size_t offset, uint32_t value) { fWriter.overwriteTAt(offset, value); }
+
     // Returns true iff all of the bytes written so far are stored in the initial storage
     // buffer provided in the constructor or the most recent call to reset.
     bool usingInitialStorage() const;
@@ -7,6 +7,7 @@
 
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
@@ -21,18 +22,21 @@
 #include "include/effects/SkImageFilters.h"
 #include "include/private/base/SkFloatingPoint.h"
 #include "include/private/base/SkMalloc.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/base/SkVx.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -735,6 +739,34 @@ private:
     skvx::Vec<4, uint32_t>* fBuffer1Cursor;
 };
 
+// Calls blurLines() over the lines [0, count), each line being length pixels long. Large blurs are
+// split into chunks of lines run in parallel on executor; without one they all run inline. Every
+// chunk gets its own Pass, since a pass holds the state of the line it is blurring.
+void blur_lines(SkExecutor* executor, const PassMaker* maker, int count, int length,
+                const std::function<void(Pass*, int, int)>& blurLines) {
+    // Aim for about 64KB of pixels per chunk.
+    const int linesPerChunk = std::max(1, (16 * 1024) / std::max(1, length));
+    const int chunks = (count + linesPerChunk - 1) / linesPerChunk;
+
+    auto blurRange = [&](int start, int end) {
+        SkSTArenaAlloc<256> alloc;
+        auto buffer = alloc.makeBytesAlignedTo(maker->bufferSizeBytes(),
+                                               alignof(skvx::Vec<4, uint32_t>));
+        blurLines(maker->makePass(buffer, &alloc), start, end);
+    };
+
+    if (!executor || chunks < 2) {
+        blurRange(0, count);
+        return;
+    }
+    SkTaskGroup tasks(*executor);
+    tasks.batch(chunks, [&](int chunk) {
+        int start = chunk * linesPerChunk;
+        blurRange(start, std::min(count, start + linesPerChunk));
+    });
+    tasks.wait();
+}
+
 sk_sp<SkSpecialImage> copy_image_with_bounds(const skif::Context& ctx,
                                              const sk_sp<SkSpecialImage>& input,
                                              SkIRect srcBounds,
@@ -859,9 +891,6 @@ sk_sp<SkSpecialImage> cpu_blur(const skif::Context& ctx,
         return nullptr;
     }
 
-    size_t bufferSizeBytes = std::max(makerX->bufferSizeBytes(), makerY->bufferSizeBytes());
-    auto buffer = alloc.makeBytesAlignedTo(bufferSizeBytes, alignof(skvx::Vec<4, uint32_t>));
-
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
     //     the destination. Then, do an in-place vertical blur.
@@ -890,7 +919,6 @@ sk_sp<SkSpecialImage> cpu_blur(const skif::Context& ctx,
     }
 
     if (makerX->window() > 1) {
-        Pass* pass = makerX->makePass(buffer, &alloc);
         // Make int64 to avoid overflow in multiplication below.
         int64_t shift = srcBounds.top() - dstBounds.top();
 
@@ -903,27 +931,34 @@ sk_sp<SkSpecialImage> cpu_blur(const skif::Context& ctx,
         intermediateWidth = dstW;
         intermediateDst = static_cast<uint32_t *>(dst.getPixels());
 
-        const uint32_t* srcCursor = static_cast<uint32_t*>(src.getPixels());
-        uint32_t* dstCursor = intermediateSrc;
-        for (auto y = 0; y < srcH; y++) {
-            pass->blur(srcBounds.left(), srcBounds.right(), dstBounds.right(),
-                      srcCursor, 1, dstCursor, 1);
-            srcCursor += src.rowBytesAsPixels();
-            dstCursor += intermediateRowBytesAsPixels;
-        }
+        // Each row is blurred independently.
+        blur_lines(ctx.executor(), makerX, srcH, dstW, [&](Pass* pass, int startY, int endY) {
+            const uint32_t* srcCursor = src.getAddr32(0, startY);
+            uint32_t* dstCursor =
+                    intermediateSrc + SkToSizeT(startY) * intermediateRowBytesAsPixels;
+            for (auto y = startY; y < endY; y++) {
+                pass->blur(srcBounds.left(), srcBounds.right(), dstBounds.right(),
+                          srcCursor, 1, dstCursor, 1);
+                srcCursor += src.rowBytesAsPixels();
+                dstCursor += intermediateRowBytesAsPixels;
+            }
+        });
     }
 
     if (makerY->window() > 1) {
-        Pass* pass = makerY->makePass(buffer, &alloc);
-        const uint32_t* srcCursor = intermediateSrc;
-        uint32_t* dstCursor = intermediateDst;
-        for (auto x = 0; x < intermediateWidth; x++) {
-            pass->blur(srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
-                       srcCursor, intermediateRowBytesAsPixels,
-                       dstCursor, dst.rowBytesAsPixels());
-            srcCursor += 1;
-            dstCursor += 1;
-        }
+        // Each column is blurred in place independently.
+        blur_lines(ctx.executor(), makerY, intermediateWidth, dstH,
+                   [&](Pass* pass, int startX, int endX) {
+            const uint32_t* srcCursor = intermediateSrc + startX;
+            uint32_t* dstCursor = intermediateDst + startX;
+            for (auto x = startX; x < endX; x++) {
+                pass->blur(srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
+                           srcCursor, intermediateRowBytesAsPixels,
+                           dstCursor, dst.rowBytesAsPixels());
+                srcCursor += 1;
+                dstCursor += 1;
+            }
+        });
     }
 
     return SkSpecialImages::MakeFromRaster(
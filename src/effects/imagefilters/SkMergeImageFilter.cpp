@@ -12,6 +12,7 @@
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkTemplates.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkReadBuffer.h"
@@ -77,9 +78,12 @@ sk_sp<SkFlattenable> SkMergeImageFilter::CreateProc(SkReadBuffer& buffer) {
 
 skif::FilterResult SkMergeImageFilter::onFilterImage(const skif::Context& ctx) const {
     const int inputCount = this->countInputs();
+    skia_private::AutoSTArray<4, skif::FilterResult> inputs(inputCount);
+    this->getChildOutputs(ctx, {inputs.get(), inputs.size()});
+
     skif::FilterResult::Builder builder{ctx};
     for (int i = 0; i < inputCount; ++i) {
-        builder.add(this->getChildOutput(i, ctx));
+        builder.add(inputs[i]);
     }
     return builder.merge();
 }
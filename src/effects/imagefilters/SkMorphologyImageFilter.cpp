@@ -10,9 +10,12 @@
 
 #ifdef SK_ENABLE_SKSL
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkM44.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
@@ -21,14 +24,20 @@
 #include "include/core/SkTypes.h"
 #include "include/effects/SkRuntimeEffect.h"
 #include "include/private/base/SkSpan_impl.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/base/SkVx.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkRuntimeEffectPriv.h"
+#include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <optional>
 #include <utility>
 
 namespace {
@@ -246,6 +255,179 @@ skif::FilterResult morphology_pass(const skif::Context& ctx, const skif::FilterR
     return childOutput;
 }
 
+// On the CPU the morphology is computed directly on the pixels with the van Herk/Gil-Werman
+// algorithm, which costs three min or max operations per pixel and pass regardless of the radius.
+// Both it and the shaders above select among the input's values, so their output is identical.
+template <MorphType kType, typename T>
+T morph(const T& a, const T& b) {
+    if constexpr (kType == MorphType::kDilate) {
+        return skvx::max(a, b);
+    } else {
+        return skvx::min(a, b);
+    }
+}
+
+template <MorphType kType>
+void morph_row(uint8_t* dst, const uint8_t* a, const uint8_t* b, int bytes) {
+    using V = skvx::Vec<16, uint8_t>;
+    int i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        morph<kType>(V::Load(a + i), V::Load(b + i)).store(dst + i);
+    }
+    for (; i < bytes; ++i) {
+        dst[i] = morph<kType>(skvx::Vec<1, uint8_t>(a[i]), skvx::Vec<1, uint8_t>(b[i]))[0];
+    }
+}
+
+// Copies 'count' pixels of row y of 'src', starting at column x, to 'dst', where src is
+// transparent black outside of its pixmap.
+void load_row(const SkPixmap& src, int x, int y, int count, uint32_t* dst) {
+    if (y < 0 || y >= src.height() || x >= src.width() || x + count <= 0) {
+        sk_bzero(dst, count * sizeof(uint32_t));
+        return;
+    }
+    const int left = std::max(0, -x);
+    const int right = std::max(0, x + count - src.width());
+    sk_bzero(dst, left * sizeof(uint32_t));
+    memcpy(dst + left, src.addr32(x + left, y), (count - left - right) * sizeof(uint32_t));
+    sk_bzero(dst + count - right, right * sizeof(uint32_t));
+}
+
+// Sets dst(x, y) to the min or max of src(x, y - radius) through src(x, y + radius), for the
+// columns [x0, x1) of dst. 'srcOrigin' and 'dstOrigin' place the pixmaps in the same space.
+template <MorphType kType>
+void morph_columns(const SkPixmap& src, SkIPoint srcOrigin,
+                   const SkPixmap& dst, SkIPoint dstOrigin,
+                   int radius, int x0, int x1) {
+    const int window = 2 * radius + 1;
+    const int rows = dst.height() + 2 * radius;
+    const int width = x1 - x0;
+    const size_t rowBytes = width * sizeof(uint32_t);
+
+    // Split the rows from dst's first row - radius into blocks of 'window' rows. 'g' holds the
+    // running aggregate from the start of a row's block, and 'h' the one to the end of its block.
+    // The window centered on any row spans at most two blocks, so its aggregate is the 'h' of its
+    // first row combined with the 'g' of its last row.
+    skia_private::AutoTMalloc<uint32_t> storage(2 * (size_t)rows * width);
+    uint32_t* g = storage.get();
+    uint32_t* h = g + (size_t)rows * width;
+    auto gRow = [&](int k) { return reinterpret_cast<uint8_t*>(g + (size_t)k * width); };
+    auto hRow = [&](int k) { return reinterpret_cast<uint8_t*>(h + (size_t)k * width); };
+
+    const int srcX = dstOrigin.fX + x0 - srcOrigin.fX;
+    const int srcY = dstOrigin.fY - radius - srcOrigin.fY;
+    for (int k = 0; k < rows; ++k) {
+        load_row(src, srcX, srcY + k, width, h + (size_t)k * width);
+        if (k % window == 0) {
+            memcpy(gRow(k), hRow(k), rowBytes);
+        } else {
+            morph_row<kType>(gRow(k), gRow(k - 1), hRow(k), rowBytes);
+        }
+    }
+    for (int k = rows - 2; k >= 0; --k) {
+        if (k % window != window - 1) {
+            morph_row<kType>(hRow(k), hRow(k), hRow(k + 1), rowBytes);
+        }
+    }
+
+    for (int y = 0; y < dst.height(); ++y) {
+        morph_row<kType>(static_cast<uint8_t*>(dst.writable_addr(x0, y)),
+                         hRow(y), gRow(y + 2 * radius), rowBytes);
+    }
+}
+
+// Sets dst(y, x) to src(x, y).
+void transpose(const SkPixmap& src, const SkPixmap& dst) {
+    SkASSERT(src.width() == dst.height() && src.height() == dst.width());
+    static constexpr int kTile = 16;
+    for (int y0 = 0; y0 < src.height(); y0 += kTile) {
+        for (int x0 = 0; x0 < src.width(); x0 += kTile) {
+            const int y1 = std::min(y0 + kTile, src.height()),
+                      x1 = std::min(x0 + kTile, src.width());
+            for (int y = y0; y < y1; ++y) {
+                const uint32_t* srcRow = src.addr32(0, y);
+                for (int x = x0; x < x1; ++x) {
+                    *dst.writable_addr32(y, x) = srcRow[x];
+                }
+            }
+        }
+    }
+}
+
+// Runs morph_columns() over all of dst, split into strips of columns on the executor.
+void morph_columns(MorphType type, const SkPixmap& src, SkIPoint srcOrigin,
+                   const SkPixmap& dst, SkIPoint dstOrigin, int radius, SkExecutor* executor) {
+    // Narrow enough that a strip's buffers stay in cache for all but the tallest images.
+    static constexpr int kStripWidth = 64;
+    auto strip = [&](int i) {
+        const int x0 = i * kStripWidth, x1 = std::min(x0 + kStripWidth, dst.width());
+        if (type == MorphType::kDilate) {
+            morph_columns<MorphType::kDilate>(src, srcOrigin, dst, dstOrigin, radius, x0, x1);
+        } else {
+            morph_columns<MorphType::kErode>(src, srcOrigin, dst, dstOrigin, radius, x0, x1);
+        }
+    };
+
+    const int strips = (dst.width() + kStripWidth - 1) / kStripWidth;
+    if (!executor || strips < 2) {
+        for (int i = 0; i < strips; ++i) {
+            strip(i);
+        }
+        return;
+    }
+    SkTaskGroup tasks{*executor};
+    tasks.batch(strips, strip);
+    tasks.wait();
+}
+
+// Returns std::nullopt if the input's pixels aren't in a format the raster path handles, in which
+// case the caller should fall back to the shaders.
+std::optional<skif::FilterResult> morphology_raster(const skif::Context& ctx,
+                                                    const skif::FilterResult& input,
+                                                    MorphType type,
+                                                    skif::LayerSpace<SkISize> radii) {
+    const skif::LayerSpace<SkIRect> output = ctx.desiredOutput();
+    skif::LayerSpace<SkIRect> sampleBounds = output;
+    sampleBounds.outset(radii);
+
+    // Only 'sampleBounds' is read by the kernel, and the input is transparent black beyond it.
+    skif::Context sampleCtx = ctx.withNewDesiredOutput(sampleBounds);
+    SkIPoint srcOrigin;
+    sk_sp<SkSpecialImage> srcImage =
+            input.applyCrop(sampleCtx, sampleBounds).imageAndOffset(sampleCtx, &srcOrigin);
+    SkBitmap src;
+    if (!srcImage || !srcImage->getROPixels(&src)) {
+        return skif::FilterResult{};
+    }
+    // The kernel works on each byte independently, so any order of four 8-bit channels will do.
+    if (src.colorType() != kRGBA_8888_SkColorType && src.colorType() != kBGRA_8888_SkColorType) {
+        return std::nullopt;
+    }
+
+    // The Y pass keeps the extra columns the X pass will consume. The X pass runs on the
+    // transpose of the Y pass output, so that both passes aggregate whole rows at once.
+    SkIRect yBounds = SkIRect(output).makeOutset(radii.width(), 0);
+    SkBitmap yPass, yPassT, xPassT, dst;
+    if (!yPass.tryAllocPixels(src.info().makeWH(yBounds.width(), yBounds.height())) ||
+        !yPassT.tryAllocPixels(src.info().makeWH(yBounds.height(), yBounds.width())) ||
+        !xPassT.tryAllocPixels(src.info().makeWH(output.height(), output.width())) ||
+        !dst.tryAllocPixels(src.info().makeWH(output.width(), output.height()))) {
+        return skif::FilterResult{};
+    }
+
+    morph_columns(type, src.pixmap(), srcOrigin, yPass.pixmap(), yBounds.topLeft(),
+                  radii.height(), ctx.executor());
+    transpose(yPass.pixmap(), yPassT.pixmap());
+    morph_columns(type, yPassT.pixmap(), {yBounds.fTop, yBounds.fLeft},
+                  xPassT.pixmap(), {output.top(), output.left()}, radii.width(), ctx.executor());
+    transpose(xPassT.pixmap(), dst.pixmap());
+    dst.setImmutable();
+
+    return skif::FilterResult(SkSpecialImages::MakeFromRaster(SkIRect::MakeSize(dst.dimensions()),
+                                                              dst, ctx.surfaceProps()),
+                              output.topLeft());
+}
+
 } // end namespace
 
 sk_sp<SkImageFilter> SkImageFilters::Dilate(SkScalar radiusX, SkScalar radiusY,
@@ -306,8 +488,17 @@ skif::FilterResult SkMorphologyImageFilter::onFilterImage(const skif::Context& c
         return {};
     }
 
-    // The X pass has to preserve the extra rows to later be consumed by the Y pass.
     skif::LayerSpace<SkISize> radii = this->radii(ctx.mapping());
+    if (!ctx.gpuBacked()) {
+        std::optional<skif::FilterResult> result =
+                morphology_raster(ctx.withNewDesiredOutput(maxOutput), childOutput, fType, radii);
+        if (result.has_value()) {
+            return *result;
+        }
+        // Other formats, e.g. F16 layers, are filtered with the shaders below.
+    }
+
+    // The X pass has to preserve the extra rows to later be consumed by the Y pass.
     skif::LayerSpace<SkIRect> maxOutputX = maxOutput;
     maxOutputX.outset(skif::LayerSpace<SkISize>({0, radii.height()}));
     childOutput = morphology_pass(ctx.withNewDesiredOutput(maxOutputX), childOutput, fType,
@@ -7,6 +7,7 @@
 
 #include "include/encode/SkEncoder.h"
 
+#include "include/core/SkColorSpace.h"
 #include "include/private/base/SkAssert.h"
 
 bool SkEncoder::encodeRows(int numRows) {
@@ -27,3 +28,17 @@ bool SkEncoder::encodeRows(int numRows) {
 
     return true;
 }
+
+bool SkEncoder::encodeRows(const SkPixmap& rows) {
+    if (!rows.addr() || rows.height() <= 0 || rows.width() != fSrc.width() ||
+        rows.colorType() != fSrc.colorType() || rows.alphaType() != fSrc.alphaType() ||
+        !SkColorSpace::Equals(rows.colorSpace(), fSrc.colorSpace()) ||
+        rows.height() > fSrc.height() - fCurrRow) {
+        return false;
+    }
+
+    fRows = &rows;
+    const bool success = this->encodeRows(rows.height());
+    fRows = nullptr;
+    return success;
+}
@@ -351,6 +351,10 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     }
 
     if (fSrcYUVA) {
+        if (fRows) {
+            // The planes can only be read from fSrcYUVA.
+            return false;
+        }
         // TODO(ccameron): Consider using jpeg_write_raw_data, to avoid having to re-pack the data.
         for (int i = 0; i < numRows; i++) {
             yuva_copy_row(fSrcYUVA, fCurrRow + i, fStorage.get());
@@ -360,8 +364,8 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     } else {
         const size_t srcBytes = SkColorTypeBytesPerPixel(fSrc.colorType()) * fSrc.width();
         const size_t jpegSrcBytes = fEncoderMgr->cinfo()->input_components * fSrc.width();
-        const void* srcRow = fSrc.addr(0, fCurrRow);
         for (int i = 0; i < numRows; i++) {
+            const void* srcRow = this->srcRowAddr(i);
             JSAMPLE* jpegSrcRow = (JSAMPLE*)srcRow;
             if (fEncoderMgr->proc()) {
                 sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
@@ -380,7 +384,6 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
             }
 
             jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
-            srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
         }
     }
 
@@ -13,6 +13,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -24,9 +25,11 @@
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkNoncopyable.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skcms/skcms.h"
 #include "src/base/SkMSAN.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/image/SkImage_Base.h"
@@ -34,6 +37,7 @@
 #include <algorithm>
 #include <csetjmp>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -42,6 +46,8 @@
 #include <png.h>
 #include <pngconf.h>
 
+#include "zlib.h"
+
 class GrDirectContext;
 class SkImage;
 
@@ -69,6 +75,289 @@ static void sk_write_fn(png_structp png_ptr, png_bytep data, png_size_t len) {
     }
 }
 
+// Applies the png filter type (0 through 4) to row, given the row above it, into dst, which takes
+// the filter type byte and then rowBytes filtered bytes.
+static void filter_row(int type, int bpp, const uint8_t* prev, const uint8_t* row,
+                       size_t rowBytes, uint8_t* dst) {
+    *dst++ = SkToU8(type);
+    const size_t n = rowBytes;
+    switch (type) {
+        case 0:
+            memcpy(dst, row, n);
+            break;
+        case 1:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = row[i] - (i >= (size_t)bpp ? row[i - bpp] : 0);
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = row[i] - prev[i];
+            }
+            break;
+        case 3:
+            for (size_t i = 0; i < n; i++) {
+                const int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+                dst[i] = row[i] - ((left + prev[i]) >> 1);
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < n; i++) {
+                const int a = i >= (size_t)bpp ? row[i - bpp] : 0,
+                          b = prev[i],
+                          c = i >= (size_t)bpp ? prev[i - bpp] : 0;
+                const int p = a + b - c,
+                          pa = std::abs(p - a),
+                          pb = std::abs(p - b),
+                          pc = std::abs(p - c);
+                dst[i] = row[i] - (pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+            }
+            break;
+    }
+}
+
+// libpng's heuristic for choosing among several filters: the sum of the filtered bytes, read as
+// signed, in absolute value.
+static size_t filtered_row_cost(const uint8_t* filtered, size_t rowBytes) {
+    size_t cost = 0;
+    for (size_t i = 0; i < rowBytes; i++) {
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    }
+    return cost;
+}
+
+static void write_u32_be(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >>  8);
+    dst[3] = (uint8_t)(value);
+}
+
+/*
+ * Writes a png's image data with the rows filtered and deflated in parallel, pigz-style.
+ *
+ * Rows are collected into batches. Each batch is cut into strips, and each strip is filtered and
+ * deflated as a raw deflate stream of its own, ended by a sync flush so that it stops on a byte
+ * boundary; the strips of the last batch end with the final block instead. Joined in order, with
+ * a zlib header in front and the Adler-32 of all the filtered rows behind, the strips make up the
+ * one zlib stream that a png expects. Each batch is written as one IDAT chunk, whose CRC is
+ * combined from the CRCs of its strips.
+ */
+class SkPngStripEncoder final : SkNoncopyable {
+public:
+    SkPngStripEncoder(SkWStream* stream, SkExecutor* executor, int filters, int zlibLevel,
+                      int bytesPerPixel, size_t rowBytes)
+            : fStream(stream)
+            , fExecutor(executor)
+            , fFilters(filters)
+            , fZLibLevel(zlibLevel)
+            , fBytesPerPixel(bytesPerPixel)
+            , fRowBytes(rowBytes)
+            , fStripRows(std::max<int>(1, SkToInt(kStripBytes / (rowBytes + 1))))
+            , fBatchRows(fStripRows * kStripsPerBatch)
+            , fRows((fBatchRows + 1) * rowBytes) {
+        // The row above the first is all zeros.
+        memset(fRows.get(), 0, rowBytes);
+    }
+
+    // Where to put the next row, already in the png's pixel format.
+    uint8_t* nextRow() {
+        SkASSERT(fPendingRows < fBatchRows);
+        return this->row(fPendingRows++);
+    }
+
+    bool batchIsFull() const { return fPendingRows == fBatchRows; }
+
+    // Filters, deflates and writes the rows from nextRow(). If finish is true, this ends the
+    // image data and writes the IEND chunk.
+    bool writeRows(bool finish);
+
+private:
+    // Strips of about this many bytes are big enough that ending each with a sync flush, and
+    // starting each with an empty dictionary, costs little compression.
+    static constexpr size_t kStripBytes = 256 * 1024;
+    static constexpr int kStripsPerBatch = 16;
+
+    struct Strip {
+        std::vector<uint8_t> fData;
+        uLong fAdler;  // Of the filtered rows.
+        uLong fCrc;    // Of fData.
+        size_t fFilteredBytes;
+        bool fSuccess;
+    };
+
+    // Row -1 is the last row of the previous batch.
+    uint8_t* row(int i) { return fRows.get() + (i + 1) * fRowBytes; }
+
+    void encodeStrip(int firstRow, int rowCount, bool last, Strip* strip);
+    void filterRow(const uint8_t* prev, const uint8_t* row, uint8_t* dst, uint8_t* scratch) const;
+
+    SkWStream* const  fStream;
+    SkExecutor* const fExecutor;
+    const int         fFilters;
+    const int         fZLibLevel;
+    const int         fBytesPerPixel;
+    const size_t      fRowBytes;
+    const int         fStripRows;
+    const int         fBatchRows;
+
+    skia_private::AutoTMalloc<uint8_t> fRows;
+    int   fPendingRows = 0;
+    bool  fWroteHeader = false;
+    uLong fAdler = adler32(0, nullptr, 0);
+};
+
+void SkPngStripEncoder::filterRow(const uint8_t* prev, const uint8_t* row, uint8_t* dst,
+                                  uint8_t* scratch) const {
+    size_t bestCost = SIZE_MAX;
+    for (int type = 0; type <= 4; type++) {
+        if (!(fFilters & ((int)SkPngEncoder::FilterFlag::kNone << type))) {
+            continue;
+        }
+        if (bestCost == SIZE_MAX && (fFilters >> (type + 4)) == 0) {
+            // The only filter to try; no need to weigh it.
+            filter_row(type, fBytesPerPixel, prev, row, fRowBytes, dst);
+            return;
+        }
+        filter_row(type, fBytesPerPixel, prev, row, fRowBytes, scratch);
+        const size_t cost = filtered_row_cost(scratch + 1, fRowBytes);
+        if (cost < bestCost) {
+            bestCost = cost;
+            memcpy(dst, scratch, fRowBytes + 1);
+        }
+    }
+    if (bestCost == SIZE_MAX) {
+        // Like libpng, no filters means the None filter.
+        filter_row(0, fBytesPerPixel, prev, row, fRowBytes, dst);
+    }
+}
+
+void SkPngStripEncoder::encodeStrip(int firstRow, int rowCount, bool last, Strip* strip) {
+    const size_t filteredRowBytes = fRowBytes + 1;
+    strip->fFilteredBytes = rowCount * filteredRowBytes;
+    std::vector<uint8_t> filtered(strip->fFilteredBytes);
+    std::vector<uint8_t> scratch(filteredRowBytes);
+    for (int i = 0; i < rowCount; i++) {
+        this->filterRow(this->row(firstRow + i - 1), this->row(firstRow + i),
+                        filtered.data() + i * filteredRowBytes, scratch.data());
+    }
+    strip->fAdler = adler32(adler32(0, nullptr, 0), filtered.data(), SkToUInt(filtered.size()));
+
+    // Match libpng's zlib settings.
+    z_stream zstream;
+    memset(&zstream, 0, sizeof(zstream));
+    const int strategy = (fFilters & ~(int)SkPngEncoder::FilterFlag::kNone) == 0
+                                 ? Z_DEFAULT_STRATEGY
+                                 : Z_FILTERED;
+    strip->fSuccess = false;
+    if (deflateInit2(&zstream, fZLibLevel, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK) {
+        return;
+    }
+    // A sync flush adds up to six bytes to deflateBound(); grow if even that falls short.
+    strip->fData.resize(deflateBound(&zstream, (uLong)filtered.size()) + 16);
+    zstream.next_in = filtered.data();
+    zstream.avail_in = SkToUInt(filtered.size());
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    int result;
+    for (;;) {
+        zstream.next_out = strip->fData.data() + zstream.total_out;
+        zstream.avail_out = SkToUInt(strip->fData.size() - zstream.total_out);
+        result = deflate(&zstream, flush);
+        if (zstream.avail_out != 0 || result == Z_STREAM_END || result == Z_STREAM_ERROR) {
+            break;
+        }
+        strip->fData.resize(strip->fData.size() * 2);
+    }
+    strip->fData.resize(zstream.total_out);
+    deflateEnd(&zstream);
+
+    strip->fSuccess = last ? result == Z_STREAM_END : result == Z_OK || result == Z_BUF_ERROR;
+    strip->fCrc = crc32(crc32(0, nullptr, 0), strip->fData.data(), SkToUInt(strip->fData.size()));
+}
+
+bool SkPngStripEncoder::writeRows(bool finish) {
+    // The image data ends with a strip, so finishing with no rows left still takes one.
+    const int stripCount = std::max(finish ? 1 : 0, (fPendingRows + fStripRows - 1) / fStripRows);
+    std::vector<Strip> strips(stripCount);
+    auto encode = [&](int i) {
+        const int first = i * fStripRows;
+        this->encodeStrip(first, std::min(fStripRows, fPendingRows - first),
+                          finish && i == stripCount - 1, &strips[i]);
+    };
+    if (stripCount > 1) {
+        SkTaskGroup tasks(*fExecutor);
+        tasks.batch(stripCount, encode);
+        tasks.wait();
+    } else if (stripCount == 1) {
+        encode(0);
+    }
+
+    // Build the IDAT chunk around the strips: its length, type, zlib header, strips, Adler-32 and
+    // CRC, the last two in network byte order.
+    static constexpr uint8_t kIDAT[] = {'I', 'D', 'A', 'T'};
+    uint8_t zlibHeader[2];
+    if (!fWroteHeader) {
+        // Deflate with a 32K window; see RFC 1950 for the level flags and check bits.
+        const int levelFlags = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3;
+        const int header = (0x78 << 8) | (levelFlags << 6);
+        zlibHeader[0] = SkToU8(header >> 8);
+        zlibHeader[1] = SkToU8((header + 31 - header % 31) & 0xff);
+    }
+    size_t length = fWroteHeader ? 0 : sizeof(zlibHeader);
+    uLong crc = crc32(crc32(0, nullptr, 0), kIDAT, sizeof(kIDAT));
+    if (!fWroteHeader) {
+        crc = crc32(crc, zlibHeader, sizeof(zlibHeader));
+    }
+    for (const Strip& strip : strips) {
+        if (!strip.fSuccess) {
+            return false;
+        }
+        length += strip.fData.size();
+        crc = crc32_combine(crc, strip.fCrc, (z_off_t)strip.fData.size());
+        fAdler = adler32_combine(fAdler, strip.fAdler, (z_off_t)strip.fFilteredBytes);
+    }
+    uint8_t adler[4];
+    if (finish) {
+        write_u32_be(adler, SkToU32(fAdler));
+        length += sizeof(adler);
+        crc = crc32(crc, adler, sizeof(adler));
+    }
+    if (length > PNG_UINT_31_MAX) {
+        return false;
+    }
+
+    uint8_t lengthBytes[4], crcBytes[4];
+    write_u32_be(lengthBytes, SkToU32(length));
+    write_u32_be(crcBytes, SkToU32(crc));
+    if (!fStream->write(lengthBytes, sizeof(lengthBytes)) ||
+        !fStream->write(kIDAT, sizeof(kIDAT)) ||
+        (!fWroteHeader && !fStream->write(zlibHeader, sizeof(zlibHeader)))) {
+        return false;
+    }
+    fWroteHeader = true;
+    for (const Strip& strip : strips) {
+        if (!fStream->write(strip.fData.data(), strip.fData.size())) {
+            return false;
+        }
+    }
+    if ((finish && !fStream->write(adler, sizeof(adler))) ||
+        !fStream->write(crcBytes, sizeof(crcBytes))) {
+        return false;
+    }
+
+    // Keep the last row for filtering the next batch's first row.
+    if (fPendingRows > 0) {
+        memcpy(this->row(-1), this->row(fPendingRows - 1), fRowBytes);
+        fPendingRows = 0;
+    }
+
+    if (finish) {
+        static constexpr uint8_t kIEND[] = {0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82};
+        return fStream->write(kIEND, sizeof(kIEND));
+    }
+    return true;
+}
+
 class SkPngEncoderMgr final : SkNoncopyable {
 public:
     /*
@@ -81,21 +370,27 @@ public:
     bool setColorSpace(const SkImageInfo& info, const SkPngEncoder::Options& options);
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
+    void chooseStripEncoder(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options);
 
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
+    // Not null if the image data is written in parallel, rather than by libpng.
+    SkPngStripEncoder* stripEncoder() { return fStripEncoder.get(); }
 
     ~SkPngEncoderMgr() { png_destroy_write_struct(&fPngPtr, &fInfoPtr); }
 
 private:
-    SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr) : fPngPtr(pngPtr), fInfoPtr(infoPtr) {}
+    SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr, SkWStream* stream)
+            : fPngPtr(pngPtr), fInfoPtr(infoPtr), fStream(stream) {}
 
     png_structp fPngPtr;
     png_infop fInfoPtr;
+    SkWStream* fStream;
     int fPngBytesPerPixel;
     transform_scanline_proc fProc;
+    std::unique_ptr<SkPngStripEncoder> fStripEncoder;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -112,7 +407,7 @@ std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
     }
 
     png_set_write_fn(pngPtr, (void*)stream, sk_write_fn, nullptr);
-    return std::unique_ptr<SkPngEncoderMgr>(new SkPngEncoderMgr(pngPtr, infoPtr));
+    return std::unique_ptr<SkPngEncoderMgr>(new SkPngEncoderMgr(pngPtr, infoPtr, stream));
 }
 
 bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options) {
@@ -427,6 +722,23 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
 
 void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) { fProc = choose_proc(srcInfo); }
 
+void SkPngEncoderMgr::chooseStripEncoder(const SkImageInfo& srcInfo,
+                                         const SkPngEncoder::Options& options) {
+    if (!options.fExecutor) {
+        return;
+    }
+    if (kRGBA_F16_SkColorType == srcInfo.colorType() &&
+        kOpaque_SkAlphaType == srcInfo.alphaType()) {
+        // libpng drops the filler that writeInfo() asked for as it writes each row.
+        return;
+    }
+    fStripEncoder = std::make_unique<SkPngStripEncoder>(
+            fStream, options.fExecutor,
+            (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll,
+            std::min(std::max(0, options.fZLibLevel), 9),
+            fPngBytesPerPixel, (size_t)fPngBytesPerPixel * srcInfo.width());
+}
+
 SkPngEncoderImpl::SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const SkPixmap& src)
         : SkEncoder(src, encoderMgr->pngBytesPerPixel() * src.width())
         , fEncoderMgr(std::move(encoderMgr)) {}
@@ -434,12 +746,32 @@ SkPngEncoderImpl::SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr> encoderMgr,
 SkPngEncoderImpl::~SkPngEncoderImpl() {}
 
 bool SkPngEncoderImpl::onEncodeRows(int numRows) {
+    if (SkPngStripEncoder* strips = fEncoderMgr->stripEncoder()) {
+        // Converting the rows to the png's format is cheap next to filtering and deflating them,
+        // so it stays on this thread, which also frees the source rows when this returns.
+        for (int y = 0; y < numRows; y++) {
+            const void* srcRow = this->srcRowAddr(y);
+            sk_msan_assert_initialized(
+                    srcRow, (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
+            fEncoderMgr->proc()((char*)strips->nextRow(),
+                                (const char*)srcRow,
+                                fSrc.width(),
+                                SkColorTypeBytesPerPixel(fSrc.colorType()));
+            if (strips->batchIsFull() && !strips->writeRows(/*finish=*/false)) {
+                return false;
+            }
+        }
+
+        fCurrRow += numRows;
+        return fCurrRow < fSrc.height() || strips->writeRows(/*finish=*/true);
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
 
-    const void* srcRow = fSrc.addr(0, fCurrRow);
     for (int y = 0; y < numRows; y++) {
+        const void* srcRow = this->srcRowAddr(y);
         sk_msan_assert_initialized(srcRow,
                                    (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
         fEncoderMgr->proc()((char*)fStorage.get(),
@@ -449,7 +781,6 @@ bool SkPngEncoderImpl::onEncodeRows(int numRows) {
 
         png_bytep rowPtr = (png_bytep)fStorage.get();
         png_write_rows(fEncoderMgr->pngPtr(), &rowPtr, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
     }
 
     fCurrRow += numRows;
@@ -484,6 +815,7 @@ std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Optio
     }
 
     encoderMgr->chooseProc(src.info());
+    encoderMgr->chooseStripEncoder(src.info(), options);
 
     return std::make_unique<SkPngEncoderImpl>(std::move(encoderMgr), src);
 }
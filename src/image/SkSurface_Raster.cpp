@@ -10,6 +10,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkCapabilities.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMallocPixelRef.h"
 #include "include/core/SkPixelRef.h"
@@ -23,6 +24,7 @@
 #include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkImagePriv.h"
 #include "src/core/SkSurfacePriv.h"
+#include "src/core/SkTiledRasterCanvas.h"
 
 #include <cstdint>
 #include <cstring>
@@ -73,7 +75,23 @@ SkSurface_Raster::SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef> pr
     fWeOwnThePixels = true;
 }
 
-SkCanvas* SkSurface_Raster::onNewCanvas() { return new SkCanvas(fBitmap, this->props()); }
+void SkSurface_Raster::setTiledPlayback(SkExecutor* executor, SkISize tileSize) {
+    fTileExecutor = executor ? executor : &SkExecutor::GetDefault();
+    fTileSize = tileSize;
+}
+
+void SkSurface_Raster::flushTiledDraws() {
+    if (fTileExecutor) {
+        static_cast<SkTiledRasterCanvas*>(this->getCachedCanvas())->flush();
+    }
+}
+
+SkCanvas* SkSurface_Raster::onNewCanvas() {
+    if (fTileExecutor) {
+        return new SkTiledRasterCanvas(fBitmap, this->props(), *fTileExecutor, fTileSize, this);
+    }
+    return new SkCanvas(fBitmap, this->props());
+}
 
 sk_sp<SkSurface> SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
     return SkSurfaces::Raster(info, &this->props());
@@ -81,10 +99,12 @@ sk_sp<SkSurface> SkSurface_Raster::onNewSurface(const SkImageInfo& info) {
 
 void SkSurface_Raster::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
                               const SkSamplingOptions& sampling, const SkPaint* paint) {
+    this->flushTiledDraws();
     canvas->drawImage(fBitmap.asImage().get(), x, y, sampling, paint);
 }
 
 sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
+    this->flushTiledDraws();
     if (subset) {
         SkASSERT(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()).contains(*subset));
         SkBitmap dst;
@@ -111,6 +131,7 @@ sk_sp<SkImage> SkSurface_Raster::onNewImageSnapshot(const SkIRect* subset) {
 }
 
 void SkSurface_Raster::onWritePixels(const SkPixmap& src, int x, int y) {
+    this->flushTiledDraws();
     fBitmap.writePixels(src, x, y);
 }
 
@@ -197,4 +218,15 @@ sk_sp<SkSurface> Raster(const SkImageInfo& info, size_t rowBytes, const SkSurfac
     return sk_make_sp<SkSurface_Raster>(info, std::move(pr), props);
 }
 
+sk_sp<SkSurface> RasterTiled(const SkImageInfo& info,
+                             SkExecutor* executor,
+                             SkISize tileSize,
+                             const SkSurfaceProps* props) {
+    sk_sp<SkSurface> surface = Raster(info, props);
+    if (surface) {
+        static_cast<SkSurface_Raster*>(surface.get())->setTiledPlayback(executor, tileSize);
+    }
+    return surface;
+}
+
 }  // namespace SkSurfaces
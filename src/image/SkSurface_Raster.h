@@ -13,12 +13,14 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
 #include "src/image/SkSurface_Base.h"
 
 #include <cstring>
 
 class SkCanvas;
 class SkCapabilities;
+class SkExecutor;
 class SkImage;
 class SkPaint;
 class SkPixelRef;
@@ -34,6 +36,10 @@ public:
                      const SkSurfaceProps*);
     SkSurface_Raster(const SkImageInfo& info, sk_sp<SkPixelRef>, const SkSurfaceProps*);
 
+    // Makes the canvas record draws and play them back across tiles on executor (see
+    // SkTiledRasterCanvas). Must be called before the canvas is first requested.
+    void setTiledPlayback(SkExecutor*, SkISize tileSize);
+
     // From SkSurface.h
     SkImageInfo imageInfo() const override { return fBitmap.info(); }
 
@@ -50,8 +56,13 @@ public:
     sk_sp<const SkCapabilities> onCapabilities() override;
 
 private:
+    // Plays back any draws the tiled canvas is still holding onto.
+    void flushTiledDraws();
+
     SkBitmap    fBitmap;
     bool        fWeOwnThePixels;
+    SkExecutor* fTileExecutor = nullptr;
+    SkISize     fTileSize = {0, 0};
 
     using INHERITED = SkSurface_Base;
 };
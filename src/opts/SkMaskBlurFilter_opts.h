@@ -0,0 +1,123 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMaskBlurFilter_opts_DEFINED
+#define SkMaskBlurFilter_opts_DEFINED
+
+#include "include/core/SkTypes.h"
+#include "src/base/SkVx.h"
+#include "src/core/SkMaskBlurFilter.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace SK_OPTS_NS {
+
+// One row per 32-bit lane of a native vector register.
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    static constexpr int kMaskBlurLanes = 8;
+#else
+    static constexpr int kMaskBlurLanes = 4;
+#endif
+static_assert(kMaskBlurLanes <= SkMaskBlurFilter::kMaxLanes);
+
+// Runs SkMaskBlurFilter's three box passes over several A8 rows at once, one row per vector lane.
+// This is the same integer arithmetic as the scalar PlanGauss::Scan::blur(), so each lane
+// produces exactly the bytes the scalar scan would for its row.
+//
+// Output i of row r is stored to dst[r + i * dstStride], so the rows come out transposed and
+// each step stores one contiguous run of bytes.
+static void mask_blur_rows(const uint8_t* src, size_t srcRB, int rows, int srcCount,
+                           int noChangeCount, uint32_t weight, const int passSizes[3],
+                           uint32_t* buffer, uint8_t* dst, size_t dstStride, int dstCount) {
+    constexpr int N = kMaskBlurLanes;
+    using V = skvx::Vec<N, uint32_t>;
+    constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
+
+    const int size0 = passSizes[0],
+              size1 = passSizes[1],
+              size2 = passSizes[2];
+    SkASSERT(size0 > 0 && size1 > 0 && size2 > 0);
+    uint32_t* buffer0 = buffer;
+    uint32_t* buffer1 = buffer0 + size0 * N;
+    uint32_t* buffer2 = buffer1 + size1 * N;
+
+    for (int r = 0; r < rows; r += N) {
+        // A partial group repeats its last row in the unused lanes, and only stores the lanes
+        // that hold real rows.
+        const int lanes = std::min(N, rows - r);
+        const uint8_t* row[N];
+        for (int lane = 0; lane < N; ++lane) {
+            row[lane] = src + (r + std::min(lane, lanes - 1)) * srcRB;
+        }
+        uint8_t* const groupDst = dst + r;
+
+        auto load = [&](int i) {
+            V v;
+            for (int lane = 0; lane < N; ++lane) {
+                v[lane] = row[lane][i];
+            }
+            return v;
+        };
+
+        // Runs the three passes for count steps, taking step k's leading edge from edgeAt(k)
+        // and storing its result to output index outAt(k).
+        auto scan = [&](int count, auto&& edgeAt, auto&& outAt) {
+            std::memset(buffer, 0, (size0 + size1 + size2) * N * sizeof(uint32_t));
+            int cursor0 = 0, cursor1 = 0, cursor2 = 0;
+            V sum0 = 0, sum1 = 0, sum2 = 0;
+
+            for (int k = 0; k < count; ++k) {
+                V leadingEdge = edgeAt(k);
+                sum0 += leadingEdge;
+                sum1 += sum0;
+                sum2 += sum1;
+
+                auto blurred = skvx::cast<uint8_t>(
+                        (skvx::cast<uint64_t>(sum2) * skvx::Vec<N, uint64_t>(weight) + kHalf)
+                        >> 32);
+                uint8_t* to = groupDst + outAt(k) * dstStride;
+                if (lanes == N) {
+                    blurred.store(to);
+                } else {
+                    uint8_t partial[N];
+                    blurred.store(partial);
+                    std::memcpy(to, partial, lanes);
+                }
+
+                sum2 -= V::Load(buffer2 + cursor2 * N);
+                sum1.store(buffer2 + cursor2 * N);
+                cursor2 = cursor2 + 1 < size2 ? cursor2 + 1 : 0;
+
+                sum1 -= V::Load(buffer1 + cursor1 * N);
+                sum0.store(buffer1 + cursor1 * N);
+                cursor1 = cursor1 + 1 < size1 ? cursor1 + 1 : 0;
+
+                sum0 -= V::Load(buffer0 + cursor0 * N);
+                leadingEdge.store(buffer0 + cursor0 * N);
+                cursor0 = cursor0 + 1 < size0 ? cursor0 + 1 : 0;
+            }
+        };
+
+        // Consume the source generating pixels, then let the leading edge run off the end.
+        const int forwardCount = srcCount + noChangeCount;
+        scan(forwardCount,
+             [&](int k) { return k < srcCount ? load(k) : V(0); },
+             [&](int k) { return k; });
+
+        // Starting from the right, fill in the rest.
+        scan(dstCount - forwardCount,
+             [&](int k) { return load(srcCount - 1 - k); },
+             [&](int k) { return dstCount - 1 - k; });
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif  // SkMaskBlurFilter_opts_DEFINED
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipmap_opts_DEFINED
+#define SkMipmap_opts_DEFINED
+
+#include "include/core/SkTypes.h"
+#include "src/base/SkVx.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized versions of SkMipmap's 2x2 box filter, the one used whenever a level's source
+// dimensions are both even. They produce exactly the same pixels as the portable
+// downsample_2_2<ColorTypeFilter_*>() templates in SkMipmap.cpp.
+
+namespace SK_OPTS_NS {
+
+#if defined(SK_CPU_SSE_LEVEL) && SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    static constexpr int kMipmapVectorBytes = 32;
+#else
+    static constexpr int kMipmapVectorBytes = 16;
+#endif
+
+// Writes N 8888 pixels, each the average of a 2x2 block from rows p0 and p1.
+template <int N>
+static void downsample_2_2_8888_N(uint32_t* d, const uint32_t* p0, const uint32_t* p1) {
+    // Each 64-bit lane holds two horizontally adjacent pixels; split them apart and widen each
+    // channel to 16 bits so the sum of four can't overflow.
+    auto expand = [](const skvx::Vec<N,uint32_t>& px) {
+        return skvx::cast<uint16_t>(sk_bit_cast<skvx::Vec<4*N,uint8_t>>(px));
+    };
+    auto r0 = skvx::Vec<N,uint64_t>::Load(p0),
+         r1 = skvx::Vec<N,uint64_t>::Load(p1);
+
+    auto sum = expand(skvx::cast<uint32_t>(r0      )) + expand(skvx::cast<uint32_t>(r1      ))
+             + expand(skvx::cast<uint32_t>(r0 >> 32)) + expand(skvx::cast<uint32_t>(r1 >> 32));
+    skvx::cast<uint8_t>(sum >> 2).store(d);
+}
+
+/*not static*/ inline void downsample_2_2_8888(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const uint32_t*>(src);
+    auto p1 = (const uint32_t*)((const char*)p0 + srcRB);
+    auto d  = static_cast<uint32_t*>(dst);
+
+    constexpr int N = kMipmapVectorBytes / sizeof(uint32_t);
+    for (; count >= N; count -= N) {
+        downsample_2_2_8888_N<N>(d, p0, p1);
+        d  += N;
+        p0 += 2*N;
+        p1 += 2*N;
+    }
+    for (; count > 0; count--) {
+        downsample_2_2_8888_N<1>(d, p0, p1);
+        d  += 1;
+        p0 += 2;
+        p1 += 2;
+    }
+}
+
+// Writes N A8 pixels, each the average of a 2x2 block from rows p0 and p1.
+template <int N>
+static void downsample_2_2_a8_N(uint8_t* d, const uint8_t* p0, const uint8_t* p1) {
+    // Each 16-bit lane holds two horizontally adjacent pixels.
+    auto r0 = skvx::Vec<N,uint16_t>::Load(p0),
+         r1 = skvx::Vec<N,uint16_t>::Load(p1);
+
+    auto sum = (r0 & 0xff) + (r1 & 0xff) + (r0 >> 8) + (r1 >> 8);
+    skvx::cast<uint8_t>(sum >> 2).store(d);
+}
+
+/*not static*/ inline void downsample_2_2_a8(void* dst, const void* src, size_t srcRB,
+                                             int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const uint8_t*>(src);
+    auto p1 = p0 + srcRB;
+    auto d  = static_cast<uint8_t*>(dst);
+
+    constexpr int N = kMipmapVectorBytes;
+    for (; count >= N; count -= N) {
+        downsample_2_2_a8_N<N>(d, p0, p1);
+        d  += N;
+        p0 += 2*N;
+        p1 += 2*N;
+    }
+    for (; count > 0; count--) {
+        downsample_2_2_a8_N<1>(d, p0, p1);
+        d  += 1;
+        p0 += 2;
+        p1 += 2;
+    }
+}
+
+/*not static*/ inline void downsample_2_2_f16(void* dst, const void* src, size_t srcRB,
+                                              int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const uint64_t*>(src);
+    auto p1 = (const uint64_t*)((const char*)p0 + srcRB);
+    auto d  = static_cast<uint64_t*>(dst);
+
+    // Float addition isn't associative, so we sum in the same order as the portable code:
+    // ((top-left + bottom-left) + top-right) + bottom-right.
+    for (; count >= 2; count -= 2) {
+        // Two output pixels at a time, from four pixels (16 halfs) of each row.
+        auto r0 = skvx::Vec<16,uint16_t>::Load(p0),
+             r1 = skvx::Vec<16,uint16_t>::Load(p1);
+        auto left  = [](const skvx::Vec<16,uint16_t>& v) {
+            return skvx::from_half(skvx::shuffle<0,1,2,3, 8, 9,10,11>(v));
+        };
+        auto right = [](const skvx::Vec<16,uint16_t>& v) {
+            return skvx::from_half(skvx::shuffle<4,5,6,7,12,13,14,15>(v));
+        };
+        auto c = left(r0) + left(r1) + right(r0) + right(r1);
+        skvx::to_half(c * 0.25f).store(d);
+        d  += 2;
+        p0 += 4;
+        p1 += 4;
+    }
+    if (count > 0) {
+        auto c = skvx::from_half(skvx::Vec<4,uint16_t>::Load(p0 + 0))
+               + skvx::from_half(skvx::Vec<4,uint16_t>::Load(p1 + 0))
+               + skvx::from_half(skvx::Vec<4,uint16_t>::Load(p0 + 1))
+               + skvx::from_half(skvx::Vec<4,uint16_t>::Load(p1 + 1));
+        skvx::to_half(c * 0.25f).store(d);
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif
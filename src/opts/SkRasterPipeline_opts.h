@@ -58,6 +58,8 @@ using NoCtx = const void*;
     #define JUMPER_IS_SCALAR
 #elif defined(SK_ARM_HAS_NEON)
     #define JUMPER_IS_NEON
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SKX
+    #define JUMPER_IS_SKX
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
     #define JUMPER_IS_HSW
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
@@ -375,6 +377,231 @@ namespace SK_OPTS_NS {
         }
     }
 
+#elif defined(JUMPER_IS_SKX)
+    // These are __m512 and __m512i, but friendlier and strongly-typed.
+    template <typename T> using V = T __attribute__((ext_vector_type(16)));
+    using F   = V<float   >;
+    using I32 = V< int32_t>;
+    using U64 = V<uint64_t>;
+    using U32 = V<uint32_t>;
+    using U16 = V<uint16_t>;
+    using U8  = V<uint8_t >;
+
+    SI F   mad(F f, F m, F a) { return _mm512_fmadd_ps(f, m, a); }
+
+    SI F   min(F a, F b)     { return _mm512_min_ps(a,b);    }
+    SI I32 min(I32 a, I32 b) { return _mm512_min_epi32(a,b); }
+    SI U32 min(U32 a, U32 b) { return _mm512_min_epu32(a,b); }
+    SI F   max(F a, F b)     { return _mm512_max_ps(a,b);    }
+    SI I32 max(I32 a, I32 b) { return _mm512_max_epi32(a,b); }
+    SI U32 max(U32 a, U32 b) { return _mm512_max_epu32(a,b); }
+
+    SI F   abs_  (F v)   { return _mm512_abs_ps(v);      }
+    SI I32 abs_  (I32 v) { return _mm512_abs_epi32(v);   }
+    SI F   floor_(F v)   { return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF); }
+    SI F   ceil_(F v)    { return _mm512_roundscale_ps(v, _MM_FROUND_TO_POS_INF); }
+    SI F   rcp_fast(F v) { return _mm512_rcp14_ps  (v);  }
+    SI F   rsqrt (F v)   { return _mm512_rsqrt14_ps(v);  }
+    SI F   sqrt_ (F v)   { return _mm512_sqrt_ps (v);    }
+    SI F rcp_precise (F v) {
+        F e = rcp_fast(v);
+        return _mm512_fnmadd_ps(v, e, _mm512_set1_ps(2.0f)) * e;
+    }
+
+    SI U32 round(F v)          { return _mm512_cvtps_epi32(v); }
+    SI U32 round(F v, F scale) { return _mm512_cvtps_epi32(v*scale); }
+    SI U16 pack(U32 v) {
+        // Clamp as signed to match _mm_packus_epi32() on the narrower targets.
+        __m512i clamped = _mm512_max_epi32(_mm512_min_epi32(v, _mm512_set1_epi32(65535)),
+                                           _mm512_setzero_si512());
+        return _mm512_cvtepi32_epi16(clamped);
+    }
+    SI U8 pack(U16 v) { return _mm256_cvtusepi16_epi8(v); }
+
+    // Like blendv, these only look at the sign bit of each lane of the mask.
+    SI F if_then_else(I32 c, F t, F e) {
+        return _mm512_mask_blend_ps(_mm512_movepi32_mask(c), e, t);
+    }
+    SI bool any(I32 c) { return _mm512_movepi32_mask(c) != 0;      }
+    SI bool all(I32 c) { return _mm512_movepi32_mask(c) == 0xffff; }
+
+    template <typename T>
+    SI V<T> gather(const T* p, U32 ix) {
+        return { p[ix[ 0]], p[ix[ 1]], p[ix[ 2]], p[ix[ 3]],
+                 p[ix[ 4]], p[ix[ 5]], p[ix[ 6]], p[ix[ 7]],
+                 p[ix[ 8]], p[ix[ 9]], p[ix[10]], p[ix[11]],
+                 p[ix[12]], p[ix[13]], p[ix[14]], p[ix[15]], };
+    }
+    SI F   gather(const float*    p, U32 ix) { return _mm512_i32gather_ps   (ix, p, 4); }
+    SI U32 gather(const uint32_t* p, U32 ix) { return _mm512_i32gather_epi32(ix, p, 4); }
+    SI U64 gather(const uint64_t* p, U32 ix) {
+        __m512i parts[] = {
+            _mm512_i32gather_epi64(_mm512_castsi512_si256(ix),      p, 8),
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix,1), p, 8),
+        };
+        return sk_bit_cast<U64>(parts);
+    }
+    template <typename V, typename S>
+    SI void scatter_masked(V src, S* dst, U32 ix, I32 mask) {
+        V before = gather(dst, ix);
+        V after = if_then_else(mask, src, before);
+        for (int i = 0; i < 16; ++i) {
+            dst[ix[i]] = after[i];
+        }
+    }
+
+    // AVX-512 loads and stores can be masked per lane, so rather than peeling off the tail a few
+    // pixels at a time we load or store every lane of the interleaved data that's in bounds.
+    // These return a mask of the first n lanes, clamped to [0, 16] or [0, 32].
+    SI __mmask16 first_lanes_16(int n) {
+        return n <= 0 ? 0 : n >= 16 ? 0xffff : (__mmask16)((1u << n) - 1);
+    }
+    SI __mmask32 first_lanes_32(int n) {
+        return n <= 0 ? 0 : n >= 32 ? 0xffffffff : (__mmask32)((1u << n) - 1);
+    }
+    SI int active_pixels(size_t tail) { return tail ? (int)tail : 16; }
+
+    SI void load2(const uint16_t* ptr, size_t tail, U16* r, U16* g) {
+        const int n = 2*active_pixels(tail);
+        __m512i rg = _mm512_maskz_loadu_epi16(first_lanes_32(n), ptr);
+
+        // Only the low 16 lanes of each permute matter.
+        const __m512i r_idx = _mm512_setr_epi32(0x00020000, 0x00060004, 0x000a0008, 0x000e000c,
+                                                0x00120010, 0x00160014, 0x001a0018, 0x001e001c,
+                                                0,0,0,0, 0,0,0,0);
+        const __m512i g_idx = _mm512_add_epi16(r_idx, _mm512_set1_epi16(1));
+        *r = _mm512_castsi512_si256(_mm512_permutexvar_epi16(r_idx, rg));
+        *g = _mm512_castsi512_si256(_mm512_permutexvar_epi16(g_idx, rg));
+    }
+    SI void store2(uint16_t* ptr, size_t tail, U16 r, U16 g) {
+        const int n = 2*active_pixels(tail);
+        __m512i rg = _mm512_inserti64x4(_mm512_castsi256_si512(r), g, 1);  // r0..r15 g0..g15
+
+        const __m512i idx = _mm512_setr_epi32(0x00100000, 0x00110001, 0x00120002, 0x00130003,
+                                              0x00140004, 0x00150005, 0x00160006, 0x00170007,
+                                              0x00180008, 0x00190009, 0x001a000a, 0x001b000b,
+                                              0x001c000c, 0x001d000d, 0x001e000e, 0x001f000f);
+        _mm512_mask_storeu_epi16(ptr, first_lanes_32(n), _mm512_permutexvar_epi16(idx, rg));
+    }
+
+    SI void load3(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b) {
+        const int n = 3*active_pixels(tail);
+        __m512i lo = _mm512_maskz_loadu_epi16(first_lanes_32(n     ), ptr +  0),  // 32 values
+                hi = _mm512_maskz_loadu_epi16(first_lanes_32(n - 32), ptr + 32);  // 16 values
+
+        // Indices 32 and up select from hi. Only the low 16 lanes of each permute matter.
+        const __m512i r_idx = _mm512_setr_epi32(0x00030000, 0x00090006, 0x000f000c, 0x00150012,
+                                                0x001b0018, 0x0021001e, 0x00270024, 0x002d002a,
+                                                0,0,0,0, 0,0,0,0);
+        const __m512i g_idx = _mm512_add_epi16(r_idx, _mm512_set1_epi16(1)),
+                      b_idx = _mm512_add_epi16(r_idx, _mm512_set1_epi16(2));
+        *r = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, r_idx, hi));
+        *g = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, g_idx, hi));
+        *b = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, b_idx, hi));
+    }
+    SI void load4(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b, U16* a) {
+        const int n = 4*active_pixels(tail);
+        __m512i lo = _mm512_maskz_loadu_epi16(first_lanes_32(n     ), ptr +  0),  // pixels 0-7
+                hi = _mm512_maskz_loadu_epi16(first_lanes_32(n - 32), ptr + 32);  // pixels 8-15
+
+        // Indices 32 and up select from hi. Only the low 16 lanes of each permute matter.
+        const __m512i r_idx = _mm512_setr_epi32(0x00040000, 0x000c0008, 0x00140010, 0x001c0018,
+                                                0x00240020, 0x002c0028, 0x00340030, 0x003c0038,
+                                                0,0,0,0, 0,0,0,0);
+        const __m512i g_idx = _mm512_add_epi16(r_idx, _mm512_set1_epi16(1)),
+                      b_idx = _mm512_add_epi16(r_idx, _mm512_set1_epi16(2)),
+                      a_idx = _mm512_add_epi16(r_idx, _mm512_set1_epi16(3));
+        *r = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, r_idx, hi));
+        *g = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, g_idx, hi));
+        *b = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, b_idx, hi));
+        *a = _mm512_castsi512_si256(_mm512_permutex2var_epi16(lo, a_idx, hi));
+    }
+    SI void store4(uint16_t* ptr, size_t tail, U16 r, U16 g, U16 b, U16 a) {
+        const int n = 4*active_pixels(tail);
+        __m512i rg = _mm512_inserti64x4(_mm512_castsi256_si512(r), g, 1),  // r0..r15 g0..g15
+                ba = _mm512_inserti64x4(_mm512_castsi256_si512(b), a, 1);  // b0..b15 a0..a15
+
+        // Indices 32 and up select from ba.
+        const __m512i lo_idx = _mm512_setr_epi32(0x00100000, 0x00300020, 0x00110001, 0x00310021,
+                                                 0x00120002, 0x00320022, 0x00130003, 0x00330023,
+                                                 0x00140004, 0x00340024, 0x00150005, 0x00350025,
+                                                 0x00160006, 0x00360026, 0x00170007, 0x00370027);
+        const __m512i hi_idx = _mm512_add_epi16(lo_idx, _mm512_set1_epi16(8));
+        _mm512_mask_storeu_epi16(ptr +  0, first_lanes_32(n     ),
+                                 _mm512_permutex2var_epi16(rg, lo_idx, ba));
+        _mm512_mask_storeu_epi16(ptr + 32, first_lanes_32(n - 32),
+                                 _mm512_permutex2var_epi16(rg, hi_idx, ba));
+    }
+
+    SI void load2(const float* ptr, size_t tail, F* r, F* g) {
+        const int n = 2*active_pixels(tail);
+        F lo = _mm512_maskz_loadu_ps(first_lanes_16(n     ), ptr +  0),  // pixels 0-7
+          hi = _mm512_maskz_loadu_ps(first_lanes_16(n - 16), ptr + 16);  // pixels 8-15
+
+        // Indices 16 and up select from hi.
+        const __m512i r_idx = _mm512_setr_epi32( 0, 2, 4, 6, 8,10,12,14,16,18,20,22,24,26,28,30);
+        *r = _mm512_permutex2var_ps(lo, r_idx, hi);
+        *g = _mm512_permutex2var_ps(lo, _mm512_add_epi32(r_idx, _mm512_set1_epi32(1)), hi);
+    }
+    SI void store2(float* ptr, size_t tail, F r, F g) {
+        const int n = 2*active_pixels(tail);
+
+        // Indices 16 and up select from g.
+        const __m512i lo_idx = _mm512_setr_epi32(0,16, 1,17, 2,18, 3,19, 4,20, 5,21, 6,22, 7,23);
+        const __m512i hi_idx = _mm512_add_epi32(lo_idx, _mm512_set1_epi32(8));
+        _mm512_mask_storeu_ps(ptr +  0, first_lanes_16(n     ),
+                              _mm512_permutex2var_ps(r, lo_idx, g));
+        _mm512_mask_storeu_ps(ptr + 16, first_lanes_16(n - 16),
+                              _mm512_permutex2var_ps(r, hi_idx, g));
+    }
+
+    SI void load4(const float* ptr, size_t tail, F* r, F* g, F* b, F* a) {
+        const int n = 4*active_pixels(tail);
+        F _0123 = _mm512_maskz_loadu_ps(first_lanes_16(n     ), ptr +  0),
+          _4567 = _mm512_maskz_loadu_ps(first_lanes_16(n - 16), ptr + 16),
+          _89ab = _mm512_maskz_loadu_ps(first_lanes_16(n - 32), ptr + 32),
+          _cdef = _mm512_maskz_loadu_ps(first_lanes_16(n - 48), ptr + 48);
+
+        // First gather r0..r7 g0..g7 (and b,a likewise) from pairs of registers, then join halves.
+        // Indices 16 and up select from the second register.
+        const __m512i rg_idx = _mm512_setr_epi32(0, 4, 8,12,16,20,24,28, 1, 5, 9,13,17,21,25,29),
+                      ba_idx = _mm512_add_epi32(rg_idx, _mm512_set1_epi32(2));
+        F rg07 = _mm512_permutex2var_ps(_0123, rg_idx, _4567),  // r0..r7  g0..g7
+          ba07 = _mm512_permutex2var_ps(_0123, ba_idx, _4567),  // b0..b7  a0..a7
+          rg8f = _mm512_permutex2var_ps(_89ab, rg_idx, _cdef),  // r8..r15 g8..g15
+          ba8f = _mm512_permutex2var_ps(_89ab, ba_idx, _cdef);  // b8..b15 a8..a15
+
+        const __m512i lo_idx = _mm512_setr_epi32(0,1,2,3,4,5,6,7,16,17,18,19,20,21,22,23),
+                      hi_idx = _mm512_add_epi32(lo_idx, _mm512_set1_epi32(8));
+        *r = _mm512_permutex2var_ps(rg07, lo_idx, rg8f);
+        *g = _mm512_permutex2var_ps(rg07, hi_idx, rg8f);
+        *b = _mm512_permutex2var_ps(ba07, lo_idx, ba8f);
+        *a = _mm512_permutex2var_ps(ba07, hi_idx, ba8f);
+    }
+    SI void store4(float* ptr, size_t tail, F r, F g, F b, F a) {
+        const int n = 4*active_pixels(tail);
+
+        // Indices 16 and up select from the second register.
+        const __m512i lo_idx = _mm512_setr_epi32(0,1,2,3,4,5,6,7,16,17,18,19,20,21,22,23),
+                      hi_idx = _mm512_add_epi32(lo_idx, _mm512_set1_epi32(8));
+        F rg07 = _mm512_permutex2var_ps(r, lo_idx, g),  // r0..r7  g0..g7
+          rg8f = _mm512_permutex2var_ps(r, hi_idx, g),  // r8..r15 g8..g15
+          ba07 = _mm512_permutex2var_ps(b, lo_idx, a),  // b0..b7  a0..a7
+          ba8f = _mm512_permutex2var_ps(b, hi_idx, a);  // b8..b15 a8..a15
+
+        const __m512i _0123_idx = _mm512_setr_epi32(0, 8,16,24, 1, 9,17,25,
+                                                    2,10,18,26, 3,11,19,27),
+                      _4567_idx = _mm512_add_epi32(_0123_idx, _mm512_set1_epi32(4));
+        _mm512_mask_storeu_ps(ptr +  0, first_lanes_16(n     ),
+                              _mm512_permutex2var_ps(rg07, _0123_idx, ba07));
+        _mm512_mask_storeu_ps(ptr + 16, first_lanes_16(n - 16),
+                              _mm512_permutex2var_ps(rg07, _4567_idx, ba07));
+        _mm512_mask_storeu_ps(ptr + 32, first_lanes_16(n - 32),
+                              _mm512_permutex2var_ps(rg8f, _0123_idx, ba8f));
+        _mm512_mask_storeu_ps(ptr + 48, first_lanes_16(n - 48),
+                              _mm512_permutex2var_ps(rg8f, _4567_idx, ba8f));
+    }
+
 #elif defined(JUMPER_IS_HSW)
     // These are __m256 and __m256i, but friendlier and strongly-typed.
     template <typename T> using V = T __attribute__((ext_vector_type(8)));
@@ -1097,6 +1324,9 @@ SI F from_half(U16 h) {
     && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f32_f16(h);
 
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtph_ps(h);
+
 #elif defined(JUMPER_IS_HSW)
     return _mm256_cvtph_ps(h);
 
@@ -1118,6 +1348,9 @@ SI U16 to_half(F f) {
     && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f16_f32(f);
 
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
+
 #elif defined(JUMPER_IS_HSW)
     return _mm256_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
 
@@ -1136,6 +1369,7 @@ SI U16 to_half(F f) {
 
 // Our fundamental vector depth is our pixel stride.
 static constexpr size_t N = sizeof(F) / sizeof(float);
+static_assert(N <= SkRasterPipeline_kMaxStride_highp);
 
 // We're finally going to get to what a Stage function looks like!
 //    tail == 0 ~~> work on a full N pixels
@@ -1384,6 +1618,16 @@ SI V load(const T* src, size_t tail) {
     if (__builtin_expect(tail, 0)) {
         V v{};  // Any inactive lanes are zeroed.
         switch (tail) {
+        #if defined(JUMPER_IS_SKX)
+            case 15: v[14] = src[14]; [[fallthrough]];
+            case 14: v[13] = src[13]; [[fallthrough]];
+            case 13: v[12] = src[12]; [[fallthrough]];
+            case 12: memcpy(&v, src, 12*sizeof(T)); break;
+            case 11: v[10] = src[10]; [[fallthrough]];
+            case 10: v[ 9] = src[ 9]; [[fallthrough]];
+            case  9: v[ 8] = src[ 8]; [[fallthrough]];
+            case  8: memcpy(&v, src,  8*sizeof(T)); break;
+        #endif
             case 7: v[6] = src[6]; [[fallthrough]];
             case 6: v[5] = src[5]; [[fallthrough]];
             case 5: v[4] = src[4]; [[fallthrough]];
@@ -1404,6 +1648,16 @@ SI void store(T* dst, V v, size_t tail) {
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         switch (tail) {
+        #if defined(JUMPER_IS_SKX)
+            case 15: dst[14] = v[14]; [[fallthrough]];
+            case 14: dst[13] = v[13]; [[fallthrough]];
+            case 13: dst[12] = v[12]; [[fallthrough]];
+            case 12: memcpy(dst, &v, 12*sizeof(T)); break;
+            case 11: dst[10] = v[10]; [[fallthrough]];
+            case 10: dst[ 9] = v[ 9]; [[fallthrough]];
+            case  9: dst[ 8] = v[ 8]; [[fallthrough]];
+            case  8: memcpy(dst, &v,  8*sizeof(T)); break;
+        #endif
             case 7: dst[6] = v[6]; [[fallthrough]];
             case 6: dst[5] = v[5]; [[fallthrough]];
             case 5: dst[4] = v[4]; [[fallthrough]];
@@ -1710,7 +1964,7 @@ STAGE(seed_shader, NoCtx) {
 
 STAGE(dither, const float* rate) {
     // Get [(dx,dy), (dx+1,dy), (dx+2,dy), ...] loaded up in integer vectors.
-    uint32_t iota[] = {0,1,2,3,4,5,6,7};
+    uint32_t iota[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15};
     U32 X = dx + sk_unaligned_load<U32>(iota),
         Y = dy;
 
@@ -2027,6 +2281,67 @@ STAGE(srcover_rgba_8888, const SkRasterPipeline_MemoryCtx* ctx) {
     store(ptr, dst, tail);
 }
 
+// Fused stages. SkRasterPipeline substitutes each of these for the sequence of stages named in its
+// comment, so they must leave memory and registers exactly as that sequence would.
+
+// load_8888, premul
+STAGE(load_8888_premul, const SkRasterPipeline_MemoryCtx* ctx) {
+    auto ptr = ptr_at_xy<const uint32_t>(ctx, dx,dy);
+    from_8888(load<U32>(ptr, tail), &r,&g,&b,&a);
+    r = r * a;
+    g = g * a;
+    b = b * a;
+}
+// load_8888, swap_rb
+STAGE(load_bgra_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    auto ptr = ptr_at_xy<const uint32_t>(ctx, dx,dy);
+    from_8888(load<U32>(ptr, tail), &b,&g,&r,&a);
+}
+// load_8888_dst, swap_rb_dst
+STAGE(load_bgra_8888_dst, const SkRasterPipeline_MemoryCtx* ctx) {
+    auto ptr = ptr_at_xy<const uint32_t>(ctx, dx,dy);
+    from_8888(load<U32>(ptr, tail), &db,&dg,&dr,&da);
+}
+// swap_rb, store_8888
+STAGE(store_bgra_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    auto ptr = ptr_at_xy<uint32_t>(ctx, dx,dy);
+
+    U32 px = to_unorm(b, 255)
+           | to_unorm(g, 255) <<  8
+           | to_unorm(r, 255) << 16
+           | to_unorm(a, 255) << 24;
+    store(ptr, px, tail);
+
+    auto tmp = r;
+    r = b;
+    b = tmp;
+}
+// swap_rb, srcover_rgba_8888
+STAGE(srcover_bgra_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    auto ptr = ptr_at_xy<uint32_t>(ctx, dx,dy);
+
+    auto tmp = r;
+    r = b;
+    b = tmp;
+
+    U32 dst = load<U32>(ptr, tail);
+    dr = cast((dst      ) & 0xff);
+    dg = cast((dst >>  8) & 0xff);
+    db = cast((dst >> 16) & 0xff);
+    da = cast((dst >> 24)       );
+
+    r = mad(dr, inv(a), r*255.0f);
+    g = mad(dg, inv(a), g*255.0f);
+    b = mad(db, inv(a), b*255.0f);
+    a = mad(da, inv(a), a*255.0f);
+
+    dst = to_unorm(r, 1, 255)
+        | to_unorm(g, 1, 255) <<  8
+        | to_unorm(b, 1, 255) << 16
+        | to_unorm(a, 1, 255) << 24;
+    store(ptr, dst, tail);
+}
+
 SI F clamp_01_(F v) { return min(max(0.0f, v), 1.0f); }
 
 STAGE(clamp_01, NoCtx) {
@@ -3004,7 +3319,22 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 8) {
+        // Only the first 8 lanes are loaded; idx never selects any of the others.
+        auto lookup = [&](const float* v) {
+            return _mm512_permutexvar_ps(idx, _mm512_castps256_ps512(_mm256_loadu_ps(v)));
+        };
+        fr = lookup(c->fs[0]);
+        br = lookup(c->bs[0]);
+        fg = lookup(c->fs[1]);
+        bg = lookup(c->bs[1]);
+        fb = lookup(c->fs[2]);
+        bb = lookup(c->bs[2]);
+        fa = lookup(c->fs[3]);
+        ba = lookup(c->bs[3]);
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), idx);
@@ -3323,7 +3653,7 @@ STAGE_TAIL(set_base_pointer, std::byte* p) {
                                                    sk_bit_cast<I32>(b))
 
 STAGE_TAIL(init_lane_masks, NoCtx) {
-    uint32_t iota[] = {0,1,2,3,4,5,6,7};
+    uint32_t iota[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15};
     I32 mask = tail ? cond_to_mask(sk_unaligned_load<U32>(iota) < tail) : I32(~0);
     r = g = b = a = sk_bit_cast<F>(mask);
 }
@@ -3447,7 +3777,7 @@ STAGE_TAIL(mask_off_return_mask, NoCtx) {
 
 STAGE_BRANCH(branch_if_all_lanes_active, SkRasterPipeline_BranchCtx* ctx) {
     if (tail) {
-        uint32_t iota[] = {0,1,2,3,4,5,6,7};
+        uint32_t iota[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15};
         I32 tailLanes = cond_to_mask(tail <= sk_unaligned_load<U32>(iota));
         return all(execution_mask() | tailLanes) ? ctx->offset : 1;
     } else {
@@ -4542,7 +4872,13 @@ namespace lowp {
 
 #else  // We are compiling vector code with Clang... let's make some lowp stages!
 
-#if defined(JUMPER_IS_HSW)
+// skx keeps hsw's 16 lanes rather than going to 32. Lowp works in 16-bit lanes but widens to 32
+// bits whenever it converts to float (gradients, bilerp, from_8888) or unpacks 8888; at 16 lanes
+// those fill a single 512-bit register, where 32 lanes would split each into two. 32 lanes would
+// also double SkRasterPipeline_kMaxStride, which sizes the lowp contexts and the stack buffers the
+// blitter and shaders keep for lowp, and leave any span narrower than 32 pixels entirely to the
+// tail path.
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     using U8  = uint8_t  __attribute__((ext_vector_type(16)));
     using U16 = uint16_t __attribute__((ext_vector_type(16)));
     using I16 =  int16_t __attribute__((ext_vector_type(16)));
@@ -4563,6 +4899,7 @@ namespace lowp {
 #endif
 
 static constexpr size_t N = sizeof(U16) / sizeof(uint16_t);
+static_assert(N <= SkRasterPipeline_kMaxStride);
 
 // Once again, some platforms benefit from a restricted Stage calling convention,
 // but others can pass tons and tons of registers and we're happy to exploit that.
@@ -4815,7 +5152,9 @@ SI U32 trunc_(F x) { return (U32)cast<I32>(x); }
 
 // Use approximate instructions and one Newton-Raphson step to calculate 1/x.
 SI F rcp_precise(F x) {
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_SKX)
+    return SK_OPTS_NS::rcp_precise(x);
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(SK_OPTS_NS::rcp_precise(lo), SK_OPTS_NS::rcp_precise(hi));
@@ -4832,7 +5171,9 @@ SI F rcp_precise(F x) {
 #endif
 }
 SI F sqrt_(F x) {
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_SKX)
+    return SK_OPTS_NS::sqrt_(x);
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_sqrt_ps(lo), _mm256_sqrt_ps(hi));
@@ -4867,6 +5208,8 @@ SI F floor_(F x) {
     float32x4_t lo,hi;
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
+#elif defined(JUMPER_IS_SKX)
+    return SK_OPTS_NS::floor_(x);
 #elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -4887,7 +5230,7 @@ SI F floor_(F x) {
 // The result is a number on [-1, 1).
 // Note: on neon this is a saturating multiply while the others are not.
 SI I16 scaled_mult(I16 a, I16 b) {
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     return _mm256_mulhrs_epi16(a, b);
 #elif defined(JUMPER_IS_SSE41) || defined(JUMPER_IS_AVX)
     return _mm_mulhrs_epi16(a, b);
@@ -5155,7 +5498,7 @@ SI V load(const T* ptr, size_t tail) {
     V v = 0;
     switch (tail & (N-1)) {
         case  0: memcpy(&v, ptr, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW)
+    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
         case 15: v[14] = ptr[14]; [[fallthrough]];
         case 14: v[13] = ptr[13]; [[fallthrough]];
         case 13: v[12] = ptr[12]; [[fallthrough]];
@@ -5179,7 +5522,7 @@ template <typename V, typename T>
 SI void store(T* ptr, size_t tail, V v) {
     switch (tail & (N-1)) {
         case  0: memcpy(ptr, &v, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW)
+    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
         case 15: ptr[14] = v[14]; [[fallthrough]];
         case 14: ptr[13] = v[13]; [[fallthrough]];
         case 13: ptr[12] = v[12]; [[fallthrough]];
@@ -5199,7 +5542,25 @@ SI void store(T* ptr, size_t tail, V v) {
     }
 }
 
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_SKX)
+    template <typename V, typename T>
+    SI V gather(const T* ptr, U32 ix) {
+        return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
+                  ptr[ix[ 4]], ptr[ix[ 5]], ptr[ix[ 6]], ptr[ix[ 7]],
+                  ptr[ix[ 8]], ptr[ix[ 9]], ptr[ix[10]], ptr[ix[11]],
+                  ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]], };
+    }
+
+    template<>
+    F gather(const float* ptr, U32 ix) {
+        return _mm512_i32gather_ps(ix, ptr, 4);
+    }
+
+    template<>
+    U32 gather(const uint32_t* ptr, U32 ix) {
+        return _mm512_i32gather_epi32(ix, ptr, 4);
+    }
+#elif defined(JUMPER_IS_HSW)
     template <typename V, typename T>
     SI V gather(const T* ptr, U32 ix) {
         return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
@@ -5237,7 +5598,12 @@ SI void store(T* ptr, size_t tail, V v) {
 // ~~~~~~ 32-bit memory loads and stores ~~~~~~ //
 
 SI void from_8888(U32 rgba, U16* r, U16* g, U16* b, U16* a) {
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_SKX)
+    // AVX-512 can narrow all 16 lanes in one instruction, in order, so no lane shuffling needed.
+    auto cast_U16 = [](U32 v) -> U16 {
+        return _mm512_cvtepi32_epi16(v);
+    };
+#elif defined(JUMPER_IS_HSW)
     // Swap the middle 128-bit lanes to make _mm256_packus_epi32() in cast_U16() work out nicely.
     __m256i _01,_23;
     split(rgba, &_01, &_23);
@@ -5718,7 +6084,22 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(JUMPER_IS_HSW)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 8) {
+        // Only the first 8 lanes are loaded; idx never selects any of the others.
+        auto lookup = [&](const float* v) -> F {
+            return _mm512_permutexvar_ps(idx, _mm512_castps256_ps512(_mm256_loadu_ps(v)));
+        };
+        fr = lookup(c->fs[0]);
+        br = lookup(c->bs[0]);
+        fg = lookup(c->fs[1]);
+        bg = lookup(c->bs[1]);
+        fb = lookup(c->fs[2]);
+        bb = lookup(c->bs[2]);
+        fa = lookup(c->fs[3]);
+        ba = lookup(c->bs[3]);
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -5921,6 +6302,47 @@ STAGE_PP(srcover_rgba_8888, const SkRasterPipeline_MemoryCtx* ctx) {
     store_8888_(ptr, tail, r,g,b,a);
 }
 
+// Fused stages; see the highp versions above.
+
+// load_8888, premul
+STAGE_PP(load_8888_premul, const SkRasterPipeline_MemoryCtx* ctx) {
+    load_8888_(ptr_at_xy<const uint32_t>(ctx, dx,dy), tail, &r,&g,&b,&a);
+    r = div255_accurate(r * a);
+    g = div255_accurate(g * a);
+    b = div255_accurate(b * a);
+}
+// load_8888, swap_rb
+STAGE_PP(load_bgra_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    load_8888_(ptr_at_xy<const uint32_t>(ctx, dx,dy), tail, &b,&g,&r,&a);
+}
+// load_8888_dst, swap_rb_dst
+STAGE_PP(load_bgra_8888_dst, const SkRasterPipeline_MemoryCtx* ctx) {
+    load_8888_(ptr_at_xy<const uint32_t>(ctx, dx,dy), tail, &db,&dg,&dr,&da);
+}
+// swap_rb, store_8888
+STAGE_PP(store_bgra_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    store_8888_(ptr_at_xy<uint32_t>(ctx, dx,dy), tail, b,g,r,a);
+
+    auto tmp = r;
+    r = b;
+    b = tmp;
+}
+// swap_rb, srcover_rgba_8888
+STAGE_PP(srcover_bgra_8888, const SkRasterPipeline_MemoryCtx* ctx) {
+    auto ptr = ptr_at_xy<uint32_t>(ctx, dx,dy);
+
+    auto tmp = r;
+    r = b;
+    b = tmp;
+
+    load_8888_(ptr, tail, &dr,&dg,&db,&da);
+    r = r + div255( dr*inv(a) );
+    g = g + div255( dg*inv(a) );
+    b = b + div255( db*inv(a) );
+    a = a + div255( da*inv(a) );
+    store_8888_(ptr, tail, r,g,b,a);
+}
+
 // ~~~~~~ skgpu::Swizzle stage ~~~~~~ //
 
 STAGE_PP(swizzle, void* ctx) {
@@ -36,7 +36,7 @@ bool sk_exists(const char *path, SkFILE_Flags flags) {
     if (flags & kRead_SkFILE_Flag) {
         mode |= R_OK;
     }
-    if (flags & kWrite_SkFILE_Flag) {
+    if (flags & (kWrite_SkFILE_Flag | kAppend_SkFILE_Flag)) {
         mode |= W_OK;
     }
 #ifdef SK_BUILD_FOR_IOS
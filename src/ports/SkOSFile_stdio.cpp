@@ -70,6 +70,8 @@ FILE* sk_fopen(const char path[], SkFILE_Flags flags) {
     }
     if (flags & kWrite_SkFILE_Flag) {
         *p++ = 'w';
+    } else if (flags & kAppend_SkFILE_Flag) {
+        *p++ = 'a';
     }
     *p = 'b';
 
@@ -89,7 +91,7 @@ FILE* sk_fopen(const char path[], SkFILE_Flags flags) {
     }
 #endif
 
-    if (nullptr == file && (flags & kWrite_SkFILE_Flag)) {
+    if (nullptr == file && (flags & (kWrite_SkFILE_Flag | kAppend_SkFILE_Flag))) {
         SkDEBUGF("sk_fopen: fopen(\"%s\", \"%s\") returned nullptr (errno:%d): %s\n",
                  path, perm, errno, strerror(errno));
     }
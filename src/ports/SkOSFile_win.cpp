@@ -29,7 +29,7 @@ bool sk_exists(const char *path, SkFILE_Flags flags) {
     if (flags & kRead_SkFILE_Flag) {
         mode |= 4; // read
     }
-    if (flags & kWrite_SkFILE_Flag) {
+    if (flags & (kWrite_SkFILE_Flag | kAppend_SkFILE_Flag)) {
         mode |= 2; // write
     }
     return (0 == _access(path, mode));
@@ -21,15 +21,285 @@
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSemaphore.h"
 #include "src/codec/SkCodecImageGenerator.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <deque>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
+// Decodes frame index with codec. If requiredImage is the frame it depends on, the frame is
+// decoded on top of it; otherwise the codec decodes the frames it depends on too.
+static sk_sp<SkImage> decode_frame(SkCodec* codec, const SkImageInfo& info, int index,
+                                   const SkCodec::FrameInfo& frameInfo,
+                                   const sk_sp<SkImage>& requiredImage) {
+    size_t rb = info.minRowBytes();
+    size_t size = info.computeByteSize(rb);
+    auto data = SkData::MakeUninitialized(size);
+
+    SkCodec::Options opts;
+    opts.fFrameIndex = index;
+
+    const auto origin = codec->getOrigin();
+    const auto orientedDims = SkEncodedOriginSwapsWidthHeight(origin)
+                                      ? SkISize{info.height(), info.width()}
+                                      : info.dimensions();
+    const auto originMatrix = SkEncodedOriginToMatrix(origin, orientedDims.width(),
+                                                              orientedDims.height());
+
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+
+    auto imageInfo = info;
+    if (frameInfo.fAlphaType != kOpaque_SkAlphaType && imageInfo.isOpaque()) {
+        imageInfo = imageInfo.makeAlphaType(kPremul_SkAlphaType);
+    }
+    const int requiredFrame = frameInfo.fRequiredFrame;
+    if (requiredFrame != SkCodec::kNoFrame && requiredImage) {
+        auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
+        if (origin != kDefault_SkEncodedOrigin) {
+            // The required frame is stored after applying the origin. Undo that,
+            // because the codec decodes prior to applying the origin.
+            // FIXME: Another approach would be to decode the frame's delta on top
+            // of transparent black, and then draw that through the origin matrix
+            // onto the required frame. To do that, SkCodec needs to expose the
+            // rectangle of the delta and the blend mode, so we can handle
+            // kRestoreBGColor frames and Blend::kSrc.
+            SkMatrix inverse;
+            SkAssertResult(originMatrix.invert(&inverse));
+            canvas->concat(inverse);
+        }
+        canvas->drawImage(requiredImage, 0, 0, SkSamplingOptions(), &paint);
+        opts.fPriorFrame = requiredFrame;
+    }
+
+    if (SkCodec::kSuccess != codec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
+        return nullptr;
+    }
+
+    auto image = SkImages::RasterFromData(imageInfo, std::move(data), rb);
+    if (origin != kDefault_SkEncodedOrigin) {
+        imageInfo = imageInfo.makeDimensions(orientedDims);
+        rb = imageInfo.minRowBytes();
+        size = imageInfo.computeByteSize(rb);
+        data = SkData::MakeUninitialized(size);
+        auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
+        canvas->concat(originMatrix);
+        canvas->drawImage(image, 0, 0, SkSamplingOptions(), &paint);
+        image = SkImages::RasterFromData(imageInfo, std::move(data), rb);
+    }
+    return image;
+}
+
+// Keeps the frames from the current one to some number after it decoded, decoding the missing
+// ones on an executor. The frames to decode are split into chains, each starting with a frame
+// that depends on none of the others, and the chains are decoded in parallel, each by a task
+// with a codec of its own. A frame that depends on one still being decoded joins that frame's
+// chain, so it is decoded on top of it rather than from the frames before it.
+class SkAnimCodecPlayer::DecodeAhead {
+public:
+    DecodeAhead(sk_sp<SkData> data, const SkImageInfo& info,
+                std::vector<SkCodec::FrameInfo> frameInfos,
+                const DecodeAheadOptions& options)
+            : fData(std::move(data))
+            , fImageInfo(info)
+            , fFrameInfos(std::move(frameInfos))
+            , fDropLateFrames(options.fDropLateFrames)
+            , fTasks(*options.fExecutor) {
+        const size_t frameBytes = std::max<size_t>(1, info.computeMinByteSize());
+        const size_t framesInBytes = std::max<size_t>(1, options.fMaxBytes / frameBytes);
+        fMaxFrames = static_cast<int>(std::min<size_t>(
+                {framesInBytes, (size_t)std::max(options.fMaxFrames, 1), fFrameInfos.size()}));
+    }
+
+    ~DecodeAhead() {
+        fCancelled = true;
+        fTasks.wait();
+    }
+
+    bool dropLateFrames() const { return fDropLateFrames; }
+
+    // Returns frame index if it is decoded, and sets decoding if it is being decoded.
+    sk_sp<SkImage> find(int index, bool* decoding = nullptr) {
+        SkAutoMutexExclusive lock(fMutex);
+        if (decoding) {
+            *decoding = fDecoding.count(index) > 0;
+        }
+        auto found = fFrames.find(index);
+        return found != fFrames.end() ? found->second : nullptr;
+    }
+
+    // If frame index is being decoded, waits for that decode to finish. Returns frame index if it
+    // is decoded.
+    sk_sp<SkImage> waitFor(int index) {
+        for (;;) {
+            {
+                SkAutoMutexExclusive lock(fMutex);
+                if (!fDecoding.count(index)) {
+                    auto found = fFrames.find(index);
+                    return found != fFrames.end() ? found->second : nullptr;
+                }
+                fWaitingFor = index;
+            }
+            fDecoded.wait();
+        }
+    }
+
+    // Keeps frame index, if it is one of the frames to keep.
+    void insert(int index, sk_sp<SkImage> image) {
+        SkAutoMutexExclusive lock(fMutex);
+        if (image && this->isKept(index)) {
+            fFrames[index] = std::move(image);
+        }
+    }
+
+    // Makes current the first frame to keep, and starts decoding the frames to keep that are
+    // neither decoded nor being decoded.
+    void schedule(int current) {
+        std::vector<std::shared_ptr<Chain>> chains;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            fCurrent = current;
+            for (auto it = fFrames.begin(); it != fFrames.end();) {
+                it = this->isKept(it->first) ? std::next(it) : fFrames.erase(it);
+            }
+
+            // A frame depends only on frames before it, so a frame joins the chain of the frame it
+            // depends on, if that is being decoded or scheduled too.
+            for (int i = 0; i < fMaxFrames; i++) {
+                const int index = (current + i) % static_cast<int>(fFrameInfos.size());
+                if (fFrames.count(index) || fDecoding.count(index)) {
+                    continue;
+                }
+                auto required = fDecoding.find(fFrameInfos[index].fRequiredFrame);
+                Chain* chain;
+                if (required != fDecoding.end()) {
+                    chain = required->second;
+                } else {
+                    chains.push_back(std::make_shared<Chain>());
+                    chain = chains.back().get();
+                }
+                chain->push_back(index);
+                fDecoding[index] = chain;
+            }
+        }
+        for (std::shared_ptr<Chain>& chain : chains) {
+            fTasks.add([this, chain = std::move(chain)] { this->decodeChain(chain.get()); });
+        }
+    }
+
+private:
+    bool isKept(int index) const {
+        const int count = static_cast<int>(fFrameInfos.size());
+        return (index - fCurrent + count) % count < fMaxFrames;
+    }
+
+    // The frames of a chain waiting to be decoded, in order. Guarded by fMutex.
+    using Chain = std::deque<int>;
+
+    void decodeChain(Chain* chain) {
+        std::unique_ptr<SkCodec> codec;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            if (!fIdleCodecs.empty()) {
+                codec = std::move(fIdleCodecs.back());
+                fIdleCodecs.pop_back();
+            }
+        }
+        if (!codec) {
+            codec = SkCodec::MakeFromData(fData);
+        }
+
+        // The frames of this chain that frames still in it depend on.
+        std::map<int, sk_sp<SkImage>> decoded;
+        for (;;) {
+            int index;
+            {
+                SkAutoMutexExclusive lock(fMutex);
+                if (chain->empty()) {
+                    break;
+                }
+                index = chain->front();
+                chain->pop_front();
+            }
+
+            sk_sp<SkImage> image;
+            if (codec && !fCancelled) {
+                const int requiredFrame = fFrameInfos[index].fRequiredFrame;
+                sk_sp<SkImage> requiredImage;
+                if (requiredFrame != SkCodec::kNoFrame) {
+                    auto found = decoded.find(requiredFrame);
+                    requiredImage = found != decoded.end() ? found->second
+                                                           : this->find(requiredFrame);
+                }
+                image = decode_frame(codec.get(), fImageInfo, index, fFrameInfos[index],
+                                     requiredImage);
+                decoded[index] = image;
+            }
+
+            SkAutoMutexExclusive lock(fMutex);
+            // Once index is no longer being decoded, schedule() stops adding frames that depend on
+            // it to this chain, so only the frames already in the chain can still need it.
+            fDecoding.erase(index);
+            for (auto it = decoded.begin(); it != decoded.end();) {
+                const int frame = it->first;
+                const bool required = std::any_of(chain->begin(), chain->end(), [&](int next) {
+                    return fFrameInfos[next].fRequiredFrame == frame;
+                });
+                it = required ? std::next(it) : decoded.erase(it);
+            }
+            if (image && this->isKept(index)) {
+                fFrames[index] = std::move(image);
+            }
+            if (index == fWaitingFor) {
+                fWaitingFor = -1;
+                fDecoded.signal();
+            }
+        }
+
+        if (codec) {
+            SkAutoMutexExclusive lock(fMutex);
+            fIdleCodecs.push_back(std::move(codec));
+        }
+    }
+
+    const sk_sp<SkData>                   fData;
+    const SkImageInfo                     fImageInfo;
+    const std::vector<SkCodec::FrameInfo> fFrameInfos;
+    const bool                            fDropLateFrames;
+    int                                   fMaxFrames;
+    std::atomic<bool>                     fCancelled{false};
+
+    SkMutex                               fMutex;
+    int                                   fCurrent = 0;
+    std::map<int, sk_sp<SkImage>>         fFrames;
+    std::map<int, Chain*>                 fDecoding;    // Each frame being decoded, and its chain.
+    std::vector<std::unique_ptr<SkCodec>> fIdleCodecs;
+
+    // The player is used from one thread at a time, so there is at most one waitFor() call, for
+    // fWaitingFor. fDecoded is signaled once that frame is no longer being decoded.
+    int                                   fWaitingFor = -1;
+    SkSemaphore                           fDecoded;
+
+    // Declared last, so that it waits for the tasks before the rest is destroyed.
+    SkTaskGroup                           fTasks;
+};
+
 SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
+    if (!fCodec) {
+        // Behave like a static image that failed to decode.
+        fTotalDuration = 0;
+        fImages.push_back(nullptr);
+        return;
+    }
+
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
     fImages.resize(fFrameInfos.size());
@@ -51,6 +321,16 @@ SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(st
     }
 }
 
+SkAnimCodecPlayer::SkAnimCodecPlayer(sk_sp<SkData> data, const DecodeAheadOptions& options)
+        : SkAnimCodecPlayer(SkCodec::MakeFromData(data)) {
+    if (fTotalDuration && options.fExecutor) {
+        fImages.clear();
+        fDecodeAhead = std::make_unique<DecodeAhead>(std::move(data), fImageInfo, fFrameInfos,
+                                                     options);
+        fDecodeAhead->schedule(fCurrIndex);
+    }
+}
+
 SkAnimCodecPlayer::~SkAnimCodecPlayer() {}
 
 SkISize SkAnimCodecPlayer::dimensions() const {
@@ -71,69 +351,51 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         return fImages[index];
     }
 
-    size_t rb = fImageInfo.minRowBytes();
-    size_t size = fImageInfo.computeByteSize(rb);
-    auto data = SkData::MakeUninitialized(size);
-
-    SkCodec::Options opts;
-    opts.fFrameIndex = index;
-
-    const auto origin = fCodec->getOrigin();
-    const auto orientedDims = this->dimensions();
-    const auto originMatrix = SkEncodedOriginToMatrix(origin, orientedDims.width(),
-                                                              orientedDims.height());
+    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
+    const sk_sp<SkImage> requiredImage =
+            requiredFrame != SkCodec::kNoFrame ? fImages[requiredFrame] : nullptr;
+    return fImages[index] = decode_frame(fCodec.get(), fImageInfo, index, fFrameInfos[index],
+                                         requiredImage);
+}
 
-    SkPaint paint;
-    paint.setBlendMode(SkBlendMode::kSrc);
+sk_sp<SkImage> SkAnimCodecPlayer::getDecodedAheadFrame(int index) {
+    SkASSERT((unsigned)index < fFrameInfos.size());
 
-    auto imageInfo = fImageInfo;
-    if (fFrameInfos[index].fAlphaType != kOpaque_SkAlphaType && imageInfo.isOpaque()) {
-        imageInfo = imageInfo.makeAlphaType(kPremul_SkAlphaType);
+    bool decoding;
+    sk_sp<SkImage> image = fDecodeAhead->find(index, &decoding);
+    if (image) {
+        return image;
     }
-    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
-    if (requiredFrame != SkCodec::kNoFrame && fImages[requiredFrame]) {
-        auto requiredImage = fImages[requiredFrame];
-        auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
-        if (origin != kDefault_SkEncodedOrigin) {
-            // The required frame is stored after applying the origin. Undo that,
-            // because the codec decodes prior to applying the origin.
-            // FIXME: Another approach would be to decode the frame's delta on top
-            // of transparent black, and then draw that through the origin matrix
-            // onto the required frame. To do that, SkCodec needs to expose the
-            // rectangle of the delta and the blend mode, so we can handle
-            // kRestoreBGColor frames and Blend::kSrc.
-            SkMatrix inverse;
-            SkAssertResult(originMatrix.invert(&inverse));
-            canvas->concat(inverse);
+    if (decoding) {
+        if (fDecodeAhead->dropLateFrames() && fLastFrame) {
+            return fLastFrame;
+        }
+        // Rather than decoding the frame a second time, wait for the decode already under way.
+        if ((image = fDecodeAhead->waitFor(index))) {
+            return image;
         }
-        canvas->drawImage(requiredImage, 0, 0, SkSamplingOptions(), &paint);
-        opts.fPriorFrame = requiredFrame;
-    }
-
-    if (SkCodec::kSuccess != fCodec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
-        return nullptr;
     }
 
-    auto image = SkImages::RasterFromData(imageInfo, std::move(data), rb);
-    if (origin != kDefault_SkEncodedOrigin) {
-        imageInfo = imageInfo.makeDimensions(orientedDims);
-        rb = imageInfo.minRowBytes();
-        size = imageInfo.computeByteSize(rb);
-        data = SkData::MakeUninitialized(size);
-        auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
-        canvas->concat(originMatrix);
-        canvas->drawImage(image, 0, 0, SkSamplingOptions(), &paint);
-        image = SkImages::RasterFromData(imageInfo, std::move(data), rb);
-    }
-    return fImages[index] = image;
+    // Decode on top of the required frame if possible, waiting for it if it is still being decoded,
+    // rather than having the codec decode every frame it depends on.
+    const int requiredFrame = fFrameInfos[index].fRequiredFrame;
+    const sk_sp<SkImage> requiredImage =
+            requiredFrame != SkCodec::kNoFrame ? fDecodeAhead->waitFor(requiredFrame) : nullptr;
+    image = decode_frame(fCodec.get(), fImageInfo, index, fFrameInfos[index], requiredImage);
+    fDecodeAhead->insert(index, image);
+    return image;
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
     SkASSERT(fTotalDuration > 0 || fImages.size() == 1);
 
-    return fTotalDuration > 0
-        ? this->getFrameAt(fCurrIndex)
-        : fImages.front();
+    if (!fTotalDuration) {
+        return fImages.front();
+    }
+    if (fDecodeAhead) {
+        return fLastFrame = this->getDecodedAheadFrame(fCurrIndex);
+    }
+    return this->getFrameAt(fCurrIndex);
 }
 
 bool SkAnimCodecPlayer::seek(uint32_t msec) {
@@ -149,6 +411,9 @@ bool SkAnimCodecPlayer::seek(uint32_t msec) {
                                   });
     int prevIndex = fCurrIndex;
     fCurrIndex = lower - fFrameInfos.begin();
+    if (fDecodeAhead && fCurrIndex != prevIndex) {
+        fDecodeAhead->schedule(fCurrIndex);
+    }
     return fCurrIndex != prevIndex;
 }
 
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkPictureBandRenderer.h"
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+
+#include <algorithm>
+
+bool SkPictureBandRenderer::Render(const SkPicture* picture,
+                                   const SkImageInfo& info,
+                                   const Options& options,
+                                   const BandProc& bandProc) {
+    if (!picture || info.isEmpty() || options.fBandHeight <= 0 || !bandProc) {
+        return false;
+    }
+
+    SkBitmap band;
+    if (!band.tryAllocPixels(info.makeWH(info.width(),
+                                         std::min(options.fBandHeight, info.height())))) {
+        return false;
+    }
+    SkCanvas canvas(band);
+
+    for (int top = 0; top < info.height(); top += band.height()) {
+        const int rows = std::min(band.height(), info.height() - top);
+
+        canvas.save();
+        canvas.clipIRect(SkIRect::MakeWH(info.width(), rows));
+        canvas.clear(options.fBackground);
+        canvas.translate(0, -SkIntToScalar(top));
+        canvas.concat(options.fMatrix);
+        // playback() draws the picture without an enclosing layer, and culls its ops to the
+        // band with the picture's bounding box hierarchy, if it has one.
+        picture->playback(&canvas);
+        canvas.restore();
+
+        SkPixmap bandRows;
+        if (!band.pixmap().extractSubset(&bandRows, SkIRect::MakeWH(info.width(), rows)) ||
+            !bandProc(bandRows, top)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -8,10 +8,13 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
@@ -21,6 +24,7 @@
 #include "tools/Resources.h"
 
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <initializer_list>
 #include <memory>
@@ -272,3 +276,70 @@ DEF_TEST(AndroidCodec_PQ, r) {
     static constexpr skcms_Matrix3x3 kExpected = SkNamedGamut::kRec2020;
     REPORTER_ASSERT(r, 0 == memcmp(&matrix, &kExpected, sizeof(skcms_Matrix3x3)));
 }
+
+// Returns the mean difference of the color channels of two same-sized N32 bitmaps.
+static float mean_difference(const SkBitmap& a, const SkBitmap& b) {
+    double sum = 0;
+    for (int y = 0; y < a.height(); y++) {
+        const uint8_t* rowA = static_cast<const uint8_t*>(a.getAddr(0, y));
+        const uint8_t* rowB = static_cast<const uint8_t*>(b.getAddr(0, y));
+        for (int i = 0; i < a.width() * 4; i++) {
+            sum += std::abs(rowA[i] - rowB[i]);
+        }
+    }
+    return (float)(sum / (a.width() * a.height() * 4));
+}
+
+DEF_TEST(AndroidCodec_resampledPixels, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+
+    for (const char* path : { "images/dog.jpg",
+                              "images/mandrill_512.png" }) {
+        auto codec = SkAndroidCodec::MakeFromCodec(SkCodec::MakeFromData(GetResourceAsData(path)));
+        if (!codec) {
+            ERRORF(r, "Failed to create codec from %s", path);
+            continue;
+        }
+
+        const SkImageInfo fullInfo = codec->getInfo().makeColorType(kN32_SkColorType)
+                                                     .makeAlphaType(kPremul_SkAlphaType);
+        SkBitmap full;
+        full.allocPixels(fullInfo);
+        if (SkCodec::kSuccess != codec->getAndroidPixels(full.info(), full.getPixels(),
+                                                         full.rowBytes())) {
+            ERRORF(r, "Failed to decode %s", path);
+            continue;
+        }
+
+        for (SkISize dims : { SkISize{97, 61}, SkISize{fullInfo.width() / 3, 20},
+                              SkISize{fullInfo.width(), fullInfo.height() / 2}, SkISize{1, 1} }) {
+            const SkImageInfo info = fullInfo.makeDimensions(dims);
+            SkBitmap expected, actual;
+            expected.allocPixels(info);
+            actual.allocPixels(info);
+            full.pixmap().scalePixels(expected.pixmap(),
+                                      SkSamplingOptions(SkCubicResampler::Mitchell()));
+
+            SkCodec::Result result = codec->getResampledPixels(info, actual.getPixels(),
+                                                               actual.rowBytes());
+            if (SkCodec::kSuccess != result) {
+                ERRORF(r, "%s: failed to resample to %dx%d: %s", path, dims.width(),
+                       dims.height(), SkCodec::ResultToString(result));
+                continue;
+            }
+            // Native scaling (e.g. jpeg's DCT scaling) filters differently than the cubic, so
+            // only expect the images to be close.
+            const float diff = mean_difference(expected, actual);
+            REPORTER_ASSERT(r, diff < 4, "%s at %dx%d differs by %g on average", path,
+                            dims.width(), dims.height(), diff);
+        }
+
+        const SkImageInfo larger = fullInfo.makeWH(fullInfo.width() + 1, fullInfo.height());
+        SkBitmap bm;
+        bm.allocPixels(larger);
+        REPORTER_ASSERT(r, SkCodec::kInvalidScale ==
+                           codec->getResampledPixels(larger, bm.getPixels(), bm.rowBytes()));
+    }
+}
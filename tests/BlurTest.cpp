@@ -12,6 +12,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMaskFilter.h"
 #include "include/core/SkPaint.h"
@@ -33,8 +34,11 @@
 #include "include/private/base/SkFloatBits.h"
 #include "include/private/base/SkTPin.h"
 #include "src/base/SkMathPriv.h"
+#include "src/base/SkRandom.h"
 #include "src/core/SkBlurMask.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/effects/SkEmbossMaskFilter.h"
 #include "src/gpu/ganesh/GrBlurUtils.h"
@@ -48,6 +52,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include <memory>
+#include <vector>
 
 struct GrContextOptions;
 
@@ -586,3 +592,51 @@ DEF_TEST(zero_blur, reporter) {
     SkIPoint offset;
     bitmap.extractAlpha(&alpha, &paint, nullptr, &offset);
 }
+
+// Blurring on one thread or on an executor, from an A8 mask or from an ARGB32 one, all have to
+// produce the pixels the original scalar blur did. The checksums were recorded from it.
+DEF_TEST(BlurMaskFilterThreaded, reporter) {
+    constexpr int kW = 701, kH = 501;  // Not a multiple of any vector width.
+    SkRandom rand;
+    std::vector<uint8_t> a8(kW * kH);
+    std::vector<uint32_t> argb(kW * kH);
+    for (int i = 0; i < kW * kH; ++i) {
+        a8[i] = (rand.nextU() & 1) ? 0xFF : rand.nextU() & 0xFF;
+        argb[i] = SkPackARGB32(a8[i], 0, 0, 0);
+    }
+    const SkIRect bounds = SkIRect::MakeXYWH(-3, 7, kW, kH);
+    const SkMask a8Mask(a8.data(), bounds, kW, SkMask::kA8_Format);
+    const SkMask argbMask(reinterpret_cast<const uint8_t*>(argb.data()), bounds,
+                          kW * sizeof(uint32_t), SkMask::kARGB32_Format);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    const struct {
+        double   sigma;
+        uint32_t checksum;
+    } kCases[] = {
+        { 2.5, 0x3193a9ac},
+        {10.0, 0x5da6434e},
+        {60.0, 0xae602889},
+    };
+    for (const auto& [sigma, checksum] : kCases) {
+        SkMaskBlurFilter filter{sigma, sigma};
+
+        SkMaskBuilder expected, threaded, fromARGB;
+        SkIPoint border = filter.blur(a8Mask, &expected);
+        REPORTER_ASSERT(reporter, border == filter.blur(a8Mask, &threaded, executor.get()));
+        REPORTER_ASSERT(reporter, border == filter.blur(argbMask, &fromARGB, executor.get()));
+        SkAutoMaskFreeImage freeExpected(expected.image()),
+                            freeThreaded(threaded.image()),
+                            freeFromARGB(fromARGB.image());
+
+        REPORTER_ASSERT(reporter, expected.fBounds == threaded.fBounds);
+        REPORTER_ASSERT(reporter, expected.fBounds == fromARGB.fBounds);
+        size_t size = expected.computeImageSize();
+        REPORTER_ASSERT(reporter, size > 0);
+        REPORTER_ASSERT(reporter, SkChecksum::Hash32(expected.fImage, size) == checksum,
+                        "sigma %g", sigma);
+        REPORTER_ASSERT(reporter, !memcmp(expected.fImage, threaded.fImage, size));
+        REPORTER_ASSERT(reporter, !memcmp(expected.fImage, fromARGB.fImage, size));
+    }
+}
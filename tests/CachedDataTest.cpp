@@ -9,9 +9,11 @@
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkMalloc.h"
 #include "src/core/SkCachedData.h"
+#include "src/core/SkResourceCachePool.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
+#include <cstdint>
 #include <cstring>
 
 class SkDiscardableMemory;
@@ -99,3 +101,59 @@ DEF_TEST(CachedData, reporter) {
         data->detachFromCacheAndUnref();
     }
 }
+
+DEF_TEST(CachedData_Pool, reporter) {
+    SkResourceCachePool pool;
+
+    // Blocks of the same size class are recycled.
+    void* a = pool.allocate(10000);
+    void* b = pool.allocate(10000);
+    REPORTER_ASSERT(reporter, a && b && a != b);
+    REPORTER_ASSERT(reporter, reinterpret_cast<uintptr_t>(a) % 16 == 0);
+    memset(a, 0x80, 10000);
+    pool.release(a);
+    void* c = pool.allocate(9900);
+    REPORTER_ASSERT(reporter, c == a);
+
+    // With their headers, both blocks fall in the 10240-byte class, 102 blocks to a slab. The rest
+    // of the slab's blocks is fragmented.
+    SkResourceCachePool::Stats stats = pool.stats();
+    REPORTER_ASSERT(reporter, stats.fSlabCount == 1);
+    REPORTER_ASSERT(reporter, stats.fAllocatedBytes == 10000 + 9900);
+    REPORTER_ASSERT(reporter, stats.fFragmentedBytes == 102 * 10240 - (10000 + 9900),
+                    "%zu", stats.fFragmentedBytes);
+
+    // A block in the 320-byte class, 3276 blocks to a slab, takes a slab of its own.
+    void* d = pool.allocate(300);
+    stats = pool.stats();
+    REPORTER_ASSERT(reporter, stats.fSlabCount == 2);
+    REPORTER_ASSERT(reporter, stats.fAllocatedBytes == 10000 + 9900 + 300);
+    REPORTER_ASSERT(reporter, stats.fFragmentedBytes == 102 * 10240 - (10000 + 9900) +
+                                                        3276 * 320 - 300,
+                    "%zu", stats.fFragmentedBytes);
+
+    // Blocks too large for a class don't take a slab.
+    void* large = pool.allocate(16 << 20);
+    REPORTER_ASSERT(reporter, large);
+    REPORTER_ASSERT(reporter, pool.stats().fUnpooledBytes == (16 << 20));
+    REPORTER_ASSERT(reporter, pool.stats().fSlabCount == 2);
+    pool.release(large);
+    REPORTER_ASSERT(reporter, pool.stats().fUnpooledBytes == 0);
+
+    // The emptied slabs are kept as spares until the pool is asked to release them.
+    pool.release(b);
+    pool.release(c);
+    pool.release(d);
+    REPORTER_ASSERT(reporter, pool.stats().fAllocatedBytes == 0);
+    REPORTER_ASSERT(reporter, pool.stats().fSlabCount == 2);
+    pool.releaseEmptySlabs();
+    REPORTER_ASSERT(reporter, pool.stats().fSlabCount == 0);
+    REPORTER_ASSERT(reporter, pool.stats().fSlabBytes == 0);
+
+    // SkCachedData returns its block to the pool.
+    SkCachedData* data = new SkCachedData(100, &pool, pool.allocate(100));
+    check_data(reporter, data, 1, kNotInCache, kLocked);
+    REPORTER_ASSERT(reporter, pool.stats().fAllocatedBytes == 100);
+    data->unref();
+    REPORTER_ASSERT(reporter, pool.stats().fAllocatedBytes == 0);
+}
@@ -13,6 +13,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
@@ -626,3 +627,64 @@ DEF_TEST(AnimCodecPlayer, r) {
                         "Mismatched size for frame at 500 ms of %s", test.fFile);
     }
 }
+
+DEF_TEST(AnimCodecPlayer_decodeAhead, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/required.gif",
+                              "images/required.webp",
+                              "images/stoplight_h.webp" }) {
+        sk_sp<SkData> data = GetResourceAsData(file);
+        if (!data) {
+            continue;
+        }
+        auto player = std::make_unique<SkAnimCodecPlayer>(SkCodec::MakeFromData(data));
+
+        // Few enough frames kept that frames are dropped and decoded again on the second loop.
+        SkAnimCodecPlayer::DecodeAheadOptions options;
+        options.fExecutor = executor.get();
+        options.fMaxFrames = 3;
+        auto aheadPlayer = std::make_unique<SkAnimCodecPlayer>(data, options);
+        REPORTER_ASSERT(r, aheadPlayer->duration() == player->duration());
+        REPORTER_ASSERT(r, aheadPlayer->dimensions() == player->dimensions());
+
+        std::vector<uint32_t> frameStarts = {0};
+        for (const SkCodec::FrameInfo& frameInfo : SkCodec::MakeFromData(data)->getFrameInfo()) {
+            frameStarts.push_back(frameStarts.back() + frameInfo.fDuration);
+        }
+        frameStarts.pop_back();
+
+        for (int loop = 0; loop < 2; loop++) {
+            for (uint32_t msec : frameStarts) {
+                player->seek(msec);
+                aheadPlayer->seek(msec);
+                sk_sp<SkImage> expected = player->getFrame();
+                sk_sp<SkImage> actual = aheadPlayer->getFrame();
+                REPORTER_ASSERT(r, expected && actual);
+                if (expected && actual) {
+                    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected.get(), actual.get()),
+                                    "%s: mismatch at %u ms", file, msec);
+                }
+            }
+        }
+
+        // Dropping late frames may return an older frame, but never none.
+        options.fDropLateFrames = true;
+        aheadPlayer = std::make_unique<SkAnimCodecPlayer>(data, options);
+        for (uint32_t msec : frameStarts) {
+            aheadPlayer->seek(msec);
+            REPORTER_ASSERT(r, aheadPlayer->getFrame());
+        }
+    }
+
+    // Data that can't be decoded makes a player with no frames.
+    SkAnimCodecPlayer::DecodeAheadOptions options;
+    options.fExecutor = executor.get();
+    for (sk_sp<SkData> data : {sk_sp<SkData>(nullptr), SkData::MakeWithCString("not an image")}) {
+        SkAnimCodecPlayer player(std::move(data), options);
+        REPORTER_ASSERT(r, player.duration() == 0);
+        REPORTER_ASSERT(r, player.dimensions().isEmpty());
+        REPORTER_ASSERT(r, !player.seek(10));
+        REPORTER_ASSERT(r, !player.getFrame());
+    }
+}
@@ -9,6 +9,7 @@
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
 #include "include/codec/SkPngChunkReader.h"
+#include "include/codec/SkPngDecoder.h"
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
@@ -17,6 +18,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkImageInfo.h"
@@ -50,6 +52,10 @@
 #include "client_utils/android/FrontBufferedStream.h"
 #endif
 
+#if defined(SK_CODEC_DECODES_JPEG)
+#include "src/codec/SkJpegRestartStrips.h"
+#endif
+
 #include <png.h>
 #include <pngconf.h>
 #include <setjmp.h>
@@ -1068,6 +1074,148 @@ DEF_TEST(Codec_jpeg_rewind, r) {
     REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
 }
 
+DEF_TEST(Codec_jpeg_restartStrips, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    auto p3 = SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB, SkNamedGamut::kDisplayP3);
+
+#if defined(SK_CODEC_DECODES_JPEG)
+    // The first image has a restart marker at the end of each row of MCUs, so it splits into
+    // strips, as the threaded decode asks for them, which cover it top to bottom.
+    if (sk_sp<SkData> data = GetResourceAsData("images/iphone_13_pro.jpeg")) {
+        std::unique_ptr<SkJpegRestartStrips> strips = SkJpegRestartStrips::Make(data, 16, 256);
+        REPORTER_ASSERT(r, strips && strips->count() > 1);
+        if (strips) {
+            int bottom = 0;
+            for (int i = 0; i < strips->count(); i++) {
+                REPORTER_ASSERT(r, strips->top(i) == bottom && strips->height(i) >= 256);
+                bottom = strips->top(i) + strips->height(i);
+            }
+            REPORTER_ASSERT(r, bottom == SkCodec::MakeFromData(data)->dimensions().height());
+        }
+    }
+#endif
+
+    // The first image is decoded in strips. The others can't be, so they fall back to decoding
+    // the whole image at once.
+    for (const char* path : { "images/iphone_13_pro.jpeg",
+                              "images/mandrill_512_q075.jpg",
+                              "images/grayscale.jpg" }) {
+        sk_sp<SkData> data(GetResourceAsData(path));
+        if (!data) {
+            continue;
+        }
+        // A truncated image can't be split, but decodes the same way it does without threads.
+        sk_sp<SkData> truncated = SkData::MakeSubset(data.get(), 0, data->size() / 2);
+        for (sk_sp<SkData> encoded : { data, truncated }) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(encoded);
+            if (!codec) {
+                ERRORF(r, "Unable to create codec '%s'.", path);
+                break;
+            }
+
+            for (sk_sp<SkColorSpace> cs : { sk_sp<SkColorSpace>(nullptr), p3 }) {
+                const SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType)
+                                                         .makeColorSpace(cs);
+                SkBitmap expected, actual;
+                expected.allocPixels(info);
+                actual.allocPixels(info);
+
+                SkCodec::Result expectedResult = codec->getPixels(expected.pixmap());
+                SkCodec::Options options;
+                options.fExecutor = executor.get();
+                SkCodec::Result result = codec->getPixels(actual.pixmap(), &options);
+                REPORTER_ASSERT(r, expectedResult == result, "%s: %s != %s", path,
+                                SkCodec::ResultToString(expectedResult),
+                                SkCodec::ResultToString(result));
+                REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual), "%s", path);
+            }
+        }
+    }
+}
+
+DEF_TEST(Codec_png_rowIndex, r) {
+    const char* path = "images/mandrill_1600.png";
+    sk_sp<SkData> data(GetResourceAsData(path));
+    if (!data) {
+        return;
+    }
+    sk_sp<SkData> rowIndex = SkPngDecoder::MakeRowIndex(data);
+    if (!rowIndex) {
+        ERRORF(r, "Unable to index '%s'.", path);
+        return;
+    }
+
+    // Images that can't be indexed.
+    REPORTER_ASSERT(r,
+                    !SkPngDecoder::MakeRowIndex(GetResourceAsData("images/plane_interlaced.png")));
+    REPORTER_ASSERT(r, !SkPngDecoder::MakeRowIndex(
+            SkData::MakeSubset(data.get(), 0, data->size() / 2)));
+
+    std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(data);
+    std::unique_ptr<SkAndroidCodec> indexedCodec = SkAndroidCodec::MakeFromCodec(
+            SkPngDecoder::DecodeWithRowIndex(data, rowIndex, nullptr));
+    if (!codec || !indexedCodec) {
+        ERRORF(r, "Unable to create codec '%s'.", path);
+        return;
+    }
+
+    // Subsets that start above, at, and below the index's first access point, with and without
+    // sampling.
+    struct {
+        SkIRect fSubset;
+        int     fSampleSize;
+    } regions[] = {
+        { SkIRect::MakeXYWH(   0,    0, 512, 512), 1 },
+        { SkIRect::MakeXYWH( 400,  700, 512, 512), 1 },
+        { SkIRect::MakeXYWH(1088, 1088, 512, 512), 1 },
+        { SkIRect::MakeXYWH( 300,  500, 1024, 1024), 2 },
+        { SkIRect::MakeXYWH(   0,    0, 1600, 1600), 4 },
+    };
+    for (const auto& region : regions) {
+        SkAndroidCodec::AndroidOptions options;
+        options.fSubset = &region.fSubset;
+        options.fSampleSize = region.fSampleSize;
+        const SkISize size = codec->getSampledSubsetDimensions(region.fSampleSize,
+                                                               region.fSubset);
+        const SkImageInfo info = codec->getInfo().makeDimensions(size)
+                                                 .makeColorType(kN32_SkColorType);
+        SkBitmap expected, actual;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getAndroidPixels(
+                info, expected.getPixels(), expected.rowBytes(), &options));
+        REPORTER_ASSERT(r, SkCodec::kSuccess == indexedCodec->getAndroidPixels(
+                info, actual.getPixels(), actual.rowBytes(), &options));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual), "%d %d %d %d / %d",
+                        region.fSubset.x(), region.fSubset.y(), region.fSubset.width(),
+                        region.fSubset.height(), region.fSampleSize);
+    }
+
+    // The whole image, decoded in parallel from the index.
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    const SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType);
+    SkBitmap expected, actual;
+    expected.allocPixels(info);
+    actual.allocPixels(info);
+    SkCodec::Options options;
+    options.fExecutor = executor.get();
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->codec()->getPixels(expected.pixmap()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == indexedCodec->codec()->getPixels(actual.pixmap(),
+                                                                             &options));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+
+    // An index of another image is ignored.
+    sk_sp<SkData> otherIndex = SkPngDecoder::MakeRowIndex(GetResourceAsData("images/gamut.png"));
+    std::unique_ptr<SkCodec> mismatched =
+            SkPngDecoder::DecodeWithRowIndex(data, otherIndex, nullptr);
+    REPORTER_ASSERT(r, mismatched);
+    if (mismatched) {
+        actual.eraseColor(SK_ColorTRANSPARENT);
+        REPORTER_ASSERT(r, SkCodec::kSuccess == mismatched->getPixels(actual.pixmap(), &options));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+    }
+}
+
 static void check_color_xform(skiatest::Reporter* r, const char* path) {
     std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromStream(GetResourceAsStream(path)));
 
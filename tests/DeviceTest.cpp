@@ -6,10 +6,19 @@
  */
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkColorType.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypes.h"
 #include "include/gpu/GpuTypes.h"
@@ -23,6 +32,9 @@
 #include "src/gpu/ganesh/GrDirectContextPriv.h"
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <iterator>
 
 struct GrContextOptions;
 
@@ -138,3 +150,105 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(SpecialImage_GPUDevice,
     SkASSERT(2*kHeight == special->height());
     SkASSERT(SkIRect::MakeWH(2*kWidth, 2*kHeight) == special->subset());
 }
+
+// SkBitmapDevice shares one blitter across consecutive draws with the same solid-color paint.
+// That must stay invisible: a new paint, a nested draw with a different paint, or the surface's
+// pixels being swapped out by copy-on-write all need a different blitter.
+DEF_TEST(BitmapDevice_SharedBlitter, reporter) {
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(64, 64));
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SK_ColorWHITE);
+
+    SkPaint red, blue;
+    red.setColor(SK_ColorRED);
+    blue.setColor(SK_ColorBLUE);
+
+    canvas->drawRect(SkRect::MakeXYWH(0, 0, 8, 8), red);
+    canvas->drawRect(SkRect::MakeXYWH(8, 0, 8, 8), red);
+    canvas->drawOval(SkRect::MakeXYWH(16, 0, 8, 8), blue);
+    canvas->drawRect(SkRect::MakeXYWH(24, 0, 8, 8), red);
+
+    // Round points are drawn as paths with a paint derived from this one.
+    SkPaint thick = blue;
+    thick.setStrokeWidth(6);
+    thick.setStrokeCap(SkPaint::kRound_Cap);
+    const SkPoint pts[] = {{44, 4}, {56, 4}};
+    canvas->drawPoints(SkCanvas::kPoints_PointMode, std::size(pts), pts, thick);
+
+    sk_sp<SkImage> before = surface->makeImageSnapshot();
+    canvas->drawRect(SkRect::MakeXYWH(0, 16, 8, 8), red);
+
+    SkPixmap after, snapshot;
+    REPORTER_ASSERT(reporter, surface->peekPixels(&after));
+    REPORTER_ASSERT(reporter, before->peekPixels(&snapshot));
+
+    REPORTER_ASSERT(reporter, after.getColor(4, 4)   == SK_ColorRED);
+    REPORTER_ASSERT(reporter, after.getColor(12, 4)  == SK_ColorRED);
+    REPORTER_ASSERT(reporter, after.getColor(20, 4)  == SK_ColorBLUE);
+    REPORTER_ASSERT(reporter, after.getColor(28, 4)  == SK_ColorRED);
+    REPORTER_ASSERT(reporter, after.getColor(44, 4)  == SK_ColorBLUE);
+    REPORTER_ASSERT(reporter, after.getColor(56, 4)  == SK_ColorBLUE);
+    REPORTER_ASSERT(reporter, after.getColor(4, 20)  == SK_ColorRED);
+
+    REPORTER_ASSERT(reporter, snapshot.getColor(28, 4) == SK_ColorRED);
+    REPORTER_ASSERT(reporter, snapshot.getColor(4, 20) == SK_ColorWHITE);
+}
+
+// Draws whose paints differ only in color share one blitter, switched to each new color. That
+// must match what a newly built blitter draws, whichever kind of blitter SkBlitter::Choose()
+// picked for the destination, blend mode and color.
+DEF_TEST(BitmapDevice_SharedBlitterColors, reporter) {
+    const SkColor4f colors[] = {
+        SkColors::kRed,
+        SkColors::kBlue,
+        SkColors::kBlack,
+        SkColors::kWhite,
+        {0.2f, 0.6f, 0.3f, 0.5f},
+        {0.9f, 0.1f, 0.7f, 0.25f},
+        SkColors::kTransparent,
+        SkColors::kBlack,
+        {0.2f, 0.6f, 0.3f, 1.0f},
+        {1.25f, -0.25f, 0.5f, 1.0f},
+        {0.5f, 0.5f, 1.5f, 0.75f},
+        {0.4f, 0.8f, 0.1f, 1.0f},
+    };
+    const SkBlendMode modes[] = {
+        SkBlendMode::kSrcOver, SkBlendMode::kSrc, SkBlendMode::kMultiply, SkBlendMode::kClear,
+    };
+    const SkImageInfo infos[] = {
+        SkImageInfo::MakeN32Premul(48, 48),
+        SkImageInfo::MakeN32Premul(48, 48, SkColorSpace::MakeSRGB()),
+        SkImageInfo::MakeN32Premul(48, 48, SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB,
+                                                                 SkNamedGamut::kDisplayP3)),
+        SkImageInfo::Make(48, 48, kRGB_565_SkColorType, kOpaque_SkAlphaType),
+        SkImageInfo::Make(48, 48, kRGBA_F16_SkColorType, kPremul_SkAlphaType,
+                          SkColorSpace::MakeSRGBLinear()),
+    };
+
+    for (const SkImageInfo& info : infos) {
+        for (SkBlendMode mode : modes) {
+            for (bool aa : {false, true}) {
+                SkBitmap shared, unshared;
+                shared.allocPixels(info);
+                unshared.allocPixels(info);
+                shared.eraseColor(SK_ColorGRAY);
+                unshared.eraseColor(SK_ColorGRAY);
+
+                SkCanvas sharedCanvas(shared);
+                for (size_t i = 0; i < std::size(colors); ++i) {
+                    SkPaint paint;
+                    paint.setColor4f(colors[i]);
+                    paint.setBlendMode(mode);
+                    paint.setAntiAlias(aa);
+                    const SkRect r = SkRect::MakeXYWH(i * 3.25f, i * 2.5f, 10.5f, 8.75f);
+                    sharedCanvas.drawRect(r, paint);
+                    // A new canvas, and so a new device and blitter, for every draw.
+                    SkCanvas(unshared).drawRect(r, paint);
+                }
+                REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(shared, unshared),
+                                "color type %d, blend mode %s, aa %d", info.colorType(),
+                                SkBlendMode_Name(mode), aa);
+            }
+        }
+    }
+}
@@ -15,6 +15,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
@@ -343,6 +344,117 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngBands, r) {
+    SkBitmap bitmap;
+    bool success = GetResourceAsBitmap("images/mandrill_128.png", &bitmap);
+    if (!success) {
+        return;
+    }
+
+    SkPixmap src;
+    success = bitmap.peekPixels(&src);
+    REPORTER_ASSERT(r, success);
+    if (!success) {
+        return;
+    }
+
+    SkDynamicMemoryWStream whole, banded;
+    success = SkPngEncoder::Encode(&whole, src, {});
+    REPORTER_ASSERT(r, success);
+
+    // Copy each band of rows into a separate buffer, as if it had just been rendered.
+    constexpr int kBandHeight = 50;
+    SkBitmap band;
+    band.allocPixels(src.info().makeWH(src.width(), kBandHeight));
+    SkPixmap image(src.info(), band.getPixels(), band.rowBytes());
+    std::unique_ptr<SkEncoder> encoder = SkPngEncoder::Make(&banded, image, {});
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+    for (int top = 0; top < src.height(); top += kBandHeight) {
+        SkPixmap rows;
+        src.extractSubset(&rows, SkIRect::MakeXYWH(0, top, src.width(), kBandHeight));
+        band.writePixels(rows);
+        REPORTER_ASSERT(r, band.pixmap().extractSubset(
+                                   &rows, SkIRect::MakeWH(src.width(), rows.height())));
+        REPORTER_ASSERT(r, encoder->encodeRows(rows));
+    }
+
+    // Rows that don't match the image, or are past its end, are rejected.
+    REPORTER_ASSERT(r, !encoder->encodeRows(band.pixmap()));
+    SkDynamicMemoryWStream unused;
+    SkPixmap narrow;
+    band.pixmap().extractSubset(&narrow, SkIRect::MakeWH(src.width() / 2, 1));
+    REPORTER_ASSERT(r, !SkPngEncoder::Make(&unused, image, {})->encodeRows(narrow));
+
+    sk_sp<SkData> wholeData = whole.detachAsData();
+    sk_sp<SkData> bandedData = banded.detachAsData();
+    REPORTER_ASSERT(r, wholeData->equals(bandedData.get()));
+}
+
+DEF_TEST(Encode_PngParallel, r) {
+    SkBitmap mandrill;
+    if (!GetResourceAsBitmap("images/mandrill_128.png", &mandrill)) {
+        return;
+    }
+
+    // Tall enough to be written in more than one batch of strips.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(500, 3000);
+    SkCanvas canvas(bitmap);
+    canvas.clear(SK_ColorTRANSPARENT);
+    for (int y = 0; y < bitmap.height(); y += 100) {
+        for (int x = (y / 100) % 2 * 50; x < bitmap.width(); x += 150) {
+            canvas.drawImage(mandrill.asImage(), x, y);
+        }
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (auto filters : {SkPngEncoder::FilterFlag::kAll, SkPngEncoder::FilterFlag::kSub,
+                         SkPngEncoder::FilterFlag::kNone}) {
+        SkPngEncoder::Options options;
+        options.fFilterFlags = filters;
+        options.fZLibLevel = filters == SkPngEncoder::FilterFlag::kAll ? 6 : 1;
+        SkDynamicMemoryWStream serial, parallel, parallelBands;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, bitmap.pixmap(), options));
+
+        options.fExecutor = executor.get();
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, bitmap.pixmap(), options));
+
+        // Encoding rows in uneven bands goes through the same strips.
+        std::unique_ptr<SkEncoder> encoder =
+                SkPngEncoder::Make(&parallelBands, bitmap.pixmap(), options);
+        REPORTER_ASSERT(r, encoder);
+        if (!encoder) {
+            return;
+        }
+        for (int rows : {1, 999, 1, 1500}) {
+            REPORTER_ASSERT(r, encoder->encodeRows(rows));
+        }
+        REPORTER_ASSERT(r, encoder->encodeRows(bitmap.height()));
+
+        sk_sp<SkData> serialData = serial.detachAsData();
+        SkBitmap expected;
+        REPORTER_ASSERT(r, SkImages::DeferredFromEncodedData(serialData)->asLegacyBitmap(&expected));
+        for (sk_sp<SkData> data : {parallel.detachAsData(), parallelBands.detachAsData()}) {
+            // Each strip ends with a sync flush and starts with no history, which costs little.
+            REPORTER_ASSERT(r, data->size() < serialData->size() * 1.05);
+
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+            REPORTER_ASSERT(r, codec);
+            if (!codec) {
+                continue;
+            }
+            REPORTER_ASSERT(r, codec->getInfo().dimensions() == bitmap.dimensions());
+            SkBitmap decoded;
+            decoded.allocPixels(expected.info());
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(decoded.pixmap()));
+            REPORTER_ASSERT(r, almost_equals(decoded, expected, 0));
+        }
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
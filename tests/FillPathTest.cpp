@@ -8,6 +8,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkTypes.h"
@@ -15,7 +16,11 @@
 #include "src/core/SkScan.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
 
 struct FakeBlitter : public SkBlitter {
     FakeBlitter()
@@ -52,3 +57,161 @@ DEF_TEST(FillPathInverse, reporter) {
 
     REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
+
+class SkScanTestPeer {
+public:
+    static void DAAFillPath(const SkPath& path, SkBlitter* blitter, const SkIRect& clip,
+                            bool forceRLE) {
+        SkScan::DAAFillPath(path, blitter, path.getBounds().roundOut(), clip, forceRLE);
+    }
+};
+
+// Records the coverage a scan converter blits into an A8 buffer, dropping anything outside it.
+struct CoverageBlitter : public SkBlitter {
+    CoverageBlitter(int width, int height)
+        : fWidth(width), fHeight(height), fCoverage(width * height, 0) {}
+
+    void blitH(int x, int y, int width) override {
+        for (int i = 0; i < width; ++i) {
+            this->set(x + i, y, 0xFF);
+        }
+    }
+
+    void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]) override {
+        for (int n; (n = *runs) > 0; runs += n, antialias += n) {
+            for (int i = 0; i < n; ++i, ++x) {
+                this->set(x, y, *antialias);
+            }
+        }
+    }
+
+    void set(int x, int y, SkAlpha alpha) {
+        if (0 <= x && x < fWidth && 0 <= y && y < fHeight) {
+            fCoverage[y * fWidth + x] = alpha;
+        }
+    }
+
+    int fWidth, fHeight;
+    std::vector<uint8_t> fCoverage;
+};
+
+// Computes coverage of path to within about one level: curves are split into many short lines,
+// and each row is sampled on 256 horizontal lines, along which the spans inside the path are
+// accumulated exactly.
+static std::vector<uint8_t> reference_coverage(const SkPath& path, int width, int height) {
+    struct Line { SkPoint p0, p1; };
+    std::vector<Line> lines;
+    SkPath::Iter iter(path, /*forceClose=*/true);
+    SkPoint pts[4];
+    for (SkPath::Verb verb; (verb = iter.next(pts)) != SkPath::kDone_Verb;) {
+        constexpr int kSteps = 1024;
+        switch (verb) {
+            case SkPath::kLine_Verb: lines.push_back({pts[0], pts[1]}); break;
+            case SkPath::kQuad_Verb:
+            case SkPath::kConic_Verb:
+            case SkPath::kCubic_Verb: {
+                SkPoint prev = pts[0];
+                for (int i = 1; i <= kSteps; ++i) {
+                    float t = (float)i / kSteps, u = 1 - t;
+                    SkPoint next;
+                    if (verb == SkPath::kCubic_Verb) {
+                        next = pts[0] * (u*u*u) + pts[1] * (3*u*u*t) + pts[2] * (3*u*t*t) +
+                               pts[3] * (t*t*t);
+                    } else {
+                        float w = verb == SkPath::kConic_Verb ? iter.conicWeight() : 1;
+                        float d = u*u + 2*w*u*t + t*t;
+                        next = (pts[0] * (u*u) + pts[1] * (2*w*u*t) + pts[2] * (t*t)) * (1 / d);
+                    }
+                    lines.push_back({prev, next});
+                    prev = next;
+                }
+                break;
+            }
+            default: break;
+        }
+    }
+
+    constexpr int kRows = 256;
+    std::vector<float> coverage(width * height, 0);
+    std::vector<std::pair<float, int>> crossings;
+    for (int y = 0; y < height; ++y) {
+        for (int j = 0; j < kRows; ++j) {
+            const float sy = y + (j + 0.5f) / kRows;
+            crossings.clear();
+            for (const Line& l : lines) {
+                if ((l.p0.fY <= sy) != (l.p1.fY <= sy)) {
+                    float x = l.p0.fX + (sy - l.p0.fY) * (l.p1.fX - l.p0.fX) / (l.p1.fY - l.p0.fY);
+                    crossings.push_back({x, l.p1.fY > l.p0.fY ? 1 : -1});
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+            int winding = 0;
+            for (size_t i = 0; i + 1 < crossings.size(); ++i) {
+                winding += crossings[i].second;
+                const bool inside = path.getFillType() == SkPathFillType::kEvenOdd ? (winding & 1)
+                                                                                  : winding != 0;
+                if (!inside) {
+                    continue;
+                }
+                // Add the span [x0, x1) to this row, clipped to [0, width).
+                const float x0 = std::max(crossings[i].first, 0.f),
+                            x1 = std::min(crossings[i + 1].first, (float)width);
+                for (int x = (int)x0; x < x1; ++x) {
+                    coverage[y * width + x] += (std::min(x1, x + 1.f) - std::max(x0, (float)x)) /
+                                               kRows;
+                }
+            }
+        }
+    }
+    std::vector<uint8_t> a8(width * height);
+    for (int i = 0; i < width * height; ++i) {
+        a8[i] = (uint8_t)std::min(255.f, coverage[i] * 255 + 0.5f);
+    }
+    return a8;
+}
+
+// The delta accumulation scan converter should match the coverage of the path, both blitting masks
+// and producing runs. Paths of lines should come out within rounding; curves are flattened to
+// within 1/16 pixel, which can move up to about 1/16 of a pixel's coverage along them.
+DEF_TEST(FillPathDeltaAA, reporter) {
+    const int width = 200, height = 150;
+    const SkIRect bounds = SkIRect::MakeWH(width, height);
+
+    SkPath paths[4];
+    paths[0].addCircle(90, 70, 55.5f);
+    paths[1].addRoundRect({-20, 10.5f, 230, 140.25f}, 30, 30);
+    paths[2].addRect({10.25f, 10.75f, 180.5f, 130.5f});
+    paths[2].addRect({50, 40, 120, 90});
+    paths[2].setFillType(SkPathFillType::kEvenOdd);
+    paths[3].moveTo(20, 140);
+    paths[3].cubicTo(40, -20, 160, -20, 180, 140);
+    paths[3].quadTo(100, 100, 20, 140);
+
+    for (const SkPath& path : paths) {
+        const std::vector<uint8_t> expected = reference_coverage(path, width, height);
+        const bool curved = path.getSegmentMasks() != SkPath::kLine_SegmentMask;
+        const int maxTolerance = curved ? 20 : 1;
+        const double meanTolerance = curved ? 8 : 0.5;
+
+        for (bool forceRLE : {false, true}) {
+            CoverageBlitter actual(width, height);
+            SkScanTestPeer::DAAFillPath(path, &actual, bounds, forceRLE);
+
+            int maxDiff = 0,
+                sumDiff = 0,
+                edgePixels = 0;
+            for (int i = 0; i < width * height; ++i) {
+                const int e = expected[i],
+                          a = actual.fCoverage[i];
+                const int diff = std::abs(e - a);
+                maxDiff = std::max(maxDiff, diff);
+                sumDiff += diff;
+                // Only pixels partially covered by either can differ.
+                edgePixels += (e != 0 && e != 0xFF) || (a != 0 && a != 0xFF);
+            }
+            REPORTER_ASSERT(reporter, maxDiff <= maxTolerance, "max diff %d", maxDiff);
+            REPORTER_ASSERT(reporter, sumDiff <= meanTolerance * edgePixels,
+                            "mean diff %g", (double)sumDiff / edgePixels);
+        }
+    }
+}
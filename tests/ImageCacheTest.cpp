@@ -5,15 +5,19 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkTypes.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
 #include <cstddef>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 
 namespace {
 static void* gGlobalAddress;
@@ -45,6 +49,9 @@ struct TestingRec : public SkResourceCache::Rec {
 };
 }  // namespace
 
+// TestingRec::bytesUsed()
+static constexpr size_t kRecBytes = sizeof(TestingKey) + sizeof(intptr_t);
+
 static const int COUNT = 10;
 static const int DIM = 256;
 
@@ -154,3 +161,48 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+DEF_TEST(ImageCache_LRUAcrossShards, r) {
+    static constexpr int kCount = 64;
+    SkResourceCache cache(kCount * kRecBytes);
+    for (int i = 0; i < kCount - 1; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+    }
+
+    // Finding 0 makes 1 the least recently used rec, whichever shard it is in.
+    intptr_t value = -1;
+    REPORTER_ASSERT(r, cache.find(TestingKey(0), TestingRec::Visitor, &value));
+    cache.add(new TestingRec(TestingKey(kCount), kCount));
+    REPORTER_ASSERT(r, cache.find(TestingKey(0), TestingRec::Visitor, &value));
+    REPORTER_ASSERT(r, !cache.find(TestingKey(1), TestingRec::Visitor, &value));
+    REPORTER_ASSERT(r, cache.find(TestingKey(2), TestingRec::Visitor, &value));
+}
+
+DEF_TEST(ImageCache_Threaded, r) {
+    static constexpr int kKeys = 1000;
+    static constexpr size_t kLimit = kKeys / 2 * kRecBytes;
+    std::unique_ptr<SkExecutor> purgeExecutor =
+            SkExecutor::MakeFIFOThreadPool(1, /*allowBorrowing=*/false);
+    SkResourceCache cache(kLimit);
+    cache.setPurgeExecutor(purgeExecutor.get());
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    std::atomic<int> mismatches{0};
+    SkTaskGroup(*executor).batch(8, [&](int task) {
+        for (int i = 0; i < 5000; ++i) {
+            const intptr_t k = (i * (2 * task + 1)) % kKeys;
+            intptr_t value = -1;
+            if (cache.find(TestingKey(k), TestingRec::Visitor, &value)) {
+                mismatches += value != k;
+            } else {
+                cache.add(new TestingRec(TestingKey(k), k));
+            }
+        }
+    });
+    REPORTER_ASSERT(r, mismatches == 0);
+    // Adds purge inline once the background purge falls this far behind.
+    REPORTER_ASSERT(r, cache.getTotalBytesUsed() < 2 * kLimit);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(r, cache.getTotalBytesUsed() == 0);
+}
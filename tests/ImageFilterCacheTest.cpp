@@ -19,7 +19,11 @@
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkShader.h"
 #include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTileMode.h"
 #include "include/core/SkTypes.h"
 #include "include/effects/SkImageFilters.h"
 #include "include/gpu/GrBackendSurface.h"
@@ -30,6 +34,7 @@
 #include "include/private/gpu/ganesh/GrTypesPriv.h"
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilterTypes.h"
+#include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/gpu/ganesh/GrColorInfo.h" // IWYU pragma: keep
 #include "src/gpu/ganesh/GrDirectContextPriv.h"
@@ -40,6 +45,7 @@
 #include "src/gpu/ganesh/image/SkSpecialImage_Ganesh.h"
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <cstddef>
 #include <tuple>
@@ -146,6 +152,58 @@ static void test_internal_purge(skiatest::Reporter* reporter, const sk_sp<SkSpec
     REPORTER_ASSERT(reporter, !cache->get(key1, &foundImage));
 }
 
+// A result cached for larger clip bounds satisfies requests for bounds it covers, and replaces
+// cached results for the bounds it covers.
+static void test_find_covering(skiatest::Reporter* reporter, const sk_sp<SkSpecialImage>& image) {
+    static const size_t kCacheSize = 1000000;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kCacheSize));
+
+    SkImageFilterCacheKey small(0, SkMatrix::I(), SkIRect::MakeXYWH(10, 10, 50, 50),
+                                image->uniqueID(), image->subset());
+    SkImageFilterCacheKey large(0, SkMatrix::I(), SkIRect::MakeWH(100, 100),
+                                image->uniqueID(), image->subset());
+    SkImageFilterCacheKey other(0, SkMatrix::I(), SkIRect::MakeXYWH(50, 50, 100, 100),
+                                image->uniqueID(), image->subset());
+
+    auto filter = make_filter();
+    cache->set(small, filter.get(), skif::FilterResult(image));
+    SkDEBUGCODE(REPORTER_ASSERT(reporter, 1 == cache->count());)
+
+    skif::FilterResult foundImage;
+    REPORTER_ASSERT(reporter, !cache->get(large, &foundImage));
+    cache->set(large, filter.get(), skif::FilterResult(image));
+    SkDEBUGCODE(REPORTER_ASSERT(reporter, 1 == cache->count());)
+
+    REPORTER_ASSERT(reporter, cache->get(small, &foundImage));
+    REPORTER_ASSERT(reporter, image->uniqueID() == foundImage.image()->uniqueID());
+    REPORTER_ASSERT(reporter, !cache->get(other, &foundImage));
+}
+
+// Test that a result that is more expensive to recompute outlives a cheaper one
+static void test_cost_weighted_purge(skiatest::Reporter* reporter,
+                                     const sk_sp<SkSpecialImage>& image) {
+    SkASSERT(image->getSize());
+    const size_t kCacheSize = 2 * image->getSize() + 10;
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(kCacheSize));
+
+    SkIRect clip = SkIRect::MakeWH(100, 100);
+    SkImageFilterCacheKey key1(0, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+    SkImageFilterCacheKey key2(1, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+    SkImageFilterCacheKey key3(2, SkMatrix::I(), clip, image->uniqueID(), image->subset());
+
+    auto filter = make_filter();
+    cache->set(key1, filter.get(), skif::FilterResult(image), /*recomputeCost=*/1e6);
+    cache->set(key2, filter.get(), skif::FilterResult(image), /*recomputeCost=*/1);
+
+    // key1 is the least recently used, but key2 is cheaper to recompute.
+    cache->set(key3, filter.get(), skif::FilterResult(image), /*recomputeCost=*/1);
+
+    skif::FilterResult foundImage;
+    REPORTER_ASSERT(reporter, cache->get(key1, &foundImage));
+    REPORTER_ASSERT(reporter, !cache->get(key2, &foundImage));
+    REPORTER_ASSERT(reporter, cache->get(key3, &foundImage));
+}
+
 // Exercise the purgeByKey and purge methods
 static void test_explicit_purging(skiatest::Reporter* reporter,
                                   const sk_sp<SkSpecialImage>& image,
@@ -198,6 +256,8 @@ DEF_TEST(ImageFilterCache_RasterBacked, reporter) {
     test_find_existing(reporter, fullImg, subsetImg);
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
+    test_find_covering(reporter, fullImg);
+    test_cost_weighted_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
 }
 
@@ -227,9 +287,150 @@ static void test_image_backed(skiatest::Reporter* reporter,
     test_find_existing(reporter, fullImg, subsetImg);
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
+    test_find_covering(reporter, fullImg);
+    test_cost_weighted_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
 }
 
+// Forwards to a real cache, counting the lookups that hit.
+class CountingImageFilterCache : public SkImageFilterCache {
+public:
+    CountingImageFilterCache() : fCache(SkImageFilterCache::Create(1000000)) {}
+
+    bool get(const SkImageFilterCacheKey& key, skif::FilterResult* result) const override {
+        bool hit = fCache->get(key, result);
+        fHits += hit ? 1 : 0;
+        return hit;
+    }
+    void set(const SkImageFilterCacheKey& key, const SkImageFilter* filter,
+             const skif::FilterResult& result, double recomputeCost) override {
+        fCache->set(key, filter, result, recomputeCost);
+    }
+    void purge() override { fCache->purge(); }
+    void purgeByImageFilter(const SkImageFilter* filter) override {
+        fCache->purgeByImageFilter(filter);
+    }
+    SkDEBUGCODE(int count() const override { return fCache->count(); })
+
+    int hits() const { return fHits; }
+
+private:
+    sk_sp<SkImageFilterCache> fCache;
+    mutable int fHits = 0;
+};
+
+// Evaluates 'filter' with the given layer matrix and desired output, returning the output pixels
+// and their layer-space bounds.
+static bool filter_with_layer_matrix(SkImageFilter* filter,
+                                     const SkMatrix& layerMatrix,
+                                     const SkIRect& desiredOutput,
+                                     const sk_sp<SkSpecialImage>& source,
+                                     SkImageFilterCache* cache,
+                                     SkBitmap* pixels,
+                                     SkIRect* bounds) {
+    skif::ContextInfo ctxInfo = {skif::Mapping(layerMatrix),
+                                 skif::LayerSpace<SkIRect>(desiredOutput),
+                                 skif::FilterResult(source),
+                                 source->colorType(),
+                                 source->getColorSpace(),
+                                 source->props(),
+                                 cache,
+                                 /*executor=*/nullptr};
+    skif::Context ctx = skif::Context::MakeRaster(ctxInfo);
+
+    SkIPoint offset;
+    sk_sp<SkSpecialImage> result =
+            as_IFB(filter)->filterImage(ctx).imageAndOffset(ctx, &offset);
+    if (!result || !result->getROPixels(pixels)) {
+        return false;
+    }
+    *bounds = SkIRect::MakeXYWH(offset.fX, offset.fY, result->width(), result->height());
+    return true;
+}
+
+// A filter that doesn't read its source reuses its cached result when the layer matrix moves by
+// whole pixels, and that result matches evaluating the filter at the new position. A fractional
+// move, or a filter that reads its source, must not hit.
+DEF_TEST(ImageFilterCache_IntegerTranslationReuse, reporter) {
+    SkBitmap srcBM = create_bm();
+    sk_sp<SkSpecialImage> source = SkSpecialImages::MakeFromRaster(
+            SkIRect::MakeWH(kFullSize, kFullSize), srcBM, SkSurfaceProps());
+
+    // A nearest-sampled pattern, so each output pixel depends on its position.
+    SkBitmap patternBM;
+    patternBM.allocN32Pixels(3, 2);
+    patternBM.eraseColor(SK_ColorRED);
+    patternBM.erase(SK_ColorGREEN, SkIRect::MakeWH(1, 2));
+    patternBM.erase(SK_ColorBLUE, SkIRect::MakeXYWH(2, 1, 1, 1));
+    sk_sp<SkImageFilter> shaderFilter = SkImageFilters::Shader(
+            patternBM.asImage()->makeShader(SkTileMode::kRepeat, SkTileMode::kRepeat,
+                                            SkSamplingOptions()));
+    REPORTER_ASSERT(reporter, !as_IFB(shaderFilter)->usesSource());
+
+    const SkMatrix layerMatrix = SkMatrix::Scale(2, 2).postTranslate(3.25f, 1.5f);
+    const SkIRect desiredOutput = SkIRect::MakeLTRB(2, 3, 30, 20);
+    const SkIVector shift = {7, -4};
+    const SkMatrix shiftedMatrix =
+            SkMatrix(layerMatrix).postTranslate(SkIntToScalar(shift.fX), SkIntToScalar(shift.fY));
+    const SkIRect shiftedOutput = desiredOutput.makeOffset(shift);
+
+    SkBitmap first, cached, expected;
+    SkIRect firstBounds, cachedBounds, expectedBounds;
+    {
+        sk_sp<CountingImageFilterCache> cache = sk_make_sp<CountingImageFilterCache>();
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(shaderFilter.get(), layerMatrix,
+                                                           desiredOutput, source, cache.get(),
+                                                           &first, &firstBounds));
+        REPORTER_ASSERT(reporter, cache->hits() == 0);
+
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(shaderFilter.get(), shiftedMatrix,
+                                                           shiftedOutput, source, cache.get(),
+                                                           &cached, &cachedBounds));
+        REPORTER_ASSERT(reporter, cache->hits() == 1);
+        REPORTER_ASSERT(reporter, cachedBounds == firstBounds.makeOffset(shift));
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(first, cached));
+
+        // Evaluated from scratch, the shifted layer matrix produces the same pixels.
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(shaderFilter.get(), shiftedMatrix,
+                                                           shiftedOutput, source, nullptr,
+                                                           &expected, &expectedBounds));
+        REPORTER_ASSERT(reporter, cachedBounds == expectedBounds);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected, cached));
+
+        // A half pixel move changes what is sampled, so it can't reuse the result.
+        SkBitmap fractional;
+        SkIRect fractionalBounds;
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(
+                shaderFilter.get(), SkMatrix(layerMatrix).postTranslate(0.5f, 0),
+                desiredOutput, source, cache.get(), &fractional, &fractionalBounds));
+        REPORTER_ASSERT(reporter, cache->hits() == 1);
+    }
+
+    {
+        // The source isn't shifted with the layer matrix, so a filter that reads it can't reuse
+        // results across whole-pixel moves either.
+        sk_sp<SkImageFilter> sourceFilter = make_filter();
+        REPORTER_ASSERT(reporter, as_IFB(sourceFilter)->usesSource());
+
+        sk_sp<CountingImageFilterCache> cache = sk_make_sp<CountingImageFilterCache>();
+        SkBitmap pixels;
+        SkIRect bounds;
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(sourceFilter.get(), layerMatrix,
+                                                           desiredOutput, source, cache.get(),
+                                                           &pixels, &bounds));
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(sourceFilter.get(), shiftedMatrix,
+                                                           shiftedOutput, source, cache.get(),
+                                                           &pixels, &bounds));
+        REPORTER_ASSERT(reporter, cache->hits() == 0);
+
+        // The same layer matrix still hits, so the cache is in use.
+        REPORTER_ASSERT(reporter, filter_with_layer_matrix(sourceFilter.get(), layerMatrix,
+                                                           desiredOutput, source, cache.get(),
+                                                           &pixels, &bounds));
+        REPORTER_ASSERT(reporter, cache->hits() == 1);
+    }
+}
+
 DEF_TEST(ImageFilterCache_ImageBackedRaster, reporter) {
     SkBitmap srcBM = create_bm();
 
@@ -326,5 +527,7 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(ImageFilterCache_GPUBacked,
     test_find_existing(reporter, fullImg, subsetImg);
     test_dont_find_if_diff_key(reporter, fullImg, subsetImg);
     test_internal_purge(reporter, fullImg);
+    test_find_covering(reporter, fullImg);
+    test_cost_weighted_purge(reporter, fullImg);
     test_explicit_purging(reporter, fullImg, subsetImg);
 }
@@ -12,8 +12,10 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
+#include "include/core/SkColorPriv.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
@@ -45,6 +47,7 @@
 #include "include/gpu/ganesh/SkSurfaceGanesh.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTo.h"
+#include "src/base/SkRandom.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkRectPriv.h"
@@ -65,6 +68,7 @@
 #include <cstring>
 #include <utility>
 #include <limits>
+#include <memory>
 
 using namespace skia_private;
 
@@ -757,6 +761,93 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(MorphologyFilterRadiusWithMirrorCTM_Gpu,
     test_morphology_radius_with_mirror_ctm(reporter, ctxInfo.directContext());
 }
 
+// The CPU morphology must select the same values as a direct min or max over the kernel, with
+// transparent black outside of the source image. 'srcBM' is N32, and is filtered as a layer of
+// 'colorType'.
+static void test_morphology_matches_reference(skiatest::Reporter* reporter, const SkBitmap& srcBM,
+                                              SkColorType colorType) {
+    SkBitmap layerBM;
+    if (!layerBM.tryAllocPixels(srcBM.info().makeColorType(colorType)) ||
+        !srcBM.readPixels(layerBM.pixmap())) {
+        ERRORF(reporter, "could not make a %s layer", ToolUtils::colortype_name(colorType));
+        return;
+    }
+    sk_sp<SkSpecialImage> src = SkSpecialImages::MakeFromRaster(
+            SkIRect::MakeWH(layerBM.width(), layerBM.height()), layerBM, SkSurfaceProps());
+
+    const SkIRect desiredOutput = SkIRect::MakeLTRB(-10, 3, 45, 40);
+    const SkISize radii[] = {{3, 7}, {20, 1}, {0, 5}, {40, 40}};
+    for (bool dilate : {false, true}) {
+        for (SkISize r : radii) {
+            sk_sp<SkImageFilter> filter =
+                    dilate ? SkImageFilters::Dilate(r.width(), r.height(), nullptr)
+                           : SkImageFilters::Erode(r.width(), r.height(), nullptr);
+            skif::Context ctx = make_context(desiredOutput, src.get());
+            SkIPoint offset;
+            sk_sp<SkSpecialImage> result =
+                    as_IFB(filter)->filterImage(ctx).imageAndOffset(ctx, &offset);
+            SkBitmap resultBM;
+            if (result) {
+                REPORTER_ASSERT(reporter, special_image_to_bitmap(nullptr, result.get(),
+                                                                  &resultBM));
+            }
+
+            for (int y = desiredOutput.fTop; y < desiredOutput.fBottom; ++y) {
+                for (int x = desiredOutput.fLeft; x < desiredOutput.fRight; ++x) {
+                    uint8_t expected[4];
+                    memset(expected, dilate ? 0 : 0xFF, sizeof(expected));
+                    for (int ky = y - r.height(); ky <= y + r.height(); ++ky) {
+                        for (int kx = x - r.width(); kx <= x + r.width(); ++kx) {
+                            SkPMColor c = 0;
+                            if (kx >= 0 && ky >= 0 && kx < srcBM.width() && ky < srcBM.height()) {
+                                c = *srcBM.getAddr32(kx, ky);
+                            }
+                            for (int i = 0; i < 4; ++i) {
+                                uint8_t v = (c >> (8 * i)) & 0xFF;
+                                expected[i] = dilate ? std::max(expected[i], v)
+                                                     : std::min(expected[i], v);
+                            }
+                        }
+                    }
+                    SkPMColor expectedColor;
+                    memcpy(&expectedColor, expected, sizeof(expectedColor));
+
+                    SkPMColor actual = 0;
+                    if (result && SkIRect::MakeXYWH(offset.fX, offset.fY, resultBM.width(),
+                                                    resultBM.height()).contains(x, y)) {
+                        actual = *resultBM.getAddr32(x - offset.fX, y - offset.fY);
+                    }
+                    if (actual != expectedColor) {
+                        ERRORF(reporter, "%s %s %dx%d at (%d, %d): expected %08x, got %08x",
+                               ToolUtils::colortype_name(colorType),
+                               dilate ? "dilate" : "erode", r.width(), r.height(), x, y,
+                               expectedColor, actual);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(MorphologyFilterMatchesReference, reporter) {
+    SkBitmap srcBM;
+    srcBM.allocN32Pixels(37, 29);
+    SkRandom random;
+    for (int y = 0; y < srcBM.height(); ++y) {
+        for (int x = 0; x < srcBM.width(); ++x) {
+            SkColor color = random.nextU();
+            *srcBM.getAddr32(x, y) = SkPreMultiplyColor(color);
+        }
+    }
+
+    // Both byte orders run the raster kernel. F16 layers fall back to the shaders, and every 8-bit
+    // value survives the round trip through F16 exactly.
+    test_morphology_matches_reference(reporter, srcBM, kRGBA_8888_SkColorType);
+    test_morphology_matches_reference(reporter, srcBM, kBGRA_8888_SkColorType);
+    test_morphology_matches_reference(reporter, srcBM, kRGBA_F16_SkColorType);
+}
+
 static void test_zero_blur_sigma(skiatest::Reporter* reporter, GrDirectContext* dContext) {
     // Check that SkBlurImageFilter with a zero sigma and a non-zero srcOffset works correctly.
     SkIRect cropRect = SkIRect::MakeXYWH(5, 0, 5, 10);
@@ -1125,6 +1216,55 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(ImageFilterMergeResultSize_Gpu,
     test_imagefilter_merge_result_size(reporter, ctxInfo.directContext());
 }
 
+static sk_sp<SkImageFilter> make_merged_branches(const sk_sp<SkImage>& image) {
+    sk_sp<SkImageFilter> source = SkImageFilters::Image(image, SkFilterMode::kNearest);
+    sk_sp<SkImageFilter> blur = SkImageFilters::Blur(3, 3, source);
+    sk_sp<SkImageFilter> branches[] = {
+        blur,
+        SkImageFilters::ColorFilter(
+                SkColorFilters::Blend(SK_ColorRED, SkBlendMode::kSrcIn),
+                SkImageFilters::Blur(6, 1, source)),
+        SkImageFilters::Offset(30, 0, source),
+        // Outside of the desired output, so it never needs to be evaluated
+        SkImageFilters::Offset(200, 200, blur),
+        blur,
+        nullptr,
+    };
+    return SkImageFilters::Merge(branches, std::size(branches));
+}
+
+// Merge branches evaluated in parallel should produce exactly what serial evaluation does.
+DEF_TEST(ImageFilterMergeBranchesThreaded, reporter) {
+    sk_sp<SkImage> image = make_small_image();
+    sk_sp<SkSpecialImage> srcImg(create_empty_special_image(nullptr, 100));
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkBitmap results[2];
+    SkIPoint offsets[2];
+    for (int threaded = 0; threaded < 2; ++threaded) {
+        skif::ContextInfo ctxInfo = {skif::Mapping(SkMatrix::I()),
+                                     skif::LayerSpace<SkIRect>(SkIRect::MakeLTRB(5, 5, 70, 40)),
+                                     skif::FilterResult(srcImg),
+                                     srcImg->colorType(),
+                                     srcImg->getColorSpace(),
+                                     srcImg->props(),
+                                     /*cache=*/nullptr,
+                                     threaded ? executor.get() : nullptr};
+        skif::Context ctx = skif::Context::MakeRaster(ctxInfo);
+        // Without an executor of its own, the serial leg must not pick one up.
+        REPORTER_ASSERT(reporter, ctx.executor() == (threaded ? executor.get() : nullptr));
+
+        // Make the filters again, so that the two evaluations are independent.
+        sk_sp<SkImageFilter> merge = make_merged_branches(image);
+        sk_sp<SkSpecialImage> result =
+                as_IFB(merge)->filterImage(ctx).imageAndOffset(ctx, &offsets[threaded]);
+        REPORTER_ASSERT(reporter, result && result->getROPixels(&results[threaded]));
+    }
+
+    REPORTER_ASSERT(reporter, offsets[0] == offsets[1]);
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(results[0], results[1]));
+}
+
 static void draw_blurred_rect(SkCanvas* canvas) {
     SkPaint filterPaint;
     filterPaint.setColor(SK_ColorWHITE);
@@ -1285,6 +1425,84 @@ DEF_GANESH_TEST_FOR_RENDERING_CONTEXTS(ImageFilterMatrixConvolutionBigKernel_Gpu
     test_big_kernel(reporter, ctxInfo.directContext());
 }
 
+// Filters evaluated with an executor may shade their output in bands of rows. That must produce
+// exactly what a single draw does, including under layer matrices and input transforms that aren't
+// integer translations.
+DEF_TEST(ImageFilterBandedShadingMatchesSingleDraw, reporter) {
+    SkBitmap srcBM;
+    srcBM.allocN32Pixels(300, 300);
+    SkRandom random;
+    for (int y = 0; y < srcBM.height(); ++y) {
+        for (int x = 0; x < srcBM.width(); ++x) {
+            *srcBM.getAddr32(x, y) = SkPreMultiplyColor(random.nextU());
+        }
+    }
+    srcBM.setImmutable();
+    sk_sp<SkImage> image = srcBM.asImage();
+    sk_sp<SkSpecialImage> srcImg = SkSpecialImages::MakeFromRaster(
+            SkIRect::MakeWH(srcBM.width(), srcBM.height()), srcBM, SkSurfaceProps());
+
+    // Draws the image scaled and at a fractional offset, so its FilterResult transform isn't an
+    // integer translation either. The second one is sampled at exactly its texel edges.
+    sk_sp<SkImageFilter> scaledImage = SkImageFilters::Image(
+            image, SkRect::MakeWH(300, 300), SkRect::MakeXYWH(0.25f, 0.5f, 375, 345),
+            SkSamplingOptions(SkFilterMode::kLinear));
+    sk_sp<SkImageFilter> shrunkImage = SkImageFilters::Image(
+            image, SkRect::MakeWH(300, 300), SkRect::MakeXYWH(0.5f, 0.5f, 100, 100),
+            SkSamplingOptions());
+    const SkScalar kernel[9] = {1, 2, 1,
+                                2, -11, 2,
+                                1, 2, 1};
+    sk_sp<SkImageFilter> filters[] = {
+        SkImageFilters::MatrixConvolution({3, 3}, kernel, 0.3f, 0.1f, {1, 1},
+                                          SkTileMode::kClamp, true, nullptr),
+        SkImageFilters::MatrixConvolution({3, 3}, kernel, 0.3f, 0.1f, {1, 1},
+                                          SkTileMode::kClamp, true, scaledImage),
+        SkImageFilters::MatrixConvolution({3, 3}, kernel, 0.3f, 0.1f, {1, 1},
+                                          SkTileMode::kClamp, true, shrunkImage),
+        SkImageFilters::PointLitDiffuse(SkPoint3::Make(30, 40, 20), SK_ColorWHITE, 1.5f, 0.75f, nullptr),
+        SkImageFilters::DisplacementMap(SkColorChannel::kR, SkColorChannel::kG, 12.5f,
+                                        scaledImage, nullptr),
+    };
+    const SkMatrix layerMatrices[] = {
+        SkMatrix::I(),
+        SkMatrix::Translate(3, -5),
+        SkMatrix::Translate(0.25f, 0.75f),
+        SkMatrix::Scale(1.5f, 1.25f),
+        SkMatrix::Scale(0.75f, 1.5f).postTranslate(-2.5f, 0.3f),
+        SkMatrix::Scale(1 / 3.f, 1 / 3.f).postTranslate(0.5f, 0.5f),
+    };
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const SkMatrix& layerMatrix : layerMatrices) {
+        for (size_t i = 0; i < std::size(filters); ++i) {
+            SkBitmap results[2];
+            SkIPoint offsets[2];
+            for (int banded = 0; banded < 2; ++banded) {
+                skif::ContextInfo ctxInfo = {skif::Mapping(layerMatrix),
+                                             skif::LayerSpace<SkIRect>(
+                                                     SkIRect::MakeLTRB(-7, 4, 280, 290)),
+                                             skif::FilterResult(srcImg),
+                                             srcImg->colorType(),
+                                             srcImg->getColorSpace(),
+                                             srcImg->props(),
+                                             /*cache=*/nullptr,
+                                             banded ? executor.get() : nullptr};
+                skif::Context ctx = skif::Context::MakeRaster(ctxInfo);
+                sk_sp<SkSpecialImage> result = as_IFB(filters[i])->filterImage(ctx)
+                                                                  .imageAndOffset(ctx,
+                                                                                  &offsets[banded]);
+                REPORTER_ASSERT(reporter, result && result->getROPixels(&results[banded]));
+            }
+            REPORTER_ASSERT(reporter, offsets[0] == offsets[1], "filter %zu", i);
+            REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(results[0], results[1]),
+                            "filter %zu, layer matrix [%g %g %g; %g %g %g]", i,
+                            layerMatrix[0], layerMatrix[1], layerMatrix[2],
+                            layerMatrix[3], layerMatrix[4], layerMatrix[5]);
+        }
+    }
+}
+
 DEF_TEST(ImageFilterCropRect, reporter) {
     test_cropRects(reporter, nullptr);
 }
@@ -10,6 +10,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
@@ -21,12 +22,15 @@
 #include "include/core/SkSurface.h"
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkMalloc.h"
+#include "src/base/SkHalf.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkMipmapBuilder.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
+#include <cstring>
+
 static void make_bitmap(SkBitmap* bm, int width, int height) {
     bm->allocN32Pixels(width, height);
     bm->eraseColor(SK_ColorWHITE);
@@ -278,3 +282,79 @@ DEF_TEST(image_mip_mismatch, reporter) {
     SkASSERT(img->imageInfo().alphaType() != kUnpremul_SkAlphaType);
     check_fails(img, img->imageInfo().makeAlphaType(kUnpremul_SkAlphaType));
 }
+
+// The 8888, A8 and F16 2x2 filters are vectorized, and big levels can be split across threads.
+// Check both against the plain definition of the filter, and against each other.
+DEF_TEST(MipMap_Downsample2x2, reporter) {
+    constexpr int kW = 1026, kH = 512;  // 1026 leaves a tail after every vector width we use.
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (SkColorType ct : {kRGBA_8888_SkColorType, kAlpha_8_SkColorType, kRGBA_F16_SkColorType}) {
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::Make(kW, kH, ct, kPremul_SkAlphaType));
+        SkRandom rand;
+        for (int y = 0; y < kH; ++y) {
+            for (int x = 0; x < kW; ++x) {
+                switch (ct) {
+                    case kRGBA_8888_SkColorType: *bm.getAddr32(x, y) = rand.nextU(); break;
+                    case kAlpha_8_SkColorType:   *bm.getAddr8 (x, y) = rand.nextU(); break;
+                    default: {
+                        skvx::float4 c{rand.nextF(), rand.nextF(), rand.nextF(), rand.nextF()};
+                        SkFloatToHalf_finite_ftz(c).store(bm.getAddr(x, y));
+                    } break;
+                }
+            }
+        }
+
+        sk_sp<SkMipmap> serial(SkMipmap::Build(bm, nullptr));
+        sk_sp<SkMipmap> threaded(SkMipmap::Build(bm, nullptr, executor.get()));
+        REPORTER_ASSERT(reporter, serial && threaded);
+        if (!serial || !threaded) {
+            continue;
+        }
+
+        SkMipmap::Level level;
+        REPORTER_ASSERT(reporter, serial->getLevel(0, &level));
+        const SkPixmap& pm = level.fPixmap;
+        for (int y = 0; y < pm.height(); ++y) {
+            for (int x = 0; x < pm.width(); ++x) {
+                switch (ct) {
+                    case kRGBA_8888_SkColorType: {
+                        auto px = [&](int dx, int dy) {
+                            return skvx::cast<uint16_t>(
+                                    skvx::byte4::Load(bm.getAddr32(2*x + dx, 2*y + dy)));
+                        };
+                        uint32_t expected;
+                        skvx::cast<uint8_t>((px(0,0) + px(1,0) + px(0,1) + px(1,1)) >> 2)
+                                .store(&expected);
+                        REPORTER_ASSERT(reporter, *pm.addr32(x, y) == expected);
+                    } break;
+                    case kAlpha_8_SkColorType: {
+                        auto px = [&](int dx, int dy) { return *bm.getAddr8(2*x + dx, 2*y + dy); };
+                        int expected = (px(0,0) + px(1,0) + px(0,1) + px(1,1)) >> 2;
+                        REPORTER_ASSERT(reporter, *pm.addr8(x, y) == expected);
+                    } break;
+                    default: {
+                        auto px = [&](int dx, int dy) {
+                            return SkHalfToFloat_finite_ftz(
+                                    *(const uint64_t*)bm.getAddr(2*x + dx, 2*y + dy));
+                        };
+                        uint64_t expected;
+                        SkFloatToHalf_finite_ftz((px(0,0) + px(0,1) + px(1,0) + px(1,1)) * 0.25f)
+                                .store(&expected);
+                        REPORTER_ASSERT(reporter, *(const uint64_t*)pm.addr(x, y) == expected);
+                    } break;
+                }
+            }
+        }
+
+        REPORTER_ASSERT(reporter, serial->countLevels() == threaded->countLevels());
+        for (int i = 0; i < serial->countLevels(); ++i) {
+            SkMipmap::Level a, b;
+            REPORTER_ASSERT(reporter, serial->getLevel(i, &a) && threaded->getLevel(i, &b));
+            REPORTER_ASSERT(reporter, a.fPixmap.computeByteSize() == b.fPixmap.computeByteSize());
+            REPORTER_ASSERT(reporter, !memcmp(a.fPixmap.addr(), b.fPixmap.addr(),
+                                              a.fPixmap.computeByteSize()));
+        }
+    }
+}
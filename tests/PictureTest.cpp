@@ -22,20 +22,28 @@
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixelRef.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkTextBlob.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/utils/SkPictureBandRenderer.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkBigPicture.h"
+#include "src/core/SkMappedPicture.h"
+#include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -923,3 +931,176 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_BandRenderer, r) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    SkCanvas* c = recorder.beginRecording(SkRect::MakeWH(200, 300), &factory);
+    SkRandom rand;
+    SkPaint paint;
+    for (int i = 0; i < 50; i++) {
+        paint.setColor(rand.nextU() | 0xFF000000);
+        const SkRect rect = SkRect::MakeXYWH(rand.nextRangeF(-20, 200), rand.nextRangeF(-20, 300),
+                                             rand.nextRangeF(1, 80), rand.nextRangeF(1, 80));
+        if (i % 2) {
+            c->drawRect(rect, paint);
+        } else {
+            c->drawOval(rect, paint);
+        }
+    }
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    SkPictureBandRenderer::Options options;
+    options.fBackground = SkColors::kWhite;
+    options.fMatrix.setScale(1.5f, 1.5f);
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 450);
+
+    SkBitmap expected;
+    expected.allocPixels(info);
+    SkCanvas canvas(expected);
+    canvas.clear(SK_ColorWHITE);
+    canvas.concat(options.fMatrix);
+    picture->playback(&canvas);
+
+    for (int bandHeight : {1, 37, 450, 1000}) {
+        options.fBandHeight = bandHeight;
+        int nextTop = 0;
+        bool rendered = SkPictureBandRenderer::Render(
+                picture.get(), info, options, [&](const SkPixmap& band, int top) {
+                    REPORTER_ASSERT(r, top == nextTop);
+                    REPORTER_ASSERT(r, band.width() == info.width());
+                    REPORTER_ASSERT(r, band.height() == std::min(bandHeight, info.height() - top));
+                    for (int y = 0; y < band.height(); y++) {
+                        if (memcmp(band.addr32(0, y), expected.getAddr32(0, top + y),
+                                   info.minRowBytes()) != 0) {
+                            ERRORF(r, "band height %d: row %d differs", bandHeight, top + y);
+                            return false;
+                        }
+                    }
+                    nextTop = top + band.height();
+                    return true;
+                });
+        REPORTER_ASSERT(r, rendered);
+        REPORTER_ASSERT(r, nextTop == info.height());
+    }
+
+    // Returning false from the callback stops the rendering.
+    int bands = 0;
+    options.fBandHeight = 100;
+    REPORTER_ASSERT(r, !SkPictureBandRenderer::Render(picture.get(), info, options,
+                                                      [&](const SkPixmap&, int) {
+                                                          return ++bands < 2;
+                                                      }));
+    REPORTER_ASSERT(r, bands == 2);
+}
+
+static sk_sp<SkPicture> make_mappable_test_picture() {
+    SkPictureRecorder recorder;
+    SkCanvas* c = recorder.beginRecording(SkRect::MakeWH(40, 40));
+    c->drawCircle(20, 20, 15, SkPaint());
+    sk_sp<SkPicture> nested = recorder.finishRecordingAsPicture();
+
+    SkBitmap bm;
+    make_bm(&bm, 10, 10, SK_ColorGREEN, true);
+    SkFont font(ToolUtils::create_portable_typeface(), 12);
+
+    c = recorder.beginRecording(SkRect::MakeWH(100, 100));
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    for (int i = 0; i < 5; i++) {
+        SkPath path;
+        path.moveTo(5, 5 + 10 * i);
+        path.quadTo(50, 10 * i, 95, 10 + 10 * i);
+        path.lineTo(50, 20 + 10 * i);
+        c->drawPath(path, paint);
+    }
+    c->drawTextBlob(SkTextBlob::MakeFromString("Mapped", font), 10, 80, paint);
+    c->drawImage(bm.asImage(), 60, 60);
+    c->translate(50, 50);
+    c->drawPicture(nested);
+    return recorder.finishRecordingAsPicture();
+}
+
+static SkBitmap draw_picture(const SkPicture* picture) {
+    SkBitmap bm;
+    bm.allocN32Pixels(100, 100);
+    SkCanvas canvas(bm);
+    canvas.clear(SK_ColorWHITE);
+    canvas.drawPicture(picture);
+    return bm;
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    return a.computeByteSize() == b.computeByteSize() &&
+           memcmp(a.getPixels(), b.getPixels(), a.computeByteSize()) == 0;
+}
+
+DEF_TEST(Picture_MappedData, r) {
+    sk_sp<SkPicture> picture = make_mappable_test_picture();
+    const SkBitmap expected = draw_picture(picture.get());
+
+    SkSerialProcs procs;
+    procs.fMappablePictures = true;
+    sk_sp<SkData> mappable = picture->serialize(&procs);
+    sk_sp<SkData> legacy = picture->serialize();
+    REPORTER_ASSERT(r, mappable && legacy);
+
+    // Records where the encoded images handed to the deserializer live, then lets it decode them
+    // as usual.
+    struct EncodedImage {
+        const void* fData;
+        size_t      fSize;
+    };
+    std::vector<EncodedImage> encodedImages;
+    SkDeserialProcs dProcs;
+    dProcs.fImageCtx = &encodedImages;
+    dProcs.fImageProc = [](const void* data, size_t size, void* ctx) -> sk_sp<SkImage> {
+        static_cast<std::vector<EncodedImage>*>(ctx)->push_back({data, size});
+        return nullptr;
+    };
+
+    // Mappable and legacy pictures can both be read either way.
+    sk_sp<SkPicture> fromMappable = SkPicture::MakeFromMappedData(mappable, &dProcs);
+    sk_sp<SkPicture> fromLegacy = SkPicture::MakeFromMappedData(legacy);
+    sk_sp<SkPicture> copied = SkPicture::MakeFromData(mappable.get());
+    REPORTER_ASSERT(r, fromMappable && fromLegacy && copied);
+    if (!fromMappable || !fromLegacy || !copied) {
+        return;
+    }
+
+    for (const sk_sp<SkPicture>& p : {fromMappable, fromLegacy, copied}) {
+        REPORTER_ASSERT(r, p->cullRect() == picture->cullRect());
+        REPORTER_ASSERT(r, same_pixels(draw_picture(p.get()), expected));
+    }
+    // Drawing again reuses the paths and text blobs read the first time.
+    REPORTER_ASSERT(r, same_pixels(draw_picture(fromMappable.get()), expected));
+
+    // The op data and the encoded image are read in place, rather than copied out of the SKP.
+    auto inMappable = [&](const void* data, size_t size) {
+        const uintptr_t start = reinterpret_cast<uintptr_t>(mappable->data()),
+                        p     = reinterpret_cast<uintptr_t>(data);
+        return start <= p && p + size <= start + mappable->size();
+    };
+    const sk_sp<SkData>& opData =
+            static_cast<const SkMappedPicture*>(fromMappable.get())->data().opData();
+    REPORTER_ASSERT(r, opData && inMappable(opData->data(), opData->size()));
+    REPORTER_ASSERT(r, !encodedImages.empty());
+    for (const EncodedImage& image : encodedImages) {
+        REPORTER_ASSERT(r, inMappable(image.fData, image.fSize));
+    }
+
+    REPORTER_ASSERT(r, fromMappable->approximateOpCount() > 0);
+    REPORTER_ASSERT(r, fromMappable->approximateOpCount(true) >
+                       fromMappable->approximateOpCount());
+
+    // The mapped picture can be written out again, in either format.
+    sk_sp<SkData> reserialized = fromMappable->serialize(&procs);
+    sk_sp<SkPicture> roundTripped = SkPicture::MakeFromMappedData(reserialized);
+    REPORTER_ASSERT(r, roundTripped && same_pixels(draw_picture(roundTripped.get()), expected));
+
+    // Truncated data is rejected.
+    for (size_t size : {mappable->size() / 2, mappable->size() - 4}) {
+        REPORTER_ASSERT(r, !SkPicture::MakeFromMappedData(SkData::MakeSubset(mappable.get(), 0,
+                                                                             size)));
+    }
+}
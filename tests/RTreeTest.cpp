@@ -82,18 +82,57 @@ DEF_TEST(RTree, reporter) {
     SkRandom rand;
     AutoTArray<SkRect> rects(NUM_RECTS);
     for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
-        SkRTree rtree;
-        REPORTER_ASSERT(reporter, 0 == rtree.getCount());
+        for (auto ordering : {SkRTree::Ordering::kHilbert, SkRTree::Ordering::kInsertionOrder}) {
+            SkRTree rtree(ordering);
+            REPORTER_ASSERT(reporter, 0 == rtree.getCount());
 
-        for (int j = 0; j < NUM_RECTS; j++) {
-            rects[j] = random_rect(rand);
+            for (int j = 0; j < NUM_RECTS; j++) {
+                rects[j] = random_rect(rand);
+            }
+
+            rtree.insert(rects.data(), NUM_RECTS);
+
+            run_queries(reporter, rand, rects.data(), rtree);
+            REPORTER_ASSERT(reporter, NUM_RECTS == rtree.getCount());
+            REPORTER_ASSERT(reporter, expectedDepthMin <= rtree.getDepth() &&
+                                      expectedDepthMax >= rtree.getDepth());
         }
+    }
+}
+
+DEF_TEST(RTree_Partition, reporter) {
+    SkRandom rand;
+    AutoTArray<SkRect> rects(NUM_RECTS);
+    for (int j = 0; j < NUM_RECTS; j++) {
+        rects[j] = random_rect(rand);
+    }
+    rects[7].setEmpty();  // Never found.
+
+    // An area that doesn't divide evenly into tiles, and doesn't cover all the rects.
+    const SkIRect area = SkIRect::MakeLTRB(3, 7, 903, 957);
+    const SkISize tileSize = {64, 100};
+    const int tilesX = (area.width() + tileSize.width() - 1) / tileSize.width();
 
+    for (auto ordering : {SkRTree::Ordering::kHilbert, SkRTree::Ordering::kInsertionOrder}) {
+        SkRTree rtree(ordering);
         rtree.insert(rects.data(), NUM_RECTS);
 
-        run_queries(reporter, rand, rects.data(), rtree);
-        REPORTER_ASSERT(reporter, NUM_RECTS == rtree.getCount());
-        REPORTER_ASSERT(reporter, expectedDepthMin <= rtree.getDepth() &&
-                                  expectedDepthMax >= rtree.getDepth());
+        for (SkScalar outset : {0.f, 1.f}) {
+            std::vector<std::vector<int>> buckets;
+            rtree.partition(area, tileSize, outset, &buckets);
+            REPORTER_ASSERT(reporter, buckets.size() == (size_t)(tilesX * 10));
+
+            // Each bucket should match a search of its tile.
+            for (int t = 0; t < (int)buckets.size(); t++) {
+                SkIRect tile = SkIRect::MakeXYWH(area.fLeft + (t % tilesX) * tileSize.width(),
+                                                 area.fTop  + (t / tilesX) * tileSize.height(),
+                                                 tileSize.width(), tileSize.height());
+                SkAssertResult(tile.intersect(area));
+
+                std::vector<int> hits;
+                rtree.search(SkRect::Make(tile).makeOutset(outset, outset), &hits);
+                REPORTER_ASSERT(reporter, hits == buckets[t], "tile %d", t);
+            }
+        }
     }
 }
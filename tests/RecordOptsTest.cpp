@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
@@ -16,6 +17,7 @@
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkSurface.h"
 #include "include/effects/SkImageFilters.h"
@@ -28,6 +30,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 static const int W = 1920, H = 1080;
 
@@ -426,3 +429,142 @@ DEF_TEST(savelayer_srcmode_alpha, r) {
     do_savelayer_srcmode(r, 0x80FF0000);
 }
 
+
+DEF_TEST(RecordOpts_CullOverdraw, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque;
+    opaque.setColor(SK_ColorBLUE);
+    SkPaint translucent;
+    translucent.setColor(0x80FF0000);
+
+    recorder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50), translucent);     // 0: culled
+    recorder.drawOval(SkRect::MakeLTRB(20, 20, 40, 40), opaque);          // 1: culled
+    recorder.drawRect(SkRect::MakeLTRB(150, 150, 250, 250), opaque);      // 2: not covered
+    recorder.drawRect(SkRect::MakeLTRB(60, 60, 70, 70), opaque);          // 3: culled
+    recorder.drawRect(SkRect::MakeLTRB(0, 0, 100, 100), translucent);     // 4: not opaque
+    recorder.drawRect(SkRect::MakeLTRB(0.5f, 0.5f, 100.5f, 100.5f), opaque);  // 5: occluder
+
+    // A clip between two draws keeps the later draw from hiding the earlier one.
+    recorder.drawRect(SkRect::MakeLTRB(300, 300, 310, 310), opaque);      // 6
+    recorder.clipRect(SkRect::MakeLTRB(300, 300, 305, 305));              // 7
+    recorder.drawRect(SkRect::MakeLTRB(200, 200, 400, 400), opaque);      // 8
+
+    SkRecordCullOverdraw(&record, SkRect::MakeWH(W, H));
+
+    assert_type<SkRecords::NoOp>(r, record, 0);
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::NoOp>(r, record, 3);
+    assert_type<SkRecords::DrawRect>(r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::DrawRect>(r, record, 8);
+}
+
+DEF_TEST(RecordOpts_CullOverdrawSoftClip, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint opaque;
+    opaque.setColor(SK_ColorBLUE);
+
+    recorder.save();
+        recorder.clipRect(SkRect::MakeLTRB(0.5f, 0.5f, 99.5f, 99.5f), true /*aa*/);
+        recorder.drawRect(SkRect::MakeLTRB(0, 0, 50, 50), opaque);    // 2: shows through the AA edge
+        recorder.drawRect(SkRect::MakeLTRB(0, 0, 100, 100), opaque);  // 3
+    recorder.restore();
+    recorder.drawRect(SkRect::MakeLTRB(0, 0, 50, 50), opaque);        // 5: culled
+    recorder.drawRect(SkRect::MakeLTRB(0, 0, 100, 100), opaque);      // 6
+
+    SkRecordCullOverdraw(&record, SkRect::MakeWH(W, H));
+
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    assert_type<SkRecords::NoOp>(r, record, 5);
+}
+
+DEF_TEST(RecordOpts_MergeDrawRects, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    SkPaint translucent;
+    translucent.setColor(0x80FF0000);
+    SkPaint opaque;
+    opaque.setColor(SK_ColorBLUE);
+
+    recorder.drawRect(SkRect::MakeLTRB( 0, 0, 10, 10), translucent);  // 0: merged
+    recorder.drawRect(SkRect::MakeLTRB(10, 0, 20, 10), translucent);  // 1: merged
+    recorder.drawRect(SkRect::MakeLTRB(30, 0, 40, 10), translucent);  // 2: merged
+    recorder.drawRect(SkRect::MakeLTRB(35, 0, 45, 10), translucent);  // 3: overlaps
+    recorder.drawRect(SkRect::MakeLTRB( 0, 20, 10, 30), opaque);      // 4: merged
+    recorder.drawRect(SkRect::MakeLTRB( 5, 20, 15, 30), opaque);      // 5: merged, opaque
+    recorder.drawRect(SkRect::MakeLTRB( 0, 40, 10.5f, 50), opaque);   // 6: not pixel-aligned
+    recorder.drawRect(SkRect::MakeLTRB(20, 40, 30, 50), opaque);      // 7
+
+    SkRecordMergeDrawRects(&record);
+
+    const SkRecords::DrawRegion* merged = assert_type<SkRecords::DrawRegion>(r, record, 0);
+    if (merged) {
+        REPORTER_ASSERT(r, merged->paint == translucent);
+        REPORTER_ASSERT(r, merged->region.getBounds() == SkIRect::MakeLTRB(0, 0, 40, 10));
+    }
+    assert_type<SkRecords::NoOp>(r, record, 1);
+    assert_type<SkRecords::NoOp>(r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    merged = assert_type<SkRecords::DrawRegion>(r, record, 4);
+    if (merged) {
+        REPORTER_ASSERT(r, merged->region.getBounds() == SkIRect::MakeLTRB(0, 20, 15, 30));
+    }
+    assert_type<SkRecords::NoOp>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    assert_type<SkRecords::DrawRect>(r, record, 7);
+}
+
+// The optional SkPictureRecorder passes should leave pictures drawing the same pixels.
+DEF_TEST(RecordOpts_OptimizationFlagsDrawTheSame, r) {
+    auto draw = [](SkCanvas* canvas) {
+        SkPaint paint;
+        for (int i = 0; i < 16; i++) {
+            // Four runs of four rects, alternating between translucent and opaque.
+            const int run = i / 4;
+            paint.setColor(SkColorSetARGB(run & 1 ? 0xFF : 0x80, 64 * run, 255 - 64 * run, 0));
+            canvas->drawRect(SkRect::MakeXYWH(4 * i, 0, 4, 32), paint);
+        }
+        paint.setAntiAlias(true);
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawOval(SkRect::MakeLTRB(8, 8, 40, 40), paint);
+        canvas->drawCircle(50, 50, 12, paint);
+        paint.setColor(SK_ColorBLACK);
+        canvas->drawRect(SkRect::MakeLTRB(4.5f, 4.5f, 48.5f, 48.5f), paint);
+        canvas->translate(2, 2);
+        canvas->drawRect(SkRect::MakeLTRB(50, 50, 60, 60), paint);
+        canvas->drawRect(SkRect::MakeLTRB(60, 50, 62, 60), paint);
+    };
+
+    SkBitmap expected, actual;
+    int expectedOps = 0;
+    for (SkBitmap* bitmap : {&expected, &actual}) {
+        SkPictureRecorder recorder;
+        if (bitmap == &actual) {
+            recorder.setOptimizationFlags(SkPictureRecorder::kCullOverdraw_OptimizationFlag |
+                                          SkPictureRecorder::kMergeDrawRects_OptimizationFlag);
+        }
+        draw(recorder.beginRecording(SkRect::MakeWH(64, 64)));
+        sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+        if (bitmap == &expected) {
+            expectedOps = picture->approximateOpCount();
+        } else {
+            // 16 rects become 4 regions, the last two rects become 1, and the oval is hidden.
+            REPORTER_ASSERT(r, picture->approximateOpCount() == expectedOps - 14);
+        }
+
+        bitmap->allocN32Pixels(64, 64);
+        bitmap->eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(*bitmap);
+        canvas.drawPicture(picture);
+    }
+
+    REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                   expected.computeByteSize()));
+}
@@ -20,6 +20,18 @@
 
 using namespace skia_private;
 
+// The lane patterns below are written out for eight lanes. This repeats them across every lane of
+// the active highp stride, laying out each slot one stride apart as the pipeline expects.
+template <typename T, size_t kSlots>
+static void fill_slots(const T (&pattern)[kSlots][8], T* dst) {
+    const size_t N = SkOpts::raster_pipeline_highp_stride;
+    for (size_t slot = 0; slot < kSlots; ++slot) {
+        for (size_t lane = 0; lane < N; ++lane) {
+            dst[slot * N + lane] = pattern[slot][lane % 8];
+        }
+    }
+}
+
 DEF_TEST(SkRasterPipeline, r) {
     // Build and run a simple pipeline to exercise SkRasterPipeline,
     // drawing 50% transparent blue over opaque red in half-floats.
@@ -45,6 +57,91 @@ DEF_TEST(SkRasterPipeline, r) {
     REPORTER_ASSERT(r, ((result >> 48) & 0xffff) == 0x3c00);
 }
 
+DEF_TEST(SkRasterPipeline_ProgramCache, r) {
+    // Compile the same op list twice with different contexts. The second compile should reuse the
+    // first program's template, and each program should still read and write its own pixels.
+    // swap_rb + store_8888 fuses, so this also checks that fused stages get the right context.
+    uint32_t src[2] = {0xff0000ff, 0xff00ff00},
+             dst[2] = {0, 0};
+
+    SkRasterPipeline_MemoryCtx load_ctx[2]  = {{&src[0], 0}, {&src[1], 0}},
+                               store_ctx[2] = {{&dst[0], 0}, {&dst[1], 0}};
+
+    // The compiled programs live in this arena, so it must outlive them.
+    SkSTArenaAlloc<256> alloc;
+    std::function<void(size_t, size_t, size_t, size_t)> programs[2];
+    // Templates are kept per thread, so this thread's counts are only moved by these compiles.
+    SkRasterPipeline::ProgramCacheStats stats[2];
+    for (int i = 0; i < 2; ++i) {
+        SkRasterPipeline p(&alloc);
+        p.append(SkRasterPipelineOp::load_8888, &load_ctx[i]);
+        p.append(SkRasterPipelineOp::swap_rb);
+        p.append(SkRasterPipelineOp::store_8888, &store_ctx[i]);
+
+        programs[i] = p.compile();
+        stats[i] = SkRasterPipeline::GetThreadProgramCacheStats();
+    }
+    // The first compile may hit a template left by an earlier test; the second must hit.
+    REPORTER_ASSERT(r, stats[1].fHits == stats[0].fHits + 1);
+    REPORTER_ASSERT(r, stats[1].fMisses == stats[0].fMisses);
+
+    programs[0](0,0,1,1);
+    programs[1](0,0,1,1);
+    REPORTER_ASSERT(r, dst[0] == 0xffff0000);
+    REPORTER_ASSERT(r, dst[1] == 0xff00ff00);
+}
+
+DEF_TEST(SkRasterPipeline_FusedStages, r) {
+    // Each of these pipelines contains sequences that SkRasterPipeline replaces with a fused stage.
+    // The results should be the same as running the stages one at a time.
+    uint32_t src = 0x800000ff,   // 50% alpha, unpremul red
+             dst = 0xff00ff00;   // opaque green
+    SkRasterPipeline_MemoryCtx src_ctx = { &src, 0 },
+                               dst_ctx = { &dst, 0 };
+
+    {
+        // load_8888, premul -> load_8888_premul
+        uint32_t result = 0;
+        SkRasterPipeline_MemoryCtx result_ctx = { &result, 0 };
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipelineOp::load_8888, &src_ctx);
+        p.append(SkRasterPipelineOp::premul);
+        p.append(SkRasterPipelineOp::store_8888, &result_ctx);
+        p.run(0,0,1,1);
+        REPORTER_ASSERT(r, result == 0x80000080);
+    }
+    {
+        // load_8888_dst, swap_rb_dst -> load_bgra_8888_dst
+        // swap_rb, store_8888        -> store_bgra_8888
+        uint32_t result = 0;
+        SkRasterPipeline_MemoryCtx result_ctx = { &result, 0 };
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipelineOp::load_8888_dst, &dst_ctx);
+        p.append(SkRasterPipelineOp::swap_rb_dst);
+        p.append(SkRasterPipelineOp::move_dst_src);
+        p.append(SkRasterPipelineOp::swap_rb);
+        p.append(SkRasterPipelineOp::store_8888, &result_ctx);
+        p.run(0,0,1,1);
+        REPORTER_ASSERT(r, result == dst);
+    }
+    {
+        // swap_rb, srcover_rgba_8888 -> srcover_bgra_8888
+        uint32_t opaque_red = 0xff0000ff,
+                 result     = dst;
+        SkRasterPipeline_MemoryCtx red_ctx    = { &opaque_red, 0 },
+                                   result_ctx = { &result, 0 };
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipelineOp::load_8888, &red_ctx);
+        p.append(SkRasterPipelineOp::swap_rb);
+        p.append(SkRasterPipelineOp::srcover_rgba_8888, &result_ctx);
+        p.run(0,0,1,1);
+        REPORTER_ASSERT(r, result == 0xffff0000);
+    }
+}
+
 DEF_TEST(SkRasterPipeline_PackSmallContext, r) {
     struct PackableObject {
         std::array<uint8_t, sizeof(void*)> data;
@@ -105,11 +202,12 @@ DEF_TEST(SkRasterPipeline_PackBigContext, r) {
 }
 
 DEF_TEST(SkRasterPipeline_LoadStoreConditionMask, reporter) {
-    alignas(64) int32_t mask[]  = {~0, 0, ~0,  0, ~0, ~0, ~0,  0};
+    alignas(64) int32_t mask[]  = {~0, 0, ~0,  0, ~0, ~0, ~0,  0,
+                                   ~0, 0, ~0,  0, ~0, ~0, ~0,  0};
     alignas(64) int32_t maskCopy[SkRasterPipeline_kMaxStride_highp] = {};
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
 
-    static_assert(std::size(mask) == SkRasterPipeline_kMaxStride_highp);
+    static_assert(std::size(mask) >= SkRasterPipeline_kMaxStride_highp);
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::init_lane_masks);
@@ -148,11 +246,12 @@ DEF_TEST(SkRasterPipeline_LoadStoreConditionMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_LoadStoreLoopMask, reporter) {
-    alignas(64) int32_t mask[]  = {~0, 0, ~0,  0, ~0, ~0, ~0,  0};
+    alignas(64) int32_t mask[]  = {~0, 0, ~0,  0, ~0, ~0, ~0,  0,
+                                   ~0, 0, ~0,  0, ~0, ~0, ~0,  0};
     alignas(64) int32_t maskCopy[SkRasterPipeline_kMaxStride_highp] = {};
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
 
-    static_assert(std::size(mask) == SkRasterPipeline_kMaxStride_highp);
+    static_assert(std::size(mask) >= SkRasterPipeline_kMaxStride_highp);
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::init_lane_masks);
@@ -191,11 +290,12 @@ DEF_TEST(SkRasterPipeline_LoadStoreLoopMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_LoadStoreReturnMask, reporter) {
-    alignas(64) int32_t mask[]  = {~0, 0, ~0,  0, ~0, ~0, ~0,  0};
+    alignas(64) int32_t mask[]  = {~0, 0, ~0,  0, ~0, ~0, ~0,  0,
+                                   ~0, 0, ~0,  0, ~0, ~0, ~0,  0};
     alignas(64) int32_t maskCopy[SkRasterPipeline_kMaxStride_highp] = {};
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
 
-    static_assert(std::size(mask) == SkRasterPipeline_kMaxStride_highp);
+    static_assert(std::size(mask) >= SkRasterPipeline_kMaxStride_highp);
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::init_lane_masks);
@@ -234,10 +334,11 @@ DEF_TEST(SkRasterPipeline_LoadStoreReturnMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_MergeConditionMask, reporter) {
-    alignas(64) int32_t mask[]  = { 0,  0, ~0, ~0, 0, ~0, 0, ~0,
-                                   ~0, ~0, ~0, ~0, 0,  0, 0,  0};
+    static constexpr int32_t kMask[2][8] = {{ 0,  0, ~0, ~0, 0, ~0, 0, ~0},
+                                            {~0, ~0, ~0, ~0, 0,  0, 0,  0}};
+    alignas(64) int32_t mask[2 * SkRasterPipeline_kMaxStride_highp];
+    fill_slots(kMask, mask);
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
-    static_assert(std::size(mask) == (2 * SkRasterPipeline_kMaxStride_highp));
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::init_lane_masks);
@@ -261,13 +362,15 @@ DEF_TEST(SkRasterPipeline_MergeConditionMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_MergeLoopMask, reporter) {
-    alignas(64) int32_t initial[]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,  // r (condition)
-                                      ~0,  0, ~0,  0, ~0, ~0, ~0, ~0,  // g (loop)
-                                      ~0, ~0, ~0, ~0, ~0, ~0,  0, ~0,  // b (return)
-                                      ~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0}; // a (combined)
-    alignas(64) int32_t mask[]     = { 0, ~0, ~0,  0, ~0, ~0, ~0, ~0};
+    static constexpr int32_t kInitial[4][8] = {{~0, ~0, ~0, ~0, ~0,  0, ~0, ~0},  // r (condition)
+                                               {~0,  0, ~0,  0, ~0, ~0, ~0, ~0},  // g (loop)
+                                               {~0, ~0, ~0, ~0, ~0, ~0,  0, ~0},  // b (return)
+                                               {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0}}; // a (combined)
+    alignas(64) int32_t initial[4 * SkRasterPipeline_kMaxStride_highp];
+    fill_slots(kInitial, initial);
+    alignas(64) int32_t mask[]     = { 0, ~0, ~0,  0, ~0, ~0, ~0, ~0,
+                                       0, ~0, ~0,  0, ~0, ~0, ~0, ~0};
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
-    static_assert(std::size(initial) == (4 * SkRasterPipeline_kMaxStride_highp));
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::load_src, initial);
@@ -293,13 +396,15 @@ DEF_TEST(SkRasterPipeline_MergeLoopMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_ReenableLoopMask, reporter) {
-    alignas(64) int32_t initial[]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,  // r (condition)
-                                      ~0,  0, ~0,  0, ~0, ~0,  0, ~0,  // g (loop)
-                                       0, ~0, ~0, ~0,  0,  0,  0, ~0,  // b (return)
-                                       0,  0, ~0,  0,  0,  0,  0, ~0}; // a (combined)
-    alignas(64) int32_t mask[]     = { 0, ~0,  0,  0,  0,  0, ~0,  0};
+    static constexpr int32_t kInitial[4][8] = {{~0, ~0, ~0, ~0, ~0,  0, ~0, ~0},  // r (condition)
+                                               {~0,  0, ~0,  0, ~0, ~0,  0, ~0},  // g (loop)
+                                               { 0, ~0, ~0, ~0,  0,  0,  0, ~0},  // b (return)
+                                               { 0,  0, ~0,  0,  0,  0,  0, ~0}}; // a (combined)
+    alignas(64) int32_t initial[4 * SkRasterPipeline_kMaxStride_highp];
+    fill_slots(kInitial, initial);
+    alignas(64) int32_t mask[]     = { 0, ~0,  0,  0,  0,  0, ~0,  0,
+                                       0, ~0,  0,  0,  0,  0, ~0,  0};
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
-    static_assert(std::size(initial) == (4 * SkRasterPipeline_kMaxStride_highp));
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::load_src, initial);
@@ -325,15 +430,17 @@ DEF_TEST(SkRasterPipeline_ReenableLoopMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_CaseOp, reporter) {
-    alignas(64) int32_t initial[]        = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,  // r (condition)
-                                             0, ~0, ~0,  0, ~0, ~0,  0, ~0,  // g (loop)
-                                            ~0,  0, ~0, ~0,  0,  0,  0, ~0,  // b (return)
-                                             0,  0, ~0,  0,  0,  0,  0, ~0}; // a (combined)
+    static constexpr int32_t kInitial[4][8] = {{~0, ~0, ~0, ~0, ~0,  0, ~0, ~0},  // r (condition)
+                                               { 0, ~0, ~0,  0, ~0, ~0,  0, ~0},  // g (loop)
+                                               {~0,  0, ~0, ~0,  0,  0,  0, ~0},  // b (return)
+                                               { 0,  0, ~0,  0,  0,  0,  0, ~0}}; // a (combined)
+    alignas(64) int32_t initial[4 * SkRasterPipeline_kMaxStride_highp];
+    fill_slots(kInitial, initial);
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
-    static_assert(std::size(initial) == (4 * SkRasterPipeline_kMaxStride_highp));
 
-    constexpr int32_t actualValues[] = { 2,  1,  2,  4,  5,  2,  2,  8};
-    static_assert(std::size(actualValues) == SkRasterPipeline_kMaxStride_highp);
+    constexpr int32_t actualValues[] = { 2,  1,  2,  4,  5,  2,  2,  8,
+                                         2,  1,  2,  4,  5,  2,  2,  8};
+    static_assert(std::size(actualValues) >= SkRasterPipeline_kMaxStride_highp);
 
     alignas(64) int32_t caseOpData[2 * SkRasterPipeline_kMaxStride_highp];
     for (size_t index = 0; index < SkOpts::raster_pipeline_highp_stride; ++index) {
@@ -382,12 +489,13 @@ DEF_TEST(SkRasterPipeline_CaseOp, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_MaskOffLoopMask, reporter) {
-    alignas(64) int32_t initial[]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,  // r (condition)
-                                      ~0,  0, ~0, ~0,  0,  0,  0, ~0,  // g (loop)
-                                      ~0, ~0,  0, ~0,  0,  0, ~0, ~0,  // b (return)
-                                      ~0,  0,  0, ~0,  0,  0,  0, ~0}; // a (combined)
+    static constexpr int32_t kInitial[4][8] = {{~0, ~0, ~0, ~0, ~0,  0, ~0, ~0},  // r (condition)
+                                               {~0,  0, ~0, ~0,  0,  0,  0, ~0},  // g (loop)
+                                               {~0, ~0,  0, ~0,  0,  0, ~0, ~0},  // b (return)
+                                               {~0,  0,  0, ~0,  0,  0,  0, ~0}}; // a (combined)
+    alignas(64) int32_t initial[4 * SkRasterPipeline_kMaxStride_highp];
+    fill_slots(kInitial, initial);
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
-    static_assert(std::size(initial) == (4 * SkRasterPipeline_kMaxStride_highp));
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::load_src, initial);
@@ -411,12 +519,13 @@ DEF_TEST(SkRasterPipeline_MaskOffLoopMask, reporter) {
 }
 
 DEF_TEST(SkRasterPipeline_MaskOffReturnMask, reporter) {
-    alignas(64) int32_t initial[]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,  // r (condition)
-                                      ~0,  0, ~0, ~0,  0,  0,  0, ~0,  // g (loop)
-                                      ~0, ~0,  0, ~0,  0,  0, ~0, ~0,  // b (return)
-                                      ~0,  0,  0, ~0,  0,  0,  0, ~0}; // a (combined)
+    static constexpr int32_t kInitial[4][8] = {{~0, ~0, ~0, ~0, ~0,  0, ~0, ~0},  // r (condition)
+                                               {~0,  0, ~0, ~0,  0,  0,  0, ~0},  // g (loop)
+                                               {~0, ~0,  0, ~0,  0,  0, ~0, ~0},  // b (return)
+                                               {~0,  0,  0, ~0,  0,  0,  0, ~0}}; // a (combined)
+    alignas(64) int32_t initial[4 * SkRasterPipeline_kMaxStride_highp];
+    fill_slots(kInitial, initial);
     alignas(64) int32_t src[4 * SkRasterPipeline_kMaxStride_highp] = {};
-    static_assert(std::size(initial) == (4 * SkRasterPipeline_kMaxStride_highp));
 
     SkRasterPipeline_<256> p;
     p.append(SkRasterPipelineOp::load_src, initial);
@@ -491,11 +600,15 @@ DEF_TEST(SkRasterPipeline_CopyFromIndirectUnmasked, r) {
     alignas(64) float dst[5 * SkRasterPipeline_kMaxStride_highp];
 
     // Test with various mixes of indirect offsets.
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) const uint32_t kOffsets1[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-    alignas(64) const uint32_t kOffsets2[8] = {2, 2, 2, 2, 2, 2, 2, 2};
-    alignas(64) const uint32_t kOffsets3[8] = {0, 2, 0, 2, 0, 2, 0, 2};
-    alignas(64) const uint32_t kOffsets4[8] = {99, 99, 0, 0, 99, 99, 0, 0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) const uint32_t kOffsets1[16] = {0, 0, 0, 0, 0, 0, 0, 0,
+                                                0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(64) const uint32_t kOffsets2[16] = {2, 2, 2, 2, 2, 2, 2, 2,
+                                                2, 2, 2, 2, 2, 2, 2, 2};
+    alignas(64) const uint32_t kOffsets3[16] = {0, 2, 0, 2, 0, 2, 0, 2,
+                                                0, 2, 0, 2, 0, 2, 0, 2};
+    alignas(64) const uint32_t kOffsets4[16] = {99, 99, 0, 0, 99, 99, 0, 0,
+                                                99, 99, 0, 0, 99, 99, 0, 0};
 
     const int N = SkOpts::raster_pipeline_highp_stride;
 
@@ -563,11 +676,15 @@ DEF_TEST(SkRasterPipeline_CopyFromIndirectUniformUnmasked, r) {
     alignas(64) float dst[5 * SkRasterPipeline_kMaxStride_highp];
 
     // Test with various mixes of indirect offsets.
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) const uint32_t kOffsets1[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-    alignas(64) const uint32_t kOffsets2[8] = {2, 2, 2, 2, 2, 2, 2, 2};
-    alignas(64) const uint32_t kOffsets3[8] = {0, 2, 0, 2, 0, 2, 0, 2};
-    alignas(64) const uint32_t kOffsets4[8] = {99, ~99u, 0, 0, ~99u, 99, 0, 0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) const uint32_t kOffsets1[16] = {0, 0, 0, 0, 0, 0, 0, 0,
+                                                0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(64) const uint32_t kOffsets2[16] = {2, 2, 2, 2, 2, 2, 2, 2,
+                                                2, 2, 2, 2, 2, 2, 2, 2};
+    alignas(64) const uint32_t kOffsets3[16] = {0, 2, 0, 2, 0, 2, 0, 2,
+                                                0, 2, 0, 2, 0, 2, 0, 2};
+    alignas(64) const uint32_t kOffsets4[16] = {99, ~99u, 0, 0, ~99u, 99, 0, 0,
+                                                99, ~99u, 0, 0, ~99u, 99, 0, 0};
 
     const int N = SkOpts::raster_pipeline_highp_stride;
 
@@ -634,17 +751,25 @@ DEF_TEST(SkRasterPipeline_CopyToIndirectMasked, r) {
     alignas(64) float dst[5 * SkRasterPipeline_kMaxStride_highp];
 
     // Test with various mixes of indirect offsets.
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) const uint32_t kOffsets1[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-    alignas(64) const uint32_t kOffsets2[8] = {2, 2, 2, 2, 2, 2, 2, 2};
-    alignas(64) const uint32_t kOffsets3[8] = {0, 2, 0, 2, 0, 2, 0, 2};
-    alignas(64) const uint32_t kOffsets4[8] = {99, ~99u, 0, 0, ~99u, 99, 0, 0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) const uint32_t kOffsets1[16] = {0, 0, 0, 0, 0, 0, 0, 0,
+                                                0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(64) const uint32_t kOffsets2[16] = {2, 2, 2, 2, 2, 2, 2, 2,
+                                                2, 2, 2, 2, 2, 2, 2, 2};
+    alignas(64) const uint32_t kOffsets3[16] = {0, 2, 0, 2, 0, 2, 0, 2,
+                                                0, 2, 0, 2, 0, 2, 0, 2};
+    alignas(64) const uint32_t kOffsets4[16] = {99, ~99u, 0, 0, ~99u, 99, 0, 0,
+                                                99, ~99u, 0, 0, ~99u, 99, 0, 0};
 
     // Test with various masks.
-    alignas(64) const int32_t kMask1[8]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0};
-    alignas(64) const int32_t kMask2[8]  = {~0,  0, ~0, ~0,  0,  0,  0, ~0};
-    alignas(64) const int32_t kMask3[8]  = {~0, ~0,  0, ~0,  0,  0, ~0, ~0};
-    alignas(64) const int32_t kMask4[8]  = { 0,  0,  0,  0,  0,  0,  0,  0};
+    alignas(64) const int32_t kMask1[16]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,
+                                             ~0, ~0, ~0, ~0, ~0,  0, ~0, ~0};
+    alignas(64) const int32_t kMask2[16]  = {~0,  0, ~0, ~0,  0,  0,  0, ~0,
+                                             ~0,  0, ~0, ~0,  0,  0,  0, ~0};
+    alignas(64) const int32_t kMask3[16]  = {~0, ~0,  0, ~0,  0,  0, ~0, ~0,
+                                             ~0, ~0,  0, ~0,  0,  0, ~0, ~0};
+    alignas(64) const int32_t kMask4[16]  = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                              0,  0,  0,  0,  0,  0,  0,  0};
 
     const int N = SkOpts::raster_pipeline_highp_stride;
 
@@ -720,17 +845,25 @@ DEF_TEST(SkRasterPipeline_SwizzleCopyToIndirectMasked, r) {
     alignas(64) float dst[5 * SkRasterPipeline_kMaxStride_highp];
 
     // Test with various mixes of indirect offsets.
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) const uint32_t kOffsets1[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-    alignas(64) const uint32_t kOffsets2[8] = {2, 2, 2, 2, 2, 2, 2, 2};
-    alignas(64) const uint32_t kOffsets3[8] = {0, 2, 0, 2, 0, 2, 0, 2};
-    alignas(64) const uint32_t kOffsets4[8] = {99, ~99u, 0, 0, ~99u, 99, 0, 0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) const uint32_t kOffsets1[16] = {0, 0, 0, 0, 0, 0, 0, 0,
+                                                0, 0, 0, 0, 0, 0, 0, 0};
+    alignas(64) const uint32_t kOffsets2[16] = {2, 2, 2, 2, 2, 2, 2, 2,
+                                                2, 2, 2, 2, 2, 2, 2, 2};
+    alignas(64) const uint32_t kOffsets3[16] = {0, 2, 0, 2, 0, 2, 0, 2,
+                                                0, 2, 0, 2, 0, 2, 0, 2};
+    alignas(64) const uint32_t kOffsets4[16] = {99, ~99u, 0, 0, ~99u, 99, 0, 0,
+                                                99, ~99u, 0, 0, ~99u, 99, 0, 0};
 
     // Test with various masks.
-    alignas(64) const int32_t kMask1[8]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0};
-    alignas(64) const int32_t kMask2[8]  = {~0,  0, ~0, ~0,  0,  0,  0, ~0};
-    alignas(64) const int32_t kMask3[8]  = {~0, ~0,  0, ~0,  0,  0, ~0, ~0};
-    alignas(64) const int32_t kMask4[8]  = { 0,  0,  0,  0,  0,  0,  0,  0};
+    alignas(64) const int32_t kMask1[16]  = {~0, ~0, ~0, ~0, ~0,  0, ~0, ~0,
+                                             ~0, ~0, ~0, ~0, ~0,  0, ~0, ~0};
+    alignas(64) const int32_t kMask2[16]  = {~0,  0, ~0, ~0,  0,  0,  0, ~0,
+                                             ~0,  0, ~0, ~0,  0,  0,  0, ~0};
+    alignas(64) const int32_t kMask3[16]  = {~0, ~0,  0, ~0,  0,  0, ~0, ~0,
+                                             ~0, ~0,  0, ~0,  0,  0, ~0, ~0};
+    alignas(64) const int32_t kMask4[16]  = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                              0,  0,  0,  0,  0,  0,  0,  0};
 
     // Test with various swizzle permutations.
     struct TestPattern {
@@ -873,16 +1006,20 @@ DEF_TEST(SkRasterPipeline_TraceVar, r) {
         TArray<int> fBuffer;
     };
 
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) static constexpr int32_t  kMaskOn   [8] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
-    alignas(64) static constexpr int32_t  kMaskOff  [8] = { 0,  0,  0,  0,  0,  0,  0,  0};
-    alignas(64) static constexpr uint32_t kIndirect0[8] = { 0,  0,  0,  0,  0,  0,  0,  0};
-    alignas(64) static constexpr uint32_t kIndirect1[8] = { 1,  1,  1,  1,  1,  1,  1,  1};
-    alignas(64) int32_t kData333[8];
-    alignas(64) int32_t kData555[8];
-    alignas(64) int32_t kData666[8];
-    alignas(64) int32_t kData777[16];
-    alignas(64) int32_t kData999[16];
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) static constexpr int32_t  kMaskOn   [16] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0,
+                                                            ~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
+    alignas(64) static constexpr int32_t  kMaskOff  [16] = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                                             0,  0,  0,  0,  0,  0,  0,  0};
+    alignas(64) static constexpr uint32_t kIndirect0[16] = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                                             0,  0,  0,  0,  0,  0,  0,  0};
+    alignas(64) static constexpr uint32_t kIndirect1[16] = { 1,  1,  1,  1,  1,  1,  1,  1,
+                                                             1,  1,  1,  1,  1,  1,  1,  1};
+    alignas(64) int32_t kData333[16];
+    alignas(64) int32_t kData555[16];
+    alignas(64) int32_t kData666[16];
+    alignas(64) int32_t kData777[32];
+    alignas(64) int32_t kData999[32];
     std::fill(kData333,     kData333 + N,   333);
     std::fill(kData555,     kData555 + N,   555);
     std::fill(kData666,     kData666 + N,   666);
@@ -957,9 +1094,11 @@ DEF_TEST(SkRasterPipeline_TraceLine, r) {
         TArray<int> fBuffer;
     };
 
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) static constexpr int32_t kMaskOn [8] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
-    alignas(64) static constexpr int32_t kMaskOff[8] = { 0,  0,  0,  0,  0,  0,  0,  0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) static constexpr int32_t kMaskOn [16] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0,
+                                                         ~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
+    alignas(64) static constexpr int32_t kMaskOff[16] = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                                          0,  0,  0,  0,  0,  0,  0,  0};
 
     TestTraceHook trace;
     SkArenaAlloc alloc(/*firstHeapAllocation=*/256);
@@ -1006,9 +1145,11 @@ DEF_TEST(SkRasterPipeline_TraceEnterExit, r) {
         TArray<int> fBuffer;
     };
 
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) static constexpr int32_t kMaskOn [8] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
-    alignas(64) static constexpr int32_t kMaskOff[8] = { 0,  0,  0,  0,  0,  0,  0,  0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) static constexpr int32_t kMaskOn [16] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0,
+                                                         ~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
+    alignas(64) static constexpr int32_t kMaskOff[16] = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                                          0,  0,  0,  0,  0,  0,  0,  0};
 
     TestTraceHook trace;
     SkArenaAlloc alloc(/*firstHeapAllocation=*/256);
@@ -1049,9 +1190,11 @@ DEF_TEST(SkRasterPipeline_TraceScope, r) {
         TArray<int> fBuffer;
     };
 
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) static constexpr int32_t kMaskOn [8] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
-    alignas(64) static constexpr int32_t kMaskOff[8] = { 0,  0,  0,  0,  0,  0,  0,  0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) static constexpr int32_t kMaskOn [16] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0,
+                                                         ~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
+    alignas(64) static constexpr int32_t kMaskOff[16] = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                                          0,  0,  0,  0,  0,  0,  0,  0};
 
     TestTraceHook trace;
     SkArenaAlloc alloc(/*firstHeapAllocation=*/256);
@@ -1093,11 +1236,15 @@ DEF_TEST(SkRasterPipeline_CopySlotsMasked, r) {
         {SkRasterPipelineOp::copy_4_slots_masked, 4},
     };
 
-    static_assert(SkRasterPipeline_kMaxStride_highp == 8);
-    alignas(64) const int32_t kMask1[8] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
-    alignas(64) const int32_t kMask2[8] = { 0,  0,  0,  0,  0,  0,  0,  0};
-    alignas(64) const int32_t kMask3[8] = {~0,  0, ~0, ~0, ~0, ~0,  0, ~0};
-    alignas(64) const int32_t kMask4[8] = { 0, ~0,  0,  0,  0, ~0, ~0,  0};
+    static_assert(SkRasterPipeline_kMaxStride_highp <= 16);
+    alignas(64) const int32_t kMask1[16] = {~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0,
+                                            ~0, ~0, ~0, ~0, ~0, ~0, ~0, ~0};
+    alignas(64) const int32_t kMask2[16] = { 0,  0,  0,  0,  0,  0,  0,  0,
+                                             0,  0,  0,  0,  0,  0,  0,  0};
+    alignas(64) const int32_t kMask3[16] = {~0,  0, ~0, ~0, ~0, ~0,  0, ~0,
+                                            ~0,  0, ~0, ~0, ~0, ~0,  0, ~0};
+    alignas(64) const int32_t kMask4[16] = { 0, ~0,  0,  0,  0, ~0, ~0,  0,
+                                             0, ~0,  0,  0,  0, ~0, ~0,  0};
 
     const int N = SkOpts::raster_pipeline_highp_stride;
 
@@ -3054,6 +3201,54 @@ DEF_TEST(SkRasterPipeline_tail, r) {
     }
 }
 
+DEF_TEST(SkRasterPipeline_highp_tail_8888, r) {
+    // Storing floats keeps these pipelines highp, so the 8888 load and store use the highp
+    // tail handling, at widths up to and past the widest (16 pixel) stride.
+    uint32_t rgba[16];
+    for (int i = 0; i < 16; i++) {
+        rgba[i] = (4*i+0) << 0
+                | (4*i+1) << 8
+                | (4*i+2) << 16
+                | (4*i+3) << 24;
+    }
+
+    for (int width = 1; width <= 16; width++) {
+        float f32[16][4];
+        uint32_t stored[16];
+        memset(f32, 0xff, sizeof(f32));
+        memset(stored, 0xab, sizeof(stored));
+
+        SkRasterPipeline_MemoryCtx src = { rgba, 0 },
+                                   mid = { f32, 0 },
+                                   dst = { stored, 0 };
+        SkRasterPipeline_<256> load;
+        load.append(SkRasterPipelineOp::load_8888, &src);
+        load.append(SkRasterPipelineOp::store_f32, &mid);
+        load.run(0,0, width,1);
+
+        SkRasterPipeline_<256> store;
+        store.append(SkRasterPipelineOp::load_f32, &mid);
+        store.append(SkRasterPipelineOp::store_8888, &dst);
+        store.run(0,0, width,1);
+
+        for (int i = 0; i < 16; i++) {
+            if (i < width) {
+                REPORTER_ASSERT(r, f32[i][0] == (4*i+0) / 255.0f &&
+                                   f32[i][3] == (4*i+3) / 255.0f,
+                                "width %d: pixel %d loaded as %g %g", width, i,
+                                f32[i][0], f32[i][3]);
+                REPORTER_ASSERT(r, stored[i] == rgba[i], "width %d: pixel %d stored as %08x",
+                                width, i, stored[i]);
+            } else {
+                REPORTER_ASSERT(r, SkScalarIsNaN(f32[i][0]), "width %d: wrote pixel %d",
+                                width, i);
+                REPORTER_ASSERT(r, stored[i] == 0xabababab, "width %d: wrote pixel %d",
+                                width, i);
+            }
+        }
+    }
+}
+
 DEF_TEST(SkRasterPipeline_u16, r) {
     {
         alignas(8) uint16_t data[][2] = {
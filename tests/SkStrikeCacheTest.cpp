@@ -5,20 +5,31 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypeface.h"
+#include "src/core/SkOSFile.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeDiskCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <atomic>
+#include <cstring>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -57,6 +68,261 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
         REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
     }
     REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
+
+DEF_TEST(SkStrikeCache_ThreadedLookups, Reporter) {
+    SkStrikeCache cache;
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+
+    constexpr int kStrikeCount = 24;
+    std::vector<SkStrikeSpec> strikeSpecs;
+    SkPaint defaultPaint;
+    for (int i = 0; i < kStrikeCount; i++) {
+        font.setSize(8 + i);
+        strikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I()));
+    }
+
+    SkPackedGlyphID glyphIDs[26];
+    for (int c = 0; c < 26; c++) {
+        glyphIDs[c] = SkPackedGlyphID{font.unicharToGlyph('a' + c)};
+    }
+
+    // Many threads find the same strikes and glyphs, racing to create and prepare them. They
+    // must all end up with the same strike, and the same glyph for each ID.
+    std::atomic<SkStrike*> strikes[kStrikeCount] = {};
+    std::atomic<const SkGlyph*> glyphs[kStrikeCount][26] = {};
+    std::atomic<int> mismatches{0};
+    SkTaskGroup().batch(64, [&](int task) {
+        for (int n = 0; n < kStrikeCount; n++) {
+            const int i = (n + task) % kStrikeCount;
+            sk_sp<SkStrike> strike = strikeSpecs[i].findOrCreateStrike(&cache);
+            SkStrike* expectedStrike = nullptr;
+            if (!strikes[i].compare_exchange_strong(expectedStrike, strike.get()) &&
+                expectedStrike != strike.get()) {
+                mismatches++;
+            }
+
+            const SkGlyph* results[26];
+            strike->prepareImages(glyphIDs, results);
+            for (int g = 0; g < 26; g++) {
+                const SkGlyph* expectedGlyph = nullptr;
+                if (results[g]->getPackedID() != glyphIDs[g] ||
+                    !results[g]->setImageHasBeenCalled() ||
+                    (!glyphs[i][g].compare_exchange_strong(expectedGlyph, results[g]) &&
+                     expectedGlyph != results[g])) {
+                    mismatches++;
+                }
+            }
+        }
+    });
+    REPORTER_ASSERT(Reporter, mismatches == 0);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == kStrikeCount);
+
+    // The budgets still apply to the cache as a whole.
+    cache.setCacheCountLimit(0);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
+
+DEF_TEST(SkStrikeCache_GlobalLimits, Reporter) {
+    SkStrikeCache cache;
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+    font.setTypeface(ToolUtils::create_portable_typeface("serif", SkFontStyle::Italic()));
+
+    // Enough strikes that most shards hold several.
+    constexpr int kStrikeCount = 64;
+    std::vector<SkStrikeSpec> strikeSpecs;
+    SkPaint defaultPaint;
+    for (int i = 0; i < kStrikeCount; i++) {
+        font.setSize(8 + i);
+        strikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                font, defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I()));
+    }
+
+    SkPackedGlyphID glyphIDs[26];
+    for (int c = 0; c < 26; c++) {
+        glyphIDs[c] = SkPackedGlyphID{font.unicharToGlyph('a' + c)};
+    }
+    auto fill = [&](int i) {
+        sk_sp<SkStrike> strike = strikeSpecs[i].findOrCreateStrike(&cache);
+        const SkGlyph* results[26];
+        strike->prepareImages(glyphIDs, results);
+    };
+
+    // The count limit holds for the whole cache, not just for each shard's share of it.
+    cache.setCacheCountLimit(1);
+    for (int i = 0; i < kStrikeCount; i++) {
+        fill(i);
+        REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 1,
+                        "%d strikes cached", cache.getCacheCountUsed());
+    }
+    // The strike used last is the one kept.
+    REPORTER_ASSERT(Reporter, cache.findStrike(strikeSpecs[kStrikeCount - 1].descriptor()));
+
+    cache.setCacheCountLimit(kStrikeCount);
+    for (int i = 0; i < kStrikeCount; i++) {
+        fill(i);
+    }
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == kStrikeCount);
+
+    // Lowering a limit trims shards that are otherwise idle.
+    cache.setCacheCountLimit(5);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 5,
+                    "%d strikes cached", cache.getCacheCountUsed());
 
+    // The byte limit holds for the whole cache too, after each new strike.
+    cache.setCacheCountLimit(kStrikeCount);
+    const size_t sizeLimit = cache.getTotalMemoryUsed() * 4;
+    cache.setCacheSizeLimit(sizeLimit);
+    for (int i = 0; i < kStrikeCount; i++) {
+        fill(i);
+    }
+    for (int i = 0; i < kStrikeCount; i++) {
+        fill(i);
+        // Find the strike again, which purges its growth from preparing the images.
+        cache.findStrike(strikeSpecs[i].descriptor());
+        REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() <= sizeLimit,
+                        "%zu bytes cached, limit %zu", cache.getTotalMemoryUsed(), sizeLimit);
+    }
+}
+
+DEF_TEST(SkStrikeCache_DiskCache, Reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/hintgasp.ttf");
+    if (tmpDir.isEmpty() || !typeface) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "strike_disk_cache_test");
+    {
+        // Not a glyph cache file, so it is started over.
+        SkFILEWStream writer(path.c_str());
+        writer.write("garbage", 7);
+    }
+
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(typeface);
+    font.setSize(24);
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+
+    SkPackedGlyphID glyphIDs[26];
+    for (int c = 0; c < 26; c++) {
+        glyphIDs[c] = SkPackedGlyphID{font.unicharToGlyph('a' + c)};
+    }
+
+    // Generate the glyphs, and append them to the file.
+    SkStrikeCache writingCache;
+    REPORTER_ASSERT(Reporter, writingCache.setDiskCache(SkStrikeDiskCache::Make(path.c_str())));
+    sk_sp<SkStrike> written = strikeSpec.findOrCreateStrike(&writingCache);
+    const SkGlyph* writtenGlyphs[26];
+    written->prepareImages(glyphIDs, writtenGlyphs);
+    writingCache.diskCache()->flush();
+    const size_t writtenMemory = writingCache.getTotalMemoryUsed();
+
+    // A new cache on the same file makes the strike with all its images already in place.
+    SkStrikeCache readingCache;
+    REPORTER_ASSERT(Reporter, readingCache.setDiskCache(SkStrikeDiskCache::Make(path.c_str())));
+    sk_sp<SkStrike> read = strikeSpec.findOrCreateStrike(&readingCache);
+    REPORTER_ASSERT(Reporter, readingCache.getTotalMemoryUsed() == writtenMemory);
+
+    const SkGlyph* readGlyphs[26];
+    read->prepareImages(glyphIDs, readGlyphs);
+    REPORTER_ASSERT(Reporter, readingCache.getTotalMemoryUsed() == writtenMemory);
+    for (int g = 0; g < 26; g++) {
+        const SkGlyph* a = writtenGlyphs[g];
+        const SkGlyph* b = readGlyphs[g];
+        REPORTER_ASSERT(Reporter, a->getPackedID() == b->getPackedID());
+        REPORTER_ASSERT(Reporter, a->iRect() == b->iRect());
+        REPORTER_ASSERT(Reporter, a->imageSize() == b->imageSize());
+        if (a->image() != nullptr && b->image() != nullptr) {
+            REPORTER_ASSERT(Reporter, memcmp(a->image(), b->image(), a->imageSize()) == 0);
+        }
+    }
+}
+
+DEF_TEST(SkStrikeCache_DiskCacheLimit, Reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    sk_sp<SkTypeface> typeface = MakeResourceAsTypeface("fonts/hintgasp.ttf");
+    if (tmpDir.isEmpty() || !typeface) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "strike_disk_cache_limit_test");
+    {
+        // Start with an empty cache file.
+        SkFILEWStream writer(path.c_str());
+    }
+    auto fileSize = [&] {
+        sk_sp<SkData> contents = SkData::MakeFromFileName(path.c_str());
+        return contents ? contents->size() : 0;
+    };
+
+    // Larger sizes make larger records.
+    auto makeStrikeSpec = [&](SkScalar size) {
+        SkFont font;
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setTypeface(typeface);
+        font.setSize(size);
+        return SkStrikeSpec::MakeMask(font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                      SkScalerContextFlags::kNone, SkMatrix::I());
+    };
+    const SkStrikeSpec small = makeStrikeSpec(24),
+                       medium = makeStrikeSpec(48),
+                       large = makeStrikeSpec(96);
+    SkPackedGlyphID glyphIDs[26];
+    for (int c = 0; c < 26; c++) {
+        glyphIDs[c] = SkPackedGlyphID{SkFont(typeface).unicharToGlyph('a' + c)};
+    }
+    auto generate = [&](SkStrikeCache* cache, const SkStrikeSpec& strikeSpec) {
+        const SkGlyph* glyphs[26];
+        strikeSpec.findOrCreateStrike(cache)->prepareImages(glyphIDs, glyphs);
+        cache->diskCache()->flush();
+    };
+    // Whether a strike comes out of the cache with more than an empty strike has.
+    auto prefilled = [&](SkStrikeCache* cache, const SkStrikeSpec& strikeSpec) {
+        SkStrikeCache empty;
+        strikeSpec.findOrCreateStrike(&empty);
+        const size_t before = cache->getTotalMemoryUsed();
+        strikeSpec.findOrCreateStrike(cache);
+        return cache->getTotalMemoryUsed() - before > empty.getTotalMemoryUsed();
+    };
+
+    // Write the medium strike, then the small one.
+    {
+        SkStrikeCache cache;
+        REPORTER_ASSERT(Reporter, cache.setDiskCache(SkStrikeDiskCache::Make(path.c_str())));
+        generate(&cache, medium);
+        generate(&cache, small);
+    }
+    const size_t fullSize = fileSize();
+
+    // With the file at its limit, opening it keeps the strikes written last within half of it:
+    // the small strike fits, and the medium one doesn't.
+    SkStrikeCache cache;
+    REPORTER_ASSERT(Reporter,
+                    cache.setDiskCache(SkStrikeDiskCache::Make(path.c_str(), fullSize)));
+    const size_t compactedSize = fileSize();
+    REPORTER_ASSERT(Reporter, compactedSize > 0 && compactedSize <= fullSize / 2,
+                    "%zu bytes of %zu", compactedSize, fullSize);
+    {
+        SkStrikeCache reading;
+        REPORTER_ASSERT(Reporter, reading.setDiskCache(SkStrikeDiskCache::Make(path.c_str())));
+        REPORTER_ASSERT(Reporter, prefilled(&reading, small));
+        REPORTER_ASSERT(Reporter, !prefilled(&reading, medium));
+    }
 
+    // A record that doesn't fit under the limit isn't written.
+    generate(&cache, large);
+    REPORTER_ASSERT(Reporter, fileSize() == compactedSize);
 }
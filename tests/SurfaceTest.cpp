@@ -14,6 +14,7 @@
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
@@ -1299,3 +1300,80 @@ DEF_TEST(surface_image_unity, reporter) {
         }
     }
 }
+
+static void draw_tiled_test_content(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    canvas->clear(SK_ColorWHITE);
+    canvas->save();
+        canvas->translate(3.5f, 7.25f);
+        canvas->rotate(17);
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawOval(SkRect::MakeXYWH(10, 10, 150, 90), paint);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(5);
+        paint.setColor(0x8000FF00);
+        canvas->drawRRect(SkRRect::MakeRectXY(SkRect::MakeXYWH(40, 60, 120, 80), 12, 12), paint);
+        paint.setStyle(SkPaint::kFill_Style);
+    canvas->restore();
+
+    SkPaint layerPaint;
+    layerPaint.setAlphaf(0.5f);
+    canvas->saveLayer(nullptr, &layerPaint);
+        canvas->clipRect(SkRect::MakeLTRB(20, 20, 180, 150), true);
+        paint.setColor(SK_ColorRED);
+        SkPath path;
+        path.moveTo(0, 0);
+        path.cubicTo(200, 10, -50, 150, 190, 170);
+        path.close();
+        canvas->drawPath(path, paint);
+    canvas->restore();
+
+    SkFont font(ToolUtils::create_portable_typeface(), 24);
+    paint.setColor(SK_ColorBLACK);
+    canvas->drawString("tiles", 30, 120, font, paint);
+}
+
+// A tiled raster surface must produce exactly the pixels of a plain raster surface, including
+// when its pixels are read back while draws are still pending or a layer is still open.
+DEF_TEST(SurfaceRasterTiled, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(200, 170);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    sk_sp<SkSurface> expected = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> tiled = SkSurfaces::RasterTiled(info, executor.get(), {37, 29});
+    REPORTER_ASSERT(reporter, expected && tiled);
+
+    draw_tiled_test_content(expected->getCanvas());
+    draw_tiled_test_content(tiled->getCanvas());
+
+    sk_sp<SkImage> expectedImage = expected->makeImageSnapshot();
+    sk_sp<SkImage> tiledImage = tiled->makeImageSnapshot();
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expectedImage.get(), tiledImage.get()));
+
+    // Draws after a snapshot must not leak into that snapshot.
+    for (SkSurface* surface : {expected.get(), tiled.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->translate(10, 10);
+        canvas->saveLayerAlphaf(nullptr, 0.75f);
+        canvas->drawColor(SK_ColorCYAN, SkBlendMode::kSrcOver);
+    }
+
+    // With the layer still open, the base pixels shouldn't have changed yet.
+    SkBitmap expectedPixels, tiledPixels;
+    expectedPixels.allocPixels(info);
+    tiledPixels.allocPixels(info);
+    REPORTER_ASSERT(reporter, expected->readPixels(expectedPixels, 0, 0));
+    REPORTER_ASSERT(reporter, tiled->readPixels(tiledPixels, 0, 0));
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expectedPixels, tiledPixels));
+
+    for (SkSurface* surface : {expected.get(), tiled.get()}) {
+        surface->getCanvas()->restore();
+    }
+    REPORTER_ASSERT(reporter, expected->readPixels(expectedPixels, 0, 0));
+    REPORTER_ASSERT(reporter, tiled->readPixels(tiledPixels, 0, 0));
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expectedPixels, tiledPixels));
+
+    REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expectedImage.get(), tiledImage.get()));
+}
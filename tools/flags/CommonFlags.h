@@ -42,7 +42,8 @@ bool CollectImages(CommandLineFlags::StringArray dir, skia_private::TArray<SkStr
 void SetCtxOptions(struct GrContextOptions*);
 
 /**
- *  Enable, disable, or force analytic anti-aliasing using --analyticAA and --forceAnalyticAA.
+ *  Enable, disable, or force analytic anti-aliasing using --analyticAA and --forceAnalyticAA,
+ *  and the delta accumulation scan converter using --deltaAA and --forceDeltaAA.
  */
 void SetAnalyticAA();
 
@@ -11,10 +11,16 @@ static DEFINE_bool(forceAnalyticAA, false,
             "Force analytic anti-aliasing even if the path is complicated: "
             "whether it's concave or convex, we consider a path complicated"
             "if its number of points is comparable to its resolution.");
+static DEFINE_bool(deltaAA, false,
+            "Use delta accumulation anti-aliasing instead of supersampling for complicated paths.");
+static DEFINE_bool(forceDeltaAA, false,
+            "Force delta accumulation anti-aliasing for all non-inverse anti-aliased path fills.");
 
 void SetAnalyticAA() {
     gSkUseAnalyticAA   = FLAGS_analyticAA;
     gSkForceAnalyticAA = FLAGS_forceAnalyticAA;
+    gSkUseDeltaAA      = FLAGS_deltaAA;
+    gSkForceDeltaAA    = FLAGS_forceDeltaAA;
 }
 
 }
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTime.h"
+#include "include/encode/SkEncoder.h"
+#include "include/encode/SkPngEncoder.h"
+#include "include/utils/SkPictureBandRenderer.h"
+#include "tools/flags/CommandLineFlags.h"
+
+#include <memory>
+
+static DEFINE_string2(input, i, "", "skp to render");
+static DEFINE_string2(output, o, "", "png to write");
+static DEFINE_double(scale, 1, "Scale the picture by this much; the png is its scaled cull rect.");
+static DEFINE_int(bandHeight, 256, "Rows of the png to render at a time.");
+static DEFINE_bool(bbh, true, "Re-record the skp with an R-tree so each band culls its ops.");
+
+// Renders an SKP to a PNG a band of rows at a time, so that the PNG can be far larger than would
+// fit in memory as a single bitmap. Peak memory is one band of pixels plus the picture.
+// return codes:
+static const int kSuccess = 0;
+static const int kMissingInput = 1;
+static const int kNotAnSKP = 2;
+static const int kIOError = 3;
+static const int kRenderError = 4;
+
+int main(int argc, char** argv) {
+    CommandLineFlags::SetUsage("Renders an skp to a png in bands of rows");
+    CommandLineFlags::Parse(argc, argv);
+
+    if (FLAGS_input.size() != 1 || FLAGS_output.size() != 1) {
+        SkDebugf("Missing input or output file\n");
+        return kMissingInput;
+    }
+
+    std::unique_ptr<SkStream> stream = SkStream::MakeFromFile(FLAGS_input[0]);
+    if (!stream) {
+        SkDebugf("Could not read %s.\n", FLAGS_input[0]);
+        return kIOError;
+    }
+    sk_sp<SkPicture> picture = SkPicture::MakeFromStream(stream.get());
+    if (!picture) {
+        SkDebugf("Could not read %s as an SkPicture.\n", FLAGS_input[0]);
+        return kNotAnSKP;
+    }
+
+    const SkRect cullRect = picture->cullRect();
+    if (FLAGS_bbh) {
+        // Deserialized pictures have no bounding box hierarchy.
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        picture->playback(recorder.beginRecording(cullRect, &factory));
+        picture = recorder.finishRecordingAsPicture();
+    }
+
+    const float scale = (float)FLAGS_scale;
+    SkPictureBandRenderer::Options options;
+    options.fBandHeight = FLAGS_bandHeight;
+    options.fMatrix.setScale(scale, scale);
+    options.fMatrix.preTranslate(-cullRect.left(), -cullRect.top());
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(
+            SkScalarCeilToInt(cullRect.width() * scale),
+            SkScalarCeilToInt(cullRect.height() * scale));
+
+    SkFILEWStream out(FLAGS_output[0]);
+    if (!out.isValid()) {
+        SkDebugf("Could not write %s.\n", FLAGS_output[0]);
+        return kIOError;
+    }
+
+    // The encoder reads the rows of each band as they are rendered, so the pixmap it is made
+    // with only describes the whole image.
+    SkPixmap image;
+    std::unique_ptr<SkEncoder> encoder;
+    const double start = SkTime::GetMSecs();
+    bool rendered = SkPictureBandRenderer::Render(
+            picture.get(), info, options, [&](const SkPixmap& band, int top) {
+                if (!encoder) {
+                    image.reset(info, band.addr(), band.rowBytes());
+                    encoder = SkPngEncoder::Make(&out, image, {});
+                }
+                return encoder && encoder->encodeRows(band);
+            });
+    if (!rendered) {
+        SkDebugf("Could not render %s to %dx%d.\n", FLAGS_input[0], info.width(), info.height());
+        return kRenderError;
+    }
+    out.flush();
+
+    SkDebugf("Wrote %dx%d %s in %.0fms.\n", info.width(), info.height(), FLAGS_output[0],
+             SkTime::GetMSecs() - start);
+    return kSuccess;
+}